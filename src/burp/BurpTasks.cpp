@@ -1149,4 +1149,320 @@ const char* RestoreRelationTask::ExcReadDone::what() const noexcept
 	throw ExcReadDone();
 }
 
+
+/// class RestoreIndexTask
+
+RestoreIndexTask::RestoreIndexTask(BurpGlobals* tdgbl) : BurpTask(tdgbl),
+	m_indices(*getDefaultMemoryPool()),
+	m_memoryBudget(tdgbl->gbl_sw_index_memory),
+	m_memoryUsed(0),
+	m_totalSize(0),
+	m_workersUsed(0),
+	m_running(0),
+	m_pending(0),
+	m_done(0),
+	m_error(false)
+{
+	int workers = tdgbl->gbl_sw_par_workers;
+	if (workers <= 0)
+		workers = 1;
+
+	MemoryPool* pool = getDefaultMemoryPool();
+
+	// every item creates one index at a time
+	for (int i = 0; i < workers; i++)
+		m_items.add(FB_NEW_POOL(*pool) Item(this));
+}
+
+RestoreIndexTask::~RestoreIndexTask()
+{
+	for (Item** p = m_items.begin(); p < m_items.end(); p++)
+		delete *p;
+}
+
+void RestoreIndexTask::addIndex(const QualifiedMetaString& name, const QualifiedMetaString& relation,
+	const QualifiedMetaString& master, FB_UINT64 sortSize)
+{
+	Index& index = m_indices.add();
+	index.name = name;
+	index.relation = relation;
+	index.master = master;
+	index.sortSize = sortSize;
+	index.workers = 1;
+	index.started = false;
+	index.running = false;
+
+	m_totalSize += sortSize;
+	m_pending++;
+}
+
+bool RestoreIndexTask::handler(WorkItem& _item)
+{
+	Item* item = static_cast<Item*>(&_item);
+
+	BurpGlobals gbl(m_masterGbl->uSvc);
+	gbl.master = false;
+
+	BurpGblHolder holder(&gbl, item);
+
+	Index& index = m_indices[item->m_index];
+	bool ret = true;
+
+	try
+	{
+		if (!activate(index))
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			m_masterGbl->flag_on_line = false;
+		}
+	}
+	catch (const LongJump&)
+	{
+		m_error = true;
+		ret = false;
+	}
+	catch (const Exception& ex)
+	{
+		FbLocalStatus st;
+		ex.stuffException(&st);
+
+		{ // scope
+			SimpleGblHolder gbl(m_masterGbl);
+			BURP_print_status(&st, true);
+		}
+
+		m_error = true;
+		ret = false;
+	}
+
+	finishIndex(index);
+	return ret;
+}
+
+bool RestoreIndexTask::getWorkItem(WorkItem** pItem)
+{
+	Item* item = static_cast<Item*>(*pItem);
+
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	if (!item)
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+		{
+			if (!(*p)->m_inuse)
+			{
+				(*p)->m_inuse = true;
+				*pItem = item = *p;
+				break;
+			}
+		}
+
+		if (!item)
+			return false;
+	}
+
+	// Wait until some pending index fits into the workers and memory limits.
+	// Nothing is left to wait for when there are no pending or running indices.
+
+	while (m_pending && !m_error)
+	{
+		FB_SIZE_T pos;
+		if (pickIndex(pos))
+		{
+			item->m_index = pos;
+			startIndex(m_indices[pos]);
+			return true;
+		}
+
+		fb_assert(m_running);
+		m_cond.wait(m_mutex);
+	}
+
+	item->m_inuse = false;
+	*pItem = NULL;
+	return false;
+}
+
+bool RestoreIndexTask::getResult(IStatus* /*status*/)
+{
+	return !m_error;
+}
+
+int RestoreIndexTask::getMaxWorkers()
+{
+	return MIN(m_items.getCount(), m_indices.getCount());
+}
+
+bool RestoreIndexTask::isBusy(const QualifiedMetaString& relation) const
+{
+	if (relation.object.isEmpty())
+		return false;
+
+	for (const auto& index : m_indices)
+	{
+		if (index.running && (index.relation == relation || index.master == relation))
+			return true;
+	}
+
+	return false;
+}
+
+bool RestoreIndexTask::pickIndex(FB_SIZE_T& pos) const
+{
+	// Choose the biggest index that fits into the memory budget. When nothing
+	// is running, the budget is ignored - otherwise the index is never created.
+
+	bool found = false;
+
+	for (FB_SIZE_T i = 0; i < m_indices.getCount(); i++)
+	{
+		const Index& index = m_indices[i];
+
+		if (index.started || isBusy(index.relation) || isBusy(index.master))
+			continue;
+
+		if (m_running && m_memoryBudget && m_memoryUsed + index.sortSize > m_memoryBudget)
+			continue;
+
+		if (!found || index.sortSize > m_indices[pos].sortSize)
+		{
+			pos = i;
+			found = true;
+		}
+	}
+
+	return found && (!m_running || m_workersUsed < (int) m_items.getCount());
+}
+
+void RestoreIndexTask::startIndex(Index& index)
+{
+	// Big index gets engine workers in proportion to its share of the total
+	// sort size, small ones get just one worker
+
+	const int maxWorkers = m_items.getCount();
+	int workers = 1;
+
+	if (m_totalSize)
+		workers = MAX(1, (int) ((index.sortSize * maxWorkers + m_totalSize - 1) / m_totalSize));
+
+	if (m_workersUsed + workers > maxWorkers)
+		workers = MAX(1, maxWorkers - m_workersUsed);
+
+	index.workers = workers;
+	index.started = true;
+	index.running = true;
+
+	m_workersUsed += workers;
+	m_memoryUsed += index.sortSize;
+	m_running++;
+	m_pending--;
+}
+
+void RestoreIndexTask::finishIndex(Index& index)
+{
+	unsigned done;
+
+	{ // scope
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		index.running = false;
+
+		m_workersUsed -= index.workers;
+		m_memoryUsed -= index.sortSize;
+		m_running--;
+		done = ++m_done;
+
+		m_cond.notifyAll();
+	}
+
+	BURP_verbose(427, SafeArg() << index.name.toQuotedString().c_str() << index.workers <<
+		done << m_indices.getCount());
+	// msg 427 index @1 created using @2 worker(s), @3 of @4 done
+}
+
+bool RestoreIndexTask::activate(Index& index)
+{
+	BURP_verbose(285, index.name.toQuotedString());
+	// activating and creating deferred index %s
+
+	FbLocalStatus status;
+	DispatcherPtr provider;
+
+	ClumpletWriter dpb(ClumpletReader::dpbList, MAX_DPB_SIZE,
+		m_masterGbl->gbl_dpb_data.begin(),
+		m_masterGbl->gbl_dpb_data.getCount());
+
+	dpb.deleteWithTag(isc_dpb_parallel_workers);
+	dpb.insertInt(isc_dpb_parallel_workers, index.workers);
+
+	IAttachment* att = provider->attachDatabase(&status, m_masterGbl->gbl_database_file_name,
+		dpb.getBufferLength(), dpb.getBuffer());
+
+	if (!(status->getState() & IStatus::STATE_ERRORS))
+	{
+		ClumpletWriter tpb(ClumpletReader::Tpb, 128, isc_tpb_version3);
+		tpb.insertTag(isc_tpb_read_committed);
+		tpb.insertTag(isc_tpb_rec_version);
+		tpb.insertTag(isc_tpb_no_auto_undo);
+
+		ITransaction* tra = att->startTransaction(&status, tpb.getBufferLength(), tpb.getBuffer());
+
+		if (!(status->getState() & IStatus::STATE_ERRORS))
+		{
+			// The same as activateIndex() in restore.epp does. The index itself
+			// is created by the engine when the transaction is committed.
+
+			const auto quote = [](const MetaString& name)
+			{
+				string str("'");
+
+				for (const char* p = name.c_str(); *p; p++)
+				{
+					if (*p == '\'')
+						str += '\'';
+					str += *p;
+				}
+
+				return str + "'";
+			};
+
+			string sql;
+			sql.printf("UPDATE RDB$INDICES SET RDB$INDEX_INACTIVE = 0 "
+				"WHERE RDB$SCHEMA_NAME IS NOT DISTINCT FROM %s AND RDB$INDEX_NAME = %s",
+				index.name.schema.hasData() ? quote(index.name.schema).c_str() : "NULL",
+				quote(index.name.object).c_str());
+
+			att->execute(&status, tra, 0, sql.c_str(), SQL_DIALECT_V6,
+				nullptr, nullptr, nullptr, nullptr);
+
+			if (!(status->getState() & IStatus::STATE_ERRORS))
+			{
+				tra->commit(&status);
+
+				if (!(status->getState() & IStatus::STATE_ERRORS))
+					tra = nullptr;
+			}
+
+			if (tra)
+			{
+				FbLocalStatus tempStatus;
+				tra->rollback(&tempStatus);
+			}
+		}
+
+		FbLocalStatus tempStatus;
+		att->detach(&tempStatus);
+	}
+
+	if (status->getState() & IStatus::STATE_ERRORS)
+	{
+		BURP_print(173, index.name.toQuotedString().c_str());
+		// msg 173 cannot commit index @1
+		BURP_print_status(&status);
+		return false;
+	}
+
+	return true;
+}
+
 } // namespace Firebird
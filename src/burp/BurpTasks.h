@@ -485,6 +485,11 @@ public:
 	void verbRecs(FB_UINT64& records, bool total);
 	void verbRecsFinal();
 
+	FB_UINT64 getRecords() const noexcept
+	{
+		return static_cast<FB_UINT64>(m_records);
+	}
+
 	// commit and detach all worker connections
 	bool finish();
 
@@ -529,6 +534,79 @@ private:
 };
 
 
+// Activates deferred indices using a few connections in parallel. Every index is
+// created by its own connection, the engine workers count (isc_dpb_parallel_workers)
+// of the connection depends on the estimated index size. Indices are scheduled
+// largest first, within the total sort memory budget, and indices of the same
+// table (or of the table referenced by a foreign key) are never created at once.
+class RestoreIndexTask : public BurpTask
+{
+public:
+	RestoreIndexTask(BurpGlobals* tdgbl);
+	~RestoreIndexTask();
+
+	void addIndex(const Firebird::QualifiedMetaString& name,
+				  const Firebird::QualifiedMetaString& relation,
+				  const Firebird::QualifiedMetaString& master,
+				  FB_UINT64 sortSize);
+
+	FB_SIZE_T getIndexCount() const noexcept
+	{
+		return m_indices.getCount();
+	}
+
+	bool handler(WorkItem& _item) override;
+	bool getWorkItem(WorkItem** pItem) override;
+	bool getResult(Firebird::IStatus* status) override;
+	int getMaxWorkers() override;
+
+	class Item : public BurpTaskItem
+	{
+	public:
+		Item(RestoreIndexTask* task) : BurpTaskItem(task)
+		{}
+
+		bool m_inuse = false;
+		FB_SIZE_T m_index = 0;		// index to create, position in m_indices
+	};
+
+private:
+	struct Index
+	{
+		explicit Index(MemoryPool& pool)
+			: name(pool), relation(pool), master(pool)
+		{}
+
+		Firebird::QualifiedMetaString name;
+		Firebird::QualifiedMetaString relation;
+		Firebird::QualifiedMetaString master;	// table referenced by foreign key
+		FB_UINT64 sortSize;		// estimated
+		int workers;
+		bool started;
+		bool running;
+	};
+
+	bool pickIndex(FB_SIZE_T& pos) const;
+	bool isBusy(const Firebird::QualifiedMetaString& relation) const;
+	void startIndex(Index& index);
+	void finishIndex(Index& index);
+	bool activate(Index& index);
+
+	Firebird::ObjectsArray<Index> m_indices;
+	Firebird::HalfStaticArray<Item*, 8> m_items;
+	Firebird::Mutex m_mutex;
+	Firebird::Condition m_cond;
+	const FB_UINT64 m_memoryBudget;		// 0 means no limit
+	FB_UINT64 m_memoryUsed;
+	FB_UINT64 m_totalSize;
+	int m_workersUsed;
+	unsigned m_running;
+	unsigned m_pending;
+	unsigned m_done;
+	bool m_error;
+};
+
+
 class IOBuffer
 {
 public:
@@ -332,6 +332,8 @@ static int svc_api_gbak(Firebird::UtilSvc* uSvc, const Switches& switches)
 		case IN_SW_BURP_FIX_FSS_DATA:
 		case IN_SW_BURP_FIX_FSS_METADATA:
 		case IN_SW_BURP_PARALLEL_WORKERS:
+		case IN_SW_BURP_INDEX_MEMORY:
+		case IN_SW_BURP_ZIP_LEVEL:
 		case IN_SW_BURP_Y:
 		case IN_SW_BURP_STATS:
 		case IN_SW_BURP_REPLICA:
@@ -866,6 +868,19 @@ int gbak(Firebird::UtilSvc* uSvc)
 				BURP_error(334, true, SafeArg() << in_sw_tab->in_sw_name);
 			tdgbl->gbl_sw_zip = true;
 			break;
+		case IN_SW_BURP_ZIP_LEVEL:
+			if (++itr >= argc)
+			{
+				BURP_error(429, true);
+				// msg 429 compression level parameter missing
+			}
+			tdgbl->gbl_sw_zip_level = get_number(argv[itr]);
+			if (tdgbl->gbl_sw_zip_level < 1 || tdgbl->gbl_sw_zip_level > 9)
+			{
+				BURP_error(430, true, argv[itr]);
+				// msg 430 expected compression level between 1 and 9, encountered "%s"
+			}
+			break;
 		case IN_SW_BURP_FA:
 			if (tdgbl->gbl_sw_blk_factor)
 				BURP_error(333, true, SafeArg() << in_sw_tab->in_sw_name << tdgbl->gbl_sw_blk_factor);
@@ -925,6 +940,22 @@ int gbak(Firebird::UtilSvc* uSvc)
 			if (tdgbl->gbl_sw_par_workers > BURP_MAX_PARALLEL_WORKERS)
 				tdgbl->gbl_sw_par_workers = BURP_MAX_PARALLEL_WORKERS;
 			break;
+		case IN_SW_BURP_INDEX_MEMORY:
+			{
+				if (++itr >= argc)
+				{
+					BURP_error(424, true);
+					// msg 424 index memory budget parameter missing
+				}
+				const SLONG megabytes = get_number(argv[itr]);
+				if (megabytes <= 0)
+				{
+					BURP_error(425, true, argv[itr]);
+					// msg 425 expected index memory budget, encountered "%s"
+				}
+				tdgbl->gbl_sw_index_memory = static_cast<FB_UINT64>(megabytes) * MBYTE;
+			}
+			break;
 		case IN_SW_BURP_Y:
 			{
 				// want to do output redirect handling now instead of waiting
@@ -1401,6 +1432,8 @@ int gbak(Firebird::UtilSvc* uSvc)
 			errNum = IN_SW_BURP_OL;
 		else if (tdgbl->gbl_sw_zip)
 			errNum = IN_SW_BURP_ZIP;
+		else if (tdgbl->gbl_sw_zip_level)
+			errNum = IN_SW_BURP_ZIP_LEVEL;
 
 		if (errNum != IN_SW_BURP_0)
 		{
@@ -1497,6 +1530,9 @@ int gbak(Firebird::UtilSvc* uSvc)
 		exit_code = FINI_ERROR;
 	}
 
+	// Stop compression threads if they still run
+	MVOL_fini_zip(tdgbl);
+
 	// Close the gbak file handles if they still open
 	for (burp_fil* file = tdgbl->gbl_sw_backup_files; file; file = file->fil_next)
 	{
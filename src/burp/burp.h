@@ -216,6 +216,12 @@ Version 12: FB6.0.
 
 inline constexpr int ATT_BACKUP_FORMAT = 12;
 
+// att_backup_zip values
+
+inline constexpr int BACKUP_ZIP_NONE = 0;
+inline constexpr int BACKUP_ZIP_STREAM = 1;		// single zlib stream
+inline constexpr int BACKUP_ZIP_FRAMES = 2;		// independently compressed frames
+
 // max array dimension
 
 inline constexpr int MAX_DIMENSION = 16;
@@ -795,6 +801,7 @@ struct burp_rel
 	Firebird::QualifiedMetaString rel_name;
 	GDS_NAME	rel_owner;		// relation owner, if not us
 	ULONG		rel_max_pp;		// max pointer page sequence number
+	FB_UINT64	rel_records;	// records restored
 };
 
 enum burp_rel_flags_vals {
@@ -999,6 +1006,7 @@ public:
 namespace Burp
 {
 	class BurpTaskItem;
+	class ZipFrames;
 };
 
 class BurpGlobals : public Firebird::ThreadData, public GblPool
@@ -1008,6 +1016,7 @@ public:
 		: ThreadData(ThreadData::tddGBL),
 		  GblPool(us->isService()),
 		  gbl_sw_par_workers(1),
+		  gbl_sw_index_memory(0),
 		  defaultCollations(getPool()),
 		  systemFields(getPool()),
 		  gbl_dpb_data(*getDefaultMemoryPool()),
@@ -1062,6 +1071,8 @@ public:
 	bool		gbl_sw_overwrite;
 	bool		gbl_sw_direct_io;
 	bool		gbl_sw_zip;
+	bool		gbl_sw_zip_frames;		// backup is compressed by independent frames
+	int			gbl_sw_zip_level;		// compression level, 0 - default
 	const SCHAR*	gbl_sw_keyholder;
 	const SCHAR*	gbl_sw_crypt;
 	const SCHAR*	gbl_sw_keyname;
@@ -1075,6 +1086,7 @@ public:
 	burp_fil*	gbl_sw_files;
 	burp_fil*	gbl_sw_backup_files;
 	int			gbl_sw_par_workers;
+	FB_UINT64	gbl_sw_index_memory;	// sort memory budget for parallel index creation
 	gfld*		gbl_global_fields;
 	unsigned	gbl_network_protocol;
 	burp_act*	action;
@@ -1114,6 +1126,7 @@ public:
 	UCHAR*		gbl_crypt_buffer;
 	ULONG		gbl_crypt_left;
 	UCHAR*      gbl_decompress;
+	Burp::ZipFrames*	gbl_zip;		// parallel compression
 	bool		gbl_default_pub_active = false;
 	bool		gbl_default_pub_auto_enable = false;
 
@@ -105,6 +105,9 @@ inline constexpr int IN_SW_BURP_DIRECT_IO			= 55;	// direct IO for backup files
 inline constexpr int IN_SW_BURP_SKIP_SCHEMA_DATA	= 56;	// skip data from schema
 inline constexpr int IN_SW_BURP_INCLUDE_SCHEMA_DATA	= 57;	// backup data from schemas
 
+inline constexpr int IN_SW_BURP_INDEX_MEMORY		= 58;	// memory budget for parallel index creation
+inline constexpr int IN_SW_BURP_ZIP_LEVEL			= 59;	// compression level of .zip backup
+
 /**************************************************************************/
 
 static inline constexpr const char* BURP_SW_MODE_NONE = "NONE";
@@ -197,6 +200,8 @@ static inline constexpr Switches::in_sw_tab_t reference_burp_in_sw_table[] =
 				// msg 416: @1INCLUDE_SCHEMA_D(ATA) backup data of schemas(s)
 	{IN_SW_BURP_INCLUDE_DATA, isc_spb_res_include_data, "INCLUDE_DATA",		0, 0, 0, false, false,	388,	7, NULL, boGeneral},
 				// msg 388: @1INCLUDE(_DATA) backup data of table(s)
+	{IN_SW_BURP_INDEX_MEMORY, isc_spb_res_index_memory, "INDEX_MEMORY",	0, 0, 0, false, false,	423,	9, NULL, boRestore},
+				// msg 423: @1INDEX_MEM(ORY) memory budget (MB) for parallel index creation
 	{IN_SW_BURP_STATS, isc_spb_bkp_stat,		"STATISTICS",		0, 0, 0, false, false,	361,	2, NULL, boGeneral},
 				// msg 361: @1ST(ATISTICS) TDRW    show statistics:
 	{-1,				0,							" ",			0, 0, 0, false, false,	362,	0, NULL, boGeneral},
@@ -231,6 +236,8 @@ static inline constexpr Switches::in_sw_tab_t reference_burp_in_sw_table[] =
 				// msg 104: @1Z print version number
 	{IN_SW_BURP_ZIP,  isc_spb_bkp_zip,			"ZIP",				0, 0, 0, false, true,	374,	3, NULL, boBackup},
 				// msg 104: @1ZIP backup file is in zip compressed format
+	{IN_SW_BURP_ZIP_LEVEL, isc_spb_bkp_zip_level, "ZIP_LEVEL",		0, 0, 0, false, false,	428,	5, NULL, boBackup},
+				// msg 428: @1ZIP_L(EVEL) compression level (1 - 9) for zip format
 /**************************************************************************/
 // The next two 'virtual' switches are hidden from user and are needed
 // for services API
@@ -67,6 +67,8 @@
 #include "../common/db_alias.h"
 #include "../common/status.h"
 #include "../common/classes/zip.h"
+#include "../common/ThreadStart.h"
+#include "memory_routines.h"
 
 using MsgFormat::SafeArg;
 using Firebird::FbLocalStatus;
@@ -419,6 +421,315 @@ static ULONG crypt_read_block(BurpGlobals* tdgbl, UCHAR* buffer, FB_SIZE_T buffe
 }
 
 
+#ifdef HAVE_ZLIB_H
+
+// Backup data compressed by a few threads in parallel. Data is cut into frames of
+// fixed size, every frame is compressed independently by worker thread and frames
+// are written into the backup file in original order, each as
+//		<raw length : 4 bytes> <packed length : 4 bytes> <packed data>
+// Restore decompresses frames one by one, as they come from the backup stream.
+
+class Burp::ZipFrames
+{
+public:
+	// writer
+	ZipFrames(Firebird::MemoryPool& pool, int level, int workers);
+	// reader
+	explicit ZipFrames(Firebird::MemoryPool& pool);
+
+	~ZipFrames();
+
+	void write(BurpGlobals* tdgbl, const UCHAR* buffer, ULONG length);
+	void flush(BurpGlobals* tdgbl);
+	ULONG read(BurpGlobals* tdgbl, UCHAR* buffer, ULONG length);
+
+private:
+	static constexpr ULONG FRAME_SIZE = 256 * 1024;
+	static constexpr ULONG PACKED_SIZE = FRAME_SIZE + FRAME_SIZE / 1000 + 64;
+	static constexpr ULONG HEADER_SIZE = 8;
+
+	enum FrameState {FRAME_FREE, FRAME_QUEUED, FRAME_DONE};
+
+	struct Frame
+	{
+		explicit Frame(Firebird::MemoryPool& pool)
+			: raw(pool), packed(pool)
+		{
+			raw.getBuffer(FRAME_SIZE);
+			packed.getBuffer(PACKED_SIZE);
+		}
+
+		Firebird::Array<UCHAR> raw;
+		Firebird::Array<UCHAR> packed;
+		ULONG rawLength = 0;
+		ULONG packedLength = 0;
+		FrameState state = FRAME_FREE;
+		int result = Z_OK;
+	};
+
+	FB_SIZE_T nextFrame(FB_SIZE_T pos) const
+	{
+		return (pos + 1) % m_frames.getCount();
+	}
+
+	void submit(BurpGlobals* tdgbl);
+	void writeFrame(BurpGlobals* tdgbl, bool flash);
+	void readExact(BurpGlobals* tdgbl, UCHAR* buffer, ULONG length);
+	int compress(Frame& frame);
+	void worker();
+
+	static THREAD_ENTRY_DECLARE workerThread(THREAD_ENTRY_PARAM arg)
+	{
+		static_cast<ZipFrames*>(arg)->worker();
+		return 0;
+	}
+
+	const int m_level;
+	Firebird::ObjectsArray<Frame> m_frames;
+	Firebird::HalfStaticArray<FB_SIZE_T, 16> m_queue;	// frames to compress, in order
+	Firebird::HalfStaticArray<Thread*, 16> m_threads;
+	Firebird::Mutex m_mutex;
+	Firebird::Condition m_workCond;
+	Firebird::Condition m_doneCond;
+	FB_SIZE_T m_fill;		// frame filled by writer
+	FB_SIZE_T m_flush;		// oldest frame not written yet
+	ULONG m_readPos;		// read position in current frame
+	bool m_stop;
+};
+
+Burp::ZipFrames::ZipFrames(Firebird::MemoryPool& pool, int level, int workers)
+	: m_level(level),
+	  m_frames(pool),
+	  m_queue(pool),
+	  m_threads(pool),
+	  m_fill(0),
+	  m_flush(0),
+	  m_readPos(0),
+	  m_stop(false)
+{
+	fb_assert(workers > 0);
+
+	// two frames per worker let the writer fill next frames while others are compressed
+	for (int i = 0; i < workers * 2; i++)
+		m_frames.add();
+
+	for (int i = 0; i < workers; i++)
+	{
+		Thread* thread = FB_NEW_POOL(pool) Thread;
+		m_threads.add(thread);
+		Thread::start(workerThread, this, THREAD_medium, thread);
+	}
+}
+
+Burp::ZipFrames::ZipFrames(Firebird::MemoryPool& pool)
+	: m_level(0),
+	  m_frames(pool),
+	  m_queue(pool),
+	  m_threads(pool),
+	  m_fill(0),
+	  m_flush(0),
+	  m_readPos(0),
+	  m_stop(false)
+{
+	m_frames.add();
+}
+
+Burp::ZipFrames::~ZipFrames()
+{
+	{	// scope
+		Firebird::MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		m_stop = true;
+		m_queue.clear();
+	}
+	m_workCond.notifyAll();
+
+	for (auto thread : m_threads)
+	{
+		thread->waitForCompletion();
+		delete thread;
+	}
+}
+
+void Burp::ZipFrames::write(BurpGlobals* tdgbl, const UCHAR* buffer, ULONG length)
+{
+	while (length)
+	{
+		Frame& frame = m_frames[m_fill];
+
+		const ULONG n = MIN(length, FRAME_SIZE - frame.rawLength);
+		memcpy(frame.raw.begin() + frame.rawLength, buffer, n);
+		frame.rawLength += n;
+		buffer += n;
+		length -= n;
+
+		if (frame.rawLength == FRAME_SIZE)
+			submit(tdgbl);
+	}
+}
+
+void Burp::ZipFrames::flush(BurpGlobals* tdgbl)
+{
+	submit(tdgbl);
+
+	while (m_flush != m_fill)
+		writeFrame(tdgbl, nextFrame(m_flush) == m_fill);
+}
+
+void Burp::ZipFrames::submit(BurpGlobals* tdgbl)
+{
+	Frame& frame = m_frames[m_fill];
+	if (!frame.rawLength)
+		return;
+
+	{	// scope
+		Firebird::MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		frame.state = FRAME_QUEUED;
+		m_queue.add(m_fill);
+	}
+	m_workCond.notifyOne();
+
+	// All frames are busy - wait for the oldest one and write it
+	m_fill = nextFrame(m_fill);
+	if (m_fill == m_flush)
+		writeFrame(tdgbl, false);
+}
+
+void Burp::ZipFrames::writeFrame(BurpGlobals* tdgbl, bool flash)
+{
+	Frame& frame = m_frames[m_flush];
+
+	{	// scope
+		Firebird::MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		while (frame.state != FRAME_DONE)
+			m_doneCond.wait(m_mutex);
+	}
+
+	if (frame.result != Z_OK)
+		BURP_error(380, true, SafeArg() << frame.result);
+
+	UCHAR header[HEADER_SIZE];
+	put_vax_long(header, frame.rawLength);
+	put_vax_long(header + 4, frame.packedLength);
+
+	crypt_write_block(tdgbl, header, sizeof(header), false);
+	crypt_write_block(tdgbl, frame.packed.begin(), frame.packedLength, flash);
+
+	frame.rawLength = frame.packedLength = 0;
+	frame.state = FRAME_FREE;
+	m_flush = nextFrame(m_flush);
+}
+
+int Burp::ZipFrames::compress(Frame& frame)
+{
+	z_stream strm;
+	memset(&strm, 0, sizeof(strm));
+	strm.zalloc = Firebird::ZLib::allocFunc;
+	strm.zfree = Firebird::ZLib::freeFunc;
+	strm.opaque = Z_NULL;
+
+	int ret = zlib().deflateInit(&strm, m_level);
+	if (ret != Z_OK)
+		return ret;
+
+	strm.next_in = frame.raw.begin();
+	strm.avail_in = frame.rawLength;
+	strm.next_out = frame.packed.begin();
+	strm.avail_out = PACKED_SIZE;
+
+	ret = zlib().deflate(&strm, Z_FINISH);
+	frame.packedLength = PACKED_SIZE - strm.avail_out;
+	zlib().deflateEnd(&strm);
+
+	return (ret == Z_STREAM_END) ? Z_OK : ret;
+}
+
+void Burp::ZipFrames::worker()
+{
+	Firebird::MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	while (true)
+	{
+		while (m_queue.isEmpty() && !m_stop)
+			m_workCond.wait(m_mutex);
+
+		if (m_stop)
+			break;
+
+		Frame& frame = m_frames[m_queue[0]];
+		m_queue.remove((FB_SIZE_T) 0);
+
+		{	// scope
+			Firebird::MutexUnlockGuard unguard(m_mutex, FB_FUNCTION);
+			frame.result = compress(frame);
+		}
+
+		frame.state = FRAME_DONE;
+		m_doneCond.notifyAll();
+	}
+}
+
+void Burp::ZipFrames::readExact(BurpGlobals* tdgbl, UCHAR* buffer, ULONG length)
+{
+	while (length)
+	{
+		const ULONG n = crypt_read_block(tdgbl, buffer, length);
+		buffer += n;
+		length -= n;
+	}
+}
+
+ULONG Burp::ZipFrames::read(BurpGlobals* tdgbl, UCHAR* buffer, ULONG length)
+{
+	Frame& frame = m_frames[0];
+
+	if (m_readPos == frame.rawLength)
+	{
+		UCHAR header[HEADER_SIZE];
+		readExact(tdgbl, header, sizeof(header));
+
+		const ULONG rawLength = gds__vax_integer(header, 4);
+		const ULONG packedLength = gds__vax_integer(header + 4, 4);
+
+		if (rawLength > FRAME_SIZE || packedLength > PACKED_SIZE)
+			BURP_error(379, true, SafeArg() << Z_DATA_ERROR);
+
+		readExact(tdgbl, frame.packed.begin(), packedLength);
+
+		z_stream strm;
+		memset(&strm, 0, sizeof(strm));
+		strm.zalloc = Firebird::ZLib::allocFunc;
+		strm.zfree = Firebird::ZLib::freeFunc;
+		strm.opaque = Z_NULL;
+
+		int ret = zlib().inflateInit(&strm);
+		if (ret != Z_OK)
+			BURP_error(383, true, SafeArg() << ret);
+
+		strm.next_in = frame.packed.begin();
+		strm.avail_in = packedLength;
+		strm.next_out = frame.raw.begin();
+		strm.avail_out = rawLength;
+
+		ret = zlib().inflate(&strm, Z_FINISH);
+		zlib().inflateEnd(&strm);
+
+		if (ret != Z_STREAM_END || strm.avail_out)
+			BURP_error(379, true, SafeArg() << ret);
+
+		frame.rawLength = rawLength;
+		m_readPos = 0;
+	}
+
+	length = MIN(length, frame.rawLength - m_readPos);
+	memcpy(buffer, frame.raw.begin() + m_readPos, length);
+	m_readPos += length;
+
+	return length;
+}
+
+#endif // HAVE_ZLIB_H
+
+
 //____________________________________________________________
 //
 //
@@ -431,6 +742,9 @@ static ULONG unzip_read_block(BurpGlobals* tdgbl, UCHAR* buffer, FB_SIZE_T buffe
 	}
 
 #ifdef HAVE_ZLIB_H
+	if (tdgbl->gbl_zip)
+		return tdgbl->gbl_zip->read(tdgbl, buffer, buffer_length);
+
 	z_stream& strm = tdgbl->gbl_stream;
 	strm.avail_out = buffer_length;
 	strm.next_out = buffer;
@@ -498,6 +812,14 @@ static void zip_write_block(BurpGlobals* tdgbl, const UCHAR* buffer, FB_SIZE_T b
 	}
 
 #ifdef HAVE_ZLIB_H
+	if (tdgbl->gbl_zip)
+	{
+		tdgbl->gbl_zip->write(tdgbl, buffer, buffer_length);
+		if (flash)
+			tdgbl->gbl_zip->flush(tdgbl);
+		return;
+	}
+
 	z_stream& strm = tdgbl->gbl_stream;
 	strm.avail_in = buffer_length;
 	strm.next_in = (Bytef*)buffer;
@@ -564,12 +886,13 @@ FB_UINT64 MVOL_fini_read()
 	BurpGlobals* tdgbl = BurpGlobals::getSpecific();
 
 #ifdef HAVE_ZLIB_H
-	if (tdgbl->gbl_sw_zip)
+	if (tdgbl->gbl_sw_zip && !tdgbl->gbl_zip)
 	{
 		zlib().inflateEnd(&tdgbl->gbl_stream);
 	}
 #endif
 
+	MVOL_fini_zip(tdgbl);
 	brio_fini(tdgbl);
 
 	return mvol_fini_read(tdgbl);
@@ -609,12 +932,13 @@ FB_UINT64 MVOL_fini_write()
 	zip_write_block(tdgbl, tdgbl->gbl_compress_buffer, tdgbl->gbl_io_ptr - tdgbl->gbl_compress_buffer, true);
 
 #ifdef HAVE_ZLIB_H
-	if (tdgbl->gbl_sw_zip)
+	if (tdgbl->gbl_sw_zip && !tdgbl->gbl_zip)
 	{
 		zlib().deflateEnd(&tdgbl->gbl_stream);
 	}
 #endif
 
+	MVOL_fini_zip(tdgbl);
 	brio_fini(tdgbl);
 
 	return mvol_fini_write(tdgbl, &tdgbl->blk_io_cnt, &tdgbl->blk_io_ptr);
@@ -677,6 +1001,19 @@ static void brio_fini(BurpGlobals* tdgbl)
 }
 
 
+//____________________________________________________________
+//
+// Stop parallel compression, if any
+//
+void MVOL_fini_zip(BurpGlobals* tdgbl)
+{
+#ifdef HAVE_ZLIB_H
+	delete tdgbl->gbl_zip;
+	tdgbl->gbl_zip = NULL;
+#endif
+}
+
+
 static void checkCompression()
 {
 #ifdef HAVE_ZLIB_H
@@ -705,6 +1042,14 @@ void MVOL_init_read(const char* file_name, USHORT* format)
 	if (tdgbl->gbl_sw_zip)
 	{
 #ifdef HAVE_ZLIB_H
+		checkCompression();
+
+		if (tdgbl->gbl_sw_zip_frames)
+		{
+			tdgbl->gbl_zip = FB_NEW_POOL(tdgbl->getPool()) ZipFrames(tdgbl->getPool());
+			return;
+		}
+
 		z_stream& strm = tdgbl->gbl_stream;
 
 		strm.zalloc = Firebird::ZLib::allocFunc;
@@ -712,7 +1057,6 @@ void MVOL_init_read(const char* file_name, USHORT* format)
 		strm.opaque = Z_NULL;
 		strm.avail_in = 0;
 		strm.next_in = Z_NULL;
-		checkCompression();
 		int ret = zlib().inflateInit(&strm);
 		if (ret != Z_OK)
 #endif
@@ -769,6 +1113,9 @@ void MVOL_init_write(const char* file_name)
 {
 	BurpGlobals* tdgbl = BurpGlobals::getSpecific();
 
+	// Parallel backup compresses data by the same number of threads
+	tdgbl->gbl_sw_zip_frames = tdgbl->gbl_sw_zip && tdgbl->gbl_sw_par_workers > 1;
+
 	mvol_init_write(tdgbl, file_name, &tdgbl->blk_io_cnt, &tdgbl->blk_io_ptr);
 
 	tdgbl->gbl_io_cnt = ZC_BUFSIZE;
@@ -777,13 +1124,23 @@ void MVOL_init_write(const char* file_name)
 #ifdef HAVE_ZLIB_H
 	if (tdgbl->gbl_sw_zip)
 	{
+		checkCompression();
+
+		const int level = tdgbl->gbl_sw_zip_level ? tdgbl->gbl_sw_zip_level : Z_DEFAULT_COMPRESSION;
+
+		if (tdgbl->gbl_sw_zip_frames)
+		{
+			tdgbl->gbl_zip = FB_NEW_POOL(tdgbl->getPool())
+				ZipFrames(tdgbl->getPool(), level, tdgbl->gbl_sw_par_workers);
+			return;
+		}
+
 		z_stream& strm = tdgbl->gbl_stream;
 
 		strm.zalloc = Firebird::ZLib::allocFunc;
 		strm.zfree = Firebird::ZLib::freeFunc;
 		strm.opaque = Z_NULL;
-		checkCompression();
-		int ret = zlib().deflateInit(&strm, Z_DEFAULT_COMPRESSION);
+		int ret = zlib().deflateInit(&strm, level);
 		if (ret != Z_OK)
 			BURP_error(384, true, SafeArg() << ret);
 		strm.next_out = Z_NULL;
@@ -1958,8 +2315,16 @@ static bool read_header(DESC handle, ULONG* buffer_size, USHORT* format, bool in
 			break;
 
 		case att_backup_zip:
-			if (get_numeric())
+			switch (get_numeric())
+			{
+			case BACKUP_ZIP_NONE:
+				break;
+			case BACKUP_ZIP_FRAMES:
+				tdgbl->gbl_sw_zip_frames = true;
+				[[fallthrough]];
+			default:
 				tdgbl->gbl_sw_zip = true;
+			}
 			break;
 
 		case att_backup_hash:
@@ -2017,7 +2382,7 @@ static bool write_header(DESC handle, ULONG backup_buffer_size, bool full_buffer
 			put_numeric(att_backup_transportable, 1);
 
 		if (tdgbl->gbl_sw_zip)
-			put_numeric(att_backup_zip, 1);
+			put_numeric(att_backup_zip, tdgbl->gbl_sw_zip_frames ? BACKUP_ZIP_FRAMES : BACKUP_ZIP_STREAM);
 
 		put_numeric(att_backup_blksize, backup_buffer_size);
 
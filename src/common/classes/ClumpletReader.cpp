@@ -324,6 +324,8 @@ ClumpletReader::ClumpletType ClumpletReader::getClumpletType(UCHAR tag) const
 			case isc_spb_bkp_factor:
 			case isc_spb_bkp_length:
 			case isc_spb_bkp_parallel_workers:
+			case isc_spb_res_index_memory:
+			case isc_spb_bkp_zip_level:
 			case isc_spb_res_length:
 			case isc_spb_res_buffers:
 			case isc_spb_res_page_size:
@@ -328,6 +328,18 @@ namespace Firebird
 		{
 			return hash(length, value) % hashSize;
 		}
+
+		// Hash values above are not guaranteed to be well distributed, so scramble them
+		// before using their bits for addressing (MurmurHash3 finalizer)
+		static unsigned int mix(unsigned int hash) noexcept
+		{
+			hash ^= hash >> 16;
+			hash *= 0x85ebca6b;
+			hash ^= hash >> 13;
+			hash *= 0xc2b2ae35;
+			hash ^= hash >> 16;
+			return hash;
+		}
 	};
 
 	class HashContext
@@ -58,11 +58,15 @@
 
 #endif
 
+#include <atomic>
+#include <mutex>
+
 #include "../common/classes/fb_tls.h"
 #include "../common/classes/locks.h"
 #include "../common/classes/init.h"
 #include "../common/classes/vector.h"
 #include "../common/classes/RefMutex.h"
+#include "../common/classes/Spinlock.h"
 #include "../common/config/config.h"
 #include "../common/os/os_utils.h"
 #include "../common/os/fbsyslog.h"
@@ -1581,6 +1585,45 @@ private:
 };
 
 
+// Small blocks cached for the threads concurrently using the pool.
+// Every thread uses one of the shards, each shard keeps a short list
+// (magazine) of free blocks per small slot. Blocks are moved between
+// the magazines and the pool free lists in batches, so the pool mutex
+// is taken once per batch of allocations or deallocations.
+
+class SmallObjectsCache
+{
+public:
+	static constexpr unsigned SHARDS = 16;
+	static constexpr unsigned BATCH = 16;			// blocks moved to / from the pool at once
+	static constexpr unsigned MAX_COUNT = BATCH * 2;	// blocks kept in the magazine
+	static constexpr size_t CACHE_LINE = 64;
+
+	struct Magazine
+	{
+		MemBlock* head;
+		unsigned count;
+	};
+
+	struct alignas(CACHE_LINE) Shard
+	{
+		SpinLock lock;
+		Magazine magazines[LowLimits::TOTAL_ELEMENTS];
+	};
+
+	Shard& getShard() noexcept
+	{
+		static std::atomic<unsigned> nextShard = 0;
+		thread_local const unsigned shard = nextShard++ % SHARDS;
+
+		return shards[shard];
+	}
+
+private:
+	Shard shards[SHARDS]{};
+};
+
+
 // Implementation of memory pool
 
 class MemPool
@@ -1619,6 +1662,11 @@ private:
 	Mutex			mutex;
 	int				blocksAllocated;
 	int				blocksActive;
+	int				contentions;
+
+	// Created when the pool mutex is found contended many times
+	std::atomic<SmallObjectsCache*> smallCache;
+	static constexpr int CACHE_CONTENTIONS = 64;
 	bool			pool_destroying, parent_redirect;
 
 	MemoryStats* stats;	// Statistics group for the pool
@@ -1678,6 +1726,11 @@ private:
 	}
 
 	void releaseBlock(MemBlock *block, int flag) noexcept;
+
+	void lockPool(MutexEnsureUnlock& guard);
+	void createCache() noexcept;
+	MemBlock* allocateCached(SmallObjectsCache* cache, size_t& length);
+	void releaseCached(SmallObjectsCache* cache, MemBlock* block) noexcept;
 	static constexpr int RELEASE_DECR = 0x1;	// Decrement memory usage
 	static constexpr int RELEASE_RED = 0x2;		// Perform red zone checks (MEM_DEBUG only)
 
@@ -1986,6 +2039,8 @@ void MemPool::initialize()
 {
 	blocksAllocated = 0;
 	blocksActive = 0;
+	contentions = 0;
+	smallCache = nullptr;
 
 #ifdef DELAYED_FREE
 	delayedFreeCount = 0;
@@ -2168,10 +2223,151 @@ void MemoryPool::setStatsGroup(MemoryStats& newStats) noexcept
 	pool->setStatsGroup(newStats);
 }
 
+void MemPool::lockPool(MutexEnsureUnlock& guard)
+{
+	if (guard.tryEnter())
+		return;
+
+	guard.enter();
+
+	if (++contentions == CACHE_CONTENTIONS)
+		createCache();
+}
+
+void MemPool::createCache() noexcept
+{
+	// Pool mutex is locked. Memory of the cache is not counted as used by the pool,
+	// it's released with the pool extents.
+
+	fb_assert(!smallCache.load(std::memory_order_relaxed));
+
+	try
+	{
+		size_t length = sizeof(SmallObjectsCache) + SmallObjectsCache::CACHE_LINE;
+		MemBlock* const block = mediumObjects.allocateBlock(this, 0, length);
+		block->pool = this;
+
+		void* const memory = FB_ALIGN(&block->body, SmallObjectsCache::CACHE_LINE);
+		smallCache.store(new(memory) SmallObjectsCache, std::memory_order_release);
+	}
+	catch (const Exception&)
+	{
+		// Just continue without the cache
+	}
+}
+
+MemBlock* MemPool::allocateCached(SmallObjectsCache* cache, size_t& length)
+{
+	const size_t fullSize = length + LinkedList::MEM_OVERHEAD;
+	if (fullSize > LowLimits::TOP_LIMIT)
+		return nullptr;
+
+	const unsigned slot = LowLimits::getSlot(fullSize, SLOT_ALLOC);
+	const size_t size = LowLimits::getSize(slot) - LinkedList::MEM_OVERHEAD;
+
+	auto& shard = cache->getShard();
+	auto& magazine = shard.magazines[slot];
+	length = size;
+
+	{	// scope
+		std::lock_guard shardGuard(shard.lock);
+
+		if (magazine.count)
+		{
+			magazine.count--;
+			return LinkedList::getElement(&magazine.head);
+		}
+	}
+
+	// Magazine is empty, take a batch of blocks from the pool.
+	// Shard is never locked together with the pool mutex.
+
+	MemBlock* batch = nullptr;
+	unsigned count = 0;
+
+	{	// scope
+		MutexLockGuard guard(mutex, "MemPool::allocateCached");
+
+		for (; count < SmallObjectsCache::BATCH; count++)
+		{
+			size_t blockSize = size;
+			MemBlock* block;
+
+			try
+			{
+				block = smallObjects.allocateBlock(this, 0, blockSize);
+			}
+			catch (const Exception&)
+			{
+				if (!count)
+					throw;
+				break;
+			}
+
+			LinkedList::putElement(&batch, block);
+		}
+
+		blocksAllocated += count;
+		blocksActive += count;
+	}
+
+	MemBlock* const block = LinkedList::getElement(&batch);
+
+	std::lock_guard shardGuard(shard.lock);
+
+	while (batch)
+	{
+		LinkedList::putElement(&magazine.head, LinkedList::getElement(&batch));
+		magazine.count++;
+	}
+
+	return block;
+}
+
+void MemPool::releaseCached(SmallObjectsCache* cache, MemBlock* block) noexcept
+{
+	const unsigned slot = LowLimits::getSlot(block->getSize(), SLOT_ALLOC);
+
+	auto& shard = cache->getShard();
+	auto& magazine = shard.magazines[slot];
+
+	MemBlock* batch = nullptr;
+
+	{	// scope
+		std::lock_guard shardGuard(shard.lock);
+
+		LinkedList::putElement(&magazine.head, block);
+		if (++magazine.count <= SmallObjectsCache::MAX_COUNT)
+			return;
+
+		// Magazine is full, return a batch of blocks to the pool
+
+		for (unsigned n = 0; n < SmallObjectsCache::BATCH; n++)
+			LinkedList::putElement(&batch, LinkedList::getElement(&magazine.head));
+
+		magazine.count -= SmallObjectsCache::BATCH;
+	}
+
+	MutexLockGuard guard(mutex, "MemPool::releaseCached");
+
+	while (batch)
+		smallObjects.deallocateBlock(LinkedList::getElement(&batch));
+
+	blocksActive -= SmallObjectsCache::BATCH;
+}
+
 MemBlock* MemPool::allocateInternal2(size_t from, size_t& length, bool flagRedirect)
 {
+	// Small blocks are taken from the cache, if the pool has it
+
+	if (SmallObjectsCache* const cache = smallCache.load(std::memory_order_acquire); cache && !from)
+	{
+		if (MemBlock* const block = allocateCached(cache, length))
+			return block;
+	}
+
 	MutexEnsureUnlock guard(mutex, "MemPool::allocateInternal2");
-	guard.enter();
+	lockPool(guard);
 
 	++blocksAllocated;
 	++blocksActive;
@@ -2365,8 +2561,20 @@ void MemPool::releaseBlock(MemBlock* block, int flags) noexcept
 
 	const size_t length = block->getSize();
 
+	// Small blocks are returned to the cache, if the pool has it
+
+	if (SmallObjectsCache* const cache = smallCache.load(std::memory_order_acquire);
+		cache && length <= LowLimits::TOP_LIMIT)
+	{
+		if (flags & RELEASE_DECR)
+			decrement_usage(length);
+
+		releaseCached(cache, block);
+		return;
+	}
+
 	MutexEnsureUnlock guard(mutex, "MemPool::releaseBlock");
-	guard.enter();
+	lockPool(guard);
 
 	--blocksActive;
 
@@ -0,0 +1,84 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/classes/alloc.h"
+#include "../common/classes/auto.h"
+#include <latch>
+#include <thread>
+#include <vector>
+
+using namespace Firebird;
+
+BOOST_AUTO_TEST_SUITE(CommonSuite)
+BOOST_AUTO_TEST_SUITE(AllocSuite)
+
+
+namespace
+{
+	constexpr size_t MAX_SMALL_SIZE = 512u;
+
+	template <typename Function>
+	void runThreads(unsigned threadCount, Function function)
+	{
+		std::vector<std::thread> threads;
+		std::latch startLatch(threadCount + 1);
+
+		for (unsigned threadNum = 0u; threadNum < threadCount; ++threadNum)
+		{
+			threads.emplace_back([&, threadNum]() {
+				startLatch.arrive_and_wait();
+				function(threadNum);
+			});
+		}
+
+		startLatch.arrive_and_wait();
+
+		for (auto& thread : threads)
+			thread.join();
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(AllocTests)
+
+BOOST_AUTO_TEST_CASE(ConcurrentStatsTest)
+{
+	// Usage statistics of the pool shared by many threads must return to
+	// the initial value, with the blocks kept by the threads cache or not.
+
+	constexpr unsigned THREAD_COUNT = 16u;
+	constexpr unsigned BLOCK_COUNT = 1'000u;
+
+	MemoryStats stats;
+	AutoMemoryPool pool(MemoryPool::createPool(nullptr, stats));
+
+	const size_t initialUsage = stats.getCurrentUsage();
+
+	for (unsigned pass = 0u; pass < 3u; ++pass)
+	{
+		std::vector<std::vector<void*>> blocks(THREAD_COUNT);
+
+		runThreads(THREAD_COUNT, [&](unsigned threadNum) {
+			for (unsigned i = 0u; i < BLOCK_COUNT; ++i)
+				blocks[threadNum].push_back(pool->allocate(1 + (threadNum * BLOCK_COUNT + i) % MAX_SMALL_SIZE));
+		});
+
+		BOOST_TEST(stats.getCurrentUsage() >= initialUsage + THREAD_COUNT * BLOCK_COUNT);
+
+		// Release the blocks by other threads than allocated them
+		runThreads(THREAD_COUNT, [&](unsigned threadNum) {
+			for (auto block : blocks[(threadNum + 1) % THREAD_COUNT])
+				pool->deallocate(block);
+		});
+
+#ifndef DEV_BUILD
+		// Debug builds delay the release of blocks, keeping them accounted
+		BOOST_TEST(stats.getCurrentUsage() == initialUsage);
+#endif
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// AllocTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// AllocSuite
+BOOST_AUTO_TEST_SUITE_END()	// CommonSuite
@@ -137,6 +137,10 @@ const char*	GCPolicyCooperative	= "cooperative";
 const char*	GCPolicyBackground	= "background";
 const char*	GCPolicyCombined	= "combined";
 
+const char*	BufferPolicyLRU		= "LRU";
+const char*	BufferPolicyClock	= "CLOCK";
+const char*	BufferPolicy2Q		= "2Q";
+
 ConfigValue Config::defaults[MAX_CONFIG_KEY];
 
 /******************************************************************************
@@ -379,6 +383,19 @@ void Config::checkValues()
 		}
 	}
 
+	strVal = values[KEY_BUFFER_POLICY].strVal;
+	if (strVal)
+	{
+		NoCaseString bufferPolicy(strVal);
+		if (bufferPolicy != BufferPolicyLRU &&
+			bufferPolicy != BufferPolicyClock &&
+			bufferPolicy != BufferPolicy2Q)
+		{
+			// user-provided value is invalid - fail to default
+			values[KEY_BUFFER_POLICY] = defaults[KEY_BUFFER_POLICY];
+		}
+	}
+
 	strVal = values[KEY_WIRE_CRYPT].strVal;
 	if (strVal)
 	{
@@ -424,6 +441,12 @@ void Config::checkValues()
 
 	checkIntForLoBound(KEY_PARALLEL_WORKERS, 1, true);
 	checkIntForHiBound(KEY_PARALLEL_WORKERS, values[KEY_MAX_PARALLEL_WORKERS].intVal, false);
+
+	checkIntForLoBound(KEY_GC_PARALLEL_WORKERS, 1, true);
+	checkIntForHiBound(KEY_GC_PARALLEL_WORKERS, values[KEY_MAX_PARALLEL_WORKERS].intVal, false);
+
+	checkIntForLoBound(KEY_IO_BATCH_SIZE, 0, true);
+	checkIntForHiBound(KEY_IO_BATCH_SIZE, 256, false);
 }
 
 
@@ -78,6 +78,10 @@ extern const char*	GCPolicyCooperative;
 extern const char*	GCPolicyBackground;
 extern const char*	GCPolicyCombined;
 
+extern const char*	BufferPolicyLRU;
+extern const char*	BufferPolicyClock;
+extern const char*	BufferPolicy2Q;
+
 inline constexpr int WIRE_CRYPT_DISABLED = 0;
 inline constexpr int WIRE_CRYPT_ENABLED = 1;
 inline constexpr int WIRE_CRYPT_REQUIRED = 2;
@@ -187,6 +191,11 @@ enum ConfigKey
 	KEY_MAX_PARALLEL_WORKERS,
 	KEY_OPTIMIZE_FOR_FIRST_ROWS,
 	KEY_ALLOW_UPDATE_OVERWRITE,
+	KEY_IO_BATCH_SIZE,
+	KEY_BUFFER_POLICY,
+	KEY_DATA_PAGE_COMPRESSION,
+	KEY_GC_PARALLEL_WORKERS,
+	KEY_HASH_AGGREGATION_MEMORY,
 	MAX_CONFIG_KEY		// keep it last
 };
 
@@ -300,7 +309,12 @@ inline constexpr ConfigEntry entries[MAX_CONFIG_KEY] =
 	{TYPE_INTEGER,	"ParallelWorkers",			true,	1},
 	{TYPE_INTEGER,	"MaxParallelWorkers",		true,	1},
 	{TYPE_BOOLEAN,	"OptimizeForFirstRows",		false,	false},
-	{TYPE_BOOLEAN,	"AllowUpdateOverwrite",		false,	true}
+	{TYPE_BOOLEAN,	"AllowUpdateOverwrite",		false,	true},
+	{TYPE_INTEGER,	"IoBatchSize",				false,	32},		// pages
+	{TYPE_STRING,	"BufferPolicy",				false,	"LRU"},		// page cache replacement policy
+	{TYPE_BOOLEAN,	"DataPageCompression",		false,	false},
+	{TYPE_INTEGER,	"GCParallelWorkers",		false,	1},
+	{TYPE_INTEGER,	"HashAggregationMemory",	false,	32 * 1048576}	// bytes
 };
 
 
@@ -623,6 +637,16 @@ public:
 	CONFIG_GET_PER_DB_BOOL(getOptimizeForFirstRows, KEY_OPTIMIZE_FOR_FIRST_ROWS);
 
 	CONFIG_GET_PER_DB_BOOL(getAllowUpdateOverwrite, KEY_ALLOW_UPDATE_OVERWRITE);
+
+	CONFIG_GET_PER_DB_KEY(ULONG, getIoBatchSize, KEY_IO_BATCH_SIZE, getInt);
+
+	CONFIG_GET_PER_DB_STR(getBufferPolicy, KEY_BUFFER_POLICY);
+
+	CONFIG_GET_PER_DB_BOOL(getDataPageCompression, KEY_DATA_PAGE_COMPRESSION);
+
+	CONFIG_GET_PER_DB_INT(getGCParallelWorkers, KEY_GC_PARALLEL_WORKERS);
+
+	CONFIG_GET_PER_DB_KEY(ULONG, getHashAggregationMemory, KEY_HASH_AGGREGATION_MEMORY, getInt);
 };
 
 // Implementation of interface to access master configuration file
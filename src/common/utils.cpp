@@ -830,6 +830,16 @@ SINT64 query_performance_frequency()
 }
 
 
+// Returns microseconds elapsed since the given value of performance counter
+FB_UINT64 elapsedMicroseconds(SINT64 start)
+{
+	static const SINT64 frequency = query_performance_frequency();
+
+	const SINT64 elapsed = query_performance_counter() - start;
+	return (elapsed > 0) ? (FB_UINT64) elapsed * 1000000 / frequency : 0;
+}
+
+
 // returns system and user time in milliseconds that process runs
 void get_process_times(SINT64 &userTime, SINT64 &sysTime)
 {
@@ -213,6 +213,9 @@ namespace fb_utils
 	// Returns frequency of performance counter in Hz
 	SINT64 query_performance_frequency();
 
+	// Returns microseconds elapsed since the given value of performance counter
+	FB_UINT64 elapsedMicroseconds(SINT64 start);
+
 	void get_process_times(SINT64 &userTime, SINT64 &sysTime);
 
 	void exactNumericToStr(SINT64 value, int scale, Firebird::string& target, bool append = false);
@@ -915,6 +915,27 @@ dsc* AvgAggNode::aggExecute(thread_db* tdbb, Request* request) const
 	return &impureTemp->vlu_desc;
 }
 
+AggNode::BatchType AvgAggNode::getBatchType() const
+{
+	return (distinct || dialect1) ? BATCH_NONE : BATCH_SUM;
+}
+
+void AvgAggNode::aggPassBatch(thread_db* tdbb, Request* request, const dsc* argDesc,
+	dsc* partial, SINT64 count) const
+{
+	impure_value_ex* impure = request->getImpure<impure_value_ex>(impureOffset);
+	if (impure->vlux_count == 0)		// first call to aggPass()
+	{
+		impure_value_ex* impureTemp = request->getImpure<impure_value_ex>(tempImpure);
+		impureTemp->vlu_desc = *argDesc;
+		outputDesc(&impureTemp->vlu_desc);
+	}
+
+	impure->vlux_count += count;
+
+	ArithmeticNode::add(tdbb, partial, &impure->vlu_desc, impure, blr_add, dialect1, nodScale, nodFlags);
+}
+
 AggNode* AvgAggNode::dsqlCopy(DsqlCompilerScratch* dsqlScratch) /*const*/
 {
 	return FB_NEW_POOL(dsqlScratch->getPool()) AvgAggNode(dsqlScratch->getPool(), distinct, dialect1,
@@ -1589,6 +1610,22 @@ dsc* CountAggNode::aggExecute(thread_db* /*tdbb*/, Request* request) const
 	return &impure->vlu_desc;
 }
 
+AggNode::BatchType CountAggNode::getBatchType() const
+{
+	return distinct ? BATCH_NONE : BATCH_COUNT;
+}
+
+void CountAggNode::aggPassBatch(thread_db* /*tdbb*/, Request* request, const dsc* /*argDesc*/,
+	dsc* /*partial*/, SINT64 count) const
+{
+	impure_value_ex* impure = request->getImpure<impure_value_ex>(impureOffset);
+
+	if (dialect1)
+		impure->vlu_misc.vlu_long += (SLONG) count;
+	else
+		impure->vlu_misc.vlu_int64 += count;
+}
+
 AggNode* CountAggNode::dsqlCopy(DsqlCompilerScratch* dsqlScratch) /*const*/
 {
 	return FB_NEW_POOL(dsqlScratch->getPool()) CountAggNode(dsqlScratch->getPool(), distinct, dialect1,
@@ -1848,6 +1885,20 @@ dsc* SumAggNode::aggExecute(thread_db* /*tdbb*/, Request* request) const
 	return &impure->vlu_desc;
 }
 
+AggNode::BatchType SumAggNode::getBatchType() const
+{
+	return (distinct || dialect1) ? BATCH_NONE : BATCH_SUM;
+}
+
+void SumAggNode::aggPassBatch(thread_db* tdbb, Request* request, const dsc* /*argDesc*/,
+	dsc* partial, SINT64 count) const
+{
+	impure_value_ex* impure = request->getImpure<impure_value_ex>(impureOffset);
+	impure->vlux_count += count;
+
+	ArithmeticNode::add(tdbb, partial, &impure->vlu_desc, impure, blr_add, dialect1, nodScale, nodFlags);
+}
+
 AggNode* SumAggNode::dsqlCopy(DsqlCompilerScratch* dsqlScratch) /*const*/
 {
 	return FB_NEW_POOL(dsqlScratch->getPool()) SumAggNode(dsqlScratch->getPool(), distinct, dialect1,
@@ -1938,6 +1989,20 @@ dsc* MaxMinAggNode::aggExecute(thread_db* /*tdbb*/, Request* request) const
 	return &impure->vlu_desc;
 }
 
+AggNode::BatchType MaxMinAggNode::getBatchType() const
+{
+	return (type == TYPE_MAX) ? BATCH_MAX : BATCH_MIN;
+}
+
+void MaxMinAggNode::aggPassBatch(thread_db* tdbb, Request* request, const dsc* /*argDesc*/,
+	dsc* partial, SINT64 count) const
+{
+	impure_value_ex* impure = request->getImpure<impure_value_ex>(impureOffset);
+	impure->vlux_count += count - 1;
+
+	aggPass(tdbb, request, partial);
+}
+
 AggNode* MaxMinAggNode::dsqlCopy(DsqlCompilerScratch* dsqlScratch) /*const*/
 {
 	return FB_NEW_POOL(dsqlScratch->getPool()) MaxMinAggNode(dsqlScratch->getPool(),
@@ -84,6 +84,10 @@ public:
 	void aggPass(thread_db* tdbb, Request* request, dsc* desc) const override;
 	dsc* aggExecute(thread_db* tdbb, Request* request) const override;
 
+	BatchType getBatchType() const override;
+	void aggPassBatch(thread_db* tdbb, Request* request, const dsc* argDesc,
+		dsc* partial, SINT64 count) const override;
+
 protected:
 	AggNode* dsqlCopy(DsqlCompilerScratch* dsqlScratch) /*const*/ override;
 
@@ -219,6 +223,10 @@ public:
 	void aggPass(thread_db* tdbb, Request* request, dsc* desc) const override;
 	dsc* aggExecute(thread_db* tdbb, Request* request) const override;
 
+	BatchType getBatchType() const override;
+	void aggPassBatch(thread_db* tdbb, Request* request, const dsc* argDesc,
+		dsc* partial, SINT64 count) const override;
+
 protected:
 	AggNode* dsqlCopy(DsqlCompilerScratch* dsqlScratch) /*const*/ override;
 };
@@ -249,6 +257,10 @@ public:
 	void aggPass(thread_db* tdbb, Request* request, dsc* desc) const override;
 	dsc* aggExecute(thread_db* tdbb, Request* request) const override;
 
+	BatchType getBatchType() const override;
+	void aggPassBatch(thread_db* tdbb, Request* request, const dsc* argDesc,
+		dsc* partial, SINT64 count) const override;
+
 protected:
 	AggNode* dsqlCopy(DsqlCompilerScratch* dsqlScratch) /*const*/ override;
 };
@@ -280,6 +292,10 @@ public:
 	void aggPass(thread_db* tdbb, Request* request, dsc* desc) const override;
 	dsc* aggExecute(thread_db* tdbb, Request* request) const override;
 
+	BatchType getBatchType() const override;
+	void aggPassBatch(thread_db* tdbb, Request* request, const dsc* argDesc,
+		dsc* partial, SINT64 count) const override;
+
 protected:
 	AggNode* dsqlCopy(DsqlCompilerScratch* dsqlScratch) /*const*/ override;
 
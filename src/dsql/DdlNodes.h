@@ -2173,6 +2173,43 @@ public:
 };
 
 
+class SetTableStatisticsNode final : public DdlNode
+{
+public:
+	SetTableStatisticsNode(MemoryPool& p, const QualifiedName& aName)
+		: DdlNode(p),
+		  relationName(p, aName)
+	{
+	}
+
+public:
+	static void deleteStatistics(thread_db* tdbb, jrd_tra* transaction,
+		const QualifiedName& relationName, const MetaName& fieldName = {});
+
+public:
+	Firebird::string internalPrint(NodePrinter& printer) const override;
+	void checkPermission(thread_db* tdbb, jrd_tra* transaction) override;
+	void execute(thread_db* tdbb, DsqlCompilerScratch* dsqlScratch, jrd_tra* transaction) override;
+
+	DdlNode* dsqlPass(DsqlCompilerScratch* dsqlScratch) override
+	{
+		dsqlScratch->qualifyExistingName(relationName, obj_relation);
+		dsqlScratch->ddlSchema = relationName.schema;
+
+		return DdlNode::dsqlPass(dsqlScratch);
+	}
+
+protected:
+	void putErrorPrefix(Firebird::Arg::StatusVector& statusVector) override
+	{
+		statusVector << Firebird::Arg::Gds(isc_dsql_alter_table_failed) << relationName.toQuotedString();
+	}
+
+public:
+	QualifiedName relationName;
+};
+
+
 class DropIndexNode final : public ModifyIndexNode, public DdlNode
 {
 public:
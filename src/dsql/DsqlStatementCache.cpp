@@ -25,6 +25,7 @@
 #include "../dsql/DsqlStatements.h"
 #include "../jrd/Attachment.h"
 #include "../jrd/Statement.h"
+#include "../jrd/SharedStatementCache.h"
 #include "../jrd/lck.h"
 
 using namespace Firebird;
@@ -61,6 +62,9 @@ int DsqlStatementCache::blockingAst(void* astObject)
 		const auto dbb = self->lock->lck_dbb;
 		AsyncContextHolder tdbb(dbb, FB_FUNCTION, self->lock);
 
+		// Metadata is changed, possibly by another process
+		dbb->dbb_shared_statements->invalidate();
+
 		self->purge(tdbb, false);
 	}
 	catch (const Exception&)
@@ -241,6 +245,8 @@ void DsqlStatementCache::purge(thread_db* tdbb, bool releaseLock)
 
 void DsqlStatementCache::purgeAllAttachments(thread_db* tdbb)
 {
+	tdbb->getDatabase()->dbb_shared_statements->invalidate();
+
 	purge(tdbb, false);
 
 	fb_assert(!lock || lock->lck_logical == LCK_SR);
@@ -26,6 +26,8 @@
 #include "../dsql/DsqlCompilerScratch.h"
 #include "../dsql/DsqlStatementCache.h"
 #include "../jrd/Statement.h"
+#include "../jrd/SharedStatementCache.h"
+#include "../jrd/tra.h"
 #include "../dsql/errd_proto.h"
 #include "../dsql/gen_proto.h"
 #include "../jrd/cmp_proto.h"
@@ -121,7 +123,10 @@ void DsqlDmlStatement::doRelease()
 
 		try
 		{
-			statement->release(tdbb);
+			if (sharedStatement)
+				tdbb->getDatabase()->dbb_shared_statements->release(tdbb, statement);
+			else
+				statement->release(tdbb);
 		}
 		catch (Exception&)
 		{} // no-op
@@ -132,7 +137,12 @@ void DsqlDmlStatement::doRelease()
 
 unsigned DsqlDmlStatement::getSize() const
 {
-	return DsqlStatement::getSize() + statement->getSize();
+	// Memory of the shared statement is accounted by every attachment partially
+	const unsigned statementSize = sharedStatement ?
+		dsqlAttachment->dbb_attachment->att_database->dbb_shared_statements->getReferenceSize(statement) :
+		statement->getSize();
+
+	return DsqlStatement::getSize() + statementSize;
 }
 
 void DsqlDmlStatement::dsqlPass(thread_db* tdbb, DsqlCompilerScratch* scratch, ntrace_result_t* traceResult)
@@ -179,15 +189,32 @@ void DsqlDmlStatement::dsqlPass(thread_db* tdbb, DsqlCompilerScratch* scratch, n
 	try
 	{
 		const auto attachment = scratch->getAttachment()->dbb_attachment;
+		const auto transaction = scratch->getTransaction();
 		const auto& blr = scratch->getBlrData();
 		const auto& debugData = scratch->getDebugData();
+		const bool internalFlag = (scratch->flags & DsqlCompilerScratch::FLAG_INTERNAL_REQUEST);
+
+		// Compiled statements are shared by the attachments if they may be cached
+		// by the attachment itself
+		const bool shareable = scratch->getAttachment()->dbb_statement_cache->isActive() &&
+			!(transaction && transaction->isDdl()) &&
+			!attachment->getDebugOptions().getDsqlKeepBlr();
+
+		if (shareable)
+		{
+			statement = tdbb->getDatabase()->dbb_shared_statements->compile(tdbb, getSqlText(),
+				blr.begin(), blr.getCount(), internalFlag, debugData.getCount(), debugData.begin());
 
-		statement = CMP_compile(tdbb, blr.begin(), blr.getCount(),
-			(scratch->flags & DsqlCompilerScratch::FLAG_INTERNAL_REQUEST),
-			debugData.getCount(), debugData.begin());
+			sharedStatement = true;
+		}
+		else
+		{
+			statement = CMP_compile(tdbb, blr.begin(), blr.getCount(), internalFlag,
+				debugData.getCount(), debugData.begin());
 
-		if (getSqlText())
-			statement->sqlText = getSqlText();
+			if (getSqlText())
+				statement->sqlText = getSqlText();
+		}
 
 		fb_assert(statement->blr.isEmpty());
 
@@ -213,6 +213,7 @@ protected:
 private:
 	NestConst<StmtNode> node;
 	Statement* statement = nullptr;
+	bool sharedStatement = false;	// statement is obtained from the database level cache
 };
 
 
@@ -1108,6 +1108,28 @@ public:
 	virtual void aggPass(thread_db* tdbb, Request* request, dsc* desc) const = 0;
 	virtual dsc* aggExecute(thread_db* tdbb, Request* request) const = 0;
 
+	// Vectorized aggregation: instead of passing every row, the caller computes a partial
+	// result over a batch of rows and passes it along with the number of non-null values.
+	enum BatchType : UCHAR
+	{
+		BATCH_NONE,
+		BATCH_COUNT,	// nothing but the count is passed
+		BATCH_SUM,		// sum of the values, possibly of a wider data type
+		BATCH_MIN,		// minimal value
+		BATCH_MAX		// maximal value
+	};
+
+	virtual BatchType getBatchType() const
+	{
+		return BATCH_NONE;
+	}
+
+	virtual void aggPassBatch(thread_db* /*tdbb*/, Request* /*request*/, const dsc* /*argDesc*/,
+		dsc* /*partial*/, SINT64 /*count*/) const
+	{
+		fb_assert(false);
+	}
+
 	AggNode* dsqlPass(DsqlCompilerScratch* dsqlScratch) override;
 
 protected:
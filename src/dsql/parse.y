@@ -6255,6 +6255,8 @@ table_list
 set_statistics
 	: SET STATISTICS INDEX symbol_index_name
 		{ $$ = newNode<SetStatisticsNode>(*$4); }
+	| SET STATISTICS TABLE symbol_table_name
+		{ $$ = newNode<SetTableStatisticsNode>(*$4); }
 	;
 
 %type <ddlNode> comment
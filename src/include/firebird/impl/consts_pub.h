@@ -434,6 +434,7 @@
 #define isc_spb_bkp_parallel_workers	 21
 #define isc_spb_bkp_skip_schema_data     22
 #define isc_spb_bkp_include_schema_data  23
+#define isc_spb_bkp_zip_level            25
 #define isc_spb_bkp_ignore_checksums     0x01
 #define isc_spb_bkp_ignore_limbo         0x02
 #define isc_spb_bkp_metadata_only        0x04
@@ -577,6 +578,7 @@
 #define isc_spb_res_use_all_space		0x4000
 #define isc_spb_res_direct_io			isc_spb_bkp_direct_io
 #define isc_spb_res_replica_mode		20
+#define isc_spb_res_index_memory		24
 
 /*****************************************
  * Parameters for isc_action_svc_validate *
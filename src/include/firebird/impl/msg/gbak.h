@@ -418,3 +418,11 @@ FB_IMPL_MSG_NO_SYMBOL(GBAK, 419, "regular expression to skip schemas was already
 FB_IMPL_MSG_NO_SYMBOL(GBAK, 420, "regular expression to include schemas was already set")
 FB_IMPL_MSG_SYMBOL(GBAK, 421, gbak_plugin_schema_migration, "migrating @1 plugin objects to schema @2")
 FB_IMPL_MSG_SYMBOL(GBAK, 422, gbak_plugin_schema_migration_err, "error migrating @1 plugin objects to schema @2. Plugin objects will be in inconsistent state:")
+FB_IMPL_MSG_NO_SYMBOL(GBAK, 423, "    @1INDEX_MEM(ORY)       memory budget (MB) for parallel index creation")
+FB_IMPL_MSG_NO_SYMBOL(GBAK, 424, "index memory budget parameter missing")
+FB_IMPL_MSG_NO_SYMBOL(GBAK, 425, "expected index memory budget, encountered \"@1\"")
+FB_IMPL_MSG_NO_SYMBOL(GBAK, 426, "creating @1 indices using up to @2 parallel connections")
+FB_IMPL_MSG_NO_SYMBOL(GBAK, 427, "    index @1 created using @2 worker(s), @3 of @4 done")
+FB_IMPL_MSG_NO_SYMBOL(GBAK, 428, "    @1ZIP_L(EVEL)          compression level (1 - 9) for zip format")
+FB_IMPL_MSG_NO_SYMBOL(GBAK, 429, "compression level parameter missing")
+FB_IMPL_MSG_NO_SYMBOL(GBAK, 430, "expected compression level between 1 and 9, encountered \"@1\"")
@@ -0,0 +1,602 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../common/classes/ClumpletWriter.h"
+#include "../common/classes/Hash.h"
+#include "../common/classes/timestamp.h"
+#include "../jrd/jrd.h"
+#include "../jrd/req.h"
+#include "../jrd/intl.h"
+#include "../jrd/Relation.h"
+#include "../jrd/ColumnStatistics.h"
+#include "../jrd/cch_proto.h"
+#include "../jrd/dpm_proto.h"
+#include "../jrd/evl_proto.h"
+#include "../jrd/mov_proto.h"
+#include "../jrd/vio_proto.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+namespace
+{
+	// Approximate number of rows to be sampled per table
+	constexpr ULONG SAMPLE_ROWS = 30000;
+
+	// Number of leading string bytes taken into account by histograms
+	constexpr unsigned STRING_ORDINAL_LENGTH = 6;
+
+	// Histogram clumplet tags
+	constexpr UCHAR HISTOGRAM_VERSION1 = 1;
+
+	constexpr UCHAR isc_hst_ordinal_type = 1;
+	constexpr UCHAR isc_hst_bound = 2;
+
+	struct ColumnSample
+	{
+		explicit ColumnSample(MemoryPool& pool)
+			: values(pool), hashes(pool)
+		{}
+
+		ColumnStatistics* stats = nullptr;
+		Array<double> values;
+		Array<ULONG> hashes;
+		SINT64 nullCount = 0;
+		bool ordinal = true;
+	};
+
+	ULONG hashValue(const dsc* desc)
+	{
+		const UCHAR* address = desc->dsc_address;
+		ULONG length = desc->dsc_length;
+
+		if (desc->isText())
+		{
+			UCHAR* text;
+			length = MOV_get_string(JRD_get_thread_data(), desc, &text, nullptr, 0);
+			address = text;
+
+			// Trailing spaces are insignificant for comparisons
+			const UCHAR pad = (desc->getCharSet() == CS_BINARY) ? 0 : ' ';
+
+			while (length && address[length - 1] == pad)
+				length--;
+		}
+
+		return InternalHash::hash(length, address);
+	}
+
+	// Estimate the number of distinct values in the table using the sample statistics.
+	// Haas & Stokes "Duj1" estimator: D = n * d / (n - f1 + f1 * n / N), where
+	// n is the sample size, N is the total number of rows, d is the number of distinct
+	// values in the sample and f1 is the number of values that occur exactly once.
+
+	double estimateDistinct(Array<ULONG>& hashes, double totalRows)
+	{
+		const double n = (double) hashes.getCount();
+
+		if (!n)
+			return 0;
+
+		std::sort(hashes.begin(), hashes.end());
+
+		double distinct = 0, singles = 0;
+
+		for (FB_SIZE_T i = 0; i < hashes.getCount(); )
+		{
+			FB_SIZE_T j = i + 1;
+
+			while (j < hashes.getCount() && hashes[j] == hashes[i])
+				j++;
+
+			distinct++;
+
+			if (j - i == 1)
+				singles++;
+
+			i = j;
+		}
+
+		if (totalRows <= n)
+			return distinct;
+
+		const double estimate = n * distinct / (n - singles + singles * n / totalRows);
+		return MIN(MAX(estimate, distinct), totalRows);
+	}
+}
+
+
+// Map the value to the ordinal domain used by histograms.
+// Returns ORDINAL_NONE if the data type has no meaningful ordering for our purposes.
+
+ColumnStatistics::OrdinalType ColumnStatistics::getOrdinal(const dsc* desc, double& value)
+{
+	const auto address = desc->dsc_address;
+
+	switch (desc->dsc_dtype)
+	{
+		case dtype_short:
+		case dtype_long:
+		case dtype_int64:
+		case dtype_int128:
+		case dtype_real:
+		case dtype_double:
+		case dtype_dec64:
+		case dtype_dec128:
+			value = MOV_get_double(JRD_get_thread_data(), desc);
+			return ORDINAL_NUMBER;
+
+		case dtype_boolean:
+			value = *address ? 1 : 0;
+			return ORDINAL_NUMBER;
+
+		case dtype_sql_date:
+			value = *(const ISC_DATE*) address;
+			return ORDINAL_DATETIME;
+
+		case dtype_timestamp:
+		case dtype_timestamp_tz:
+		case dtype_ex_timestamp_tz:
+			{
+				// Only the UTC part is used for values with time zone
+				const auto ts = (const ISC_TIMESTAMP*) address;
+				value = ts->timestamp_date + (double) ts->timestamp_time / TimeStamp::ISC_TICKS_PER_DAY;
+			}
+			return ORDINAL_DATETIME;
+
+		case dtype_sql_time:
+		case dtype_sql_time_tz:
+		case dtype_ex_time_tz:
+			value = (double) *(const ISC_TIME*) address / TimeStamp::ISC_TICKS_PER_DAY;
+			return ORDINAL_TIME;
+
+		case dtype_text:
+		case dtype_cstring:
+		case dtype_varying:
+			{
+				// Only binary comparable strings may be mapped to ordinals
+				if (IS_INTL_DATA(desc))
+					return ORDINAL_NONE;
+
+				UCHAR* text;
+				const ULONG length = MOV_get_string(JRD_get_thread_data(), desc, &text, nullptr, 0);
+				const UCHAR pad = (desc->getCharSet() == CS_BINARY) ? 0 : ' ';
+
+				value = 0;
+
+				for (unsigned i = 0; i < STRING_ORDINAL_LENGTH; i++)
+					value = value * 256 + (i < length ? text[i] : pad);
+			}
+			return ORDINAL_STRING;
+
+		default:
+			return ORDINAL_NONE;
+	}
+}
+
+
+// Convert the given value into the histogram domain
+
+bool ColumnStatistics::getValue(const dsc* desc, double& value) const
+{
+	if (!hasHistogram() || !desc)
+		return false;
+
+	if (getOrdinal(desc, value) == ordinalType)
+		return true;
+
+	// Literals may be specified as strings and converted implicitly at runtime,
+	// e.g. dates, so try to perform the same conversion here
+
+	if (desc->isText() && (ordinalType == ORDINAL_NUMBER || ordinalType == ORDINAL_DATETIME))
+	{
+		const auto tdbb = JRD_get_thread_data();
+
+		try
+		{
+			if (ordinalType == ORDINAL_NUMBER)
+			{
+				value = MOV_get_double(tdbb, desc);
+				return true;
+			}
+
+			ISC_TIMESTAMP ts;
+			dsc tsDesc;
+			tsDesc.makeTimestamp(&ts);
+			MOV_move(tdbb, const_cast<dsc*>(desc), &tsDesc);
+
+			value = ts.timestamp_date + (double) ts.timestamp_time / TimeStamp::ISC_TICKS_PER_DAY;
+			return true;
+		}
+		catch (const Exception&)
+		{} // no-op, statistics are not applicable
+	}
+
+	return false;
+}
+
+
+// Fraction of non-null values equal to the given one
+
+double ColumnStatistics::getEqualFraction(double value) const
+{
+	const auto buckets = bounds.getCount() - 1;
+
+	if (value < bounds.front() || value > bounds.back())
+		return 0;
+
+	// Values covering more than a single bucket are represented by repeated bounds.
+	// Remember them to exclude their share from the rest of the distribution.
+
+	unsigned frequentBuckets = 0, frequentValues = 0;
+
+	for (FB_SIZE_T i = 0; i < bounds.getCount(); )
+	{
+		FB_SIZE_T j = i + 1;
+
+		while (j < bounds.getCount() && bounds[j] == bounds[i])
+			j++;
+
+		if (j - i > 1)
+		{
+			if (bounds[i] == value)
+				return (double) (j - i - 1) / buckets;
+
+			frequentBuckets += j - i - 1;
+			frequentValues++;
+		}
+
+		i = j;
+	}
+
+	// Assume uniform distribution among the remaining values
+
+	const double share = 1.0 - (double) frequentBuckets / buckets;
+	const double distinct = MAX(distinctCount - frequentValues, 1.0);
+
+	return share / distinct;
+}
+
+
+// Fraction of non-null values less than the given one
+
+double ColumnStatistics::getLessFraction(double value) const
+{
+	const auto buckets = bounds.getCount() - 1;
+
+	if (value <= bounds.front())
+		return 0;
+
+	if (value > bounds.back())
+		return 1;
+
+	double result = 0;
+
+	for (FB_SIZE_T i = 0; i < buckets; i++)
+	{
+		const double lower = bounds[i];
+		const double upper = bounds[i + 1];
+
+		if (upper < value)
+		{
+			result++;
+			continue;
+		}
+
+		// Interpolate inside the bucket
+		if (lower < value && upper > lower)
+			result += (value - lower) / (upper - lower);
+
+		break;
+	}
+
+	return result / buckets;
+}
+
+
+std::optional<double> ColumnStatistics::getEqualSelectivity(const dsc* desc) const
+{
+	// Comparison with NULL is never true
+	if (desc && desc->isNull())
+		return adjust(0);
+
+	const double nonNulls = 1.0 - nullFraction;
+	double value;
+
+	if (getValue(desc, value))
+		return adjust(nonNulls * getEqualFraction(value));
+
+	if (distinctCount > 0)
+		return adjust(nonNulls / distinctCount);
+
+	return std::nullopt;
+}
+
+std::optional<double> ColumnStatistics::getLessSelectivity(const dsc* desc, bool inclusive) const
+{
+	if (desc && desc->isNull())
+		return adjust(0);
+
+	double value;
+
+	if (!getValue(desc, value))
+		return std::nullopt;
+
+	double fraction = getLessFraction(value);
+
+	if (inclusive)
+		fraction += getEqualFraction(value);
+
+	return adjust((1.0 - nullFraction) * MIN(fraction, 1.0));
+}
+
+std::optional<double> ColumnStatistics::getGreaterSelectivity(const dsc* desc, bool inclusive) const
+{
+	if (desc && desc->isNull())
+		return adjust(0);
+
+	double value;
+
+	if (!getValue(desc, value))
+		return std::nullopt;
+
+	double fraction = 1.0 - getLessFraction(value);
+
+	if (!inclusive)
+		fraction -= getEqualFraction(value);
+
+	return adjust((1.0 - nullFraction) * MAX(fraction, 0.0));
+}
+
+std::optional<double> ColumnStatistics::getBetweenSelectivity(const dsc* lowerDesc, const dsc* upperDesc) const
+{
+	if ((lowerDesc && lowerDesc->isNull()) || (upperDesc && upperDesc->isNull()))
+		return adjust(0);
+
+	double lower, upper;
+
+	if (!getValue(lowerDesc, lower) || !getValue(upperDesc, upper))
+		return std::nullopt;
+
+	const double fraction = getLessFraction(upper) + getEqualFraction(upper) - getLessFraction(lower);
+
+	return adjust((1.0 - nullFraction) * MIN(MAX(fraction, 0.0), 1.0));
+}
+
+std::optional<double> ColumnStatistics::getJoinSelectivity(const ColumnStatistics* other) const
+{
+	// Classic estimation for equi-joins: every value of the column with less
+	// distinct values is assumed to have a match in the other column
+
+	if (!other || distinctCount <= 0 || other->distinctCount <= 0)
+		return std::nullopt;
+
+	const double nonNulls = (1.0 - nullFraction) * (1.0 - other->nullFraction);
+
+	return adjust(nonNulls / MAX(distinctCount, other->distinctCount));
+}
+
+
+// Never report zero selectivity: statistics may be outdated and the value
+// may be just missing in the sample. Assume half of a row in the sample.
+
+double ColumnStatistics::adjust(double selectivity) const
+{
+	const double minSelectivity = 0.5 / MAX(sampleSize, 1);
+	return MIN(MAX(selectivity, minSelectivity), 1.0);
+}
+
+
+void ColumnStatistics::getHistogram(UCharBuffer& buffer) const
+{
+	ClumpletWriter writer(ClumpletReader::Tagged, MAX_ULONG, HISTOGRAM_VERSION1);
+
+	writer.insertByte(isc_hst_ordinal_type, ordinalType);
+
+	for (const auto bound : bounds)
+		writer.insertDouble(isc_hst_bound, bound);
+
+	buffer.assign(writer.getBuffer(), writer.getBufferLength());
+}
+
+void ColumnStatistics::setHistogram(const UCHAR* data, ULONG length)
+{
+	bounds.clear();
+	ordinalType = ORDINAL_NONE;
+
+	if (!length)
+		return;
+
+	ClumpletReader reader(ClumpletReader::Tagged, data, length);
+
+	if (reader.getBufferTag() != HISTOGRAM_VERSION1)
+		return;		// unknown format, ignore it
+
+	for (reader.rewind(); !reader.isEof(); reader.moveNext())
+	{
+		switch (reader.getClumpTag())
+		{
+			case isc_hst_ordinal_type:
+				ordinalType = (OrdinalType) reader.getInt();
+				break;
+
+			case isc_hst_bound:
+				bounds.add(reader.getDouble());
+				break;
+		}
+	}
+
+	if (ordinalType == ORDINAL_NONE)
+		bounds.clear();
+}
+
+
+void ColumnStatistics::collect(thread_db* tdbb, jrd_tra* transaction, jrd_rel* relation,
+	ObjectsArray<ColumnStatistics>& result)
+{
+	SET_TDBB(tdbb);
+	const auto dbb = tdbb->getDatabase();
+	auto& pool = *tdbb->getDefaultPool();
+
+	const auto format = relation->currentFormat(tdbb);
+	const auto fields = relation->rel_fields;
+
+	// Pick up stored scalar columns
+
+	ObjectsArray<ColumnSample> samples;
+
+	for (USHORT id = 0; fields && id < format->fmt_count && id < fields->count(); id++)
+	{
+		const auto field = (*fields)[id];
+		const auto& desc = format->fmt_desc[id];
+
+		if (!field || field->fld_computation || !desc.dsc_dtype ||
+			desc.isBlob() || desc.dsc_dtype == dtype_array)
+		{
+			continue;
+		}
+
+		auto& stats = result.add();
+		stats.fieldId = id;
+		stats.fieldName = field->fld_name;
+
+		auto& sample = samples.add();
+		sample.stats = &stats;
+	}
+
+	if (samples.isEmpty())
+		return;
+
+	// Choose data pages to be sampled: every N-th one, with N being calculated
+	// from the estimated number of rows per data page
+
+	const auto relPages = relation->getPages(tdbb);
+	const ULONG ppCount = relPages->rel_pages ? relPages->rel_pages->count() : 0;
+	const ULONG maxSequence = ppCount * dbb->dbb_dp_per_pp;
+	const ULONG dataPages = MAX(DPM_data_pages(tdbb, getPermanent(relation)), 1);
+	const double cardinality = DPM_cardinality(tdbb, relation, format);
+	const double rowsPerPage = MAX(cardinality / dataPages, 1.0);
+	const ULONG samplePages = MAX((ULONG) (SAMPLE_ROWS / rowsPerPage), 1);
+	const ULONG step = MAX(dataPages / samplePages, 1);
+
+	record_param rpb;
+	rpb.rpb_relation = relation;
+	rpb.rpb_record = nullptr;
+	rpb.getWindow(tdbb).win_flags = WIN_large_scan;
+	rpb.rpb_org_scans = getPermanent(relation)->rel_scan_count++;
+
+	SINT64 sampleSize = 0;
+
+	try
+	{
+		for (ULONG sequence = 0; sequence < maxSequence; sequence += step)
+		{
+			rpb.rpb_number.setValue((SINT64) sequence * dbb->dbb_max_records - 1);
+			const RecordNumber last((SINT64) (sequence + 1) * dbb->dbb_max_records - 1);
+
+			while (VIO_next_record(tdbb, &rpb, transaction, &pool, DPM_next_data_page, &last))
+			{
+				sampleSize++;
+
+				for (auto& sample : samples)
+				{
+					dsc desc;
+
+					if (!EVL_field(relation, rpb.rpb_record, sample.stats->fieldId, &desc))
+					{
+						sample.nullCount++;
+						continue;
+					}
+
+					sample.hashes.add(hashValue(&desc));
+
+					if (sample.ordinal)
+					{
+						double value;
+						const auto type = getOrdinal(&desc, value);
+
+						if (type == ORDINAL_NONE)
+							sample.ordinal = false;
+						else
+						{
+							sample.stats->ordinalType = type;
+							sample.values.add(value);
+						}
+					}
+				}
+
+				JRD_reschedule(tdbb);
+			}
+		}
+	}
+	catch (const Exception&)
+	{
+		delete rpb.rpb_record;
+		--getPermanent(relation)->rel_scan_count;
+		throw;
+	}
+
+	delete rpb.rpb_record;
+	--getPermanent(relation)->rel_scan_count;
+
+	// Unless the whole table was read, rely upon the cardinality estimation
+
+	const double totalRows = (step == 1) ? sampleSize : MAX(cardinality, (double) sampleSize);
+
+	for (auto& sample : samples)
+	{
+		auto* const stats = sample.stats;
+
+		stats->sampleSize = sampleSize;
+		stats->nullFraction = sampleSize ? (double) sample.nullCount / sampleSize : 0;
+
+		const double nonNullRows = totalRows * (1.0 - stats->nullFraction);
+		stats->distinctCount = estimateDistinct(sample.hashes, nonNullRows);
+
+		if (!sample.ordinal || sample.values.isEmpty())
+		{
+			stats->ordinalType = ORDINAL_NONE;
+			continue;
+		}
+
+		// Build the equi-depth histogram
+
+		auto& values = sample.values;
+		std::sort(values.begin(), values.end());
+
+		const FB_SIZE_T count = values.getCount();
+		const FB_SIZE_T buckets = MIN(count, (FB_SIZE_T) MAX_BUCKETS);
+
+		for (FB_SIZE_T i = 0; i <= buckets; i++)
+			stats->bounds.add(values[(FB_UINT64) i * (count - 1) / buckets]);
+	}
+}
+
+
+const ColumnStatistics* TableStatistics::find(const MetaName& fieldName) const
+{
+	for (const auto& stats : columns)
+	{
+		if (stats.fieldName == fieldName)
+			return &stats;
+	}
+
+	return nullptr;
+}
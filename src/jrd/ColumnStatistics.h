@@ -0,0 +1,141 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_COLUMN_STATISTICS_H
+#define JRD_COLUMN_STATISTICS_H
+
+#include "firebird.h"
+#include "../common/classes/array.h"
+#include "../common/classes/objects_array.h"
+#include "../common/classes/RefCounted.h"
+#include "../jrd/MetaName.h"
+#include <optional>
+
+struct dsc;
+
+namespace Jrd {
+
+class thread_db;
+class jrd_tra;
+class jrd_rel;
+
+// Distribution statistics of a single table column. They're collected by
+// SET STATISTICS TABLE, stored in RDB$COLUMN_STATISTICS and used by the optimizer
+// to estimate selectivity of the predicates not covered by index statistics.
+
+class ColumnStatistics : public Firebird::PermanentStorage
+{
+public:
+	// Ordinal domain of the histogram bounds, values of different domains are incomparable
+	enum OrdinalType : UCHAR
+	{
+		ORDINAL_NONE = 0,
+		ORDINAL_NUMBER,		// exact and approximate numerics, booleans
+		ORDINAL_DATETIME,	// dates and timestamps as days (with the fraction of day)
+		ORDINAL_TIME,		// times as the fraction of day
+		ORDINAL_STRING		// binary comparable strings by their leading bytes
+	};
+
+	static constexpr unsigned MAX_BUCKETS = 64;
+
+	explicit ColumnStatistics(MemoryPool& pool)
+		: PermanentStorage(pool),
+		  bounds(pool)
+	{}
+
+	ColumnStatistics(MemoryPool& pool, const ColumnStatistics& other)
+		: PermanentStorage(pool),
+		  fieldId(other.fieldId),
+		  fieldName(other.fieldName),
+		  nullFraction(other.nullFraction),
+		  distinctCount(other.distinctCount),
+		  sampleSize(other.sampleSize),
+		  ordinalType(other.ordinalType),
+		  bounds(pool)
+	{
+		bounds.assign(other.bounds);
+	}
+
+	// Selectivity estimations, relative to the whole table.
+	// Nothing is returned if the statistics are not applicable to the given values.
+
+	double getNullSelectivity() const
+	{
+		return adjust(nullFraction);
+	}
+
+	std::optional<double> getEqualSelectivity(const dsc* value) const;
+	std::optional<double> getLessSelectivity(const dsc* value, bool inclusive) const;
+	std::optional<double> getGreaterSelectivity(const dsc* value, bool inclusive) const;
+	std::optional<double> getBetweenSelectivity(const dsc* lower, const dsc* upper) const;
+	std::optional<double> getJoinSelectivity(const ColumnStatistics* other) const;
+
+	bool hasHistogram() const
+	{
+		return bounds.getCount() > 1;
+	}
+
+	// Histogram (de)serialization for RDB$COLUMN_STATISTICS.RDB$HISTOGRAM
+	void getHistogram(Firebird::UCharBuffer& buffer) const;
+	void setHistogram(const UCHAR* data, ULONG length);
+
+	// Collect statistics for all stored columns of the relation by sampling its data pages
+	static void collect(thread_db* tdbb, jrd_tra* transaction, jrd_rel* relation,
+		Firebird::ObjectsArray<ColumnStatistics>& result);
+
+	static OrdinalType getOrdinal(const dsc* desc, double& value);
+
+public:
+	USHORT fieldId = 0;
+	MetaName fieldName;
+	double nullFraction = 0;
+	double distinctCount = 0;
+	SINT64 sampleSize = 0;
+	OrdinalType ordinalType = ORDINAL_NONE;
+
+	// Equi-depth histogram: bounds[0] is the minimum value, bounds[N] is the maximum one,
+	// every bucket between two adjacent bounds covers the same share of non-null values
+	Firebird::Array<double> bounds;
+
+private:
+	bool getValue(const dsc* desc, double& value) const;
+	double adjust(double selectivity) const;
+	double getEqualFraction(double value) const;
+	double getLessFraction(double value) const;
+};
+
+// Statistics of all the columns of a table. They're loaded once per relation
+// and shared by its compiled statements until the statistics are updated.
+
+class TableStatistics : public Firebird::RefCounted, public Firebird::PermanentStorage
+{
+public:
+	explicit TableStatistics(MemoryPool& pool)
+		: PermanentStorage(pool),
+		  columns(pool)
+	{}
+
+	const ColumnStatistics* find(const MetaName& fieldName) const;
+
+	Firebird::ObjectsArray<ColumnStatistics> columns;
+};
+
+} // namespace Jrd
+
+#endif // JRD_COLUMN_STATISTICS_H
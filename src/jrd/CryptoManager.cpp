@@ -43,10 +43,12 @@
 #include "../jrd/cch_proto.h"
 #include "../jrd/lck.h"
 #include "../jrd/pag_proto.h"
+#include "../jrd/ods_proto.h"
 #include "firebird/impl/inf_pub.h"
 #include "../jrd/Monitoring.h"
 #include "../jrd/os/pio_proto.h"
 #include "../common/isc_proto.h"
+#include "../common/utils_proto.h"
 #include "../common/classes/auto.h"
 #include "../common/classes/RefMutex.h"
 #include "../common/classes/ClumpletWriter.h"
@@ -1266,6 +1268,23 @@ namespace Jrd
 			}
 		}
 
+		// Compressed data page is read regardless of current DataPageCompression setting
+		if (page->pag_type == pag_data && (page->pag_flags & Ods::dpg_compressed))
+		{
+			const SINT64 start = fb_utils::query_performance_counter();
+
+			if (!Ods::decompressPage(page, dbb.dbb_page_size))
+			{
+				string msg;
+				msg.printf("error decompressing data page %" ULONGFORMAT, page->pag_pageno);
+				(Arg::Gds(isc_random) << msg).copyTo(sv);
+				return FAILED_IO;
+			}
+
+			dbb.dbb_decompressed_pages++;
+			dbb.dbb_compression_time += fb_utils::elapsedMicroseconds(start);
+		}
+
 		return SUCCESS_ALL;
 	}
 
@@ -1362,6 +1381,21 @@ namespace Jrd
 		else
 		{
 			page->pag_flags &= ~Ods::crypted_page;
+
+			// Compressed image is written while the page in cache stays as is
+			if (page->pag_type == pag_data && (dbb.dbb_flags & DBB_page_compression))
+			{
+				const SINT64 start = fb_utils::query_performance_counter();
+				const ULONG length = Ods::compressPage(page, to, dbb.dbb_page_size);
+				dbb.dbb_compression_time += fb_utils::elapsedMicroseconds(start);
+
+				if (length)
+				{
+					dbb.dbb_compressed_pages++;
+					dbb.dbb_compressed_size += length;
+					dest = to;
+				}
+			}
 		}
 
 		if (!io->callback(tdbb, sv, dest))
@@ -42,6 +42,7 @@
 #include "../common/os/os_utils.h"
 #include "../jrd/met.h"
 #include "../jrd/Statement.h"
+#include "../jrd/SharedStatementCache.h"
 
 // Thread data block
 #include "../common/ThreadData.h"
@@ -214,6 +215,7 @@ namespace Jrd
 		delete dbb_monitoring_data;
 		delete dbb_backup_manager;
 		delete dbb_crypto_manager;
+		delete dbb_shared_statements;
 		delete dbb_mdc;
 
 		fb_assert(dbb_pools[0] == dbb_permanent);
@@ -825,6 +827,11 @@ namespace Jrd
 		dbb_compatibility_index(~0U),
 		dbb_dic(*p),
 		dbb_mdc(FB_NEW_POOL(*p) MetadataCache(*p)),
+		dbb_shared_statements(FB_NEW_POOL(*p) SharedStatementCache(*p)),
+		dbb_compressed_pages(0),
+		dbb_compressed_size(0),
+		dbb_decompressed_pages(0),
+		dbb_compression_time(0),
 		dbb_user_ids(*p),
 		dbb_del_pages(*p)
 	{
@@ -95,6 +95,7 @@ class GarbageCollector;
 class CryptoManager;
 class KeywordsMap;
 class MetadataCache;
+class SharedStatementCache;
 class ExtEngineManager;
 class RelationPermanent;
 
@@ -132,6 +133,7 @@ inline constexpr ULONG DBB_shared					= 0x100000L;	// Database object is shared
 inline constexpr ULONG DBB_restoring				= 0x200000L;	// Database restore is in progress
 inline constexpr ULONG DBB_rescan_pages				= 0x400000L;	// Rescan pages after TIP cache creation
 inline constexpr ULONG DBB_dropping					= 0x800000L;	// Drop database is in progress
+inline constexpr ULONG DBB_page_compression			= 0x1000000L;	// Data pages are written compressed
 
 //
 // dbb_ast_flags
@@ -466,6 +468,13 @@ public:
 	Firebird::InitInstance<Keywords, Keywords::Allocator, Firebird::TraditionalDelete> dbb_keywords;
 
 	MetadataCache* dbb_mdc;
+	SharedStatementCache* dbb_shared_statements;	// compiled statements shared by attachments
+
+	// data page compression statistics
+	std::atomic<FB_UINT64> dbb_compressed_pages;	// data pages written compressed
+	std::atomic<FB_UINT64> dbb_compressed_size;		// total size of their compressed images
+	std::atomic<FB_UINT64> dbb_decompressed_pages;	// compressed data pages read
+	std::atomic<FB_UINT64> dbb_compression_time;	// time spent for (de)compression, microseconds
 
 private:
 	Firebird::GenericMap<Firebird::Pair<Firebird::Left<
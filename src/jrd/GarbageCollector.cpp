@@ -33,6 +33,7 @@ namespace Jrd {
 void GarbageCollector::RelationData::clear()
 {
 	m_pages.clear();
+	m_pending = 0;
 }
 
 
@@ -58,6 +59,7 @@ TraNumber GarbageCollector::RelationData::addPage(const ULONG pageno, const TraN
 		return findTran;
 
 	m_pages.add(PageTran(pageno, tranid));
+	m_pending++;
 	return tranid;
 }
 
@@ -76,6 +78,7 @@ void GarbageCollector::RelationData::swept(const TraNumber oldest_snapshot, Page
 				PBM_SET(&m_pool, bm, pages.current().pageno);
 			}
 			next = pages.fastRemove();
+			m_pending--;
 		}
 		else
 			next = pages.getNext();
@@ -192,6 +195,37 @@ void GarbageCollector::sweptRelation(const TraNumber oldest_snapshot, const USHO
 }
 
 
+void GarbageCollector::processed(const USHORT relID, const ULONG pages, const FB_UINT64 time)
+{
+	Sync syncGC(&m_sync, "GarbageCollector::processed");
+
+	RelationData* relData = getRelData(syncGC, relID, false);
+	if (relData)
+	{
+		relData->m_processedPages += pages;
+		relData->m_processingTime += time;
+	}
+}
+
+
+void GarbageCollector::getStatistics(StatsArray& stats)
+{
+	SyncLockGuard shGuard(&m_sync, SYNC_SHARED, "GarbageCollector::getStatistics");
+
+	for (FB_SIZE_T pos = 0; pos < m_relations.getCount(); pos++)
+	{
+		RelationData* relData = m_relations[pos];
+		SyncLockGuard syncData(&relData->m_sync, SYNC_SHARED, "GarbageCollector::getStatistics");
+
+		RelationStats& relStats = stats.add();
+		relStats.relID = relData->getRelID();
+		relStats.pendingPages = relData->m_pending;
+		relStats.processedPages = relData->m_processedPages;
+		relStats.processingTime = relData->m_processingTime;
+	}
+}
+
+
 GarbageCollector::RelationData* GarbageCollector::getRelData(Sync &sync, const USHORT relID,
 	bool allowCreate)
 {
@@ -24,6 +24,7 @@
 #define JRD_GARBAGE_COLLECTOR_H
 
 #include "firebird.h"
+#include <atomic>
 #include "../common/classes/array.h"
 #include "../common/classes/GenericMap.h"
 #include "../common/classes/SyncObject.h"
@@ -44,11 +45,25 @@ public:
 
 	~GarbageCollector();
 
+	// Per-relation state of background garbage collection
+	struct RelationStats
+	{
+		USHORT relID;
+		ULONG pendingPages;			// data pages waiting for garbage collection
+		FB_UINT64 processedPages;	// data pages processed by garbage collector
+		FB_UINT64 processingTime;	// time spent on them, in microseconds
+	};
+
+	typedef Firebird::HalfStaticArray<RelationStats, 16> StatsArray;
+
 	TraNumber addPage(const USHORT relID, const ULONG pageno, const TraNumber tranid);
 	PageBitmap* getPages(const TraNumber oldest_snapshot, USHORT &relID);
 	void removeRelation(const USHORT relID);
 	void sweptRelation(const TraNumber oldest_snapshot, const USHORT relID);
 
+	void processed(const USHORT relID, const ULONG pages, const FB_UINT64 time);
+	void getStatistics(StatsArray& stats);
+
 private:
 	struct PageTran
 	{
@@ -77,7 +92,8 @@ private:
 	{
 	public:
 		explicit RelationData(MemoryPool& p, USHORT relID)
-			: m_pool(p), m_pages(p), m_relID(relID)
+			: m_pool(p), m_pages(p), m_relID(relID),
+			  m_pending(0), m_processedPages(0), m_processingTime(0)
 		{}
 
 		~RelationData()
@@ -105,6 +121,9 @@ private:
 		Firebird::SyncObject m_sync;
 		PageTranMap m_pages;
 		USHORT m_relID;
+		ULONG m_pending;
+		std::atomic<FB_UINT64> m_processedPages;
+		std::atomic<FB_UINT64> m_processingTime;
 	};
 
 	typedef	Firebird::SortedArray<
@@ -42,6 +42,7 @@
 #include "../jrd/pag_proto.h"
 #include "../jrd/cvt_proto.h"
 #include "../jrd/CryptoManager.h"
+#include "../jrd/GarbageCollector.h"
 #include "../jrd/Relation.h"
 #include "../jrd/RecordBuffer.h"
 #include "../jrd/Monitoring.h"
@@ -471,6 +472,9 @@ MonitoringSnapshot::MonitoringSnapshot(thread_db* tdbb, MemoryPool& pool)
 	const auto tab_stat_buffer = allocBuffer(tdbb, pool, rel_mon_tab_stats);
 	const auto local_temp_tables_buffer = allocBuffer(tdbb, pool, rel_mon_local_temp_tables);
 	const auto local_temp_table_columns_buffer = allocBuffer(tdbb, pool, rel_mon_local_temp_table_columns);
+	const auto gc_queue_buffer = dbb->getEncodedOdsVersion() >= ODS_14_1 ?
+		allocBuffer(tdbb, pool, rel_mon_gc_queue) :
+		nullptr;
 
 	// Increment the global monitor generation
 
@@ -612,6 +616,9 @@ MonitoringSnapshot::MonitoringSnapshot(thread_db* tdbb, MemoryPool& pool)
 		case rel_mon_local_temp_table_columns:
 			buffer = local_temp_table_columns_buffer;
 			break;
+		case rel_mon_gc_queue:
+			buffer = gc_queue_buffer;
+			break;
 		default:
 			fb_assert(false);
 		}
@@ -1024,6 +1031,42 @@ void Monitoring::putDatabase(thread_db* tdbb, SnapshotData::DumpRecord& record)
 
 	record.storeInteger(f_mon_db_repl_mode, dbb->dbb_replica_mode);
 
+	// page cache replacement policy and its efficiency, appeared in ODS 14.1
+	if (dbb->getEncodedOdsVersion() >= ODS_14_1)
+	{
+		const BufferControl* const bcb = dbb->dbb_bcb;
+		const char* bufferPolicy = BufferPolicyLRU;
+		if (bcb->bcb_policy == BUFFER_POLICY_CLOCK)
+			bufferPolicy = BufferPolicyClock;
+		else if (bcb->bcb_policy == BUFFER_POLICY_2Q)
+			bufferPolicy = BufferPolicy2Q;
+		record.storeString(f_mon_db_buffer_policy, std::string_view(bufferPolicy));
+
+		// hits are not counted separately to avoid contention on every page fetch,
+		// every fetch is either a hit or a miss
+		const SINT64 misses = bcb->bcb_misses.load(std::memory_order_relaxed);
+		SINT64 fetches = 0;
+		if (dbb->dbb_flags & DBB_shared)
+		{
+			MutexLockGuard guard(dbb->dbb_stats_mutex, FB_FUNCTION);
+			fetches = dbb->dbb_stats[PageStatType::FETCHES];
+		}
+		else if (const auto attachment = tdbb->getAttachment())
+			fetches = attachment->att_stats[PageStatType::FETCHES];
+
+		record.storeInteger(f_mon_db_buffer_hits, MAX(fetches - misses, 0));
+		record.storeInteger(f_mon_db_buffer_misses, misses);
+	}
+
+	// data page compression, appeared in ODS 14.1
+	if (dbb->getEncodedOdsVersion() >= ODS_14_1)
+	{
+		record.storeInteger(f_mon_db_compressed_pages, dbb->dbb_compressed_pages.load(std::memory_order_relaxed));
+		record.storeInteger(f_mon_db_compressed_size, dbb->dbb_compressed_size.load(std::memory_order_relaxed));
+		record.storeInteger(f_mon_db_decompressed_pages, dbb->dbb_decompressed_pages.load(std::memory_order_relaxed));
+		record.storeInteger(f_mon_db_compression_time, dbb->dbb_compression_time.load(std::memory_order_relaxed));
+	}
+
 	// statistics
 	const int stat_id = fb_utils::genUniqueId();
 	record.storeGlobalId(f_mon_db_stat_id, getGlobalId(stat_id));
@@ -1043,6 +1086,26 @@ void Monitoring::putDatabase(thread_db* tdbb, SnapshotData::DumpRecord& record)
 		putStatistics(tdbb, record, zero_rt_stats, stat_id, stat_database);
 		putMemoryUsage(record, zero_mem_stats, stat_id, stat_database);
 	}
+
+	// background garbage collection queue, MON$GC_QUEUE appeared in ODS 14.1
+	const auto gc = dbb->dbb_garbage_collector;
+
+	if (gc && dbb->getEncodedOdsVersion() >= ODS_14_1)
+	{
+		GarbageCollector::StatsArray gcStats;
+		gc->getStatistics(gcStats);
+
+		for (const auto& relStats : gcStats)
+		{
+			record.reset(rel_mon_gc_queue);
+			record.storeTableIdSchemaName(f_mon_gcq_sch_name, relStats.relID);
+			record.storeTableIdObjectName(f_mon_gcq_tab_name, relStats.relID);
+			record.storeInteger(f_mon_gcq_pending_pages, relStats.pendingPages);
+			record.storeInteger(f_mon_gcq_processed_pages, relStats.processedPages);
+			record.storeInteger(f_mon_gcq_processing_time, relStats.processingTime);
+			record.write();
+		}
+	}
 }
 
 
@@ -2107,7 +2107,21 @@ bool AggregateSourceNode::containsStream(StreamType checkStream) const
 RecordSource* AggregateSourceNode::compile(thread_db* tdbb, Optimizer* opt, bool /*innerSubStream*/)
 {
 	const auto csb = opt->getCompilerScratch();
-	rse->rse_sorted = group;
+
+	// Hash the groups instead of sorting the input if their order does not matter
+	// and they're estimated to fit into memory
+	bool hashed = false;
+
+	if (group && !orderedGroups)
+	{
+		if (const auto groupCount = opt->getDistinctCount(group->expressions))
+		{
+			hashed = HashAggregatedStream::isApplicable(tdbb, csb,
+				&group->expressions, map, groupCount.value());
+		}
+	}
+
+	rse->rse_sorted = hashed ? nullptr : group;
 
 	// AB: Try to distribute items from the HAVING CLAUSE to the WHERE CLAUSE.
 	// Zip thru stack of booleans looking for fields that belong to shellStream.
@@ -2124,7 +2138,7 @@ RecordSource* AggregateSourceNode::compile(thread_db* tdbb, Optimizer* opt, bool
 	NestConst<ValueExprNode>* ptr;
 	AggNode* aggNode = NULL;
 
-	if (map->sourceList.getCount() == 1 && (ptr = map->sourceList.begin()) &&
+	if (!hashed && map->sourceList.getCount() == 1 && (ptr = map->sourceList.begin()) &&
 		(aggNode = nodeAs<AggNode>(*ptr)) &&
 		(aggNode->aggInfo.blr == blr_agg_min || aggNode->aggInfo.blr == blr_agg_max))
 	{
@@ -2148,8 +2162,18 @@ RecordSource* AggregateSourceNode::compile(thread_db* tdbb, Optimizer* opt, bool
 
 	// allocate and optimize the record source block
 
-	AggregatedStream* const rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) AggregatedStream(tdbb, csb,
-		stream, (group ? &group->expressions : NULL), map, nextRsb);
+	RecordSource* rsb;
+
+	if (hashed)
+	{
+		rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) HashAggregatedStream(tdbb, csb,
+			stream, &group->expressions, map, nextRsb);
+	}
+	else
+	{
+		rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) AggregatedStream(tdbb, csb,
+			stream, (group ? &group->expressions : NULL), map, nextRsb);
+	}
 
 	if (rse->rse_aggregate)
 	{
@@ -578,6 +578,7 @@ private:
 
 public:
 	bool dsqlWindow;
+	bool orderedGroups = false;		// groups must be returned ordered by the group values
 };
 
 class UnionSourceNode final : public TypedNode<RecordSourceNode, RecordSourceNode::TYPE_UNION>
@@ -118,6 +118,7 @@ jrd_rel::jrd_rel(MemoryPool& p, Cached::Relation* r)
 RelationPermanent::RelationPermanent(thread_db* tdbb, MemoryPool& p, MetaId id, NoData)
 	: PermanentStorage(p),
 	  rel_partners_lock(nullptr),
+	  rel_stats_lock(nullptr),
 	  rel_gc_lock(this),
 	  rel_gc_records(p),
 	  rel_scan_count(0),
@@ -135,11 +136,16 @@ RelationPermanent::RelationPermanent(thread_db* tdbb, MemoryPool& p, MetaId id,
 	rel_partners_lock = FB_NEW_RPT(getPool(), 0)
 		Lock(tdbb, sizeof(SLONG), LCK_rel_partners, this, partners_ast_relation);
 	rel_partners_lock->setKey(rel_id);
+
+	rel_stats_lock = FB_NEW_RPT(getPool(), 0)
+		Lock(tdbb, sizeof(SLONG), LCK_rel_stats, this, stats_ast_relation);
+	rel_stats_lock->setKey(rel_id);
 }
 
 RelationPermanent::~RelationPermanent()
 {
 	fb_assert(!rel_partners_lock);
+	fb_assert(!rel_stats_lock);
 }
 
 bool RelationPermanent::destroy(thread_db* tdbb, RelationPermanent* rel)
@@ -150,6 +156,12 @@ bool RelationPermanent::destroy(thread_db* tdbb, RelationPermanent* rel)
 		rel->rel_partners_lock = nullptr;
 	}
 
+	if (rel->rel_stats_lock)
+	{
+		LCK_release(tdbb, rel->rel_stats_lock);
+		rel->rel_stats_lock = nullptr;
+	}
+
 	if (rel->rel_file)
 	{
 		rel->rel_file->release();
@@ -202,6 +214,28 @@ int RelationPermanent::partners_ast_relation(void* ast_object)
 }
 
 
+int RelationPermanent::stats_ast_relation(void* ast_object)
+{
+	auto* const relation = static_cast<RelationPermanent*>(ast_object);
+
+	try
+	{
+		Lock* lock = relation->rel_stats_lock;
+		Database* const dbb = lock->lck_dbb;
+
+		AsyncContextHolder tdbb(dbb, FB_FUNCTION);
+
+		auto oldFlags = relation->rel_flags.fetch_or(REL_check_stats);
+		if (!(oldFlags & REL_check_stats))
+			LCK_release(tdbb, lock);
+	}
+	catch (const Exception&)
+	{} // no-op
+
+	return 0;
+}
+
+
 
 Record* RelationPermanent::getGCRecord(thread_db* tdbb, const Format* const format)
 {
@@ -254,6 +288,17 @@ void RelationPermanent::checkPartners(thread_db* tdbb)
 	LCK_release(tdbb, rel_partners_lock);
 }
 
+void RelationPermanent::checkColumnStatistics(thread_db* tdbb)
+{
+	rel_flags |= REL_check_stats;
+
+	if (!rel_stats_lock)
+		return;
+
+	LCK_lock(tdbb, rel_stats_lock, LCK_EX, LCK_WAIT);
+	LCK_release(tdbb, rel_stats_lock);
+}
+
 bool RelationPermanent::isReplicating(thread_db* tdbb)
 {
 	Database* const dbb = tdbb->getDatabase();
@@ -677,6 +722,9 @@ void RelationPermanent::releaseLock(thread_db* tdbb)
 	if (rel_partners_lock)
 		LCK_release(tdbb, rel_partners_lock);
 
+	if (rel_stats_lock)
+		LCK_release(tdbb, rel_stats_lock);
+
 	rel_gc_lock.forcedRelease(tdbb);
 
 	for (auto* index : rel_indices)
@@ -1036,6 +1084,7 @@ void RelationPages::free(RelationPages*& nextFree)
 	rel_slot_space = rel_pri_data_space = rel_sec_data_space = 0;
 	rel_last_free_pri_dp = rel_last_free_blb_dp = 0;
 	rel_instance_id = 0;
+	rel_swept_top = 0;
 
 	dpMap.clear();
 	dpMapMark = 0;
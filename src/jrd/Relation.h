@@ -36,6 +36,7 @@
 #include "../common/classes/TriState.h"
 #include "../common/sha2/sha2.h"
 #include "../jrd/ods.h"
+#include "../jrd/ColumnStatistics.h"
 
 namespace Jrd
 {
@@ -326,13 +327,15 @@ public:
 	ULONG rel_last_free_pri_dp;	// last primary data page found with space
 	ULONG rel_last_free_blb_dp;	// last blob data page found with space
 	USHORT rel_pg_space_id;
+	std::atomic<TraNumber> rel_swept_top;	// newest record on swept pages not marked as all-visible,
+											// 0 if unknown
 
 	RelationPages(Firebird::MemoryPool& pool)
 		: rel_pages(NULL), rel_instance_id(0),
 		  rel_index_root(0), rel_data_pages(0), rel_slot_space(0),
 		  rel_pri_data_space(0), rel_sec_data_space(0),
 		  rel_last_free_pri_dp(0), rel_last_free_blb_dp(0),
-		  rel_pg_space_id(DB_PAGE_SPACE), rel_next_free(NULL),
+		  rel_pg_space_id(DB_PAGE_SPACE), rel_swept_top(0), rel_next_free(NULL),
 		  dpMap(pool),
 		  dpMapMark(0)
 	{}
@@ -719,6 +722,7 @@ inline constexpr ULONG REL_virtual				= 0x0040;	// relation is virtual
 inline constexpr ULONG REL_jrd_view				= 0x0080;	// relation is VIEW
 inline constexpr ULONG REL_temp_gtt				= 0x0100;	// relation is a GTT
 inline constexpr ULONG REL_temp_ltt				= 0x0200;	// relation is a LTT
+inline constexpr ULONG REL_check_stats			= 0x0400;	// Reload column statistics
 
 class GCLock
 {
@@ -872,6 +876,7 @@ public:
 	}
 
 	Lock*		rel_partners_lock;		// partners lock
+	Lock*		rel_stats_lock;			// column statistics lock
 	GCLock		rel_gc_lock;			// garbage collection lock
 
 	void releaseLock(thread_db* tdbb);
@@ -913,6 +918,9 @@ public:
 	void	fillPagesSnapshot(RelPagesSnapshot&, const bool AttachmentOnly = false);
 	void	scanPartners(thread_db* tdbb);		// Foreign keys scan - impl. in met.epp
 
+	// Column statistics - impl. in met.epp
+	Firebird::RefPtr<TableStatistics> getColumnStatistics(thread_db* tdbb);
+
 	RelationPages* getBasePages() noexcept
 	{
 		return &rel_pages_base;
@@ -966,6 +974,7 @@ public:
 	bool isReplicating(thread_db* tdbb);
 
 	static int partners_ast_relation(void* ast_object);
+	static int stats_ast_relation(void* ast_object);
 
 	// Relation must be updated on next use or commit
 	static Cached::Relation* newVersion(thread_db* tdbb, const QualifiedName& name);
@@ -977,6 +986,9 @@ public:
 	// Lists of FK partners should be updated on next update
 	void checkPartners(thread_db* tdbb);
 
+	// Column statistics should be reloaded on next use
+	void checkColumnStatistics(thread_db* tdbb);
+
 	// On commit of relation dependencies of global field to be cleaned ...
 	void removeDependsFrom(const QualifiedName& globField);
 	//			... will be removed
@@ -988,6 +1000,9 @@ private:
 	SharedReadVector<Format*, 16> rel_formats;	// Known record formats
 	Firebird::Mutex rel_formats_grow;	// Mutex to grow rel_formats
 
+	Firebird::RefPtr<TableStatistics> rel_statistics;	// Loaded column statistics
+	Firebird::Mutex rel_statistics_mutex;
+
 public:
 	HazardPtr<Formats::Generation> getFormats()
 	{
@@ -0,0 +1,212 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/SharedStatementCache.h"
+#include "../jrd/jrd.h"
+#include "../jrd/Attachment.h"
+#include "../jrd/Statement.h"
+#include "../jrd/cmp_proto.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+// Class SharedStatementCache
+
+SharedStatementCache::SharedStatementCache(MemoryPool& pool)
+	: PermanentStorage(pool),
+	  m_keys(pool),
+	  m_entries(pool)
+{
+}
+
+SharedStatementCache::~SharedStatementCache()
+{
+	fb_assert(m_entries.count() == 0);
+}
+
+Statement* SharedStatementCache::compile(thread_db* tdbb, const string* sqlText,
+	const UCHAR* blr, ULONG blrLength, bool internalFlag, ULONG dbginfoLength, const UCHAR* dbginfo)
+{
+	string key(getPool());
+	buildKey(tdbb, key, sqlText, blr, blrLength, internalFlag, dbginfoLength, dbginfo);
+
+	Statement* statement = nullptr;
+	ULONG generation;
+
+	{	// scope
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		generation = m_generation;
+
+		if (const auto entryPtr = m_keys.get(key))
+		{
+			Entry* const entry = *entryPtr;
+			fb_assert(entry->shared);
+
+			entry->useCount++;
+			statement = entry->statement;
+		}
+	}
+
+	if (statement)
+	{
+		// The statement was compiled on behalf of another user
+
+		try
+		{
+			statement->verifyAccess(tdbb);
+		}
+		catch (const Exception&)
+		{
+			release(tdbb, statement);
+			throw;
+		}
+
+		return statement;
+	}
+
+	statement = CMP_compile(tdbb, blr, blrLength, internalFlag, dbginfoLength, dbginfo);
+
+	if (sqlText)
+		statement->sqlText = FB_NEW_POOL(*statement->pool) RefString(*statement->pool, *sqlText);
+
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	// If the metadata was changed while compiling, the statement may use the old one.
+	// If another attachment has compiled the same statement meanwhile, it's shared instead.
+	// Anyway, ours is not shared and will be released by the usual way.
+	if (m_generation != generation || m_keys.exist(key))
+		return statement;
+
+	Entry* const entry = FB_NEW_POOL(getPool()) Entry(getPool());
+	entry->key = key;
+	entry->statement = statement;
+	entry->useCount = 1;
+
+	m_keys.put(entry->key, entry);
+	m_entries.put(statement, entry);
+
+	return statement;
+}
+
+void SharedStatementCache::release(thread_db* tdbb, Statement* statement)
+{
+	{	// scope
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		if (const auto entryPtr = m_entries.get(statement))
+		{
+			Entry* const entry = *entryPtr;
+			fb_assert(entry->useCount);
+
+			if (--entry->useCount)
+				return;
+
+			if (entry->shared)
+				m_keys.remove(entry->key);
+
+			m_entries.remove(statement);
+			delete entry;
+		}
+	}
+
+	statement->release(tdbb);
+}
+
+unsigned SharedStatementCache::getReferenceSize(const Statement* statement)
+{
+	const unsigned size = statement->getSize();
+
+	// Memory of the shared statement, including the requests of all its users,
+	// is divided between them to keep the attachment statement caches bounded
+
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	if (const auto entryPtr = m_entries.get(const_cast<Statement*>(statement)))
+		return size / (*entryPtr)->useCount;
+
+	return size;
+}
+
+void SharedStatementCache::invalidate()
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	m_generation++;
+
+	for (auto& item : m_keys)
+		item.second->shared = false;
+
+	m_keys.clear();
+}
+
+void SharedStatementCache::shutdown(thread_db* tdbb)
+{
+	HalfStaticArray<Statement*, 16> statements;
+
+	{	// scope
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		for (auto& item : m_entries)
+		{
+			statements.add(item.first);
+			delete item.second;
+		}
+
+		m_keys.clear();
+		m_entries.clear();
+	}
+
+	for (auto statement : statements)
+		statement->release(tdbb);
+}
+
+void SharedStatementCache::buildKey(thread_db* tdbb, string& key, const string* sqlText,
+	const UCHAR* blr, ULONG blrLength, bool internalFlag, ULONG dbginfoLength, const UCHAR* dbginfo)
+{
+	// Everything resolved by DSQL (schemas of the search path, data type bindings
+	// and so on) is in the BLR already. The attachment settings used by the compiler
+	// are the character set and the optimizer mode.
+
+	const auto dbb = tdbb->getDatabase();
+	const auto attachment = tdbb->getAttachment();
+
+	const CSetId charSetId = internalFlag ? CSetId(CS_METADATA) : attachment->att_charset;
+	const bool firstRows = !internalFlag &&
+		attachment->att_opt_first_rows.valueOr(dbb->dbb_config->getOptimizeForFirstRows());
+
+	const ULONG textLength = sqlText ? sqlText->length() : 0;
+
+	key.reserve(1 + sizeof(charSetId) + sizeof(ULONG) * 2 + textLength + blrLength + dbginfoLength);
+
+	key += char((int(internalFlag) << 1) | int(firstRows));
+	key.append((const char*) &charSetId, sizeof(charSetId));
+	key.append((const char*) &textLength, sizeof(textLength));
+	key.append((const char*) &blrLength, sizeof(blrLength));
+
+	if (sqlText)
+		key += *sqlText;
+
+	key.append((const char*) blr, blrLength);
+
+	if (dbginfoLength)
+		key.append((const char*) dbginfo, dbginfoLength);
+}
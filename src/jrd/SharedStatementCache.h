@@ -0,0 +1,105 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_SHARED_STATEMENT_CACHE_H
+#define JRD_SHARED_STATEMENT_CACHE_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/fb_string.h"
+#include "../common/classes/GenericMap.h"
+#include "../common/classes/locks.h"
+
+namespace Jrd {
+
+class Statement;
+class thread_db;
+
+// Compiled statements shared by all attachments of the database.
+//
+// DSQL statements prepared by different attachments with the same SQL text,
+// BLR, character set and optimizer mode use the single compiled Statement.
+// Every attachment keeps its own DSQL statement and requests only. An entry
+// lives while it's used by at least one DSQL statement, so the cache is bounded
+// by the statement caches of the attachments.
+//
+// The cache is invalidated together with the DSQL statement caches when the
+// metadata changes are committed. Invalidated statements are not shared anymore
+// but are kept until released by their current users. Statements compiled while
+// the cache was invalidated are not shared either, as they might be compiled
+// using the old metadata.
+
+class SharedStatementCache final : public Firebird::PermanentStorage
+{
+private:
+	struct Entry
+	{
+		explicit Entry(MemoryPool& p)
+			: key(p)
+		{}
+
+		Firebird::string key;
+		Statement* statement = nullptr;
+		unsigned useCount = 0;
+		bool shared = true;				// entry may be found by its key
+	};
+
+public:
+	explicit SharedStatementCache(MemoryPool& pool);
+	~SharedStatementCache();
+
+	SharedStatementCache(const SharedStatementCache&) = delete;
+	SharedStatementCache& operator=(const SharedStatementCache&) = delete;
+
+	// Find the statement compiled by another attachment or compile it
+	Statement* compile(thread_db* tdbb, const Firebird::string* sqlText,
+		const UCHAR* blr, ULONG blrLength, bool internalFlag,
+		ULONG dbginfoLength, const UCHAR* dbginfo);
+
+	// Release the statement obtained from compile()
+	void release(thread_db* tdbb, Statement* statement);
+
+	// Memory of the statement accounted by every one of its users
+	unsigned getReferenceSize(const Statement* statement);
+
+	bool isCached(Statement* statement)
+	{
+		Firebird::MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		return m_entries.exist(statement);
+	}
+
+	// Don't share the currently cached statements anymore
+	void invalidate();
+
+	// Release statements left by the attachments gone without releasing them
+	void shutdown(thread_db* tdbb);
+
+private:
+	void buildKey(thread_db* tdbb, Firebird::string& key, const Firebird::string* sqlText,
+		const UCHAR* blr, ULONG blrLength, bool internalFlag,
+		ULONG dbginfoLength, const UCHAR* dbginfo);
+
+	Firebird::Mutex m_mutex;
+	Firebird::GenericMap<Firebird::Pair<Firebird::Left<Firebird::string, Entry*> > > m_keys;
+	Firebird::NonPooledMap<Statement*, Entry*> m_entries;
+	ULONG m_generation = 0;			// incremented by invalidate()
+};
+
+}	// namespace Jrd
+
+#endif // JRD_SHARED_STATEMENT_CACHE_H
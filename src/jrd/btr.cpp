@@ -44,6 +44,7 @@
 #include "iberror.h"
 #include "../jrd/lck.h"
 #include "../jrd/cch.h"
+#include "../jrd/os/pio.h"
 #include "../jrd/sort.h"
 #include "../jrd/met.h"
 #include "../jrd/Statement.h"
@@ -252,6 +253,7 @@ static INT64_KEY make_int64_key(SINT64, SSHORT);
 static void print_int64_key(SINT64, SSHORT, INT64_KEY);
 #endif
 static string print_key(thread_db*, jrd_rel*, index_desc*, Record*);
+static void read_ahead_leaves(thread_db*, btree_page*, ULONG, const temporary_key*);
 static contents remove_node(thread_db*, index_insertion*, WIN*);
 static contents remove_leaf_node(thread_db*, index_insertion*, WIN*);
 static bool scan(thread_db*, UCHAR*, RecordBitmap**, RecordBitmap*, index_desc*,
@@ -1579,7 +1581,7 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 	do
 	{
 		if (!page) // scan from the index root
-			page = BTR_find_page(tdbb, retrieval, &window, &idx, lower, upper);
+			page = BTR_find_page(tdbb, retrieval, &window, &idx, lower, upper, true);
 
 		const bool descending = (idx.idx_flags & idx_descending);
 		bool skipLowerKey = (retrieval->irb_generic & ~forceInclFlag) & irb_exclude_lower;
@@ -1734,7 +1736,8 @@ btree_page* BTR_find_page(thread_db* tdbb,
 						  WIN* window,
 						  index_desc* idx,
 						  temporary_key* lower,
-						  temporary_key* upper)
+						  temporary_key* upper,
+						  bool readAhead)
 {
 /**************************************
  *
@@ -1744,6 +1747,9 @@ btree_page* BTR_find_page(thread_db* tdbb,
  *
  * Functional description
  *	Initialize for an index retrieval.
+ *	If readAhead is set, the leaf pages
+ *	which are going to be scanned are
+ *	read into the cache in advance.
  *
  **************************************/
 
@@ -1774,6 +1780,12 @@ btree_page* BTR_find_page(thread_db* tdbb,
 
 	const bool firstData = (retrieval->irb_lower_count || ignoreNulls);
 
+	// Equality lookups rarely span more than one leaf page, don't read ahead for them
+	if (retrieval->irb_generic & irb_equality)
+		readAhead = false;
+
+	const temporary_key* const readAheadUpper = retrieval->irb_upper_count ? upper : nullptr;
+
 	if (firstData)
 	{
 		// Make a temporary key with length 1 and zero byte, this will return
@@ -1792,6 +1804,9 @@ btree_page* BTR_find_page(thread_db* tdbb,
 					NO_VALUE, (retrieval->irb_generic & (irb_starting | irb_partial)));
 				if (number != END_BUCKET)
 				{
+					if (readAhead && page->btr_level == 1)
+						read_ahead_leaves(tdbb, page, number, readAheadUpper);
+
 					page = (btree_page*) CCH_HANDOFF(tdbb, window, number, LCK_read, pag_index);
 					break;
 				}
@@ -1814,6 +1829,9 @@ btree_page* BTR_find_page(thread_db* tdbb,
 			if (pointer > endPointer)
 				BUGCHECK(204);	// msg 204 index inconsistent
 
+			if (readAhead && page->btr_level == 1)
+				read_ahead_leaves(tdbb, page, node.pageNumber, readAheadUpper);
+
 			page = (btree_page*) CCH_HANDOFF(tdbb, window, node.pageNumber, LCK_read, pag_index);
 		}
 	}
@@ -7148,6 +7166,66 @@ string print_key(thread_db* tdbb, jrd_rel* relation, index_desc* idx, Record* re
 }
 
 
+static void read_ahead_leaves(thread_db* tdbb, btree_page* page, ULONG number, const temporary_key* upper)
+{
+/**************************************
+ *
+ *	r e a d _ a h e a d _ l e a v e s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Given the page of the level above the leaves and
+ *	the leaf page the scan starts from, read ahead the
+ *	next leaf pages, up to the one which may contain
+ *	the upper bound of the scan.
+ *
+ **************************************/
+	const ULONG batch = tdbb->getDatabase()->dbb_bcb->bcb_io_batch;
+	if (!batch)
+		return;
+
+	fb_assert(page->btr_level == 1);
+
+	ULONG pages[MAX_IO_BATCH];
+	FB_SIZE_T count = 0;
+	bool found = false;
+
+	temporary_key key;
+	key.key_length = 0;
+
+	const UCHAR* const endPointer = (UCHAR*) page + page->btr_length;
+	UCHAR* pointer = page->btr_nodes + page->btr_jump_size;
+	IndexNode node;
+
+	while (count < batch)
+	{
+		pointer = node.readNode(pointer, false);
+		if (pointer > endPointer || node.isEndBucket || node.isEndLevel)
+			break;
+
+		memcpy(key.key_data + node.prefix, node.data, node.length);
+		key.key_length = node.prefix + node.length;
+
+		// Skip nodes up to the starting page, it's going to be fetched anyway
+		if (!found)
+		{
+			found = (node.pageNumber == number);
+			continue;
+		}
+
+		// The first key of the page is beyond the upper bound
+		if (upper && memcmp(key.key_data, upper->key_data, MIN(key.key_length, upper->key_length)) > 0)
+			break;
+
+		pages[count++] = node.pageNumber;
+	}
+
+	if (count > 1)
+		CCH_read_ahead(tdbb, pages, count);
+}
+
+
 static contents remove_node(thread_db* tdbb, index_insertion* insertion, WIN* window)
 {
 /**************************************
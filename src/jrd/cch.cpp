@@ -150,11 +150,14 @@ static void purgePrecedence(BufferControl*, BufferDesc*);
 static SSHORT related(BufferDesc*, const BufferDesc*, SSHORT, const ULONG);
 static int write_buffer(thread_db*, BufferDesc*, const PageNumber, const bool, FbStatusVector* const,
 	const bool);
+static bool write_buffers(thread_db*, BufferDesc**, FB_SIZE_T, const bool, FbStatusVector* const);
 static bool write_page(thread_db*, BufferDesc*, FbStatusVector* const, const bool);
+static void page_written(thread_db*, BufferDesc*);
 static bool set_diff_page(thread_db*, BufferDesc*);
 static void clear_dirty_flag_and_nbak_state(thread_db*, BufferDesc*);
 
 static BufferDesc* get_dirty_buffer(thread_db*);
+static FB_SIZE_T get_dirty_buffers(thread_db*, BufferDesc**, FB_SIZE_T);
 
 
 static inline void insertDirty(BufferControl* bcb, BufferDesc* bdb)
@@ -197,6 +200,30 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 static void recentlyUsed(BufferDesc* bdb);
 static void requeueRecentlyUsed(BufferControl* bcb);
 
+static void bufferHit(BufferDesc* bdb);
+static void bufferAssigned(BufferControl* bcb, BufferDesc* bdb);
+static void insertAssigned(BufferControl* bcb, BufferDesc* bdb);
+static void releaseToTail(BufferControl* bcb, BufferDesc* bdb);
+static void setupPolicy(BufferControl* bcb);
+static void getLruQues(BufferControl* bcb, que* ques[2]);
+static void addGhost(BufferControl* bcb, const PageNumber& page);
+static bool removeGhost(BufferControl* bcb, const PageNumber& page);
+
+static inline void unlinkBuffer(BufferControl* bcb, BufferDesc* bdb)
+{
+	// Caller must hold bcb_syncLRU exclusively
+
+	QUE_DELETE(bdb->bdb_in_use);
+	QUE_INIT(bdb->bdb_in_use);
+
+	if (bdb->bdb_probation)
+	{
+		fb_assert(bcb->bcb_probation_count > 0);
+		bcb->bcb_probation_count--;
+		bdb->bdb_probation = false;
+	}
+}
+
 
 constexpr ULONG MIN_BUFFER_SEGMENT = 65536;
 
@@ -351,16 +378,7 @@ void CCH_clean_page(thread_db* tdbb, PageNumber page)
 		clear_dirty_flag_and_nbak_state(tdbb, bdb);
 	}
 
-	{
-		Sync lruSync(&bcb->bcb_syncLRU, "CCH_release");
-		lruSync.lock(SYNC_EXCLUSIVE);
-
-		if (bdb->bdb_flags & BDB_lru_chained)
-			requeueRecentlyUsed(bcb);
-
-		QUE_DELETE(bdb->bdb_in_use);
-		QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
-	}
+	releaseToTail(bcb, bdb);
 
 	bdb->release(tdbb, true);
 }
@@ -1114,7 +1132,7 @@ void CCH_forget_page(thread_db* tdbb, WIN* window)
 	{
 		SyncLockGuard lruSync(&bcb->bcb_syncLRU, SYNC_EXCLUSIVE, FB_FUNCTION);
 		requeueRecentlyUsed(bcb);
-		QUE_DELETE(bdb->bdb_in_use);
+		unlinkBuffer(bcb, bdb);
 	}
 
 	// remove from hash table and put into empty list
@@ -1615,10 +1633,19 @@ void CCH_init(thread_db* tdbb, ULONG number)
 	//bcb->bcb_flags = BCB_exclusive;	// TODO detect real state using LM
 
 	QUE_INIT(bcb->bcb_in_use);
+	QUE_INIT(bcb->bcb_probation);
 	QUE_INIT(bcb->bcb_dirty);
 	bcb->bcb_dirty_count = 0;
 	QUE_INIT(bcb->bcb_empty);
 
+	const NoCaseString policy(dbb->dbb_config->getBufferPolicy());
+	if (policy == BufferPolicyClock)
+		bcb->bcb_policy = BUFFER_POLICY_CLOCK;
+	else if (policy == BufferPolicy2Q)
+		bcb->bcb_policy = BUFFER_POLICY_2Q;
+	else
+		bcb->bcb_policy = BUFFER_POLICY_LRU;
+
 	// initialization of memory is system-specific
 
 	bcb->bcb_count = memory_init(tdbb, bcb, number);
@@ -1627,6 +1654,13 @@ void CCH_init(thread_db* tdbb, ULONG number)
 	if (bcb->bcb_count < MIN_PAGE_BUFFERS)
 		ERR_post(Arg::Gds(isc_cache_too_small));
 
+	setupPolicy(bcb);
+
+	// Don't let the batched IO occupy more than 1/8 of the cache
+
+	const ULONG ioBatch = MIN(dbb->dbb_config->getIoBatchSize(), MIN(bcb->bcb_count / 8, MAX_IO_BATCH));
+	bcb->bcb_io_batch = (ioBatch > 1) ? ioBatch : 0;
+
 	// Log if requested number of page buffers could not be allocated.
 
 	if (count != bcb->bcb_count)
@@ -1939,6 +1973,136 @@ bool CCH_prefetch_pages(thread_db* tdbb)
 #endif // CACHE_READER
 
 
+void CCH_read_ahead(thread_db* tdbb, const ULONG* pages, FB_SIZE_T count)
+{
+/**************************************
+ *
+ *	C C H _ r e a d _ a h e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read the given database pages into the cache
+ *	using single batched IO request. Used by the
+ *	sequential and index range scans to keep the
+ *	storage busy while the pages are processed.
+ *	Pages already in the cache or whose buffers
+ *	can't be latched immediately are skipped.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+	BufferControl* const bcb = dbb->dbb_bcb;
+
+	// Pages of the shared cache would need page locks to be read on behalf of
+	// somebody else, so read ahead is done only if the cache is not shared
+
+	if (!(bcb->bcb_flags & BCB_exclusive) || !bcb->bcb_io_batch)
+		return;
+
+	count = MIN(count, bcb->bcb_io_batch);
+	if (count < 2)
+		return;
+
+	BackupManager::StateReadGuard stateGuard(tdbb);
+	if (dbb->dbb_backup_manager->getState() != Ods::hdr_nbak_normal)
+		return;
+
+	HalfStaticArray<PageIo, 64> ios;
+
+	for (const ULONG* const end = pages + count; pages < end; pages++)
+	{
+		if (!*pages)
+			continue;
+
+		const PageNumber page(DB_PAGE_SPACE, *pages);
+
+		{	// scope
+#ifndef HASH_USE_CDS_LIST
+			SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_SHARED, FB_FUNCTION);
+#endif
+			if (bcb->bcb_hashTable->find(page))
+				continue;
+		}
+
+		BufferDesc* const bdb = get_buffer(tdbb, page, SYNC_EXCLUSIVE, 0);
+		if (!bdb)
+			continue;
+
+		// Somebody could read the page in the meantime
+
+		if (!(bdb->bdb_flags & BDB_read_pending))
+		{
+			bdb->release(tdbb, false);
+			continue;
+		}
+
+		PageIo& io = ios.add();
+		io.pio_bdb = bdb;
+		io.pio_page = bdb->bdb_buffer;
+		io.pio_done = false;
+	}
+
+	if (ios.isEmpty())
+		return;
+
+	class Pio : public CryptoManager::IOCallback
+	{
+	public:
+		Pio(jrd_file* f, BufferDesc* b)
+			: file(f), bdb(b), preRead(true)
+		{ }
+
+		bool callback(thread_db* tdbb, FbStatusVector* status, Ods::pag* page)
+		{
+			// The page is already read by the batch. Crypto manager may ask
+			// to read it again if the crypt state has been changed meanwhile.
+
+			if (preRead)
+			{
+				preRead = false;
+				return true;
+			}
+
+			return PIO_read(tdbb, file, bdb, page, status);
+		}
+
+	private:
+		jrd_file* file;
+		BufferDesc* bdb;
+		bool preRead;
+	};
+
+	jrd_file* const file = dbb->dbb_page_manager.findPageSpace(DB_PAGE_SPACE)->file;
+	FbLocalStatus status;
+
+	// Failed pages are left pending read, so they're read again on demand
+	// and the caller gets the error, if any, in the usual way
+
+	PIO_read_batch(tdbb, file, ios.begin(), ios.getCount(), &status);
+
+	for (auto& io : ios)
+	{
+		BufferDesc* const bdb = io.pio_bdb;
+
+		if (io.pio_done)
+		{
+			Pio pio(file, bdb);
+			if (dbb->dbb_crypto_manager->read(tdbb, &status, bdb->bdb_buffer, &pio))
+			{
+				bdb->bdb_incarnation = ++bcb->bcb_page_incarnation;
+				tdbb->bumpStats(PageStatType::READS, DB_PAGE_SPACE);
+
+				bdb->bdb_flags &= ~(BDB_not_valid | BDB_read_pending);
+				bdb->bdb_flags |= BDB_prefetch;
+			}
+		}
+
+		bdb->release(tdbb, false);
+	}
+}
+
+
 bool set_diff_page(thread_db* tdbb, BufferDesc* bdb)
 {
 	Database* const dbb = tdbb->getDatabase();
@@ -2127,18 +2291,7 @@ void CCH_release(thread_db* tdbb, WIN* window, const bool release_tail)
 				if (window->win_flags & WIN_garbage_collector)
 					bdb->bdb_flags &= ~BDB_garbage_collect;
 
-				{ // bcb_syncLRU scope
-					Sync lruSync(&bcb->bcb_syncLRU, "CCH_release");
-					lruSync.lock(SYNC_EXCLUSIVE);
-
-					if (bdb->bdb_flags & BDB_lru_chained)
-					{
-						requeueRecentlyUsed(bcb);
-					}
-
-					QUE_DELETE(bdb->bdb_in_use);
-					QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
-				}
+				releaseToTail(bcb, bdb);
 
 				if ((bcb->bcb_flags & BCB_cache_writer) &&
 					(bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) )
@@ -2554,6 +2707,14 @@ static void adjust_scan_count(WIN* window, bool mustRead)
  **************************************/
 	BufferDesc* bdb = window->win_bdb;
 
+	// Page read ahead is considered as read by its first fetch
+
+	if (bdb->bdb_flags & BDB_prefetch)
+	{
+		bdb->bdb_flags &= ~BDB_prefetch;
+		mustRead = true;
+	}
+
 	// If a page was read or prefetched on behalf of a large scan
 	// then load the window scan count into the buffer descriptor.
 	// This buffer scan count is decremented by releasing a buffer
@@ -2564,7 +2725,7 @@ static void adjust_scan_count(WIN* window, bool mustRead)
 
 	if (window->win_flags & WIN_large_scan)
 	{
-		if (mustRead || (bdb->bdb_flags & BDB_prefetch) || bdb->bdb_scan_count < 0)
+		if (mustRead || bdb->bdb_scan_count < 0)
 			bdb->bdb_scan_count = window->win_scans;
 	}
 	else if (window->win_flags & WIN_garbage_collector)
@@ -2792,9 +2953,11 @@ extern "C" {
 static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, FB_SIZE_T count)
 {
 	FbStatusVector* const status = tdbb->tdbb_status_vector;
+	BufferControl* const bcb = tdbb->getDatabase()->dbb_bcb;
 	const bool all_flag = (flush_flag & FLUSH_ALL) != 0;
 	const bool release_flag = (flush_flag & FLUSH_RLSE) != 0;
 	const bool write_thru = release_flag;
+	const SyncType syncType = release_flag ? SYNC_EXCLUSIVE : SYNC_SHARED;
 
 	qsort(begin, count, sizeof(BufferDesc*), cmpBdbs);
 
@@ -2803,6 +2966,30 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 	FB_SIZE_T written = 0;
 	bool writeAll = false;
 
+	// Pages with no high precedence pages found at the same iteration don't depend
+	// on each other, so they're collected and written by the batched IO requests
+
+	HalfStaticArray<BufferDesc*, 64> batch;
+
+	const auto writeBatch = [&]()
+	{
+		if (batch.isEmpty())
+			return;
+
+		if (!write_buffers(tdbb, batch.begin(), batch.getCount(), write_thru, status))
+			CCH_unwind(tdbb, true);
+
+		for (auto bdb : batch)
+		{
+			if (release_flag)
+				PAGE_LOCK_RELEASE(tdbb, bcb, bdb->bdb_lock);
+
+			bdb->release(tdbb, !release_flag && !(bdb->bdb_flags & BDB_dirty));
+		}
+
+		batch.clear();
+	};
+
 	while (!iter.isEmpty())
 	{
 		bool found = false;
@@ -2813,9 +3000,14 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 			if (!bdb)
 				continue;
 
-			bdb->addRef(tdbb, release_flag ? SYNC_EXCLUSIVE : SYNC_SHARED);
+			// Don't wait for the latch while holding latches of the batched pages
+
+			if (batch.isEmpty() || !bdb->addRefConditional(tdbb, syncType))
+			{
+				writeBatch();
+				bdb->addRef(tdbb, syncType);
+			}
 
-			BufferControl* bcb = bdb->bdb_bcb;
 			if (!writeAll)
 				purgePrecedence(bcb, bdb);
 
@@ -2829,6 +3021,19 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 
 				if (!all_flag || bdb->bdb_flags & (BDB_db_dirty | BDB_dirty))
 				{
+					if (!writeAll && bcb->bcb_io_batch)
+					{
+						batch.add(bdb);
+
+						if (batch.getCount() >= bcb->bcb_io_batch)
+							writeBatch();
+
+						iter.mark();
+						found = true;
+						written++;
+						continue;
+					}
+
 					if (!write_buffer(tdbb, bdb, bdb->bdb_page, write_thru, status, true))
 						CCH_unwind(tdbb, true);
 				}
@@ -2850,6 +3055,8 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 			}
 		}
 
+		writeBatch();
+
 		if (!found)
 			writeAll = true;
 
@@ -3086,10 +3293,11 @@ void BufferControl::cache_writer(BufferControl* bcb)
 
 				if (bcb->bcb_flags & BCB_free_pending)
 				{
-					BufferDesc* const bdb = get_dirty_buffer(tdbb);
-					if (bdb)
+					BufferDesc* dirty[MAX_IO_BATCH];
+					const FB_SIZE_T count = get_dirty_buffers(tdbb, dirty, MAX(bcb->bcb_io_batch, 1));
+					if (count)
 					{
-						write_buffer(tdbb, bdb, bdb->bdb_page, true, &status_vector, true);
+						write_buffers(tdbb, dirty, count, true, &status_vector);
 						attachment->mergeStats();
 					}
 				}
@@ -3606,49 +3814,82 @@ static bool expand_buffers(thread_db* tdbb, ULONG number)
 	bcb->bcb_count += allocated;
 	bcb->bcb_free_minimum = (SSHORT) MIN(bcb->bcb_count / 4, 128);	// 25% clean page reserve
 
+	{
+		SyncLockGuard lruSync(&bcb->bcb_syncLRU, SYNC_EXCLUSIVE, FB_FUNCTION);
+		setupPolicy(bcb);
+	}
+
 	return true;
 }
 
 
 static BufferDesc* get_dirty_buffer(thread_db* tdbb)
+{
+	BufferDesc* bdb = NULL;
+	get_dirty_buffers(tdbb, &bdb, 1);
+	return bdb;
+}
+
+
+static FB_SIZE_T get_dirty_buffers(thread_db* tdbb, BufferDesc** buffers, FB_SIZE_T max)
 {
 	// This code is only used by the background I/O threads:
 	// cache writer, cache reader and garbage collector.
+	// Returns up to max dirty buffers close to the LRU tail.
 
 	SET_TDBB(tdbb);
 	Database* dbb = tdbb->getDatabase();
 	BufferControl* bcb = dbb->dbb_bcb;
 	int walk = bcb->bcb_free_minimum;
 	int chained = walk;
+	FB_SIZE_T count = 0;
 
 	Sync lruSync(&bcb->bcb_syncLRU, FB_FUNCTION);
 	lruSync.lock(SYNC_SHARED);
 
-	for (QUE que_inst = bcb->bcb_in_use.que_backward;
-		 que_inst != &bcb->bcb_in_use; que_inst = que_inst->que_backward)
-	{
-		BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_in_use);
+	// Look at the buffers in the same order as get_oldest_buffer() does
 
-		if (bdb->bdb_flags & BDB_lru_chained)
+	que* ques[2];
+	getLruQues(bcb, ques);
+
+	for (que* const lru : ques)
+	{
+		for (QUE que_inst = lru->que_backward; que_inst != lru; que_inst = que_inst->que_backward)
 		{
-			if (!--chained)
-				break;
-			continue;
-		}
+			BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_in_use);
 
-		if (bdb->bdb_use_count || (bdb->bdb_flags & BDB_free_pending))
-			continue;
+			if (bdb->bdb_flags & BDB_lru_chained)
+			{
+				if (!--chained)
+					break;
+				continue;
+			}
 
-		if (bdb->bdb_flags & BDB_db_dirty)
-		{
-			//tdbb->bumpStats(PageStatType::FETCHES); shouldn't it be here?
-			return bdb;
+			if (bdb->bdb_use_count || (bdb->bdb_flags & BDB_free_pending))
+				continue;
+
+			if (bdb->bdb_flags & BDB_db_dirty)
+			{
+				//tdbb->bumpStats(PageStatType::FETCHES); shouldn't it be here?
+				buffers[count++] = bdb;
+
+				if (count == max)
+					break;
+
+				continue;
+			}
+
+			if (!--walk)
+				break;
 		}
 
-		if (!--walk)
+		if (count == max || !chained || !walk)
 			break;
 	}
 
+	if (count)
+		return count;
+
 	if (!chained)
 	{
 		lruSync.unlock();
@@ -3658,7 +3899,7 @@ static BufferDesc* get_dirty_buffer(thread_db* tdbb)
 	else
 		bcb->bcb_flags &= ~BCB_free_pending;
 
-	return NULL;
+	return 0;
 }
 
 
@@ -3673,48 +3914,26 @@ static BufferDesc* get_oldest_buffer(thread_db* tdbb, BufferControl* bcb)
 	int walk = bcb->bcb_free_minimum;
 	BufferDesc* bdb = nullptr;
 
-	Sync lruSync(&bcb->bcb_syncLRU, FB_FUNCTION);
-	if (bcb->bcb_lru_chain.load() != NULL)
-	{
-		lruSync.lock(SYNC_EXCLUSIVE);
-		requeueRecentlyUsed(bcb);
-		lruSync.downgrade(SYNC_SHARED);
-	}
-	else
-		lruSync.lock(SYNC_SHARED);
+	// Try to latch the buffer found. Returns true if it may be reused or if there are
+	// enough dirty buffers seen already, otherwise let the cache writer write it.
 
-	for (QUE que_inst = bcb->bcb_in_use.que_backward;
-		 que_inst != &bcb->bcb_in_use;
-		 que_inst = que_inst->que_backward)
+	const auto latchOldest = [&](BufferDesc* oldest) -> bool
 	{
-		bdb = nullptr;
-
-		// get the oldest buffer as the least recently used -- note
-		// that since there are no empty buffers this queue cannot be empty
-
-		if (bcb->bcb_in_use.que_forward == &bcb->bcb_in_use)
-			BUGCHECK(213);	// msg 213 insufficient cache size
-
-		BufferDesc* oldest = BLOCK(que_inst, BufferDesc, bdb_in_use);
-
-		if (oldest->bdb_flags & BDB_lru_chained)
-			continue;
-
 		if (oldest->bdb_use_count || !oldest->addRefConditional(tdbb, SYNC_EXCLUSIVE))
-			continue;
+			return false;
 
 		/*if (!writeable(oldest))
 		{
 			oldest->release(tdbb, true);
-			continue;
+			return false;
 		}*/
 
 		bdb = oldest;
 		if (!(bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) || !walk)
-			break;
+			return true;
 
 		if (!(bcb->bcb_flags & BCB_cache_writer))
-			break;
+			return true;
 
 		bcb->bcb_flags |= BCB_free_pending;
 		if (!(bcb->bcb_flags & BCB_writer_active))
@@ -3723,6 +3942,95 @@ static BufferDesc* get_oldest_buffer(thread_db* tdbb, BufferControl* bcb)
 		bdb->release(tdbb, true);
 		bdb = nullptr;
 		--walk;
+		return false;
+	};
+
+	Sync lruSync(&bcb->bcb_syncLRU, FB_FUNCTION);
+
+	if (bcb->bcb_policy == BUFFER_POLICY_LRU)
+	{
+		if (bcb->bcb_lru_chain.load() != NULL)
+		{
+			lruSync.lock(SYNC_EXCLUSIVE);
+			requeueRecentlyUsed(bcb);
+			lruSync.downgrade(SYNC_SHARED);
+		}
+		else
+			lruSync.lock(SYNC_SHARED);
+
+		// get the oldest buffer as the least recently used -- note
+		// that since there are no empty buffers this queue cannot be empty
+
+		if (bcb->bcb_in_use.que_forward == &bcb->bcb_in_use)
+			BUGCHECK(213);	// msg 213 insufficient cache size
+
+		for (QUE que_inst = bcb->bcb_in_use.que_backward;
+			 que_inst != &bcb->bcb_in_use;
+			 que_inst = que_inst->que_backward)
+		{
+			BufferDesc* oldest = BLOCK(que_inst, BufferDesc, bdb_in_use);
+
+			if (oldest->bdb_flags & BDB_lru_chained)
+				continue;
+
+			if (latchOldest(oldest))
+				break;
+		}
+	}
+	else
+	{
+		// CLOCK and 2Q: buffer accessed since it was looked at last time is moved
+		// to the head of its que and gets the next chance. The usage counter is
+		// decremented, thus every buffer is moved no more than MAX_BUFFER_USAGE times.
+		// Buffers in the probation que don't get second chance, but the page
+		// evicted from there is remembered and goes directly into the main que
+		// if it's read again.
+
+		lruSync.lock(SYNC_EXCLUSIVE);
+		requeueRecentlyUsed(bcb);
+
+		if (QUE_EMPTY(bcb->bcb_in_use) && QUE_EMPTY(bcb->bcb_probation))
+			BUGCHECK(213);	// msg 213 insufficient cache size
+
+		que* ques[2];
+		getLruQues(bcb, ques);
+
+		for (que* const lru : ques)
+		{
+			const bool probation = (lru == &bcb->bcb_probation);
+
+			for (QUE que_inst = lru->que_backward; que_inst != lru; )
+			{
+				BufferDesc* oldest = BLOCK(que_inst, BufferDesc, bdb_in_use);
+				que_inst = que_inst->que_backward;
+
+				// assigned to the new page concurrently, not requeued yet
+				if (oldest->bdb_flags & BDB_lru_chained)
+					continue;
+
+				if (!probation)
+				{
+					const UCHAR usage = oldest->bdb_usage.load(std::memory_order_relaxed);
+					if (usage)
+					{
+						oldest->bdb_usage.store(usage - 1, std::memory_order_relaxed);
+						QUE_DELETE(oldest->bdb_in_use);
+						QUE_INSERT(*lru, oldest->bdb_in_use);
+						continue;
+					}
+				}
+
+				if (latchOldest(oldest))
+					break;
+			}
+
+			if (bdb)
+			{
+				if (probation)
+					addGhost(bcb, bdb->bdb_page);
+				break;
+			}
+		}
 	}
 
 	lruSync.unlock();
@@ -3816,7 +4124,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 			{
 				if (bdb->bdb_page == page)
 				{
-					recentlyUsed(bdb);
+					bufferHit(bdb);
 					tdbb->bumpStats(PageStatType::FETCHES, pageSpaceId);
 					return bdb;
 				}
@@ -3859,7 +4167,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				// ensure the found page buffer is still for the same page after latch
 				if (bdb->bdb_page == page)
 				{
-					recentlyUsed(bdb);
+					bufferHit(bdb);
 					tdbb->bumpStats(PageStatType::FETCHES, pageSpaceId);
 					cacheBuffer(att, bdb);
 					return bdb;
@@ -3899,7 +4207,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				else if (bdb->bdb_page == page)
 				{
 					bdb->downgrade(syncType);
-					recentlyUsed(bdb);
+					bufferHit(bdb);
 					tdbb->bumpStats(PageStatType::FETCHES, pageSpaceId);
 					cacheBuffer(att, bdb);
 					return bdb;
@@ -3933,17 +4241,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 					bcbSync.unlock();
 #endif
 
-					if (!(bdb->bdb_flags & BDB_lru_chained))
-					{
-						Sync syncLRU(&bcb->bcb_syncLRU, FB_FUNCTION);
-						if (syncLRU.lockConditional(SYNC_EXCLUSIVE))
-						{
-							QUE_DELETE(bdb->bdb_in_use);
-							QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
-						}
-						else
-							recentlyUsed(bdb);
-					}
+					bufferAssigned(bcb, bdb);
 					tdbb->bumpStats(PageStatType::FETCHES, pageSpaceId);
 					cacheBuffer(att, bdb);
 					return bdb;
@@ -3961,7 +4259,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 					bdb2->release(tdbb, true);
 					continue;
 				}
-				recentlyUsed(bdb2);
+				bufferHit(bdb2);
 				tdbb->bumpStats(PageStatType::FETCHES, pageSpaceId);
 				cacheBuffer(att, bdb2);
 			}
@@ -4860,6 +5158,172 @@ static int write_buffer(thread_db* tdbb,
 }
 
 
+static bool write_buffers(thread_db* tdbb, BufferDesc** bdbs, FB_SIZE_T count, const bool write_thru,
+						  FbStatusVector* const status)
+{
+/**************************************
+ *
+ *	w r i t e _ b u f f e r s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Write a set of dirty buffers using single batched
+ *	IO request. Buffers must not depend on each other.
+ *	Buffers with pending higher precedence pages or
+ *	needing special handling (header and temporary
+ *	pages, shadows, backup in progress) are written
+ *	one by one by write_buffer.
+ *
+ * return: false if write failed
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+	BufferControl* const bcb = dbb->dbb_bcb;
+
+	HalfStaticArray<BufferDesc*, 64> single;
+	HalfStaticArray<PageIo, 64> ios;
+
+	const bool batch = (count > 1) && bcb->bcb_io_batch && !dbb->dbb_shadow &&
+		dbb->dbb_backup_manager->getState() == Ods::hdr_nbak_normal;
+
+	// Collects page images to be written. Encrypted image is built by the crypto
+	// manager in the temporary buffer, so it's copied to keep it until the write.
+
+	class Pio : public CryptoManager::IOCallback
+	{
+	public:
+		Pio(MemoryPool& pool, ULONG size, FB_SIZE_T count)
+			: images(pool), pageSize(size), maxCount(count)
+		{ }
+
+		void setTarget(PageIo* io, FB_SIZE_T slot)
+		{
+			target = io;
+			targetSlot = slot;
+		}
+
+		bool callback(thread_db*, FbStatusVector*, Ods::pag* page)
+		{
+			if (page != target->pio_bdb->bdb_buffer)
+			{
+				if (!imagesBase)
+				{
+					UCHAR* const buffer = images.getBuffer(maxCount * pageSize + DIRECT_IO_BLOCK_SIZE);
+					imagesBase = FB_ALIGN(buffer, DIRECT_IO_BLOCK_SIZE);
+				}
+
+				pag* const image = reinterpret_cast<pag*>(imagesBase + targetSlot * pageSize);
+				memcpy(image, page, pageSize);
+				page = image;
+			}
+
+			target->pio_page = page;
+			return true;
+		}
+
+	private:
+		Array<UCHAR> images;
+		UCHAR* imagesBase = nullptr;
+		const ULONG pageSize;
+		const FB_SIZE_T maxCount;
+		PageIo* target = nullptr;
+		FB_SIZE_T targetSlot = 0;
+	};
+
+	Pio io(*tdbb->getDefaultPool(), bcb->bcb_page_size, MIN(count, bcb->bcb_io_batch));
+
+	for (FB_SIZE_T i = 0; i < count; i++)
+	{
+		BufferDesc* const bdb = bdbs[i];
+		const PageNumber page = bdb->bdb_page;
+
+		if (!batch || ios.getCount() >= bcb->bcb_io_batch ||
+			page.getPageSpaceID() != DB_PAGE_SPACE || page == HEADER_PAGE_NUMBER)
+		{
+			single.add(bdb);
+			continue;
+		}
+
+		bdb->lockIO(tdbb);
+
+		if (bdb->bdb_page != page)
+		{
+			bdb->unLockIO(tdbb);
+			continue;
+		}
+
+		if (QUE_NOT_EMPTY(bdb->bdb_higher) || (bdb->bdb_flags & (BDB_marked | BDB_not_valid)) ||
+			!(bdb->bdb_flags & BDB_dirty || (write_thru && bdb->bdb_flags & BDB_db_dirty)))
+		{
+			bdb->unLockIO(tdbb);
+			single.add(bdb);
+			continue;
+		}
+
+		CCH_TRACE(("WRITE   %d:%06d", page.getPageSpaceID(), page.getPageNum()));
+
+		pag* const buffer = bdb->bdb_buffer;
+		buffer->pag_generation++;
+		buffer->pag_pageno = page.getPageNum();
+
+		PageIo& pageIo = ios.add();
+		pageIo.pio_bdb = bdb;
+		pageIo.pio_page = nullptr;
+		pageIo.pio_done = false;
+
+		io.setTarget(&pageIo, ios.getCount() - 1);
+
+		if (!dbb->dbb_crypto_manager->write(tdbb, status, buffer, &io))
+		{
+			// Let write_page report the error
+			ios.pop();
+			bdb->unLockIO(tdbb);
+			single.add(bdb);
+		}
+	}
+
+	if (ios.hasData())
+	{
+		jrd_file* const file = dbb->dbb_page_manager.findPageSpace(DB_PAGE_SPACE)->file;
+		FbLocalStatus localStatus;
+
+		PIO_write_batch(tdbb, file, ios.begin(), ios.getCount(), &localStatus);
+
+		for (auto& pageIo : ios)
+		{
+			BufferDesc* const bdb = pageIo.pio_bdb;
+
+			if (pageIo.pio_done)
+			{
+				tdbb->bumpStats(PageStatType::WRITES, DB_PAGE_SPACE);
+
+				bdb->bdb_flags &= ~BDB_db_dirty;
+				page_written(tdbb, bdb);
+
+				bdb->unLockIO(tdbb);
+				clear_precedence(tdbb, bdb);
+			}
+			else
+			{
+				// Failed pages are written again one by one to handle the error properly
+				bdb->unLockIO(tdbb);
+				single.add(bdb);
+			}
+		}
+	}
+
+	for (auto bdb : single)
+	{
+		if (!write_buffer(tdbb, bdb, bdb->bdb_page, write_thru, status, true))
+			return false;
+	}
+
+	return true;
+}
+
+
 static bool write_page(thread_db* tdbb, BufferDesc* bdb, FbStatusVector* const status, const bool inAst)
 {
 /**************************************
@@ -5054,34 +5518,50 @@ static bool write_page(thread_db* tdbb, BufferDesc* bdb, FbStatusVector* const s
 		dbb->dbb_flags |= DBB_suspend_bgio;
 	}
 	else
-	{
-		// clear the dirty bit vector, since the buffer is now
-		// clean regardless of which transactions have modified it
+		page_written(tdbb, bdb);
 
-		// Destination difference page number is only valid between MARK and
-		// write_page so clean it now to avoid confusion
-		bdb->bdb_difference_page = 0;
-		bdb->bdb_transactions = 0;
-		bdb->bdb_mark_transaction = 0;
+	return result;
+}
 
-		if (!(bdb->bdb_bcb->bcb_flags & BCB_keep_pages))
-			removeDirty(bdb->bdb_bcb, bdb);
 
-		bdb->bdb_flags &= ~(BDB_must_write | BDB_system_dirty);
-		clear_dirty_flag_and_nbak_state(tdbb, bdb);
+static void page_written(thread_db* tdbb, BufferDesc* bdb)
+{
+/**************************************
+ *
+ *	p a g e _ w r i t t e n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Mark the buffer as clean after its page
+ *	has been successfully written.
+ *
+ **************************************/
 
-		if (bdb->bdb_flags & BDB_io_error)
-		{
-			// If a write error has cleared, signal background threads
-			// to resume their regular duties. If someone has freed up
-			// disk space these errors will spontaneously go away.
+	// clear the dirty bit vector, since the buffer is now
+	// clean regardless of which transactions have modified it
 
-			bdb->bdb_flags &= ~BDB_io_error;
-			dbb->dbb_flags &= ~DBB_suspend_bgio;
-		}
-	}
+	// Destination difference page number is only valid between MARK and
+	// write_page so clean it now to avoid confusion
+	bdb->bdb_difference_page = 0;
+	bdb->bdb_transactions = 0;
+	bdb->bdb_mark_transaction = 0;
 
-	return result;
+	if (!(bdb->bdb_bcb->bcb_flags & BCB_keep_pages))
+		removeDirty(bdb->bdb_bcb, bdb);
+
+	bdb->bdb_flags &= ~(BDB_must_write | BDB_system_dirty);
+	clear_dirty_flag_and_nbak_state(tdbb, bdb);
+
+	if (bdb->bdb_flags & BDB_io_error)
+	{
+		// If a write error has cleared, signal background threads
+		// to resume their regular duties. If someone has freed up
+		// disk space these errors will spontaneously go away.
+
+		bdb->bdb_flags &= ~BDB_io_error;
+		tdbb->getDatabase()->dbb_flags &= ~DBB_suspend_bgio;
+	}
 }
 
 static void clear_dirty_flag_and_nbak_state(thread_db* tdbb, BufferDesc* bdb)
@@ -5156,8 +5636,17 @@ void requeueRecentlyUsed(BufferControl* bcb)
 	while ((bdb = reversed) != NULL)
 	{
 		reversed = bdb->bdb_lru_chain;
-		QUE_DELETE(bdb->bdb_in_use);
-		QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
+
+		// With LRU policy the chain consists of recently used buffers, with CLOCK
+		// and 2Q - of the buffers assigned to new pages while bcb_syncLRU was busy
+
+		if (bcb->bcb_policy == BUFFER_POLICY_LRU)
+		{
+			QUE_DELETE(bdb->bdb_in_use);
+			QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
+		}
+		else
+			insertAssigned(bcb, bdb);
 
 		bdb->bdb_lru_chain = NULL;
 		bdb->bdb_flags &= ~BDB_lru_chained;
@@ -5167,6 +5656,175 @@ void requeueRecentlyUsed(BufferControl* bcb)
 }
 
 
+void bufferHit(BufferDesc* bdb)
+{
+	// Page is found in the cache
+
+	BufferControl* bcb = bdb->bdb_bcb;
+
+	if (bcb->bcb_policy == BUFFER_POLICY_LRU)
+	{
+		recentlyUsed(bdb);
+		return;
+	}
+
+	// CLOCK and 2Q don't touch LRU ques here, races between concurrent
+	// increments are not important as the counter is just a hint
+
+	const UCHAR usage = bdb->bdb_usage.load(std::memory_order_relaxed);
+	if (usage < MAX_BUFFER_USAGE)
+		bdb->bdb_usage.store(usage + 1, std::memory_order_relaxed);
+}
+
+
+void bufferAssigned(BufferControl* bcb, BufferDesc* bdb)
+{
+	// Buffer is assigned to the new page, put it into the head of the proper que.
+	// If LRU que is busy, buffer is chained and put there by requeueRecentlyUsed().
+
+	bcb->bcb_misses.fetch_add(1, std::memory_order_relaxed);
+
+	if (bcb->bcb_policy != BUFFER_POLICY_LRU)
+		bdb->bdb_usage.store(0, std::memory_order_relaxed);
+
+	if (bdb->bdb_flags & BDB_lru_chained)
+		return;
+
+	Sync syncLRU(&bcb->bcb_syncLRU, FB_FUNCTION);
+	if (!syncLRU.lockConditional(SYNC_EXCLUSIVE))
+	{
+		recentlyUsed(bdb);
+		return;
+	}
+
+	if (bcb->bcb_policy == BUFFER_POLICY_LRU)
+	{
+		QUE_DELETE(bdb->bdb_in_use);
+		QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
+	}
+	else
+		insertAssigned(bcb, bdb);
+}
+
+
+void insertAssigned(BufferControl* bcb, BufferDesc* bdb)
+{
+	// Caller must hold bcb_syncLRU exclusively.
+	// Page read once goes into the probation que, unless it was evicted
+	// from there recently, i.e. it's not a one-time access.
+
+	unlinkBuffer(bcb, bdb);
+
+	if (bcb->bcb_policy == BUFFER_POLICY_2Q && !removeGhost(bcb, bdb->bdb_page))
+	{
+		QUE_INSERT(bcb->bcb_probation, bdb->bdb_in_use);
+		bdb->bdb_probation = true;
+		bcb->bcb_probation_count++;
+	}
+	else
+		QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
+}
+
+
+void releaseToTail(BufferControl* bcb, BufferDesc* bdb)
+{
+	// Make buffer the first candidate for reuse
+
+	Sync lruSync(&bcb->bcb_syncLRU, FB_FUNCTION);
+	lruSync.lock(SYNC_EXCLUSIVE);
+
+	if (bdb->bdb_flags & BDB_lru_chained)
+		requeueRecentlyUsed(bcb);
+
+	unlinkBuffer(bcb, bdb);
+	bdb->bdb_usage.store(0, std::memory_order_relaxed);
+
+	if (bcb->bcb_policy == BUFFER_POLICY_2Q)
+	{
+		QUE_APPEND(bcb->bcb_probation, bdb->bdb_in_use);
+		bdb->bdb_probation = true;
+		bcb->bcb_probation_count++;
+	}
+	else
+		QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
+}
+
+
+void setupPolicy(BufferControl* bcb)
+{
+	// Adjust policy parameters to the cache size. Probation que should take
+	// 1/4 of the cache and about 1/2 of cache size pages should be remembered
+	// after eviction from it.
+
+	if (bcb->bcb_policy != BUFFER_POLICY_2Q)
+		return;
+
+	bcb->bcb_probation_limit = bcb->bcb_count / 4;
+
+	FB_SIZE_T ghosts = 64;
+	while (ghosts < bcb->bcb_count / 2)
+		ghosts <<= 1;
+
+	if (ghosts > bcb->bcb_ghosts.getCount())
+	{
+		// It's just a hint, no need to preserve old entries
+		bcb->bcb_ghosts.clear();
+		bcb->bcb_ghosts.grow(ghosts);
+	}
+}
+
+
+void getLruQues(BufferControl* bcb, que* ques[2])
+{
+	// Ques in the order they should be looked for a buffer to reuse.
+	// Probation que is always empty if the policy is not 2Q.
+
+	if (bcb->bcb_probation_count > bcb->bcb_probation_limit)
+	{
+		ques[0] = &bcb->bcb_probation;
+		ques[1] = &bcb->bcb_in_use;
+	}
+	else
+	{
+		ques[0] = &bcb->bcb_in_use;
+		ques[1] = &bcb->bcb_probation;
+	}
+}
+
+
+static inline FB_UINT64* getGhost(BufferControl* bcb, const PageNumber& page, FB_UINT64& key)
+{
+	fb_assert(bcb->bcb_ghosts.hasData());
+
+	key = ((FB_UINT64) page.getPageSpaceID() << 32) | page.getPageNum();
+	fb_assert(key);
+
+	// Fibonacci hashing, table size is a power of 2
+	const FB_SIZE_T mask = bcb->bcb_ghosts.getCount() - 1;
+	return &bcb->bcb_ghosts[(FB_SIZE_T) ((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask];
+}
+
+
+void addGhost(BufferControl* bcb, const PageNumber& page)
+{
+	FB_UINT64 key;
+	*getGhost(bcb, page, key) = key;
+}
+
+
+bool removeGhost(BufferControl* bcb, const PageNumber& page)
+{
+	FB_UINT64 key;
+	FB_UINT64* const ghost = getGhost(bcb, page, key);
+
+	if (*ghost != key)
+		return false;
+
+	*ghost = 0;
+	return true;
+}
+
+
 BufferControl* BufferControl::create(Database* dbb)
 {
 	MemoryPool* const pool = dbb->createPool(false);
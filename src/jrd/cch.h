@@ -73,6 +73,17 @@ inline constexpr ULONG MAX_PAGE_BUFFERS = 131072;
 inline constexpr ULONG MAX_PAGE_BUFFERS = MAX_SLONG - 1;
 #endif
 
+// Page buffer replacement policies, see BufferPolicy in firebird.conf
+
+enum BufferPolicy : UCHAR
+{
+	BUFFER_POLICY_LRU = 0,	// every page access moves the buffer to the head of LRU que
+	BUFFER_POLICY_CLOCK,	// buffers with non-zero usage counter get second chance
+	BUFFER_POLICY_2Q		// as CLOCK, but new pages are put into the probation que
+};
+
+inline constexpr UCHAR MAX_BUFFER_USAGE = 3;	// max value of usage counter for CLOCK and 2Q
+
 // BufferControl -- Buffer control block -- one per system
 
 class BufferControl : public pool_alloc<type_bcb>
@@ -81,11 +92,13 @@ class BufferControl : public pool_alloc<type_bcb>
 		: bcb_bufferpool(&p),
 		  bcb_memory_stats(&parentStats),
 		  bcb_memory(p),
+		  bcb_ghosts(p),
 		  bcb_writer_fini(p, cache_writer, THREAD_medium),
 		  bcb_bdbBlocks(p)
 	{
 		bcb_database = NULL;
 		QUE_INIT(bcb_in_use);
+		QUE_INIT(bcb_probation);
 		QUE_INIT(bcb_pending);
 		QUE_INIT(bcb_empty);
 		QUE_INIT(bcb_dirty);
@@ -98,6 +111,11 @@ class BufferControl : public pool_alloc<type_bcb>
 		bcb_prec_walk_mark = 0;
 		bcb_page_size = 0;
 		bcb_page_incarnation = 0;
+		bcb_io_batch = 0;
+		bcb_policy = BUFFER_POLICY_LRU;
+		bcb_probation_count = 0;
+		bcb_probation_limit = 0;
+		bcb_misses = 0;
 		bcb_hashTable = nullptr;
 #ifdef SUPERSERVER_V2
 		bcb_prefetch = NULL;
@@ -116,6 +134,7 @@ public:
 
 	UCharStack	bcb_memory;			// Large block partitioned into buffers
 	que			bcb_in_use;			// Que of buffers in use, main LRU que
+	que			bcb_probation;		// Que of buffers with pages read once, 2Q policy only
 	que			bcb_pending;		// Que of buffers which are going to be freed and reassigned
 	que			bcb_empty;			// Que of empty buffers
 
@@ -135,6 +154,19 @@ public:
 	ULONG		bcb_prec_walk_mark;	// mark value used in precedence graph walk
 	ULONG		bcb_page_size;		// Database page size in bytes
 	ULONG		bcb_page_incarnation;	// Cache page incarnation counter
+	ULONG		bcb_io_batch;		// Max number of pages in batched IO, 0 if disabled
+
+	BufferPolicy	bcb_policy;			// Buffer replacement policy
+	ULONG		bcb_probation_count;	// Number of buffers in probation que
+	ULONG		bcb_probation_limit;	// Target size of probation que
+
+	// Pages recently evicted from the probation que, 2Q policy only. It's a lossy
+	// hash table: new entry just replaces the old one with the same hash value.
+	Firebird::Array<FB_UINT64>	bcb_ghosts;
+
+	// Number of pages put into cache. Cache hits are not counted here, they are
+	// page fetches (counted per attachment) minus misses, see Monitoring::putDatabase()
+	std::atomic<FB_UINT64>	bcb_misses;
 
 	Firebird::SyncObject	bcb_syncObject;
 	Firebird::SyncObject	bcb_syncDirtyBdbs;
@@ -213,6 +245,8 @@ public:
 		bdb_scan_count = 0;
 		bdb_difference_page = 0;
 		bdb_prec_walk_mark = 0;
+		bdb_usage = 0;
+		bdb_probation = false;
 	}
 
 	bool addRef(thread_db* tdbb, Firebird::SyncType syncType, int wait = 1);
@@ -267,6 +301,8 @@ public:
 	Firebird::AtomicCounter	bdb_scan_count;		// concurrent sequential scans
 	ULONG       bdb_difference_page;			// Number of page in difference file, NBAK
 	ULONG		bdb_prec_walk_mark;				// mark value used in precedence graph walk
+	std::atomic<UCHAR>	bdb_usage;				// usage counter, CLOCK and 2Q policies
+	bool		bdb_probation;					// buffer is in probation que, guarded by bcb_syncLRU
 };
 
 // bdb_flags
@@ -70,6 +70,7 @@ void	DPM_fetch_fragment(Jrd::thread_db*, Jrd::record_param*, USHORT);
 SINT64	DPM_gen_id(Jrd::thread_db*, SLONG, bool, SINT64);
 bool	DPM_get(Jrd::thread_db*, Jrd::record_param*, SSHORT);
 ULONG	DPM_get_blob(Jrd::thread_db*, Jrd::blb*, Jrd::jrd_rel*, RecordNumber, bool, ULONG);
+bool	DPM_is_all_visible(Jrd::thread_db*, Jrd::record_param*);
 void	DPM_mark_relation(Jrd::thread_db*, Jrd::Cached::Relation*);
 bool	DPM_next(Jrd::thread_db*, Jrd::record_param*, USHORT, Jrd::FindNextRecordScope);
 void	DPM_pages(Jrd::thread_db*, SSHORT, int, ULONG, ULONG);
@@ -30,8 +30,18 @@
 
 #include "../common/classes/alloc.h"
 #include "../common/classes/array.h"
+#include <algorithm>
+#include <bit>
 #include <type_traits>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define EVL_SEARCH_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define EVL_SEARCH_SSE2
+#endif
+
 // Number of pattern items statically allocated
 inline constexpr int STATIC_PATTERN_ITEMS	= 16;
 
@@ -72,6 +82,120 @@ static void preKmp(const CharType *x, int m, SLONG kmpNext[]) noexcept(std::is_s
 	kmpNext[++i] = ++j;
 }
 
+// Vectorized filter of the substring search: selects the positions of the data
+// block where both the first and the last characters of the string are found
+#if defined(EVL_SEARCH_AVX2)
+class SearchFilter
+{
+public:
+	static constexpr SLONG BLOCK_SIZE = 32;
+
+	SearchFilter(UCHAR first, UCHAR last) noexcept
+		: firstMask(_mm256_set1_epi8(static_cast<char>(first))),
+		  lastMask(_mm256_set1_epi8(static_cast<char>(last)))
+	{
+	}
+
+	ULONG match(const UCHAR* block, SLONG lastOffset) const noexcept
+	{
+		const __m256i firstBlock = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+		const __m256i lastBlock = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + lastOffset));
+
+		return static_cast<ULONG>(_mm256_movemask_epi8(_mm256_and_si256(
+			_mm256_cmpeq_epi8(firstBlock, firstMask), _mm256_cmpeq_epi8(lastBlock, lastMask))));
+	}
+
+private:
+	const __m256i firstMask;
+	const __m256i lastMask;
+};
+#elif defined(EVL_SEARCH_SSE2)
+class SearchFilter
+{
+public:
+	static constexpr SLONG BLOCK_SIZE = 16;
+
+	SearchFilter(UCHAR first, UCHAR last) noexcept
+		: firstMask(_mm_set1_epi8(static_cast<char>(first))),
+		  lastMask(_mm_set1_epi8(static_cast<char>(last)))
+	{
+	}
+
+	ULONG match(const UCHAR* block, SLONG lastOffset) const noexcept
+	{
+		const __m128i firstBlock = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+		const __m128i lastBlock = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + lastOffset));
+
+		return static_cast<ULONG>(_mm_movemask_epi8(_mm_and_si128(
+			_mm_cmpeq_epi8(firstBlock, firstMask), _mm_cmpeq_epi8(lastBlock, lastMask))));
+	}
+
+private:
+	const __m128i firstMask;
+	const __m128i lastMask;
+};
+#endif
+
+// Returns position of the first character c in the data or data_len if not found
+template <typename CharType>
+inline SLONG findChar(const CharType* data, SLONG data_len, CharType c) noexcept
+{
+	if constexpr (sizeof(CharType) == 1)
+	{
+		const void* const found = memchr(data, c, data_len);
+		return found ? static_cast<const CharType*>(found) - data : data_len;
+	}
+	else
+		return std::find(data, data + data_len, c) - data;
+}
+
+// Returns position of the first occurrence of the string in the data or -1 if not found
+inline SLONG findString(const UCHAR* data, SLONG data_len, const UCHAR* str, SLONG str_len) noexcept
+{
+	if (str_len > data_len)
+		return -1;
+
+	if (str_len <= 1)
+	{
+		const SLONG pos = str_len ? findChar(data, data_len, *str) : 0;
+		return pos < data_len ? pos : -1;
+	}
+
+	const SLONG lastOffset = str_len - 1;
+	SLONG pos = 0;
+
+#if defined(EVL_SEARCH_AVX2) || defined(EVL_SEARCH_SSE2)
+	const SearchFilter filter(str[0], str[lastOffset]);
+
+	for (; pos + lastOffset + SearchFilter::BLOCK_SIZE <= data_len; pos += SearchFilter::BLOCK_SIZE)
+	{
+		for (ULONG mask = filter.match(data + pos, lastOffset); mask; mask &= mask - 1)
+		{
+			const SLONG candidate = pos + std::countr_zero(mask);
+			if (memcmp(data + candidate + 1, str + 1, str_len - 2) == 0)
+				return candidate;
+		}
+	}
+#endif
+
+	// Rest of the data, or all of it if not vectorized
+	const SLONG end = data_len - lastOffset;
+
+	while (pos < end)
+	{
+		pos += findChar(data + pos, end - pos, str[0]);
+		if (pos >= end)
+			break;
+
+		if (memcmp(data + pos + 1, str + 1, lastOffset) == 0)
+			return pos;
+
+		pos++;
+	}
+
+	return -1;
+}
+
 class StaticAllocator
 {
 public:
@@ -192,7 +316,15 @@ public:
 		if (result)
 			return false;
 
-		SLONG data_pos = 0;
+		if constexpr (sizeof(CharType) == 1)
+			return processBytes(data, data_len);
+		else
+			return processKmp(data, 0, data_len);
+	}
+
+private:
+	bool processKmp(const CharType* data, SLONG data_pos, SLONG data_len) noexcept(std::is_scalar_v<CharType>)
+	{
 		while (data_pos < data_len)
 		{
 			while (offset > -1 && pattern_str[offset] != data[data_pos])
@@ -207,7 +339,34 @@ public:
 		return true;
 	}
 
-private:
+	bool processBytes(const CharType* data, SLONG data_len) noexcept
+	{
+		// Finish the match started in the previous chunk by KMP
+		SLONG data_pos = 0;
+		while (offset > 0 && data_pos < data_len)
+		{
+			if (!processKmp(data, data_pos, data_pos + 1))
+				return false;
+			data_pos++;
+		}
+
+		if (data_pos >= data_len)
+			return true;
+
+		// Search the rest of the chunk by the vectorized search
+		if (findString(reinterpret_cast<const UCHAR*>(data + data_pos), data_len - data_pos,
+				reinterpret_cast<const UCHAR*>(pattern_str), pattern_len) >= 0)
+		{
+			result = true;
+			return false;
+		}
+
+		// Not found, so the tail shorter than the pattern defines the KMP state for the next chunk
+		offset = 0;
+		return processKmp(data, MAX(data_pos, data_len - pattern_len + 1), data_len);
+	}
+
+
 	const CharType* pattern_str;
 	SLONG pattern_len;
 	SLONG offset;
@@ -501,6 +660,15 @@ bool LikeEvaluator<CharType>::processNextChunk(const CharType* data, SLONG data_
 
 	while (data_pos < data_len)
 	{
+		// Single branch not matched any character of the searched string yet,
+		// skip the data not containing its first character
+		if (branches.getCount() == 1 && branches[0].pattern->type == piSearch && branches[0].offset == 0)
+		{
+			data_pos += findChar(data + data_pos, data_len - data_pos, branches[0].pattern->str.data[0]);
+			if (data_pos >= data_len)
+				break;
+		}
+
 		FB_SIZE_T branch_number = 0;
 		while (branch_number < branches.getCount())
 		{
@@ -524,6 +524,13 @@ static inline constexpr struct ini_idx_t indices[] =
 		SEGMENT(f_pubtab_tab_schema, idx_metadata),	// table schema name
 		SEGMENT(f_pubtab_tab_name, idx_metadata),	// table name
 		SEGMENT(f_pubtab_pub_name, idx_metadata)	// publication name
+	}},
+	// define index RDB$INDEX_98 for RDB$COLUMN_STATISTICS unique RDB$SCHEMA_NAME,
+	// RDB$RELATION_NAME, RDB$FIELD_NAME;
+	INDEX(98, rel_column_stats, idx_unique, 3, ODS_14_1)
+		SEGMENT(f_cst_schema, idx_metadata),	// schema name
+		SEGMENT(f_cst_rname, idx_metadata),		// relation name
+		SEGMENT(f_cst_fname, idx_metadata)		// field name
 	}}
 };
 
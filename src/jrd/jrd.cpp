@@ -135,6 +135,7 @@
 #include "../jrd/CryptoManager.h"
 #include "../jrd/DbCreators.h"
 #include "../jrd/met.h"
+#include "../jrd/SharedStatementCache.h"
 
 #include "../dsql/dsql.h"
 #include "../dsql/dsql_proto.h"
@@ -1828,6 +1829,10 @@ JAttachment* JProvider::internalAttach(CheckStatusWrapper* user_status, const ch
 
 				PAG_init2(tdbb);
 				PAG_header(tdbb, false, newForceWrite);
+
+				if (dbb->dbb_config->getDataPageCompression())
+					PAG_set_page_compression(tdbb);
+
 				dbb->dbb_page_manager.initTempPageSpace(tdbb);
 				dbb->dbb_crypto_manager->attach(tdbb, attachment);
 
@@ -3128,6 +3133,9 @@ JAttachment* JProvider::createDatabase(CheckStatusWrapper* user_status, const ch
 			if (options.dpb_set_no_reserve)
 				PAG_set_no_reserve(tdbb, options.dpb_no_reserve);
 
+			if (dbb->dbb_config->getDataPageCompression())
+				PAG_set_page_compression(tdbb);
+
 			fb_assert(attachment->att_user);	// set by UserId::sclInit()
 			INI_format(tdbb, options.dpb_set_db_charset);
 
@@ -7852,7 +7860,12 @@ void release_attachment(thread_db* tdbb, Jrd::Attachment* attachment, XThreadEns
 	{
 		auto* req = attachment->att_requests.back();
 		req->setUnused();
-		CMP_release(tdbb, req);
+
+		// Shared statements may be used by other attachments
+		if (dbb->dbb_shared_statements->isCached(req->getStatement()))
+			EXE_release(tdbb, req);
+		else
+			CMP_release(tdbb, req);
 	}
 
 	attachment->releaseLocks(tdbb);
@@ -8161,6 +8174,8 @@ bool JRD_shutdown_database(Database* dbb, const unsigned flags)
 	// Release the system requests
 	dbb->releaseSystemRequests(tdbb);
 
+	dbb->dbb_shared_statements->shutdown(tdbb);
+
 	CCH_shutdown(tdbb);
 
 	dbb->dbb_mdc->releaseLocks(tdbb);
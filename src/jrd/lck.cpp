@@ -580,6 +580,7 @@ static lck_owner_t get_owner_type(enum lck_t lock_type)
 	case LCK_repl_state:
 	case LCK_rel_gc:
 	case LCK_rel_partners:
+	case LCK_rel_stats:
 	case LCK_rel_rescan:
 	case LCK_idx_rescan:
 	case LCK_prc_rescan:
@@ -77,7 +77,8 @@ enum lck_t : UCHAR {
 	LCK_dsql_statement_cache,	// DSQL statement cache lock
 	LCK_profiler_listener,		// Remote profiler listener
 	LCK_dbwide_triggers,		// Database wide triggers rescan lock
-	LCK_idx_create				// Taken during index build process
+	LCK_idx_create,				// Taken during index build process
+	LCK_rel_stats				// Relation column statistics lock
 };
 
 // Lock owner types
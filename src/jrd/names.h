@@ -505,3 +505,22 @@ NAME("MON$FIELD_PRECISION", nam_mon_f_precision)
 NAME("MON$FIELD_SUB_TYPE", nam_mon_f_sub_type)
 NAME("MON$CHAR_LENGTH", nam_mon_char_length)
 NAME("MON$COLLATION_ID", nam_mon_collate_id)
+
+NAME("RDB$COLUMN_STATISTICS", nam_column_stats)
+NAME("RDB$NULL_FRACTION", nam_null_fraction)
+NAME("RDB$DISTINCT_COUNT", nam_distinct_count)
+NAME("RDB$SAMPLE_SIZE", nam_sample_size)
+NAME("RDB$HISTOGRAM", nam_histogram)
+
+NAME("MON$BUFFER_POLICY", nam_mon_buffer_policy)
+NAME("MON$BUFFER_HITS", nam_mon_buffer_hits)
+NAME("MON$BUFFER_MISSES", nam_mon_buffer_misses)
+NAME("MON$COMPRESSED_PAGES", nam_mon_compressed_pages)
+NAME("MON$COMPRESSED_SIZE", nam_mon_compressed_size)
+NAME("MON$DECOMPRESSED_PAGES", nam_mon_decompressed_pages)
+NAME("MON$COMPRESSION_TIME", nam_mon_compression_time)
+
+NAME("MON$GC_QUEUE", nam_mon_gc_queue)
+NAME("MON$PENDING_PAGES", nam_mon_gc_pending_pages)
+NAME("MON$PROCESSED_PAGES", nam_mon_gc_processed_pages)
+NAME("MON$PROCESSING_TIME", nam_mon_gc_processing_time)
@@ -23,9 +23,75 @@
 #include "firebird.h"
 #include "../jrd/ods.h"
 #include "../jrd/ods_proto.h"
+#include "../common/classes/init.h"
+#include "../common/classes/zip.h"
 
 using namespace Firebird;
 
+#ifdef HAVE_ZLIB_H
+namespace
+{
+	InitInstance<ZLib> zlib;
+
+	// Initialization of zlib stream allocates a lot of memory,
+	// therefore every thread reuses its own streams for all pages.
+
+	class PageStreams
+	{
+	public:
+		~PageStreams()
+		{
+			if (deflateReady)
+				zlib().deflateEnd(&deflater);
+
+			if (inflateReady)
+				zlib().inflateEnd(&inflater);
+		}
+
+		z_stream* getDeflater()
+		{
+			if (deflateReady)
+				return (zlib().deflateReset(&deflater) == Z_OK) ? &deflater : nullptr;
+
+			prepare(deflater);
+			if (zlib().deflateInit(&deflater, Z_BEST_SPEED) != Z_OK)
+				return nullptr;
+
+			deflateReady = true;
+			return &deflater;
+		}
+
+		z_stream* getInflater()
+		{
+			if (inflateReady)
+				return (zlib().inflateReset(&inflater) == Z_OK) ? &inflater : nullptr;
+
+			prepare(inflater);
+			if (zlib().inflateInit(&inflater) != Z_OK)
+				return nullptr;
+
+			inflateReady = true;
+			return &inflater;
+		}
+
+	private:
+		static void prepare(z_stream& strm)
+		{
+			memset(&strm, 0, sizeof(z_stream));
+			strm.zalloc = ZLib::allocFunc;
+			strm.zfree = ZLib::freeFunc;
+		}
+
+		z_stream deflater;
+		z_stream inflater;
+		bool deflateReady = false;
+		bool inflateReady = false;
+	};
+
+	thread_local PageStreams pageStreams;
+}
+#endif // HAVE_ZLIB_H
+
 namespace Ods {
 
 bool isSupported(const header_page* hdr) noexcept
@@ -154,6 +220,84 @@ Firebird::string pagtype(UCHAR type)
 	return rc;
 }
 
+ULONG compressPage(const pag* page, pag* image, ULONG page_size)
+{
+	fb_assert(page->pag_type == pag_data);
+
+#ifdef HAVE_ZLIB_H
+	// Compressed image is worth writing only if it saves at least one IO block
+
+	const ULONG headerSize = offsetof(compressed_data_page, cdp_data);
+	if (page_size < 2 * DIRECT_IO_BLOCK_SIZE || !zlib())
+		return 0;
+
+	z_stream* const strm = pageStreams.getDeflater();
+	if (!strm)
+		return 0;
+
+	const ULONG maxLength = page_size - DIRECT_IO_BLOCK_SIZE - headerSize;
+	compressed_data_page* const cdp = reinterpret_cast<compressed_data_page*>(image);
+
+	strm->next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(page + 1));
+	strm->avail_in = page_size - sizeof(pag);
+	strm->next_out = cdp->cdp_data;
+	strm->avail_out = maxLength;
+
+	if (zlib().deflate(strm, Z_FINISH) != Z_STREAM_END)
+		return 0;
+
+	const ULONG length = strm->total_out;
+	fb_assert(length <= maxLength);
+
+	cdp->cdp_header = *page;
+	cdp->cdp_header.pag_flags |= dpg_compressed;
+	cdp->cdp_length = static_cast<USHORT>(length);
+
+	// Tail of the image is not used, make it zero rather than a garbage
+	memset(cdp->cdp_data + length, 0, page_size - headerSize - length);
+
+	return headerSize + length;
+#else
+	return 0;
+#endif
+}
+
+bool decompressPage(pag* page, ULONG page_size)
+{
+	fb_assert(page->pag_type == pag_data && (page->pag_flags & dpg_compressed));
+
+#ifdef HAVE_ZLIB_H
+	const ULONG headerSize = offsetof(compressed_data_page, cdp_data);
+	const compressed_data_page* const cdp = reinterpret_cast<compressed_data_page*>(page);
+	const ULONG length = cdp->cdp_length;
+
+	if (length > page_size - headerSize || !zlib())
+		return false;
+
+	z_stream* const strm = pageStreams.getInflater();
+	if (!strm)
+		return false;
+
+	// Page contents overlap the image, so inflate from the copy of compressed data
+
+	UCHAR data[MAX_PAGE_SIZE];
+	memcpy(data, cdp->cdp_data, length);
+
+	strm->next_in = data;
+	strm->avail_in = length;
+	strm->next_out = reinterpret_cast<Bytef*>(page + 1);
+	strm->avail_out = page_size - sizeof(pag);
+
+	if (zlib().inflate(strm, Z_FINISH) != Z_STREAM_END || strm->avail_out)
+		return false;
+
+	page->pag_flags &= ~dpg_compressed;
+	return true;
+#else
+	return false;
+#endif
+}
+
 TraNumber getTraNum(const void* ptr) noexcept
 {
 	const rhd* const record = (rhd*) ptr;
@@ -133,7 +133,9 @@ inline constexpr USHORT ODS_CURRENT13	= 1;
 // Minor versions for ODS 14
 
 inline constexpr USHORT ODS_CURRENT14_0	= 0;	// Firebird 6.0 features
-inline constexpr USHORT ODS_CURRENT14	= 0;
+inline constexpr USHORT ODS_CURRENT14_1	= 1;	// Compressed and all-visible data pages, column statistics,
+												// new monitoring tables and fields
+inline constexpr USHORT ODS_CURRENT14	= 1;
 
 // useful ODS macros. These are currently used to flag the version of the
 // system triggers and system indices in ini.e
@@ -156,6 +158,7 @@ inline constexpr USHORT ODS_12_0	= ENCODE_ODS(ODS_VERSION12, 0);
 inline constexpr USHORT ODS_13_0	= ENCODE_ODS(ODS_VERSION13, 0);
 inline constexpr USHORT ODS_13_1	= ENCODE_ODS(ODS_VERSION13, 1);
 inline constexpr USHORT ODS_14_0	= ENCODE_ODS(ODS_VERSION14, 0);
+inline constexpr USHORT ODS_14_1	= ENCODE_ODS(ODS_VERSION14, 1);
 
 inline constexpr USHORT ODS_FIREBIRD_FLAG = 0x8000;
 
@@ -183,7 +186,7 @@ inline constexpr USHORT ODS_RELEASED = ODS_CURRENT14_0;		// The lowest stable mi
 inline constexpr USHORT ODS_CURRENT = ODS_CURRENT14;		// The highest defined minor version
 															// number for this ODS_VERSION!
 
-inline constexpr USHORT ODS_CURRENT_VERSION = ODS_14_0;		// Current ODS version in use which includes
+inline constexpr USHORT ODS_CURRENT_VERSION = ODS_14_1;		// Current ODS version in use which includes
 															// both major and minor ODS versions!
 
 
@@ -369,6 +372,23 @@ inline constexpr UCHAR dpg_large		= 0x04;		// Large object is on page
 inline constexpr UCHAR dpg_swept		= 0x08;		// Sweep has nothing to do on this page
 inline constexpr UCHAR dpg_secondary	= 0x10;		// Primary record versions not stored on this page
 													// Set in dpm.epp's extend_relation() but never tested.
+inline constexpr UCHAR dpg_all_visible	= 0x20;		// All records are primary versions visible to everybody
+inline constexpr UCHAR dpg_compressed	= 0x40;		// Page on disk is compressed (in memory cache it always isn't)
+
+
+// Compressed image of the data page, exists on disk only
+
+struct compressed_data_page
+{
+	pag cdp_header;
+	USHORT cdp_length;				// length of compressed page contents
+	UCHAR cdp_data[2];				// page contents following the header, deflated
+};
+
+static_assert(sizeof(struct compressed_data_page) == 20, "struct compressed_data_page size mismatch");
+static_assert(offsetof(struct compressed_data_page, cdp_header) == 0, "cdp_header offset mismatch");
+static_assert(offsetof(struct compressed_data_page, cdp_length) == 16, "cdp_length offset mismatch");
+static_assert(offsetof(struct compressed_data_page, cdp_data) == 18, "cdp_data offset mismatch");
 
 
 // Index root page
@@ -727,6 +747,7 @@ inline constexpr USHORT hdr_no_reserve			= 0x8;		// 8	don't reserve space for ve
 inline constexpr USHORT hdr_SQL_dialect_3		= 0x10;		// 16	database SQL dialect 3
 inline constexpr USHORT hdr_read_only			= 0x20;		// 32	Database is ReadOnly. If not set, DB is RW
 inline constexpr USHORT hdr_encrypted			= 0x40;		// 64	Database is encrypted
+inline constexpr USHORT hdr_compressed_pages	= 0x80;		// 128	Data pages may be compressed, requires ODS 14.1
 
 // Values for backup mode
 inline constexpr UCHAR hdr_nbak_normal			= 0;			// Normal mode. Changes are simply written to main files
@@ -845,6 +866,7 @@ inline constexpr UCHAR ppg_dp_large			= 0x02;		// Large object is on data page
 inline constexpr UCHAR ppg_dp_swept			= 0x04;		// Sweep has nothing to do on data page
 inline constexpr UCHAR ppg_dp_secondary		= 0x08;		// Primary record versions not stored on data page
 inline constexpr UCHAR ppg_dp_empty			= 0x10;		// Data page is empty
+inline constexpr UCHAR ppg_dp_all_visible	= 0x20;		// All records on data page are visible to everybody
 
 inline constexpr UCHAR PPG_DP_ALL_BITS	= (1 << PPG_DP_BITS_NUM) - 1;
 
@@ -39,6 +39,12 @@ namespace Ods {
 	ULONG maxRecsPerDP(ULONG page_size) noexcept;
 	ULONG maxIndices(ULONG page_size) noexcept;
 
+	// Data page compression, see compressed_data_page.
+	// compressPage() returns the length of compressed image or zero
+	// if the page can't be compressed or compression isn't worth it.
+	ULONG compressPage(const pag* page, pag* image, ULONG page_size);
+	bool decompressPage(pag* page, ULONG page_size);
+
 	TraNumber getTraNum(const void* ptr) noexcept;
 	void writeTraNum(void* ptr, TraNumber number, FB_SIZE_T header_size) noexcept;
 
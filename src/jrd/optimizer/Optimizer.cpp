@@ -53,6 +53,7 @@
 #include "../jrd/met.h"
 #include "../jrd/intl.h"
 #include "../jrd/Collation.h"
+#include "../jrd/ColumnStatistics.h"
 #include "../common/gdsassert.h"
 #include "../jrd/btr_proto.h"
 #include "../jrd/cch_proto.h"
@@ -594,7 +595,8 @@ Optimizer::Optimizer(thread_db* aTdbb, CompilerScratch* aCsb, RseNode* aRse,
 	  bedStreams(getPool()),
 	  keyStreams(getPool()),
 	  outerStreams(getPool()),
-	  conjuncts(getPool())
+	  conjuncts(getPool()),
+	  tableStatistics(getPool())
 {
     // Ignore optimization for first rows in impossible cases
 	if (firstRows)
@@ -625,7 +627,8 @@ Optimizer::Optimizer(thread_db* aTdbb, CompilerScratch* aCsb, RseNode* aRse,
 	  bedStreams(getPool()),
 	  keyStreams(getPool()),
 	  outerStreams(getPool()),
-	  conjuncts(getPool())
+	  conjuncts(getPool()),
+	  tableStatistics(getPool())
 {
 	for (BoolExprNodeStack::const_iterator iter(stack); iter.hasData(); ++iter)
 	{
@@ -661,6 +664,9 @@ Optimizer::~Optimizer()
 		csb->csb_rpt[compileStream].csb_idx = nullptr;
 	}
 
+	for (const auto statistics : tableStatistics)
+		statistics->release();
+
 	if (debugFile)
 		fclose(debugFile);
 }
@@ -1153,7 +1159,26 @@ RecordSource* Optimizer::compile(BoolExprNodeStack* parentStack)
 
 		// Handle sort clause if present
 		if (sort)
-			rsb = generateSort(bedStreams, &keyStreams, rsb, sort, favorFirstRows(), false);
+		{
+			const auto sortRsb = generateSort(bedStreams, &keyStreams, rsb, sort, favorFirstRows(), false);
+
+			// If only the first rows are requested, the sort may keep just them.
+			// The limit is evaluated twice, so it must be free from side effects.
+
+			const auto isInvariantValue = [](const ValueExprNode* node)
+			{
+				return nodeIs<LiteralNode>(node) || nodeIs<ParameterNode>(node) ||
+					nodeIs<VariableNode>(node);
+			};
+
+			if (rse->rse_first && isInvariantValue(rse->rse_first) &&
+				(!rse->rse_skip || isInvariantValue(rse->rse_skip)))
+			{
+				sortRsb->setLimit(rse->rse_first, rse->rse_skip);
+			}
+
+			rsb = sortRsb;
+		}
 	}
 
 	// Add invariant booleans, if any. They should be evaluated before
@@ -1235,6 +1260,361 @@ double Optimizer::getDependentSelectivity()
 }
 
 
+//
+// Estimate selectivity of a single boolean. Column statistics are preferred if available,
+// otherwise hardcoded reduction factors are used.
+//
+
+double Optimizer::getSelectivity(const BoolExprNode* node) const
+{
+	auto factor = REDUCE_SELECTIVITY_FACTOR_OTHER;
+
+	if (const auto columnSelectivity = getColumnSelectivity(node))
+	{
+		factor = columnSelectivity.value();
+	}
+	else if (const auto notNode = nodeAs<NotBoolNode>(node))
+	{
+		factor = MAXIMUM_SELECTIVITY - getSelectivity(notNode->arg);
+	}
+	else if (const auto binaryNode = nodeAs<BinaryBoolNode>(node))
+	{
+		const auto selectivity1 = getSelectivity(binaryNode->arg1);
+		const auto selectivity2 = getSelectivity(binaryNode->arg2);
+
+		if (binaryNode->blrOp == blr_and)
+			factor = selectivity1 * selectivity2;
+		else if (binaryNode->blrOp == blr_or)
+			factor = selectivity1 + selectivity2 - selectivity1 * selectivity2;
+		else
+			fb_assert(false);
+	}
+	else if (const auto listNode = nodeAs<InListBoolNode>(node))
+	{
+		factor = REDUCE_SELECTIVITY_FACTOR_EQUALITY * listNode->list->items.getCount();
+	}
+	else if (nodeIs<MissingBoolNode>(node))
+	{
+		factor = REDUCE_SELECTIVITY_FACTOR_EQUALITY;
+	}
+	else if (const auto cmpNode = nodeAs<ComparativeBoolNode>(node))
+	{
+		switch (cmpNode->blrOp)
+		{
+		case blr_eql:
+		case blr_equiv:
+			factor = REDUCE_SELECTIVITY_FACTOR_EQUALITY;
+			break;
+
+		case blr_gtr:
+		case blr_geq:
+			factor = REDUCE_SELECTIVITY_FACTOR_GREATER;
+			break;
+
+		case blr_lss:
+		case blr_leq:
+			factor = REDUCE_SELECTIVITY_FACTOR_LESS;
+			break;
+
+		case blr_between:
+			factor = REDUCE_SELECTIVITY_FACTOR_BETWEEN;
+			break;
+
+		case blr_starting:
+			factor = REDUCE_SELECTIVITY_FACTOR_STARTING;
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	if (!factor)
+		factor = DEFAULT_SELECTIVITY;
+
+	return MIN(factor, MAXIMUM_SELECTIVITY);
+}
+
+
+//
+// Find the column statistics for the given field reference, if any
+//
+
+const ColumnStatistics* Optimizer::getColumnStatistics(const ValueExprNode* node) const
+{
+	const auto fieldNode = nodeAs<FieldNode>(node);
+
+	if (!fieldNode)
+		return nullptr;
+
+	const auto tail = &csb->csb_rpt[fieldNode->fieldStream];
+
+	if (!tail->csb_relation)
+		return nullptr;
+
+	const auto permanent = tail->csb_relation();
+
+	if (permanent->isSystem() || permanent->isView() || permanent->isVirtual() ||
+		permanent->isTemporary() || permanent->getExtFile())
+	{
+		return nullptr;
+	}
+
+	const auto relation = tail->csb_relation(tdbb);
+	const auto fields = relation ? relation->rel_fields : nullptr;
+
+	if (!fields || fieldNode->fieldId >= fields->count())
+		return nullptr;
+
+	const auto field = (*fields)[fieldNode->fieldId];
+
+	if (!field)
+		return nullptr;
+
+	// Keep the statistics alive until the optimization is done
+	const auto statistics = permanent->getColumnStatistics(tdbb);
+
+	if (!tableStatistics.exist(statistics))
+	{
+		statistics->addRef();
+		tableStatistics.add(statistics);
+	}
+
+	return statistics->find(field->fld_name);
+}
+
+
+//
+// Estimate number of distinct values of the field using selectivity of an index
+// starting with it. Nothing is returned if there's no such index with statistics.
+//
+
+std::optional<double> Optimizer::getIndexDistinctCount(const ValueExprNode* node) const
+{
+	const auto fieldNode = nodeAs<FieldNode>(node);
+
+	if (!fieldNode)
+		return std::nullopt;
+
+	const auto relation = csb->csb_rpt[fieldNode->fieldStream].csb_relation;
+
+	if (!relation || relation()->isSystem() || relation()->getExtFile() || relation()->isVirtual())
+		return std::nullopt;
+
+	const auto relPages = relation()->getPages(tdbb);
+	IndexDescList idxList;
+	BTR_all(tdbb, relation(), idxList, relPages, csb->csb_g_flags & csb_internal);
+
+	float selectivity = 0;
+
+	for (const auto& idx : idxList)
+	{
+		if ((idx.idx_flags & (idx_expression | idx_condition)) ||
+			idx.idx_rpt[0].idx_field != fieldNode->fieldId ||
+			idx.idx_rpt[0].idx_selectivity <= 0)
+		{
+			continue;
+		}
+
+		const auto idv = relation()->lookup_index(tdbb, idx.idx_id, CacheFlag::AUTOCREATE);
+
+		if (!idv || idv->getActive() != MET_index_active)
+			continue;
+
+		// Indices may have been analyzed at different times, trust the most selective one
+		if (!selectivity || idx.idx_rpt[0].idx_selectivity < selectivity)
+			selectivity = idx.idx_rpt[0].idx_selectivity;
+	}
+
+	if (!selectivity)
+		return std::nullopt;
+
+	// NULL may form a group of its own
+	return 1 / selectivity + 1;
+}
+
+
+//
+// Estimate number of distinct combinations of the given values using column statistics,
+// falling back to index selectivity for the fields without them.
+// Nothing is returned unless all the values are fields with either source of estimation.
+//
+
+std::optional<double> Optimizer::getDistinctCount(const NestValueArray& values) const
+{
+	double count = 1;
+
+	for (const auto value : values)
+	{
+		const auto stats = getColumnStatistics(value);
+
+		if (stats && stats->distinctCount > 0)
+		{
+			// NULL forms a group of its own
+			count *= stats->distinctCount + (stats->nullFraction > 0 ? 1 : 0);
+			continue;
+		}
+
+		const auto indexCount = getIndexDistinctCount(value);
+
+		if (!indexCount)
+			return std::nullopt;
+
+		count *= indexCount.value();
+	}
+
+	return count;
+}
+
+
+//
+// Estimate selectivity of a simple predicate using column statistics.
+// Nothing is returned if the predicate cannot be evaluated this way.
+//
+
+std::optional<double> Optimizer::getColumnSelectivity(const BoolExprNode* node) const
+{
+	static const dsc nullDesc = []
+	{
+		dsc desc;
+		desc.makeNullString();
+		return desc;
+	}();
+
+	const auto getLiteral = [](const ValueExprNode* value) -> const dsc*
+	{
+		if (nodeIs<NullNode>(value))
+			return &nullDesc;
+
+		const auto literal = nodeAs<LiteralNode>(value);
+		return literal ? &literal->litDesc : nullptr;
+	};
+
+	if (const auto missingNode = nodeAs<MissingBoolNode>(node))
+	{
+		if (const auto stats = getColumnStatistics(missingNode->arg))
+			return stats->getNullSelectivity();
+	}
+	else if (const auto listNode = nodeAs<InListBoolNode>(node))
+	{
+		if (const auto stats = getColumnStatistics(listNode->arg))
+		{
+			double selectivity = 0;
+
+			for (const auto item : listNode->list->items)
+			{
+				const auto itemSelectivity = stats->getEqualSelectivity(getLiteral(item));
+
+				if (!itemSelectivity)
+					return std::nullopt;
+
+				selectivity += itemSelectivity.value();
+			}
+
+			return MIN(selectivity, MAXIMUM_SELECTIVITY);
+		}
+	}
+	else if (const auto cmpNode = nodeAs<ComparativeBoolNode>(node))
+	{
+		auto blrOp = cmpNode->blrOp;
+		const ValueExprNode* other = cmpNode->arg2;
+		auto stats = getColumnStatistics(cmpNode->arg1);
+
+		if (!stats && blrOp != blr_between)
+		{
+			// Literal on the left side, swap the operands
+			stats = getColumnStatistics(cmpNode->arg2);
+			other = cmpNode->arg1;
+
+			switch (blrOp)
+			{
+			case blr_gtr:
+				blrOp = blr_lss;
+				break;
+
+			case blr_geq:
+				blrOp = blr_leq;
+				break;
+
+			case blr_lss:
+				blrOp = blr_gtr;
+				break;
+
+			case blr_leq:
+				blrOp = blr_geq;
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		if (!stats)
+			return std::nullopt;
+
+		switch (blrOp)
+		{
+		case blr_eql:
+		case blr_equiv:
+			if (const auto otherStats = getColumnStatistics(other))
+				return stats->getJoinSelectivity(otherStats);
+
+			if (blrOp == blr_equiv)
+			{
+				// IS NOT DISTINCT FROM NULL
+				if (const auto literal = getLiteral(other); literal && literal->isNull())
+					return stats->getNullSelectivity();
+			}
+
+			return stats->getEqualSelectivity(getLiteral(other));
+
+		case blr_gtr:
+		case blr_geq:
+			return stats->getGreaterSelectivity(getLiteral(other), blrOp == blr_geq);
+
+		case blr_lss:
+		case blr_leq:
+			return stats->getLessSelectivity(getLiteral(other), blrOp == blr_leq);
+
+		case blr_between:
+			return stats->getBetweenSelectivity(getLiteral(cmpNode->arg2), getLiteral(cmpNode->arg3));
+
+		default:
+			break;
+		}
+	}
+
+	return std::nullopt;
+}
+
+
+//
+// Estimate selectivity of the booleans matched to the leading index segment using
+// column statistics, so that skewed distributions are accounted for.
+// Nothing is returned if they cannot be evaluated this way.
+//
+
+std::optional<double> Optimizer::getSegmentSelectivity(const IndexScratchSegment& segment) const
+{
+	const auto& matches = segment.matches;
+
+	if (matches.getCount() == 1)
+		return getColumnSelectivity(matches[0]);
+
+	// Range defined by its lower and upper bounds separately
+	if (matches.getCount() == 2 && segment.scanType == segmentScanBetween)
+	{
+		const auto first = getColumnSelectivity(matches[0]);
+		const auto second = getColumnSelectivity(matches[1]);
+
+		if (first && second)
+			return MAX(first.value() + second.value() - MAXIMUM_SELECTIVITY, 0.0);
+	}
+
+	return std::nullopt;
+}
+
+
 //
 // Estimate overall selectivity for a list of conjuncts.
 // Booleans are usually inter-dependent in practice and simple multiplication results to a very low selectivity value,
@@ -1242,7 +1622,7 @@ double Optimizer::getDependentSelectivity()
 // See also explanation in the middle of Retrieval::makeInversion().
 //
 
-double Optimizer::estimateSelectivity(const BooleanList& filters, double cardinality, unsigned priorConjuncts)
+double Optimizer::estimateSelectivity(const BooleanList& filters, double cardinality, unsigned priorConjuncts) const
 {
 	// Get selectivities and order them
 	SortedArray<double, InlineStorage<double, OPT_STATIC_ITEMS> > selectivities;
@@ -2107,6 +2487,9 @@ void Optimizer::checkSorts()
 				setDirection(sort, group);
 				setPosition(sort, group, map);
 				sort = rse->rse_sorted = nullptr;
+
+				// Now the groups must be produced in the sorted order
+				aggregate->orderedGroups = true;
 			}
 		}
 	}
@@ -3145,7 +3528,7 @@ RecordSource* Optimizer::generateRetrieval(StreamType stream,
 
 	if (rsb)
 	{
-		filterSelectivity = Optimizer::estimateSelectivity(filters, rsb->getCardinality());
+		filterSelectivity = estimateSelectivity(filters, rsb->getCardinality());
 	}
 	else
 	{
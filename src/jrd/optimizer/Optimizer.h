@@ -44,9 +44,13 @@
 #include "../jrd/recsrc/RecordSource.h"
 
 #include <cmath>
+#include <optional>
 
 namespace Jrd {
 
+class ColumnStatistics;
+class TableStatistics;
+
 // AB: 2005-11-05
 // Constants below needs some discussions and ideas
 inline constexpr double REDUCE_SELECTIVITY_FACTOR_EQUALITY = 0.001;
@@ -85,6 +89,7 @@ class PlanNode;
 class SortNode;
 class River;
 class SortedStream;
+struct IndexScratchSegment;
 
 // List of booleans
 typedef Firebird::HalfStaticArray<BoolExprNode*, OPT_STATIC_ITEMS> BooleanList;
@@ -390,73 +395,9 @@ public:
 		return statement ? statement->getPlan(tdbb, detailed) : "";
 	}
 
-	static double getSelectivity(const BoolExprNode* node)
-	{
-		auto factor = REDUCE_SELECTIVITY_FACTOR_OTHER;
-
-		if (const auto notNode = nodeAs<NotBoolNode>(node))
-		{
-			factor = MAXIMUM_SELECTIVITY - getSelectivity(notNode->arg);
-		}
-		else if (const auto binaryNode = nodeAs<BinaryBoolNode>(node))
-		{
-			const auto selectivity1 = getSelectivity(binaryNode->arg1);
-			const auto selectivity2 = getSelectivity(binaryNode->arg2);
-
-			if (binaryNode->blrOp == blr_and)
-				factor = selectivity1 * selectivity2;
-			else if (binaryNode->blrOp == blr_or)
-				factor = selectivity1 + selectivity2 - selectivity1 * selectivity2;
-			else
-				fb_assert(false);
-		}
-		else if (const auto listNode = nodeAs<InListBoolNode>(node))
-		{
-			factor = REDUCE_SELECTIVITY_FACTOR_EQUALITY * listNode->list->items.getCount();
-		}
-		else if (nodeIs<MissingBoolNode>(node))
-		{
-			factor = REDUCE_SELECTIVITY_FACTOR_EQUALITY;
-		}
-		else if (const auto cmpNode = nodeAs<ComparativeBoolNode>(node))
-		{
-			switch (cmpNode->blrOp)
-			{
-			case blr_eql:
-			case blr_equiv:
-				factor = REDUCE_SELECTIVITY_FACTOR_EQUALITY;
-				break;
-
-			case blr_gtr:
-			case blr_geq:
-				factor = REDUCE_SELECTIVITY_FACTOR_GREATER;
-				break;
-
-			case blr_lss:
-			case blr_leq:
-				factor = REDUCE_SELECTIVITY_FACTOR_LESS;
-				break;
-
-			case blr_between:
-				factor = REDUCE_SELECTIVITY_FACTOR_BETWEEN;
-				break;
-
-			case blr_starting:
-				factor = REDUCE_SELECTIVITY_FACTOR_STARTING;
-				break;
-
-			default:
-				break;
-			}
-		}
-
-		if (!factor)
-			factor = DEFAULT_SELECTIVITY;
-
-		return MIN(factor, MAXIMUM_SELECTIVITY);
-	}
-
-	static double estimateSelectivity(const BooleanList& filters, double cardinality = 0, unsigned priorConjuncts = 0);
+	double getSelectivity(const BoolExprNode* node) const;
+	std::optional<double> getSegmentSelectivity(const IndexScratchSegment& segment) const;
+	double estimateSelectivity(const BooleanList& filters, double cardinality = 0, unsigned priorConjuncts = 0) const;
 
 	double getDependentSelectivity();
 
@@ -557,6 +498,8 @@ public:
 		return firstRows;
 	}
 
+	std::optional<double> getDistinctCount(const NestValueArray& values) const;
+
 	RecordSource* applyBoolean(RecordSource* rsb, ConjunctIterator& iter);
 	RecordSource* applyLocalBoolean(RecordSource* rsb,
 									const StreamList& streams,
@@ -623,6 +566,10 @@ private:
 
 	ValueExprNode* optimizeLikeSimilar(ComparativeBoolNode* cmpNode);
 
+	const ColumnStatistics* getColumnStatistics(const ValueExprNode* node) const;
+	std::optional<double> getIndexDistinctCount(const ValueExprNode* node) const;
+	std::optional<double> getColumnSelectivity(const BoolExprNode* node) const;
+
 	thread_db* const tdbb;
 	CompilerScratch* const csb;
 	RseNode* const rse;
@@ -637,6 +584,9 @@ private:
 
 	StreamList compileStreams, bedStreams, keyStreams, outerStreams;
 	ConjunctList conjuncts;
+
+	// Column statistics referenced while optimizing
+	mutable Firebird::HalfStaticArray<TableStatistics*, 4> tableStatistics;
 };
 
 
@@ -739,12 +689,12 @@ struct InversionCandidate
 	Firebird::Array<DbKeyRangeNode*> dbkeyRanges;
 	SortedStreamList dependentFromStreams;
 
-	void applyFilters(double cardinality)
+	void applyFilters(const Optimizer* optimizer, double cardinality)
 	{
 		fb_assert(selectivity == matchSelectivity);
 		fb_assert(filterSelectivity == MAXIMUM_SELECTIVITY);
 		const auto matchCount = (unsigned) matches.getCount();
-		filterSelectivity = Optimizer::estimateSelectivity(filters, cardinality, matchCount);
+		filterSelectivity = optimizer->estimateSelectivity(filters, cardinality, matchCount);
 		selectivity *= filterSelectivity;
 	}
 };
@@ -361,7 +361,7 @@ InversionCandidate* Retrieval::getInversion()
 	}
 
 	const auto streamCardinality = csb->csb_rpt[stream].csb_cardinality;
-	invCandidate->applyFilters(streamCardinality);
+	invCandidate->applyFilters(optimizer, streamCardinality);
 
 	// Double check whether navigational walk is preferrable to the external sort
 	if (navigationCandidate)
@@ -981,6 +981,10 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 			unsigned listCount = 0;
 			auto maxSelectivity = scratch.selectivity;
 
+			// Ratio of the leading segment selectivity estimated by the column statistics
+			// (reflecting skewed values) to the average one known from the index statistics
+			double skew = 1;
+
 			for (unsigned j = 0; j < scratch.segments.getCount(); j++)
 			{
 				const auto& segment = scratch.segments[j];
@@ -1025,6 +1029,27 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 				if (useDefaultSelectivity)
 					selectivity = MAX(scratch.selectivity * DEFAULT_SELECTIVITY, minSelectivity);
 
+				std::optional<double> columnSelectivity;
+
+				if (j == 0 && !(idx->idx_flags & idx_expression))
+				{
+					columnSelectivity = optimizer->getSegmentSelectivity(segment);
+
+					if (columnSelectivity)
+					{
+						// Selectivity of the list scan is the sum of the per-item ones
+						if (scanType == segmentScanList)
+							columnSelectivity = columnSelectivity.value() / segment.valueList->getCount();
+
+						columnSelectivity = MAX(columnSelectivity.value(), minSelectivity);
+
+						if (!useDefaultSelectivity)
+							skew = columnSelectivity.value() / selectivity;
+					}
+				}
+				else if (!useDefaultSelectivity)
+					selectivity = MIN(selectivity * skew, scratch.selectivity);
+
 				if (scanType == segmentScanList)
 				{
 					if (listCount) // we cannot have more than one list matched to an index
@@ -1050,7 +1075,7 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 					scratch.nonFullMatchedSegments = idx->idx_count - (j + 1);
 					// Add matches for this segment to the main matches list
 					matches.join(segment.matches);
-					scratch.selectivity = selectivity;
+					scratch.selectivity = columnSelectivity.value_or(selectivity);
 
 					// An equality scan for any unique index cannot retrieve more
 					// than one row. The same is true for an equivalence scan for
@@ -1122,13 +1147,21 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 								break;
 						}
 
-						// Adjust the compound selectivity using the reduce factor.
-						// It should be better than the previous segment but worse
-						// than a full match.
-						const double diffSelectivity = scratch.selectivity - selectivity;
-						selectivity += (diffSelectivity * factor);
-						fb_assert(selectivity <= scratch.selectivity);
-						scratch.selectivity = selectivity;
+						if (columnSelectivity && scanType != segmentScanStarting)
+						{
+							// Range of the leading segment is estimated by the histogram
+							scratch.selectivity = columnSelectivity.value();
+						}
+						else
+						{
+							// Adjust the compound selectivity using the reduce factor.
+							// It should be better than the previous segment but worse
+							// than a full match.
+							const double diffSelectivity = scratch.selectivity - selectivity;
+							selectivity += (diffSelectivity * factor);
+							fb_assert(selectivity <= scratch.selectivity);
+							scratch.selectivity = selectivity;
+						}
 
 						scratch.nonFullMatchedSegments = idx->idx_count - j;
 						matches.join(segment.matches);
@@ -34,8 +34,14 @@
 #include "../common/classes/array.h"
 #include "../common/classes/File.h"
 
+namespace Ods {
+	struct pag;
+}
+
 namespace Jrd {
 
+class BufferDesc;
+
 #ifdef UNIX
 
 class jrd_file : public pool_alloc_rpt<SCHAR, type_fil>
@@ -79,6 +85,7 @@ inline constexpr USHORT FIL_readonly		= 4;	// file opened in readonly mode
 inline constexpr USHORT FIL_sh_write		= 8;	// file opened in shared write mode
 inline constexpr USHORT FIL_no_fast_extend	= 16;	// file not supports fast extending
 inline constexpr USHORT FIL_raw_device		= 32;	// file is raw device
+inline constexpr USHORT FIL_no_punch_hole	= 64;	// file not supports punching holes
 
 // Physical IO trace events
 
@@ -89,6 +96,19 @@ inline constexpr SSHORT trace_read		= 4;
 inline constexpr SSHORT trace_write		= 5;
 inline constexpr SSHORT trace_close		= 6;
 
+// Single page transfer of the batched physical IO, see PIO_read_batch and PIO_write_batch
+
+struct PageIo
+{
+	BufferDesc* pio_bdb;		// Buffer descriptor, defines the page to transfer
+	Ods::pag* pio_page;			// Page image to read into or to write from
+	bool pio_done;				// Transfer completed successfully
+};
+
+// Maximum number of pages in the single batched IO call
+
+inline constexpr unsigned MAX_IO_BATCH = 256;
+
 // Physical I/O status block, used only in SS v2 for Win32
 
 #ifdef SUPERSERVER_V2
@@ -48,6 +48,16 @@
 #ifdef HAVE_LINUX_FALLOC_H
 #include <linux/falloc.h>
 #endif
+#if defined(HAVE_PREADV) || defined(HAVE_PWRITEV)
+#include <sys/uio.h>
+#endif
+#ifdef HAVE_LINUX_IO_URING_H
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <atomic>
+#endif
 
 #ifdef SUPPORT_RAW_DEVICES
 #include <sys/ioctl.h>
@@ -132,7 +142,16 @@ using namespace Firebird;
 
 static const mode_t MASK = 0660;
 
+#if defined(HAVE_LINUX_IO_URING_H) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define USE_IO_URING
+#endif
+
 static bool seek_file(jrd_file*, BufferDesc*, FB_UINT64*, FbStatusVector*);
+static bool batch_io(thread_db*, jrd_file*, PageIo*, unsigned, bool, FbStatusVector*);
+#if defined(HAVE_PREADV) && defined(HAVE_PWRITEV)
+static void vectored_io(int, PageIo*, const FB_UINT64*, unsigned, unsigned, bool);
+static void punch_page_tail(jrd_file*, const Ods::pag*, FB_UINT64, unsigned);
+#endif
 static jrd_file* setup_file(Database*, const PathName&, int, USHORT);
 static void lockDatabaseFile(int& desc, const bool shareMode, const bool temporary,
 							 const char* fileName, ISC_STATUS operation);
@@ -150,6 +169,331 @@ static int	openFile(const Firebird::PathName&, const bool, const bool, const boo
 static void	maybeCloseFile(int&);
 
 
+#ifdef USE_IO_URING
+namespace
+{
+	// Minimal io_uring wrapper used by the batched page IO. Every thread gets its own ring
+	// on first use, so requests are submitted without any locking. If the kernel doesn't
+	// support io_uring or it's disabled by the system policy, the batched IO falls back
+	// to the vectored and then to the regular single page IO.
+
+	class IoRing
+	{
+	public:
+		static constexpr unsigned RING_ENTRIES = 64;
+		static constexpr unsigned MAX_RETRIES = 100;	// in a row, for transient io_uring_enter() errors
+		static constexpr FB_UINT64 NO_PAGE = MAX_UINT64;	// user data of the requests not transferring pages
+
+		~IoRing()
+		{
+			shutdown();
+		}
+
+		static IoRing* getThreadRing();
+
+		// Transfer the given pages and wait for completion. Successfully transferred pages
+		// are marked as done. If the ring breaks, it's not used anymore and the pages not
+		// marked as done may be transferred by other means. Returns false if some requests
+		// could not be cancelled and may be still in flight, the pages must not be
+		// transferred again then.
+		bool run(UCHAR opcode, int fd, PageIo* ios, const FB_UINT64* offsets, unsigned count,
+			unsigned size);
+
+	private:
+		bool init();
+		void shutdown();
+		int enter(unsigned toSubmit);
+		unsigned reap(PageIo* ios, unsigned start, unsigned size);
+		bool cancel(PageIo* ios, unsigned start, unsigned count, unsigned submitted,
+			unsigned completed, unsigned size);
+
+		enum State { RING_NONE, RING_READY, RING_FAILED };
+
+		State state = RING_NONE;
+		int ringFd = -1;
+		unsigned sqEntries = 0;
+
+		void* sqRing = nullptr;
+		size_t sqRingSize = 0;
+		void* cqRing = nullptr;
+		size_t cqRingSize = 0;
+		io_uring_sqe* sqes = nullptr;
+		size_t sqesSize = 0;
+
+		unsigned* sqTail = nullptr;
+		unsigned* sqMask = nullptr;
+		unsigned* sqArray = nullptr;
+		unsigned* cqHead = nullptr;
+		unsigned* cqTail = nullptr;
+		unsigned* cqMask = nullptr;
+		io_uring_cqe* cqes = nullptr;
+
+		iovec iovs[RING_ENTRIES];
+		bool inFlight[RING_ENTRIES];
+	};
+
+	thread_local IoRing threadRing;
+	std::atomic<bool> ringUnsupported = false;
+
+	IoRing* IoRing::getThreadRing()
+	{
+		if (ringUnsupported.load(std::memory_order_relaxed))
+			return nullptr;
+
+		IoRing& ring = threadRing;
+
+		if (ring.state == RING_NONE)
+		{
+			if (ring.init())
+				ring.state = RING_READY;
+			else
+			{
+				// Don't try again in other threads if the kernel rejects io_uring at all
+				if (errno == ENOSYS || errno == EPERM || errno == EACCES)
+					ringUnsupported = true;
+
+				ring.shutdown();
+			}
+		}
+
+		return (ring.state == RING_READY) ? &ring : nullptr;
+	}
+
+	bool IoRing::init()
+	{
+		io_uring_params params;
+		memset(&params, 0, sizeof(params));
+
+		ringFd = syscall(__NR_io_uring_setup, RING_ENTRIES, &params);
+		if (ringFd < 0)
+			return false;
+
+		sqEntries = params.sq_entries;
+
+		sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			ringFd, IORING_OFF_SQ_RING);
+		if (sqRing == MAP_FAILED)
+		{
+			sqRing = nullptr;
+			return false;
+		}
+
+		cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			ringFd, IORING_OFF_CQ_RING);
+		if (cqRing == MAP_FAILED)
+		{
+			cqRing = nullptr;
+			return false;
+		}
+
+		sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+		void* const sqesPtr = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			ringFd, IORING_OFF_SQES);
+		if (sqesPtr == MAP_FAILED)
+			return false;
+
+		sqes = static_cast<io_uring_sqe*>(sqesPtr);
+
+		UCHAR* const sq = static_cast<UCHAR*>(sqRing);
+		sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+		sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+		sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+		UCHAR* const cq = static_cast<UCHAR*>(cqRing);
+		cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+		cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+		cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+		cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+		return true;
+	}
+
+	void IoRing::shutdown()
+	{
+		const int savedErrno = errno;
+
+		if (sqes)
+			munmap(sqes, sqesSize);
+		if (cqRing)
+			munmap(cqRing, cqRingSize);
+		if (sqRing)
+			munmap(sqRing, sqRingSize);
+		if (ringFd >= 0)
+			close(ringFd);
+
+		sqes = nullptr;
+		cqRing = sqRing = nullptr;
+		ringFd = -1;
+		state = RING_FAILED;
+
+		errno = savedErrno;
+	}
+
+	// Submit the given number of entries and wait for at least one completion.
+	// Transient errors are retried, returns -1 if the ring cannot be used anymore.
+	int IoRing::enter(unsigned toSubmit)
+	{
+		for (unsigned retries = 0; ; )
+		{
+			const int rc = syscall(__NR_io_uring_enter, ringFd, toSubmit, 1,
+				IORING_ENTER_GETEVENTS, nullptr, 0);
+
+			if (rc >= 0 || !(errno == EINTR || errno == EAGAIN || errno == EBUSY) || ++retries >= MAX_RETRIES)
+				return rc;
+		}
+	}
+
+	// Process the completions, returns the number of completed page transfers
+	unsigned IoRing::reap(PageIo* ios, unsigned start, unsigned size)
+	{
+		unsigned head = *cqHead;
+		const unsigned tail = std::atomic_ref<unsigned>(*cqTail).load(std::memory_order_acquire);
+		unsigned count = 0;
+
+		for (; head != tail; ++head)
+		{
+			const io_uring_cqe* const cqe = &cqes[head & *cqMask];
+
+			if (cqe->user_data != NO_PAGE)
+			{
+				ios[cqe->user_data].pio_done = (cqe->res == (int) size);
+				inFlight[cqe->user_data - start] = false;
+				++count;
+			}
+		}
+
+		std::atomic_ref<unsigned>(*cqHead).store(head, std::memory_order_release);
+		return count;
+	}
+
+	// Cancel the page transfers still in flight and wait until they're finished.
+	// Entries not consumed by the kernel yet are turned into no-ops. Returns false
+	// if the ring fails while doing that, so the transfers may be still in flight.
+	bool IoRing::cancel(PageIo* ios, unsigned start, unsigned count, unsigned submitted,
+		unsigned completed, unsigned size)
+	{
+		unsigned tail = *sqTail;
+		const unsigned first = tail - count;
+
+		for (unsigned i = submitted; i < count; i++)
+		{
+			io_uring_sqe* const sqe = &sqes[(first + i) & *sqMask];
+			memset(sqe, 0, sizeof(io_uring_sqe));
+			sqe->opcode = IORING_OP_NOP;
+			sqe->user_data = NO_PAGE;
+
+			inFlight[i] = false;
+		}
+
+		// Slots of the submitted entries are free, there are at most that many requests to cancel
+
+		unsigned toSubmit = count - submitted;
+
+		for (unsigned i = 0; i < submitted; i++)
+		{
+			if (!inFlight[i])
+				continue;
+
+			const unsigned index = tail++ & *sqMask;
+			io_uring_sqe* const sqe = &sqes[index];
+			memset(sqe, 0, sizeof(io_uring_sqe));
+
+			sqe->opcode = IORING_OP_ASYNC_CANCEL;
+			sqe->addr = start + i;		// user data of the request to cancel
+			sqe->user_data = NO_PAGE;
+
+			sqArray[index] = index;
+			++toSubmit;
+		}
+
+		std::atomic_ref<unsigned>(*sqTail).store(tail, std::memory_order_release);
+
+		// Cancelled requests complete with an error, the ones that cannot be
+		// cancelled anymore complete as usual, wait for all of them
+
+		while (toSubmit || completed < submitted)
+		{
+			const int rc = enter(toSubmit);
+
+			if (rc < 0)
+				return false;
+
+			toSubmit -= rc;
+			completed += reap(ios, start, size);
+		}
+
+		return true;
+	}
+
+	bool IoRing::run(UCHAR opcode, int fd, PageIo* ios, const FB_UINT64* offsets, unsigned count,
+		unsigned size)
+	{
+		for (unsigned start = 0; start < count; start += sqEntries)
+		{
+			const unsigned n = MIN(count - start, sqEntries);
+
+			// We're the only producer, so no need to synchronize with the kernel while
+			// preparing entries, only the tail update must be visible after them
+
+			unsigned tail = *sqTail;
+			for (unsigned i = 0; i < n; i++, tail++)
+			{
+				const unsigned index = tail & *sqMask;
+				io_uring_sqe* const sqe = &sqes[index];
+				memset(sqe, 0, sizeof(io_uring_sqe));
+
+				iovs[i].iov_base = ios[start + i].pio_page;
+				iovs[i].iov_len = size;
+
+				sqe->opcode = opcode;
+				sqe->fd = fd;
+				sqe->off = offsets[start + i];
+				sqe->addr = (U_IPTR) &iovs[i];
+				sqe->len = 1;
+				sqe->user_data = start + i;
+
+				sqArray[index] = index;
+			}
+
+			std::atomic_ref<unsigned>(*sqTail).store(tail, std::memory_order_release);
+
+			for (unsigned i = 0; i < n; i++)
+				inFlight[i] = true;
+
+			unsigned submitted = 0, completed = 0;
+
+			while (completed < n)
+			{
+				const int rc = enter(n - submitted);
+
+				if (rc < 0)
+				{
+					// Unexpected failure, don't use the ring anymore. Requests in flight
+					// must be finished before the caller transfers their pages again,
+					// otherwise the racing transfers may tear the pages.
+
+					const int savedErrno = errno;
+					const bool finished = cancel(ios, start, n, submitted, completed, size);
+					errno = savedErrno;
+
+					shutdown();
+					return finished;
+				}
+
+				submitted += rc;
+				completed += reap(ios, start, size);
+			}
+		}
+
+		return true;
+	}
+
+} // anonymous namespace
+#endif // USE_IO_URING
+
+
 void PIO_close(jrd_file* file)
 {
 /**************************************
@@ -803,6 +1147,23 @@ bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+bool PIO_read_batch(thread_db* tdbb, jrd_file* file, PageIo* ios, unsigned count, FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	P I O _ r e a d _ b a t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read a set of pages at once.
+ *
+ **************************************/
+
+	return batch_io(tdbb, file, ios, count, false, status_vector);
+}
+
+
 bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page, FbStatusVector* status_vector)
 {
 /**************************************
@@ -836,6 +1197,7 @@ bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 		if ((bytes = os_utils::pwrite(file->fil_desc, page, size, LSEEK_OFFSET_CAST offset)) == size)
 		{
 			// os_utils::posix_fadvise(file->desc, offset, size, POSIX_FADV_DONTNEED);
+			punch_page_tail(file, page, offset, size);
 			return true;
 		}
 
@@ -847,6 +1209,207 @@ bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+bool PIO_write_batch(thread_db* tdbb, jrd_file* file, PageIo* ios, unsigned count, FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	P I O _ w r i t e _ b a t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Write a set of pages at once. Pages must not
+ *	depend on each other as they're written in
+ *	no particular order.
+ *
+ **************************************/
+
+	return batch_io(tdbb, file, ios, count, true, status_vector);
+}
+
+
+static bool batch_io(thread_db* tdbb, jrd_file* file, PageIo* ios, unsigned count, bool write,
+					 FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	b a t c h _ i o
+ *
+ **************************************
+ *
+ * Functional description
+ *	Transfer a set of pages using io_uring or vectored IO,
+ *	when available. Pages not transferred this way are
+ *	read or written one by one, so the usual retry and
+ *	error reporting logic is applied to them.
+ *
+ **************************************/
+	if (file->fil_desc == -1)
+		return unix_error(write ? "write" : "read", file, write ? isc_io_write_err : isc_io_read_err, status_vector);
+
+	const Database* const dbb = tdbb->getDatabase();
+	const unsigned size = dbb->dbb_page_size;
+
+	HalfStaticArray<FB_UINT64, 64> offsets;
+	FB_UINT64* const offsetList = offsets.getBuffer(count);
+
+	for (unsigned i = 0; i < count; i++)
+	{
+		ios[i].pio_done = false;
+
+		if (!seek_file(file, ios[i].pio_bdb, &offsetList[i], status_vector))
+			return false;
+	}
+
+	bool inFlight = false;
+
+	if (count > 1)
+	{
+		EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
+
+#ifdef USE_IO_URING
+		if (IoRing* const ring = IoRing::getThreadRing())
+		{
+			inFlight = !ring->run(write ? IORING_OP_WRITEV : IORING_OP_READV, file->fil_desc,
+				ios, offsetList, count, size);
+		}
+		else
+#endif
+		{
+#if defined(HAVE_PREADV) && defined(HAVE_PWRITEV)
+			vectored_io(file->fil_desc, ios, offsetList, count, size, write);
+#endif
+		}
+
+		if (write)
+		{
+			for (unsigned i = 0; i < count; i++)
+			{
+				if (ios[i].pio_done)
+					punch_page_tail(file, ios[i].pio_page, offsetList[i], size);
+			}
+		}
+	}
+
+	// Pages of the requests still in flight cannot be transferred again safely
+
+	if (inFlight)
+	{
+		return unix_error(write ? "io_uring write" : "io_uring read", file,
+			write ? isc_io_write_err : isc_io_read_err, status_vector);
+	}
+
+	for (unsigned i = 0; i < count; i++)
+	{
+		PageIo& io = ios[i];
+
+		if (!io.pio_done)
+		{
+			if (!(write ? PIO_write : PIO_read)(tdbb, file, io.pio_bdb, io.pio_page, status_vector))
+				return false;
+
+			io.pio_done = true;
+		}
+	}
+
+	return true;
+}
+
+
+#if defined(HAVE_PREADV) && defined(HAVE_PWRITEV)
+static void vectored_io(int fd, PageIo* ios, const FB_UINT64* offsets, unsigned count, unsigned size,
+						bool write)
+{
+/**************************************
+ *
+ *	v e c t o r e d _ i o
+ *
+ **************************************
+ *
+ * Functional description
+ *	Transfer runs of adjacent pages using single
+ *	system call per run.
+ *
+ **************************************/
+	const unsigned MAX_RUN = 64;
+	iovec iovs[MAX_RUN];
+
+	for (unsigned start = 0; start < count; )
+	{
+		unsigned n = 1;
+		while (start + n < count && n < MAX_RUN &&
+			offsets[start + n] == offsets[start] + (FB_UINT64) n * size)
+		{
+			n++;
+		}
+
+		// Single pages are left for the regular IO routines
+
+		if (n > 1)
+		{
+			for (unsigned i = 0; i < n; i++)
+			{
+				iovs[i].iov_base = ios[start + i].pio_page;
+				iovs[i].iov_len = size;
+			}
+
+			const ssize_t bytes = write ?
+				pwritev(fd, iovs, n, LSEEK_OFFSET_CAST offsets[start]) :
+				preadv(fd, iovs, n, LSEEK_OFFSET_CAST offsets[start]);
+
+			if (bytes == (ssize_t) n * size)
+			{
+				for (unsigned i = 0; i < n; i++)
+					ios[start + i].pio_done = true;
+			}
+		}
+
+		start += n;
+	}
+}
+#endif
+
+
+static void punch_page_tail(jrd_file* file, const Ods::pag* page, FB_UINT64 offset, unsigned size)
+{
+/**************************************
+ *
+ *	p u n c h _ p a g e _ t a i l
+ *
+ **************************************
+ *
+ * Functional description
+ *	Release the unused tail of just written
+ *	compressed data page back to the file system.
+ *	Failure is not an error as the tail is never read.
+ *
+ **************************************/
+#if defined(HAVE_LINUX_FALLOC_H) && defined(HAVE_FALLOCATE) && defined(FALLOC_FL_PUNCH_HOLE)
+	if (page->pag_type != pag_data || !(page->pag_flags & Ods::dpg_compressed) ||
+		(file->fil_flags & (FIL_no_punch_hole | FIL_raw_device)))
+	{
+		return;
+	}
+
+	const auto image = reinterpret_cast<const Ods::compressed_data_page*>(page);
+	const unsigned used = FB_ALIGN(offsetof(Ods::compressed_data_page, cdp_data) + image->cdp_length,
+		DIRECT_IO_BLOCK_SIZE);
+
+	if (used >= size)
+		return;
+
+	while (fallocate(file->fil_desc, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset + used, size - used))
+	{
+		if (!SYSCALL_INTERRUPTED(errno))
+		{
+			file->fil_flags |= FIL_no_punch_hole;
+			break;
+		}
+	}
+#endif
+}
+
+
 static bool seek_file(jrd_file* file, BufferDesc* bdb, FB_UINT64* offset,
 					  FbStatusVector* status_vector)
 {
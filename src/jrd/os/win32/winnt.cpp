@@ -572,6 +572,36 @@ bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+bool PIO_read_batch(thread_db* tdbb, jrd_file* file, PageIo* ios, unsigned count, FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	P I O _ r e a d _ b a t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read a set of pages. No batching on Windows yet,
+ *	pages are read one by one.
+ *
+ **************************************/
+	for (unsigned i = 0; i < count; i++)
+		ios[i].pio_done = false;
+
+	for (unsigned i = 0; i < count; i++)
+	{
+		PageIo& io = ios[i];
+
+		if (!PIO_read(tdbb, file, io.pio_bdb, io.pio_page, status_vector))
+			return false;
+
+		io.pio_done = true;
+	}
+
+	return true;
+}
+
+
 #ifdef SUPERSERVER_V2
 bool PIO_read_ahead(thread_db*	tdbb,
 				   SLONG	start_page,
@@ -731,6 +761,36 @@ bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+bool PIO_write_batch(thread_db* tdbb, jrd_file* file, PageIo* ios, unsigned count, FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	P I O _ w r i t e _ b a t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Write a set of pages. No batching on Windows yet,
+ *	pages are written one by one.
+ *
+ **************************************/
+	for (unsigned i = 0; i < count; i++)
+		ios[i].pio_done = false;
+
+	for (unsigned i = 0; i < count; i++)
+	{
+		PageIo& io = ios[i];
+
+		if (!PIO_write(tdbb, file, io.pio_bdb, io.pio_page, status_vector))
+			return false;
+
+		io.pio_done = true;
+	}
+
+	return true;
+}
+
+
 ULONG PIO_get_number_of_pages(const jrd_file* file, const USHORT pagesize)
 {
 /**************************************
@@ -1132,6 +1132,10 @@ void PAG_header_init(thread_db* tdbb)
 											Arg::Num(ODS_CURRENT));
 	}
 
+	// Compressed data pages require ODS 14.1
+	if ((header->hdr_flags & hdr_compressed_pages) && header->hdr_ods_minor < ODS_CURRENT14_1)
+		ERR_post(Arg::Gds(isc_bad_db_format) << Arg::Str(attachment->att_filename));
+
 	// Note that if this check is turned on, it should be recoded in order that
 	// the Intel platforms can share databases.  At present (Feb 95) it is possible
 	// to share databases between Windows and NT, but not with NetWare.  Sharing
@@ -1682,6 +1686,48 @@ void PAG_set_page_buffers(thread_db* tdbb, ULONG buffers)
 }
 
 
+void PAG_set_page_compression(thread_db* tdbb)
+{
+/**************************************
+ *
+ *	P A G _ s e t _ p a g e _ c o m p r e s s i o n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Allow data pages to be written compressed.
+ *	Compressed pages require ODS 14.1, engines not knowing it refuse
+ *	to open the database. Older databases should be upgraded first.
+ *	Header is marked before the first compressed page is written.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	const auto dbb = tdbb->getDatabase();
+
+	if (dbb->readOnly())
+		return;
+
+	if (dbb->getEncodedOdsVersion() < ODS_14_1)
+	{
+		gds__log("Database: %s\n\tData page compression requires ODS 14.1, pages are not compressed",
+			dbb->dbb_filename.c_str());
+		return;
+	}
+
+	WIN window(HEADER_PAGE_NUMBER);
+	header_page* header = (header_page*) CCH_FETCH(tdbb, &window, LCK_write, pag_header);
+
+	if (!(header->hdr_flags & hdr_compressed_pages))
+	{
+		CCH_MARK_MUST_WRITE(tdbb, &window);
+		header->hdr_flags |= hdr_compressed_pages;
+	}
+
+	CCH_RELEASE(tdbb, &window);
+
+	dbb->dbb_flags |= DBB_page_compression;
+}
+
 void PAG_set_repl_sequence(thread_db* tdbb, FB_UINT64 sequence)
 {
 /**************************************
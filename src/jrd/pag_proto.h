@@ -60,6 +60,7 @@ void	PAG_set_db_readonly(Jrd::thread_db* tdbb, bool);
 void	PAG_set_db_replica(Jrd::thread_db* tdbb, ReplicaMode);
 void	PAG_set_db_SQL_dialect(Jrd::thread_db* tdbb, SSHORT);
 void	PAG_set_page_buffers(Jrd::thread_db* tdbb, ULONG);
+void	PAG_set_page_compression(Jrd::thread_db* tdbb);
 void	PAG_set_page_scn(Jrd::thread_db* tdbb, Jrd::win* window);
 void	PAG_set_repl_sequence(Jrd::thread_db* tdbb, FB_UINT64);
 void	PAG_set_sweep_interval(Jrd::thread_db* tdbb, SLONG);
@@ -30,6 +30,7 @@
 #include "../jrd/optimizer/Optimizer.h"
 
 #include "RecordSource.h"
+#include "ParallelBatchScan.h"
 
 using namespace Firebird;
 using namespace Jrd;
@@ -369,16 +370,21 @@ bool BaseAggWinStream<ThisType, NextType>::getNextRecord(thread_db* tdbb, Reques
 		return m_next->getRecord(tdbb);
 }
 
-// Export the template for WindowedStream::WindowStream.
+// Export the template for WindowedStream::WindowStream and HashAggregatedStream.
 template class Jrd::BaseAggWinStream<WindowedStream::WindowStream, BaseBufferedStream>;
+template class Jrd::BaseAggWinStream<HashAggregatedStream, RecordSource>;
 
 // ------------------------------
 
 AggregatedStream::AggregatedStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
 			const NestValueArray* group, MapNode* map, RecordSource* next)
-	: BaseAggWinStream(tdbb, csb, stream, group, map, !group, next)
+	: BaseAggWinStream(tdbb, csb, stream, group, map, !group, next),
+	  m_batchAggregates(csb->csb_pool)
 {
 	fb_assert(map);
+
+	if (!group)
+		setupBatchMode(tdbb, csb);
 }
 
 void AggregatedStream::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
@@ -400,6 +406,35 @@ void AggregatedStream::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, un
 	}
 }
 
+void AggregatedStream::internalOpen(thread_db* tdbb) const
+{
+	BaseAggWinStream::internalOpen(tdbb);
+
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = getImpure(request);
+
+	impure->batchMode = false;
+
+	if (!m_batchLayout || !m_next->openBatch(tdbb))
+		return;
+
+	// MIN/MAX mapped to an index fetch a single record
+	for (const auto& aggregate : m_batchAggregates)
+	{
+		if (aggregate.node->indexed)
+			return;
+	}
+
+	if (!impure->batch)
+	{
+		MemoryPool& pool = *tdbb->getDefaultPool();
+		impure->batch = FB_NEW_POOL(pool) RecordBatch(pool, *m_batchLayout);
+		impure->aggregator = FB_NEW_POOL(pool) BatchAggregator(pool, *m_batchLayout, m_batchAggregates);
+	}
+
+	impure->batchMode = true;
+}
+
 bool AggregatedStream::internalGetRecord(thread_db* tdbb) const
 {
 	JRD_reschedule(tdbb);
@@ -414,7 +449,7 @@ bool AggregatedStream::internalGetRecord(thread_db* tdbb) const
 		return false;
 	}
 
-	if (!evaluateGroup(tdbb))
+	if (!(impure->batchMode ? evaluateBatches(tdbb) : evaluateGroup(tdbb)))
 	{
 		rpb->rpb_number.setValid(false);
 		return false;
@@ -423,3 +458,102 @@ bool AggregatedStream::internalGetRecord(thread_db* tdbb) const
 	rpb->rpb_number.setValid(true);
 	return true;
 }
+
+// Check whether the aggregation may be evaluated by batches. It's possible if every
+// aggregate supports that and has a plain field of the underlying stream as its argument,
+// and the underlying record sources are able to produce batches.
+void AggregatedStream::setupBatchMode(thread_db* tdbb, CompilerScratch* csb)
+{
+	const NestValueArray& sourceList = m_groupMap->sourceList;
+
+	for (const auto& source : sourceList)
+	{
+		if (nodeIs<LiteralNode>(source))
+			continue;
+
+		const AggNode* const aggNode = nodeAs<AggNode>(source);
+
+		if (!aggNode || aggNode->getBatchType() == AggNode::BATCH_NONE ||
+			aggNode->sort || aggNode->indexed)
+		{
+			return;
+		}
+	}
+
+	// The layout is referenced by the filters below even if the batch mode is rejected later
+	RecordBatch::Layout* const layout = FB_NEW_POOL(csb->csb_pool) RecordBatch::Layout(csb->csb_pool);
+
+	if (!m_next->setupBatch(tdbb, csb, *layout))
+		return;
+
+	for (const auto& source : sourceList)
+	{
+		const AggNode* const aggNode = nodeAs<AggNode>(source);
+
+		if (!aggNode)
+			continue;
+
+		BatchAggregator::Aggregate& aggregate = m_batchAggregates.add();
+		aggregate.node = aggNode;
+		aggregate.type = aggNode->getBatchType();
+
+		if (aggNode->arg)
+		{
+			USHORT column;
+
+			if (!layout->addField(tdbb, csb, aggNode->arg, column))
+			{
+				m_batchAggregates.clear();
+				return;
+			}
+
+			aggregate.column = column;
+		}
+	}
+
+	m_batchLayout = layout;
+}
+
+// Compute the single group of aggregates by batches. If the record sources below
+// allow that, the batches are produced and aggregated by the parallel workers.
+bool AggregatedStream::evaluateBatches(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = getImpure(request);
+
+	if (impure->state == STATE_EOF)
+		return false;
+
+	RecordBatch* const batch = impure->batch;
+	BatchAggregator* const aggregator = impure->aggregator;
+
+	try
+	{
+		aggInit(tdbb, request, m_groupMap);
+
+		ParallelBatchScan parallelScan(*tdbb->getDefaultPool());
+
+		if (parallelScan.prepare(tdbb) && m_next->setupParallelBatch(tdbb, parallelScan))
+			parallelScan.aggregate(tdbb, *m_batchLayout, m_batchAggregates);
+		else
+		{
+			aggregator->reset();
+
+			while (m_next->getBatch(tdbb, *batch))
+				aggregator->pass(*batch);
+
+			aggregator->flush(tdbb, request);
+		}
+
+		impure->state = STATE_EOF;
+
+		aggExecute(tdbb, request, m_groupMap->sourceList, m_groupMap->targetList);
+	}
+	catch (const Exception&)
+	{
+		aggFinish(tdbb, request, m_groupMap);
+		throw;
+	}
+
+	return true;
+}
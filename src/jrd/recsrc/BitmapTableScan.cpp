@@ -113,7 +113,9 @@ bool BitmapTableScan::internalGetRecord(thread_db* tdbb) const
 			if (VIO_get(tdbb, rpb, request->req_transaction, request->req_pool))
 			{
 				rpb->rpb_number.setValid(true);
-				return true;
+
+				if (checkRuntimeFilter(tdbb))
+					return true;
 			}
 		} while (bitmap->getNext());
 	}
@@ -146,6 +148,9 @@ void BitmapTableScan::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, uns
 
 	printInversion(tdbb, m_inversion, planEntry.lines, true, 1, false);
 
+	if (m_runtimeFilter)
+		m_runtimeFilter->print(planEntry.lines, 1);
+
 	planEntry.objectType = m_relation()->getObjectType();
 	planEntry.objectName = m_relation()->getName();
 
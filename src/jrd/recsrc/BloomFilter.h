@@ -0,0 +1,97 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_BLOOM_FILTER_H
+#define JRD_BLOOM_FILTER_H
+
+#include "../common/classes/array.h"
+#include "../common/classes/Hash.h"
+
+namespace Jrd
+{
+	// Bloom filter over 32-bit hash values, used as the runtime filter of hash joins.
+	// About eight bits per entry with three probes give a false positive rate of ~3%.
+	// Unset filter accepts everything.
+
+	class BloomFilter
+	{
+		static constexpr ULONG BITS_PER_HASH = 8;
+		static constexpr ULONG PROBES = 3;
+		static constexpr ULONG MIN_BITS = 64;
+		static constexpr ULONG MAX_BITS = 1 << 26;		// 8MB
+
+	public:
+		explicit BloomFilter(MemoryPool& pool)
+			: m_bits(pool)
+		{}
+
+		void init(ULONG count)
+		{
+			const FB_UINT64 wanted = (FB_UINT64) count * BITS_PER_HASH;
+
+			ULONG bits = MIN_BITS;
+			while (bits < wanted && bits < MAX_BITS)
+				bits <<= 1;
+
+			m_bits.clear();
+			m_bits.resize(bits / 64, 0);
+			m_mask = bits - 1;
+		}
+
+		void add(ULONG hash)
+		{
+			fb_assert(m_mask);
+
+			ULONG bit = Firebird::InternalHash::mix(hash), step = probeStep(hash);
+
+			for (ULONG i = 0; i < PROBES; i++, bit += step)
+				m_bits[(bit & m_mask) / 64] |= FB_UINT64(1) << (bit & 63);
+		}
+
+		bool check(ULONG hash) const noexcept
+		{
+			if (!m_mask)
+				return true;
+
+			ULONG bit = Firebird::InternalHash::mix(hash), step = probeStep(hash);
+
+			for (ULONG i = 0; i < PROBES; i++, bit += step)
+			{
+				if (!(m_bits[(bit & m_mask) / 64] & (FB_UINT64(1) << (bit & 63))))
+					return false;
+			}
+
+			return true;
+		}
+
+	private:
+		// Second hash function (double hashing), must be odd
+		static ULONG probeStep(ULONG hash) noexcept
+		{
+			hash *= 0x9e3779b1;
+			return (hash >> 15 | hash << 17) | 1;
+		}
+
+		Firebird::Array<FB_UINT64> m_bits;
+		ULONG m_mask = 0;
+	};
+
+} // namespace Jrd
+
+#endif // JRD_BLOOM_FILTER_H
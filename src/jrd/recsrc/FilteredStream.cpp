@@ -28,6 +28,7 @@
 #include "../jrd/optimizer/Optimizer.h"
 
 #include "RecordSource.h"
+#include "ParallelBatchScan.h"
 
 using namespace Firebird;
 using namespace Jrd;
@@ -101,15 +102,110 @@ bool FilteredStream::internalGetRecord(thread_db* tdbb) const
 	if (!(impure->irsb_flags & irsb_open))
 		return false;
 
-	if (evaluateBoolean(tdbb) != TriState(true))
+	while (true)
 	{
-		invalidateRecords(request);
-		return false;
+		if (evaluateBoolean(tdbb) != TriState(true))
+		{
+			invalidateRecords(request);
+			return false;
+		}
+
+		if (!m_runtimeFilter || m_runtimeFilter->check(tdbb))
+			return true;
 	}
+}
+
+bool FilteredStream::pushRuntimeFilter(RuntimeFilter* filter)
+{
+	if (m_anyBoolean)
+		return false;
+
+	// Prefer the underlying stream, so that rows are rejected as early as possible.
+	// Otherwise the filter is checked after our boolean, for rows passing it only.
+
+	if (filter->canPushDown() && m_next->pushRuntimeFilter(filter))
+		return true;
+
+	if (m_runtimeFilter)
+		return false;
+
+	StreamList streams;
+	findUsedStreams(streams);
+
+	if (!filter->isApplicable(streams))
+		return false;
 
+	m_runtimeFilter = filter;
 	return true;
 }
 
+bool FilteredStream::setupBatch(thread_db* tdbb, CompilerScratch* csb, RecordBatch::Layout& layout)
+{
+	if (!m_next->setupBatch(tdbb, csb, layout))
+		return false;
+
+	// The invariant boolean is evaluated once in internalOpen()
+	if (m_invariant)
+		return true;
+
+	m_batchFilter = BatchFilter::compile(tdbb, csb, m_boolean, layout);
+	return (m_batchFilter != nullptr);
+}
+
+bool FilteredStream::openBatch(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (m_anyBoolean)
+		return false;
+
+	if (!(impure->irsb_flags & irsb_open))
+		return true;
+
+	if (!m_next->openBatch(tdbb))
+		return false;
+
+	return !m_batchFilter || m_batchFilter->prepare(tdbb, request);
+}
+
+bool FilteredStream::setupParallelBatch(thread_db* tdbb, ParallelBatchScan& scan) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (!(impure->irsb_flags & irsb_open) || !m_next->setupParallelBatch(tdbb, scan))
+		return false;
+
+	if (m_batchFilter)
+		scan.addFilter(m_batchFilter);
+
+	return true;
+}
+
+bool FilteredStream::internalGetBatch(thread_db* tdbb, RecordBatch& batch) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (!(impure->irsb_flags & irsb_open))
+	{
+		batch.reset();
+		return false;
+	}
+
+	while (m_next->getBatch(tdbb, batch))
+	{
+		if (m_batchFilter)
+			m_batchFilter->apply(request, batch);
+
+		if (batch.selected)
+			return true;
+	}
+
+	return false;
+}
+
 bool FilteredStream::refetchRecord(thread_db* tdbb) const
 {
 	Request* const request = tdbb->getRequest();
@@ -139,6 +235,9 @@ void FilteredStream::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsi
 
 	printOptInfo(planEntry.lines);
 
+	if (m_runtimeFilter)
+		m_runtimeFilter->print(planEntry.lines, 1);
+
 	if (recurse)
 		m_next->getPlan(tdbb, planEntry.children.add(), ++level, recurse);
 }
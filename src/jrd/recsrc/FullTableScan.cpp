@@ -28,6 +28,7 @@
 #include "../jrd/Attachment.h"
 
 #include "RecordSource.h"
+#include "ParallelBatchScan.h"
 
 using namespace Firebird;
 using namespace Jrd;
@@ -148,16 +149,82 @@ bool FullTableScan::internalGetRecord(thread_db* tdbb) const
 
 	const RecordNumber* upper = impure->irsb_upper.isValid() ? &impure->irsb_upper : nullptr;
 
-	if (VIO_next_record(tdbb, rpb, request->req_transaction, request->req_pool, DPM_next_all, upper))
+	while (VIO_next_record(tdbb, rpb, request->req_transaction, request->req_pool, DPM_next_all, upper))
 	{
 		rpb->rpb_number.setValid(true);
-		return true;
+
+		if (checkRuntimeFilter(tdbb))
+			return true;
 	}
 
 	rpb->rpb_number.setValid(false);
 	return false;
 }
 
+bool FullTableScan::setupBatch(thread_db* /*tdbb*/, CompilerScratch* /*csb*/, RecordBatch::Layout& layout)
+{
+	layout.stream = m_stream;
+	return true;
+}
+
+bool FullTableScan::openBatch(thread_db* /*tdbb*/) const
+{
+	return true;
+}
+
+bool FullTableScan::setupParallelBatch(thread_db* tdbb, ParallelBatchScan& scan) const
+{
+	Request* const request = tdbb->getRequest();
+	record_param* const rpb = &request->req_rpb[m_stream];
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (!(impure->irsb_flags & irsb_open) || (impure->irsb_flags & irsb_eof) || m_dbkeyRanges.hasData())
+		return false;
+
+	scan.setRelation(tdbb, rpb->rpb_relation, (rpb->getWindow(tdbb).win_flags & WIN_large_scan));
+	return scan.isValid();
+}
+
+bool FullTableScan::internalGetBatch(thread_db* tdbb, RecordBatch& batch) const
+{
+	JRD_reschedule(tdbb);
+
+	Request* const request = tdbb->getRequest();
+	record_param* const rpb = &request->req_rpb[m_stream];
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	batch.reset();
+
+	if (!(impure->irsb_flags & irsb_open) || (impure->irsb_flags & irsb_eof))
+	{
+		rpb->rpb_number.setValid(false);
+		return false;
+	}
+
+	const RecordNumber* upper = impure->irsb_upper.isValid() ? &impure->irsb_upper : nullptr;
+
+	while (batch.count < RecordBatch::CAPACITY)
+	{
+		if (!VIO_next_record(tdbb, rpb, request->req_transaction, request->req_pool, DPM_next_all, upper))
+		{
+			impure->irsb_flags |= irsb_eof;
+			break;
+		}
+
+		batch.putRecord(tdbb, rpb->rpb_relation, rpb->rpb_record);
+	}
+
+	if (!batch.count)
+	{
+		rpb->rpb_number.setValid(false);
+		return false;
+	}
+
+	rpb->rpb_number.setValid(!(impure->irsb_flags & irsb_eof));
+	batch.selectAll();
+	return true;
+}
+
 void FullTableScan::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
 {
 	if (!level)
@@ -195,6 +262,9 @@ void FullTableScan::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsig
 		printName(tdbb, m_relation()->getName().toQuotedString(), m_alias) + " Full Scan" + bounds;
 	printOptInfo(planEntry.lines);
 
+	if (m_runtimeFilter)
+		m_runtimeFilter->print(planEntry.lines, 1);
+
 	planEntry.objectType = m_relation()->getObjectType();
 	planEntry.objectName = m_relation()->getName();
 
@@ -0,0 +1,293 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_GROUP_TABLE_H
+#define JRD_GROUP_TABLE_H
+
+#include "../common/classes/array.h"
+#include "../common/classes/Hash.h"
+#include "../jrd/TempSpace.h"
+
+namespace Jrd
+{
+	// Groups of the hash aggregation. Every group is a fixed size entry starting with
+	// the hash value followed by the binary key, the rest of the entry is up to the caller.
+	// Entries are located via an open addressing table with linear probing.
+	//
+	// Once the entries exceed the memory budget, rows of the groups not present in memory
+	// are spilled into partitions on disk (as single row entries) chosen by the next bits
+	// of the hash value. After the groups in memory are returned, the partitions are
+	// processed one by one, those still not fitting into memory are split further.
+	// Partitions of the last level cannot be split anymore and must be processed otherwise.
+
+	class GroupTable
+	{
+		static constexpr const char* SCRATCH = "fb_hashagg_";
+		static constexpr ULONG BLOCK_ENTRIES = 1024;
+		static constexpr ULONG MIN_TABLE_SIZE = 256;	// slots, must be a power of two
+		static constexpr ULONG PARTITION_BITS = 4;
+		static constexpr ULONG PARTITIONS = 1 << PARTITION_BITS;
+
+		struct Slot
+		{
+			ULONG hash;
+			ULONG entry;		// entry number + 1, zero for the empty slot
+		};
+
+		struct Partition
+		{
+			TempSpace* space;
+			FB_UINT64 count;
+			ULONG level;
+		};
+
+	public:
+		static constexpr ULONG MAX_SPILL_LEVEL = 4;
+		static constexpr ULONG SLOT_SIZE = sizeof(Slot);
+
+		GroupTable(MemoryPool& pool, ULONG entrySize, ULONG keyLength, ULONG memoryBudget)
+			: m_pool(pool),
+			  m_entrySize(entrySize),
+			  m_compareLength(sizeof(ULONG) + keyLength),
+			  m_blocks(pool),
+			  m_slots(pool),
+			  m_pending(pool)
+		{
+			// Slots of the hash table are kept at most half full
+			m_maxCount = MAX(BLOCK_ENTRIES, memoryBudget / (entrySize + 2 * SLOT_SIZE));
+			m_rowEntry = FB_NEW_POOL(pool) UCHAR[entrySize];
+			memset(m_spilled, 0, sizeof(m_spilled));
+
+			m_slots.resize(MIN_TABLE_SIZE);
+			clear();
+		}
+
+		~GroupTable()
+		{
+			for (auto block : m_blocks)
+				delete[] block;
+
+			delete[] m_rowEntry;
+
+			releaseSpilled();
+
+			for (auto& partition : m_pending)
+				delete partition.space;
+
+			delete m_input.space;
+		}
+
+		UCHAR* getRowEntry() const
+		{
+			return m_rowEntry;
+		}
+
+		ULONG getCompareLength() const
+		{
+			return m_compareLength;
+		}
+
+		// Current partition cannot be split further
+		bool isLastLevel() const
+		{
+			return m_level >= MAX_SPILL_LEVEL;
+		}
+
+		// Forget everything, the allocated memory is kept for reuse
+		void reset()
+		{
+			releaseSpilled();
+
+			for (auto& partition : m_pending)
+				delete partition.space;
+
+			m_pending.clear();
+
+			delete m_input.space;
+			m_input.space = nullptr;
+
+			m_level = 0;
+			clear();
+		}
+
+		UCHAR* find(const UCHAR* entry) const
+		{
+			const ULONG hash = *(ULONG*) entry;
+			const ULONG mask = m_slots.getCount() - 1;
+
+			for (ULONG index = Firebird::InternalHash::mix(hash) & mask; m_slots[index].entry;
+				index = (index + 1) & mask)
+			{
+				const Slot& slot = m_slots[index];
+
+				if (slot.hash == hash)
+				{
+					UCHAR* const group = getEntry(slot.entry - 1);
+
+					if (!memcmp(group, entry, m_compareLength))
+						return group;
+				}
+			}
+
+			return nullptr;
+		}
+
+		// Add the new group unless the memory budget is exhausted
+		bool add(const UCHAR* entry)
+		{
+			if (m_count >= m_maxCount)
+				return false;
+
+			if (m_count == m_blocks.getCount() * BLOCK_ENTRIES)
+				m_blocks.add(FB_NEW_POOL(m_pool) UCHAR[BLOCK_ENTRIES * m_entrySize]);
+
+			if ((m_count + 1) * 2 > m_slots.getCount())
+				grow();
+
+			memcpy(getEntry(m_count), entry, m_entrySize);
+			insertSlot(*(ULONG*) entry, ++m_count);
+
+			return true;
+		}
+
+		// Postpone the row of the group not fitting into memory
+		void spill(const UCHAR* entry)
+		{
+			fb_assert(!isLastLevel());
+
+			const ULONG shift = 32 - PARTITION_BITS * (m_level + 1);
+			const ULONG number = (Firebird::InternalHash::mix(*(ULONG*) entry) >> shift) & (PARTITIONS - 1);
+
+			Partition& partition = m_spilled[number];
+
+			if (!partition.space)
+			{
+				partition.space = FB_NEW_POOL(m_pool) TempSpace(m_pool, SCRATCH, false);
+				partition.level = m_level + 1;
+			}
+
+			partition.space->write(partition.count * m_entrySize, entry, m_entrySize);
+			partition.count++;
+		}
+
+		// Next group to be returned from memory
+		const UCHAR* fetch()
+		{
+			return (m_position < m_count) ? getEntry(m_position++) : nullptr;
+		}
+
+		// Switch to the next partition on disk, the groups in memory are discarded
+		bool startPartition()
+		{
+			for (auto& partition : m_spilled)
+			{
+				if (partition.space)
+					m_pending.push(partition);
+			}
+
+			memset(m_spilled, 0, sizeof(m_spilled));
+
+			delete m_input.space;
+			m_input.space = nullptr;
+
+			if (m_pending.isEmpty())
+				return false;
+
+			m_input = m_pending.pop();
+			m_inputPosition = 0;
+			m_level = m_input.level;
+			clear();
+
+			return true;
+		}
+
+		// Read the next row entry of the current partition
+		bool readEntry()
+		{
+			if (m_inputPosition >= m_input.count)
+				return false;
+
+			m_input.space->read(m_inputPosition * m_entrySize, m_rowEntry, m_entrySize);
+			m_inputPosition++;
+
+			return true;
+		}
+
+	private:
+		UCHAR* getEntry(ULONG number) const
+		{
+			return m_blocks[number / BLOCK_ENTRIES] + (number % BLOCK_ENTRIES) * m_entrySize;
+		}
+
+		void clear()
+		{
+			m_count = m_position = 0;
+			memset(m_slots.begin(), 0, m_slots.getCount() * sizeof(Slot));
+		}
+
+		void insertSlot(ULONG hash, ULONG entry)
+		{
+			const ULONG mask = m_slots.getCount() - 1;
+			ULONG index = Firebird::InternalHash::mix(hash) & mask;
+
+			while (m_slots[index].entry)
+				index = (index + 1) & mask;
+
+			m_slots[index].hash = hash;
+			m_slots[index].entry = entry;
+		}
+
+		void grow()
+		{
+			m_slots.resize(m_slots.getCount() * 2);
+			memset(m_slots.begin(), 0, m_slots.getCount() * sizeof(Slot));
+
+			for (ULONG i = 0; i < m_count; i++)
+				insertSlot(*(ULONG*) getEntry(i), i + 1);
+		}
+
+		void releaseSpilled()
+		{
+			for (auto& partition : m_spilled)
+				delete partition.space;
+
+			memset(m_spilled, 0, sizeof(m_spilled));
+		}
+
+		MemoryPool& m_pool;
+		const ULONG m_entrySize;
+		const ULONG m_compareLength;	// hash value and the binary key
+		ULONG m_maxCount = 0;
+
+		Firebird::Array<UCHAR*> m_blocks;
+		Firebird::Array<Slot> m_slots;
+		ULONG m_count = 0;
+		ULONG m_position = 0;
+		UCHAR* m_rowEntry = nullptr;
+
+		ULONG m_level = 0;
+		Partition m_spilled[PARTITIONS];
+		Firebird::Array<Partition> m_pending;
+		Partition m_input = {};
+		FB_UINT64 m_inputPosition = 0;
+	};
+
+} // namespace Jrd
+
+#endif // JRD_GROUP_TABLE_H
@@ -0,0 +1,576 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../common/classes/Aligner.h"
+#include "../common/classes/Hash.h"
+#include "../jrd/jrd.h"
+#include "../jrd/req.h"
+#include "../jrd/intl.h"
+#include "../jrd/align.h"
+#include "../jrd/sort.h"
+#include "../dsql/ExprNodes.h"
+#include "../jrd/evl_proto.h"
+#include "../jrd/intl_proto.h"
+#include "../jrd/mov_proto.h"
+#include "../jrd/vio_proto.h"
+
+#include "RecordSource.h"
+#include "GroupTable.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+// -------------------------------------
+// Data access: hash based aggregation
+// -------------------------------------
+
+// Every group is kept as a fixed size entry (see GroupTable) consisting of the hash value,
+// the binary key of the group values (null flag and the same key as used by the hash join
+// for every value), the group values of its first row and the partial results of the
+// aggregates in the form used by the batch aggregator.
+//
+// Partitions that cannot be split further are sorted by the binary key instead, so that
+// rows of the same group are adjacent and merged on the fly. This way the memory usage
+// stays bounded even if the hash values do not distribute the groups.
+
+static constexpr ULONG MAX_ENTRY_SIZE = 16 * 1024;			// bytes
+
+static constexpr ULONG ENTRY_ALIGNMENT = alignof(BatchAggregator::State);
+static_assert(ENTRY_ALIGNMENT <= ALLOC_ALIGNMENT, "Entries must be aligned by the memory pool");
+
+
+HashAggregatedStream::HashAggregatedStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
+			const NestValueArray* group, MapNode* map, RecordSource* next)
+	: BaseAggWinStream(tdbb, csb, stream, group, map, false, next),
+	  m_groupKeys(csb->csb_pool),
+	  m_aggregates(csb->csb_pool),
+	  m_assignments(csb->csb_pool)
+{
+	fb_assert(group && map);
+
+	// Binary keys follow the hash value, then the group values and aggregate states are placed
+
+	ULONG offset = sizeof(ULONG);
+
+	for (auto value : *group)
+	{
+		GroupKey& key = m_groupKeys.add();
+		value->getDesc(tdbb, csb, &key.desc);
+
+		const bool valid = getKeyLength(tdbb, &key.desc, key.keyLength);
+		fb_assert(valid);
+
+		key.nullOffset = offset;
+		offset += 1 + key.keyLength;
+	}
+
+	m_keyLength = offset - sizeof(ULONG);
+
+	for (auto& key : m_groupKeys)
+	{
+		fb_assert(type_alignments[key.desc.dsc_dtype] <= ENTRY_ALIGNMENT);
+
+		offset = FB_ALIGN(offset, MAX(type_alignments[key.desc.dsc_dtype], 1));
+		key.valueOffset = offset;
+		key.desc.dsc_address = nullptr;
+		offset += key.desc.dsc_length;
+	}
+
+	const NestConst<ValueExprNode>* target = map->targetList.begin();
+
+	for (const auto source : map->sourceList)
+	{
+		if (const auto aggNode = nodeAs<AggNode>(source))
+		{
+			Aggregate& aggregate = m_aggregates.add();
+			aggregate.node = aggNode;
+			aggregate.type = aggNode->getBatchType();
+
+			if (aggNode->arg && aggregate.type != AggNode::BATCH_COUNT)
+			{
+				RecordBatch::Column column;
+				column.fieldId = 0;
+				NestConst<ValueExprNode> arg = aggNode->arg;
+				arg->getDesc(tdbb, csb, &column.desc);
+				column.desc.dsc_address = nullptr;
+
+				const bool valid = RecordBatch::getDomain(&column.desc, column.domain);
+				fb_assert(valid);
+
+				aggregate.column = column;
+			}
+
+			offset = FB_ALIGN(offset, ENTRY_ALIGNMENT);
+			aggregate.stateOffset = offset;
+			offset += sizeof(BatchAggregator::State);
+		}
+		else if (!nodeIs<LiteralNode>(source))
+		{
+			for (FB_SIZE_T i = 0; i < group->getCount(); i++)
+			{
+				if (source->sameAs((*group)[i], false))
+				{
+					Assignment& assignment = m_assignments.add();
+					assignment.target = *target;
+					assignment.groupKey = i;
+					break;
+				}
+			}
+		}
+
+		++target;
+	}
+
+	m_entrySize = FB_ALIGN(offset, ENTRY_ALIGNMENT);
+}
+
+// Check whether every group value may be hashed, every mapped value is either an aggregate
+// supported by the batch aggregator or a group value, and the expected number of groups
+// fits into the memory budget. Otherwise the sorted input is aggregated.
+bool HashAggregatedStream::isApplicable(thread_db* tdbb, CompilerScratch* csb,
+	const NestValueArray* group, const MapNode* map, double groupCount)
+{
+	if (!group || group->isEmpty() || !map)
+		return false;
+
+	ULONG size = sizeof(ULONG);
+
+	for (auto value : *group)
+	{
+		dsc desc;
+		value->getDesc(tdbb, csb, &desc);
+
+		ULONG keyLength;
+		if (!getKeyLength(tdbb, &desc, keyLength))
+			return false;
+
+		size += 1 + keyLength + desc.dsc_length + type_alignments[desc.dsc_dtype];
+	}
+
+	for (const auto source : map->sourceList)
+	{
+		if (const auto aggNode = nodeAs<AggNode>(source))
+		{
+			const auto type = aggNode->getBatchType();
+
+			if (type == AggNode::BATCH_NONE || aggNode->distinct || aggNode->sort)
+				return false;
+
+			if (aggNode->arg && type != AggNode::BATCH_COUNT)
+			{
+				NestConst<ValueExprNode> arg = aggNode->arg;
+
+				dsc desc;
+				arg->getDesc(tdbb, csb, &desc);
+
+				RecordBatch::Domain domain;
+				if (!RecordBatch::getDomain(&desc, domain))
+					return false;
+			}
+
+			size += sizeof(BatchAggregator::State) + ENTRY_ALIGNMENT;
+		}
+		else if (!nodeIs<LiteralNode>(source))
+		{
+			bool found = false;
+
+			for (const auto value : *group)
+			{
+				if (source->sameAs(value, false))
+				{
+					found = true;
+					break;
+				}
+			}
+
+			if (!found)
+				return false;
+		}
+	}
+
+	// Slots of the hash table are kept at most half full
+	const double groupSize = size + 2 * GroupTable::SLOT_SIZE;
+	const ULONG memoryBudget = tdbb->getDatabase()->dbb_config->getHashAggregationMemory();
+
+	return size <= MAX_ENTRY_SIZE && groupCount * groupSize <= memoryBudget;
+}
+
+// Length of the binary key of the value, as used by the hash join
+bool HashAggregatedStream::getKeyLength(thread_db* tdbb, const dsc* desc, ULONG& keyLength)
+{
+	if (desc->isUnknown() || desc->isBlob() || desc->dsc_dtype == dtype_array)
+		return false;
+
+	keyLength = desc->isText() ? desc->getStringLength() : desc->dsc_length;
+
+	if (IS_INTL_DATA(desc))
+		keyLength = INTL_key_length(tdbb, INTL_INDEX_TYPE(desc), keyLength);
+	else if (desc->isTime())
+		keyLength = sizeof(ISC_TIME);
+	else if (desc->isTimeStamp())
+		keyLength = sizeof(ISC_TIMESTAMP);
+	else if (desc->dsc_dtype == dtype_dec64)
+		keyLength = Decimal64::getKeyLength();
+	else if (desc->dsc_dtype == dtype_dec128)
+		keyLength = Decimal128::getKeyLength();
+
+	return true;
+}
+
+void HashAggregatedStream::close(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = getImpure(request);
+
+	if (impure->irsb_flags & irsb_open)
+	{
+		delete impure->sort;
+		impure->sort = nullptr;
+
+		delete impure->table;
+		impure->table = nullptr;
+	}
+
+	BaseAggWinStream::close(tdbb);
+}
+
+void HashAggregatedStream::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
+{
+	m_next->getLegacyPlan(tdbb, plan, level);
+}
+
+void HashAggregatedStream::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const
+{
+	planEntry.className = "HashAggregatedStream";
+
+	planEntry.lines.add().text = "Hash Aggregate";
+	printOptInfo(planEntry.lines);
+
+	if (recurse)
+	{
+		++level;
+		m_next->getPlan(tdbb, planEntry.children.add(), level, recurse);
+	}
+}
+
+void HashAggregatedStream::internalOpen(thread_db* tdbb) const
+{
+	BaseAggWinStream::internalOpen(tdbb);
+
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = getImpure(request);
+
+	if (!impure->table)
+	{
+		MemoryPool& pool = *tdbb->getDefaultPool();
+		const ULONG memoryBudget = tdbb->getDatabase()->dbb_config->getHashAggregationMemory();
+		impure->table = FB_NEW_POOL(pool) GroupTable(pool, m_entrySize, m_keyLength, memoryBudget);
+	}
+	else
+		impure->table->reset();
+
+	delete impure->sort;
+	impure->sort = nullptr;
+	impure->sortedEntry = nullptr;
+
+	impure->built = false;
+}
+
+bool HashAggregatedStream::internalGetRecord(thread_db* tdbb) const
+{
+	JRD_reschedule(tdbb);
+
+	Request* const request = tdbb->getRequest();
+	record_param* const rpb = &request->req_rpb[m_stream];
+	Impure* const impure = getImpure(request);
+
+	if (!(impure->irsb_flags & irsb_open))
+	{
+		rpb->rpb_number.setValid(false);
+		return false;
+	}
+
+	GroupTable* const table = impure->table;
+	UCHAR* const rowEntry = table->getRowEntry();
+
+	if (!impure->built)
+	{
+		while (m_next->getRecord(tdbb))
+		{
+			makeEntry(tdbb, request, rowEntry);
+			insertEntry(table, rowEntry);
+		}
+
+		impure->built = true;
+	}
+
+	while (true)
+	{
+		const UCHAR* const entry = impure->sort ?
+			fetchSorted(tdbb, impure) : table->fetch();
+
+		if (entry)
+		{
+			outputGroup(tdbb, request, entry);
+
+			rpb->rpb_number.setValid(true);
+			return true;
+		}
+
+		delete impure->sort;
+		impure->sort = nullptr;
+
+		if (!table->startPartition())
+			break;
+
+		if (table->isLastLevel())
+			sortPartition(tdbb, request, impure);
+		else
+		{
+			while (table->readEntry())
+				insertEntry(table, rowEntry);
+		}
+
+		JRD_reschedule(tdbb);
+	}
+
+	rpb->rpb_number.setValid(false);
+	return false;
+}
+
+// Build the single row entry for the current record
+void HashAggregatedStream::makeEntry(thread_db* tdbb, Request* request, UCHAR* entry) const
+{
+	// Padding bytes take part in the key comparison
+	memset(entry, 0, m_entrySize);
+
+	UCHAR* keyPtr = entry + sizeof(ULONG);
+
+	for (FB_SIZE_T i = 0; i < m_groupKeys.getCount(); i++)
+	{
+		const GroupKey& key = m_groupKeys[i];
+		dsc* const desc = EVL_expr(tdbb, request, (*m_group)[i]);
+
+		if (!desc)
+		{
+			*keyPtr = 1;
+			keyPtr += 1 + key.keyLength;
+			continue;
+		}
+
+		keyPtr++;
+
+		if (desc->isText())
+		{
+			dsc to;
+			to.makeText(key.keyLength, desc->getTextType(), keyPtr);
+
+			if (IS_INTL_DATA(desc))
+			{
+				// Convert the INTL string into the binary comparable form
+				INTL_string_to_key(tdbb, INTL_INDEX_TYPE(desc), desc, &to, INTL_KEY_UNIQUE);
+			}
+			else
+			{
+				// This call ensures that the padding bytes are appended
+				MOV_move(tdbb, desc, &to, true);
+			}
+		}
+		else
+		{
+			const auto* const data = desc->dsc_address;
+
+			if (desc->isDecFloat())
+			{
+				// Values inside the key are not aligned
+				OutAligner<ULONG, MAX_DEC_KEY_LONGS> decKey(keyPtr, key.keyLength);
+
+				if (desc->dsc_dtype == dtype_dec64)
+					((Decimal64*) data)->makeKey(decKey);
+				else
+					((Decimal128*) data)->makeKey(decKey);
+			}
+			else if ((desc->dsc_dtype == dtype_real && *(float*) data == 0) ||
+				(desc->dsc_dtype == dtype_double && *(double*) data == 0))
+			{
+				// Negative zero is the same group as the positive one
+			}
+			else
+			{
+				// For date/time with time zone, only the UTC part is copied
+				fb_assert(key.keyLength <= desc->dsc_length);
+				memcpy(keyPtr, data, key.keyLength);
+			}
+		}
+
+		keyPtr += key.keyLength;
+
+		dsc value = key.desc;
+		value.dsc_address = entry + key.valueOffset;
+		MOV_move(tdbb, desc, &value);
+	}
+
+	fb_assert(ULONG(keyPtr - entry) == sizeof(ULONG) + m_keyLength);
+
+	*(ULONG*) entry = InternalHash::hash(m_keyLength, entry + sizeof(ULONG));
+
+	for (const auto& aggregate : m_aggregates)
+	{
+		auto* const state = (BatchAggregator::State*) (entry + aggregate.stateOffset);
+		BatchAggregator::initState(*state);
+
+		RecordBatch::Value value = state->value;
+
+		if (aggregate.node->arg)
+		{
+			const dsc* const desc = EVL_expr(tdbb, request, aggregate.node->arg);
+
+			if (!desc)
+				continue;
+
+			if (aggregate.column.has_value())
+				RecordBatch::makeValue(tdbb, aggregate.column.value(), desc, value);
+		}
+
+		BatchAggregator::accumulate(aggregate.type,
+			aggregate.column.has_value() ? &aggregate.column.value() : nullptr, *state, value);
+	}
+}
+
+// Merge the row entry into its group, spill it if the group is absent and cannot be added
+void HashAggregatedStream::insertEntry(GroupTable* table, const UCHAR* entry) const
+{
+	UCHAR* const group = table->find(entry);
+
+	if (!group)
+	{
+		if (!table->add(entry))
+			table->spill(entry);
+
+		return;
+	}
+
+	mergeEntry(group, entry);
+}
+
+// Merge the partial results of the aggregates
+void HashAggregatedStream::mergeEntry(UCHAR* group, const UCHAR* entry) const
+{
+	for (const auto& aggregate : m_aggregates)
+	{
+		BatchAggregator::merge(aggregate.type,
+			aggregate.column.has_value() ? &aggregate.column.value() : nullptr,
+			*(BatchAggregator::State*) (group + aggregate.stateOffset),
+			*(const BatchAggregator::State*) (entry + aggregate.stateOffset));
+	}
+}
+
+// Sort the current partition by the hash value and the binary key
+void HashAggregatedStream::sortPartition(thread_db* tdbb, Request* request, Impure* impure) const
+{
+	GroupTable* const table = impure->table;
+
+	sort_key_def key;
+	key.setSkdLength(SKD_bytes, table->getCompareLength());
+	key.skd_flags = SKD_ascending;
+	key.setSkdOffset();
+	key.skd_vary_offset = 0;
+
+	impure->sort = FB_NEW_POOL(request->req_sorts.getPool())
+		Sort(tdbb->getDatabase(), &request->req_sorts, m_entrySize, 1, 1, &key, nullptr, 0);
+
+	while (table->readEntry())
+	{
+		UCHAR* data = nullptr;
+		impure->sort->put(tdbb, reinterpret_cast<ULONG**>(&data));
+		memcpy(data, table->getRowEntry(), m_entrySize);
+	}
+
+	impure->sort->sort(tdbb);
+	impure->sort->get(tdbb, reinterpret_cast<ULONG**>(&impure->sortedEntry));
+}
+
+// Next group of the sorted partition, its rows follow each other
+const UCHAR* HashAggregatedStream::fetchSorted(thread_db* tdbb, Impure* impure) const
+{
+	UCHAR* entry = impure->sortedEntry;
+
+	if (!entry)
+		return nullptr;
+
+	GroupTable* const table = impure->table;
+	UCHAR* const group = table->getRowEntry();
+	memcpy(group, entry, m_entrySize);
+
+	// The record returned by the sort stays valid until the next one is requested
+	while (true)
+	{
+		impure->sort->get(tdbb, reinterpret_cast<ULONG**>(&entry));
+
+		if (!entry || memcmp(entry, group, table->getCompareLength()))
+			break;
+
+		mergeEntry(group, entry);
+	}
+
+	impure->sortedEntry = entry;
+	return group;
+}
+
+// Compute the aggregated record of the group
+void HashAggregatedStream::outputGroup(thread_db* tdbb, Request* request, const UCHAR* entry) const
+{
+	try
+	{
+		aggInit(tdbb, request, m_groupMap);
+
+		for (const auto& aggregate : m_aggregates)
+		{
+			BatchAggregator::flushState(tdbb, request, aggregate.node, aggregate.type,
+				aggregate.column.has_value() ? &aggregate.column.value() : nullptr,
+				*(const BatchAggregator::State*) (entry + aggregate.stateOffset));
+		}
+
+		for (const auto& assignment : m_assignments)
+		{
+			const GroupKey& key = m_groupKeys[assignment.groupKey];
+			const FieldNode* const field = nodeAs<FieldNode>(assignment.target);
+			Record* const record = request->req_rpb[field->fieldStream].rpb_record;
+
+			if (entry[key.nullOffset])
+				record->setNull(field->fieldId);
+			else
+			{
+				dsc value = key.desc;
+				value.dsc_address = const_cast<UCHAR*>(entry) + key.valueOffset;
+
+				MOV_move(tdbb, &value, EVL_assign_to(tdbb, assignment.target));
+				record->clearNull(field->fieldId);
+			}
+		}
+
+		aggExecute(tdbb, request, m_groupMap->sourceList, m_groupMap->targetList);
+	}
+	catch (const Exception&)
+	{
+		aggFinish(tdbb, request, m_groupMap);
+		throw;
+	}
+}
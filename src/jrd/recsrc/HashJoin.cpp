@@ -33,6 +33,7 @@
 #include "../jrd/optimizer/Optimizer.h"
 
 #include "RecordSource.h"
+#include "BloomFilter.h"
 
 using namespace Firebird;
 using namespace Jrd;
@@ -43,209 +44,373 @@ using namespace Jrd;
 // Data access: hash join
 // ----------------------
 
-// NS: FIXME - Why use static hash table here??? Hash table shall support dynamic resizing
-static constexpr ULONG HASH_SIZE = 1009;
-static constexpr ULONG BUCKET_PREALLOCATE_SIZE = 32;	// 256 bytes per bucket
+// The hash table is split into a fixed number of partitions (chosen by the upper bits
+// of the mixed hash value), each of them being an open addressing table with linear
+// probing. Every slot keeps the full hash value inline, so probing never touches
+// the buffered records. Rows sharing the same hash value are chained via the link
+// array indexed by the record position, thus collisions do not affect the probing.
+// Partitions are sized from the estimated stream cardinality (up to a modest limit,
+// as the estimation may be wrong) and grow independently.
+
+static constexpr ULONG HASH_PARTITION_BITS = 4;
+static constexpr ULONG HASH_PARTITIONS = 1 << HASH_PARTITION_BITS;
+static constexpr ULONG MIN_PARTITION_SIZE = 16;				// slots, must be a power of two
+static constexpr ULONG MAX_PARTITION_SIZE = 1 << 22;		// slots, limit of the pre-sizing
+static constexpr ULONG MAX_LOAD_FACTOR_PERCENT = 75;
+static constexpr ULONG MAX_PRESIZED_ROWS = 1 << 16;		// estimations above are not trusted
+static constexpr ULONG MAX_HASHED_ROWS = 1009 * 1000;		// estimated rows allowed by the optimizer
+static constexpr ULONG FILTER_SAMPLE_ROWS = 4096;			// rows checked before judging the runtime filter
+static constexpr ULONG FILTER_MIN_REJECT_PERCENT = 10;		// runtime filter is disabled below that
+
+// The runtime filter is a Bloom filter over the hash values present in all the hashed
+// streams, it's probed by the leading stream before the hash table lookup.
 
 unsigned HashJoin::maxCapacity() noexcept
 {
-	// Binary search across 1000 collisions is computationally similar to
-	// linear search across 10 collisions. We use this number as a rough
-	// estimation of whether the lookup performance is likely to be acceptable.
-	return HASH_SIZE * 1000;
+	// Lookup performance no longer depends on the number of rows, but the hash table
+	// is kept in memory (~20-40 bytes per row, depending on the load factor) and
+	// it's never spilled to disk, only the records are (by BufferedStream).
+	// So keep the previous conservative limit, larger streams are joined using
+	// the merge join or nested loops as before.
+	return MAX_HASHED_ROWS;
 }
 
 
 class HashJoin::HashTable final : public PermanentStorage
 {
-	class CollisionList
+	static constexpr ULONG END_OF_CHAIN = MAX_ULONG;
+
+	struct Slot
+	{
+		ULONG hash;
+		ULONG first;
+		ULONG last;
+	};
+
+	class Partition
 	{
-		static constexpr FB_SIZE_T INVALID_ITERATOR = FB_SIZE_T(~0);
+	public:
+		explicit Partition(MemoryPool& pool)
+			: m_slots(pool), m_count(0)
+		{}
 
-		struct Entry
+		void init(ULONG size)
 		{
-			Entry() noexcept
-				: hash(0), position(0)
-			{}
+			fb_assert(size && !(size & (size - 1)));
+			m_slots.resize(size, EMPTY_SLOT);
+		}
 
-			Entry(ULONG h, ULONG pos) noexcept
-				: hash(h), position(pos)
-			{}
+		const Slot* find(ULONG hash, ULONG mixed) const noexcept
+		{
+			const ULONG mask = m_slots.getCount() - 1;
 
-			static const ULONG generate(const Entry& item) noexcept
+			for (ULONG index = mixed & mask; ; index = (index + 1) & mask)
 			{
-				return item.hash;
+				const Slot& slot = m_slots[index];
+
+				if (slot.first == END_OF_CHAIN)
+					return nullptr;
+
+				if (slot.hash == hash)
+					return &slot;
 			}
+		}
 
-			ULONG hash;
-			ULONG position;
-		};
+		Slot* findOrInsert(ULONG hash, ULONG mixed)
+		{
+			if ((FB_UINT64) (m_count + 1) * 100 > (FB_UINT64) m_slots.getCount() * MAX_LOAD_FACTOR_PERCENT)
+				grow();
 
-	public:
-		CollisionList(MemoryPool& pool)
-			: m_collisions(pool, BUCKET_PREALLOCATE_SIZE),
-			  m_iterator(INVALID_ITERATOR)
+			const ULONG mask = m_slots.getCount() - 1;
+
+			for (ULONG index = mixed & mask; ; index = (index + 1) & mask)
+			{
+				Slot& slot = m_slots[index];
+
+				if (slot.first == END_OF_CHAIN)
+				{
+					slot.hash = hash;
+					m_count++;
+					return &slot;
+				}
+
+				if (slot.hash == hash)
+					return &slot;
+			}
+		}
+
+		ULONG getCount() const noexcept
 		{
-			m_collisions.setSortMode(FB_ARRAY_SORT_MANUAL);
+			return m_count;
 		}
 
-		void sort()
+		ULONG getSize() const noexcept
 		{
-			m_collisions.sort();
+			return m_slots.getCount();
 		}
 
-		ULONG getCount() const noexcept
+		template <typename F>
+		void forEachHash(F func) const
 		{
-			return (ULONG) m_collisions.getCount();
+			for (const auto& slot : m_slots)
+			{
+				if (slot.first != END_OF_CHAIN)
+					func(slot.hash);
+			}
 		}
 
-		void add(ULONG hash, ULONG position)
+	private:
+		void grow()
 		{
-			m_collisions.add(Entry(hash, position));
+			const ULONG oldSize = m_slots.getCount();
+
+			Array<Slot> oldSlots(m_slots.getPool());
+			oldSlots.assign(m_slots);
+
+			m_slots.clear();
+			m_slots.resize(oldSize * 2, EMPTY_SLOT);
+
+			const ULONG mask = m_slots.getCount() - 1;
+
+			for (const auto& slot : oldSlots)
+			{
+				if (slot.first == END_OF_CHAIN)
+					continue;
+
+				ULONG index = InternalHash::mix(slot.hash) & mask;
+
+				while (m_slots[index].first != END_OF_CHAIN)
+					index = (index + 1) & mask;
+
+				m_slots[index] = slot;
+			}
 		}
 
-		bool locate(ULONG hash)
+		static constexpr Slot EMPTY_SLOT = {0, END_OF_CHAIN, END_OF_CHAIN};
+
+		Array<Slot> m_slots;
+		ULONG m_count;
+	};
+
+	class StreamTable
+	{
+	public:
+		explicit StreamTable(MemoryPool& pool)
+			: m_partitions(pool), m_links(pool),
+			  m_first(END_OF_CHAIN), m_next(END_OF_CHAIN)
 		{
-			if (m_collisions.find(hash, m_iterator))
-				return true;
+			for (ULONG i = 0; i < HASH_PARTITIONS; i++)
+				m_partitions.add();
+		}
 
-			m_iterator = INVALID_ITERATOR;
-			return false;
+		void init(double cardinality)
+		{
+			// Pre-size partitions to avoid rehashing if the cardinality estimation is correct.
+			// Do not trust the estimation too much though, the table grows on demand anyway.
+
+			const ULONG rows = (ULONG) MIN(MAX(cardinality, 0.0), (double) MAX_PRESIZED_ROWS);
+			const ULONG expected = rows / HASH_PARTITIONS / MAX_LOAD_FACTOR_PERCENT * 100;
+
+			ULONG size = MIN_PARTITION_SIZE;
+			while (size < expected && size < MAX_PARTITION_SIZE)
+				size <<= 1;
+
+			for (auto& partition : m_partitions)
+				partition.init(size);
+
+			m_links.ensureCapacity(rows);
 		}
 
-		bool iterate(ULONG hash, ULONG& position) noexcept
+		void put(ULONG hash, ULONG position)
 		{
-			if (m_iterator >= m_collisions.getCount())
-				return false;
+			fb_assert(position == m_links.getCount());
 
-			const Entry& collision = m_collisions[m_iterator++];
+			const ULONG mixed = InternalHash::mix(hash);
+			Slot* const slot = m_partitions[getPartition(mixed)].findOrInsert(hash, mixed);
 
-			if (hash != collision.hash)
-			{
-				m_iterator = INVALID_ITERATOR;
+			if (slot->first == END_OF_CHAIN)
+				slot->first = position;
+			else
+				m_links[slot->last] = position;
+
+			slot->last = position;
+			m_links.add(END_OF_CHAIN);
+		}
+
+		bool locate(ULONG hash) noexcept
+		{
+			const ULONG mixed = InternalHash::mix(hash);
+			const Slot* const slot = m_partitions[getPartition(mixed)].find(hash, mixed);
+
+			m_first = m_next = slot ? slot->first : END_OF_CHAIN;
+			return (slot != nullptr);
+		}
+
+		bool contains(ULONG hash) const noexcept
+		{
+			const ULONG mixed = InternalHash::mix(hash);
+			return (m_partitions[getPartition(mixed)].find(hash, mixed) != nullptr);
+		}
+
+		ULONG getHashCount() const noexcept
+		{
+			ULONG count = 0;
+
+			for (const auto& partition : m_partitions)
+				count += partition.getCount();
+
+			return count;
+		}
+
+		void reset() noexcept
+		{
+			m_next = m_first;
+		}
+
+		bool iterate(ULONG& position) noexcept
+		{
+			if (m_next == END_OF_CHAIN)
 				return false;
-			}
 
-			position = collision.position;
+			position = m_next;
+			m_next = m_links[position];
 			return true;
 		}
 
+		const ObjectsArray<Partition>& getPartitions() const noexcept
+		{
+			return m_partitions;
+		}
+
 	private:
-		SortedArray<Entry, EmptyStorage<Entry>, ULONG, Entry> m_collisions;
-		FB_SIZE_T m_iterator;
+		static ULONG getPartition(ULONG mixed) noexcept
+		{
+			return mixed >> (32 - HASH_PARTITION_BITS);
+		}
+
+		ObjectsArray<Partition> m_partitions;
+		Array<ULONG> m_links;
+		ULONG m_first;
+		ULONG m_next;
 	};
 
 public:
-	HashTable(MemoryPool& pool, ULONG streamCount, ULONG tableSize = HASH_SIZE)
-		: PermanentStorage(pool), m_streamCount(streamCount),
-		  m_tableSize(tableSize), m_slot(0)
+	HashTable(MemoryPool& pool, ULONG streamCount)
+		: PermanentStorage(pool), m_streams(pool), m_filter(pool)
 	{
-		m_collisions = FB_NEW_POOL(pool) CollisionList*[streamCount * tableSize];
-		memset(m_collisions, 0, streamCount * tableSize * sizeof(CollisionList*));
+		for (ULONG i = 0; i < streamCount; i++)
+			m_streams.add();
 	}
 
-	~HashTable()
+	void init(ULONG stream, double cardinality)
 	{
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
-			delete m_collisions[i];
-
-		delete[] m_collisions;
+		fb_assert(stream < m_streams.getCount());
+		m_streams[stream].init(cardinality);
 	}
 
 	void put(ULONG stream, ULONG hash, ULONG position)
 	{
-		const ULONG slot = hash % m_tableSize;
-
-		fb_assert(stream < m_streamCount);
-		fb_assert(slot < m_tableSize);
-
-		CollisionList* collisions = m_collisions[stream * m_tableSize + slot];
-
-		if (!collisions)
-		{
-			collisions = FB_NEW_POOL(getPool()) CollisionList(getPool());
-			m_collisions[stream * m_tableSize + slot] = collisions;
-		}
-
-		collisions->add(hash, position);
+		fb_assert(stream < m_streams.getCount());
+		m_streams[stream].put(hash, position);
 	}
 
 	bool setup(ULONG hash)
 	{
-		const ULONG slot = hash % m_tableSize;
-
-		for (ULONG i = 0; i < m_streamCount; i++)
+		for (auto& stream : m_streams)
 		{
-			CollisionList* const collisions = m_collisions[i * m_tableSize + slot];
-
-			if (!collisions)
-				return false;
-
-			if (!collisions->locate(hash))
+			if (!stream.locate(hash))
 				return false;
 		}
 
-		m_slot = slot;
 		return true;
 	}
 
-	void reset(ULONG stream, ULONG hash)
+	void reset(ULONG stream)
 	{
-		fb_assert(stream < m_streamCount);
-
-		CollisionList* const collisions = m_collisions[stream * m_tableSize + m_slot];
-		collisions->locate(hash);
+		fb_assert(stream < m_streams.getCount());
+		m_streams[stream].reset();
 	}
 
-	bool iterate(ULONG stream, ULONG hash, ULONG& position) noexcept
+	bool iterate(ULONG stream, ULONG& position) noexcept
 	{
-		fb_assert(stream < m_streamCount);
-
-		CollisionList* const collisions = m_collisions[stream * m_tableSize + m_slot];
-		return collisions->iterate(hash, position);
+		fb_assert(stream < m_streams.getCount());
+		return m_streams[stream].iterate(position);
 	}
 
-	void sort()
+	void buildFilter()
 	{
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
+		// Only the hash values present in every stream may produce matches,
+		// so iterate through the stream having the least of them
+
+		const StreamTable* smallest = nullptr;
+		ULONG count = MAX_ULONG;
+
+		for (const auto& stream : m_streams)
 		{
-			if (const auto collisions = m_collisions[i])
-				collisions->sort();
+			const ULONG streamCount = stream.getHashCount();
+
+			if (streamCount < count)
+			{
+				smallest = &stream;
+				count = streamCount;
+			}
 		}
 
-#ifdef PRINT_HASH_TABLE
-		FB_UINT64 total = 0;
-		ULONG min = MAX_ULONG, max = 0, count = 0;
+		fb_assert(smallest);
+
+		m_filter.init(count);
 
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
+		for (const auto& partition : smallest->getPartitions())
 		{
-			CollisionList* const collisions = m_collisions[i];
-			if (!collisions)
-				continue;
-
-			const auto cnt = collisions->getCount();
-
-			if (cnt < min)
-				min = cnt;
-			if (cnt > max)
-				max = cnt;
-			total += cnt;
-			count++;
+			partition.forEachHash([&](ULONG hash)
+			{
+				for (const auto& stream : m_streams)
+				{
+					if (&stream != smallest && !stream.contains(hash))
+						return;
+				}
+
+				m_filter.add(hash);
+			});
 		}
+	}
+
+	bool checkFilter(ULONG hash) const noexcept
+	{
+		return m_filter.check(hash);
+	}
 
-		if (count)
+	void finish()
+	{
+#ifdef PRINT_HASH_TABLE
+		for (const auto& stream : m_streams)
 		{
-			printf("Hash table size %u, count %u, buckets %u, min %u, max %u, avg %u\n",
-				   m_tableSize, (ULONG) total, count, min, max, (ULONG) (total / count));
+			FB_UINT64 slots = 0, count = 0;
+			ULONG min = MAX_ULONG, max = 0;
+
+			for (const auto& partition : stream.getPartitions())
+			{
+				const auto cnt = partition.getCount();
+
+				if (cnt < min)
+					min = cnt;
+				if (cnt > max)
+					max = cnt;
+
+				count += cnt;
+				slots += partition.getSize();
+			}
+
+			printf("Hash table partitions %u, slots %" UQUADFORMAT ", hashes %" UQUADFORMAT
+				   ", min %u, max %u per partition\n",
+				   HASH_PARTITIONS, slots, count, min, max);
 		}
 #endif
 	}
 
 private:
-	const ULONG m_streamCount;
-	const ULONG m_tableSize;
-	CollisionList** m_collisions;
-	ULONG m_slot;
+	ObjectsArray<StreamTable> m_streams;
+	BloomFilter m_filter;
 };
 
 
@@ -352,6 +517,33 @@ void HashJoin::init(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 		m_args.add(sub.buffer);
 	}
 
+	// Leading rows not matching any hashed row are discarded by inner and semi joins,
+	// so try to reject them early inside the leading stream, using the runtime filter
+
+	if (m_joinType == JoinType::INNER || m_joinType == JoinType::SEMI)
+	{
+		// Keys being expressions may fail for rows rejected by the filters and joins
+		// inside the leading stream, so they're checked only on top of it
+
+		bool pushDown = true;
+
+		for (const auto key : *m_leader.keys)
+		{
+			if (!nodeIs<FieldNode>(key))
+				pushDown = false;
+		}
+
+		const auto filter = FB_NEW_POOL(csb->csb_pool) RuntimeFilter(csb->csb_pool, this, pushDown);
+
+		for (const auto key : *m_leader.keys)
+			key->collectStreams(filter->getStreams());
+
+		if (filter->getStreams().hasData() && m_leader.source->pushRuntimeFilter(filter))
+			m_filter = filter;
+		else
+			delete filter;
+	}
+
 	if (!selectivity)
 	{
 		selectivity = (m_joinType == JoinType::INNER || m_joinType == JoinType::OUTER) ?
@@ -374,6 +566,15 @@ void HashJoin::internalOpen(thread_db* tdbb) const
 	delete[] impure->irsb_leader_buffer;
 	impure->irsb_leader_buffer = nullptr;
 
+	impure->irsb_leader_hashed = false;
+
+	impure->irsb_filter_disabled = false;
+	impure->irsb_filter_checked = 0;
+	impure->irsb_filter_rejected = 0;
+
+	// The hash table is built when the first leading row arrives, the runtime
+	// filter doesn't reject anything until then
+
 	m_leader.source->open(tdbb);
 }
 
@@ -430,40 +631,19 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 			// We have something to join with, so ensure the hash table is initialized
 
 			if (!impure->irsb_hash_table && !impure->irsb_leader_buffer)
-			{
-				auto& pool = *tdbb->getDefaultPool();
-				const auto argCount = m_subs.getCount();
-
-				impure->irsb_hash_table = FB_NEW_POOL(pool) HashTable(pool, argCount);
-				impure->irsb_leader_buffer = FB_NEW_POOL(pool) UCHAR[m_leader.totalKeyLength];
+				buildHashTable(tdbb, request, impure);
 
-				UCharBuffer buffer(pool);
+			// Compute and hash the comparison keys, unless the runtime filter
+			// has already done that for this row
 
-				for (FB_SIZE_T i = 0; i < argCount; i++)
-				{
-					// Read and cache the inner streams. While doing that,
-					// hash the join condition values and populate hash tables.
-
-					m_subs[i].buffer->open(tdbb);
-
-					ULONG counter = 0;
-					const auto keyBuffer = buffer.getBuffer(m_subs[i].totalKeyLength, false);
-
-					while (m_subs[i].buffer->getRecord(tdbb))
-					{
-						const auto hash = computeHash(tdbb, request, m_subs[i], keyBuffer);
-						impure->irsb_hash_table->put(i, hash, counter++);
-					}
-				}
-
-				impure->irsb_hash_table->sort();
+			if (impure->irsb_leader_hashed)
+				impure->irsb_leader_hashed = false;
+			else
+			{
+				impure->irsb_leader_hash =
+					computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
 			}
 
-			// Compute and hash the comparison keys
-
-			impure->irsb_leader_hash =
-				computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
-
 			// Ensure the every inner stream having matches for this hash slot.
 			// Setup the hash table for the iteration through collisions.
 
@@ -533,6 +713,53 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 	return true;
 }
 
+bool HashJoin::pushRuntimeFilter(RuntimeFilter* filter)
+{
+	// Leading rows failing the filter cannot produce matching rows, whatever the join type is.
+	// But they may be rejected by this join, so expressions must not be evaluated there.
+
+	if (!filter->canPushDown())
+		return false;
+
+	StreamList streams;
+	m_leader.source->findUsedStreams(streams);
+
+	return filter->isApplicable(streams) && m_leader.source->pushRuntimeFilter(filter);
+}
+
+bool HashJoin::checkFilter(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	const auto hashTable = impure->irsb_hash_table;
+
+	if (!hashTable || impure->irsb_filter_disabled)
+		return true;
+
+	// Keep the hash for the join itself, the row is going to be joined if it passes the filter.
+	// If it's rejected by some other filter instead, the hash is recomputed for the next row.
+
+	impure->irsb_leader_hash = computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+	impure->irsb_leader_hashed = true;
+
+	const bool passed = hashTable->checkFilter(impure->irsb_leader_hash);
+
+	if (!passed)
+		impure->irsb_filter_rejected++;
+
+	// Stop checking the filter for the rest of the execution if it rejects too few rows
+	// to pay for the extra hashing of the rows that are filtered out by the scan anyway
+
+	if (++impure->irsb_filter_checked == FILTER_SAMPLE_ROWS &&
+		impure->irsb_filter_rejected * 100 < FILTER_SAMPLE_ROWS * FILTER_MIN_REJECT_PERCENT)
+	{
+		impure->irsb_filter_disabled = true;
+	}
+
+	return passed;
+}
+
 void HashJoin::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
 {
 	level++;
@@ -644,7 +871,7 @@ bool HashJoin::fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) co
 	const BufferedStream* const arg = m_subs[stream].buffer;
 
 	ULONG position;
-	if (hashTable->iterate(stream, impure->irsb_leader_hash, position))
+	if (hashTable->iterate(stream, position))
 	{
 		arg->locate(tdbb, position);
 
@@ -660,9 +887,9 @@ bool HashJoin::fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) co
 		if (stream == 0 || !fetchRecord(tdbb, impure, stream - 1))
 			return false;
 
-		hashTable->reset(stream, impure->irsb_leader_hash);
+		hashTable->reset(stream);
 
-		if (hashTable->iterate(stream, impure->irsb_leader_hash, position))
+		if (hashTable->iterate(stream, position))
 		{
 			arg->locate(tdbb, position);
 
@@ -671,3 +898,37 @@ bool HashJoin::fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) co
 		}
 	}
 }
+
+void HashJoin::buildHashTable(thread_db* tdbb, Request* request, Impure* impure) const
+{
+	auto& pool = *tdbb->getDefaultPool();
+	const auto argCount = m_subs.getCount();
+
+	impure->irsb_hash_table = FB_NEW_POOL(pool) HashTable(pool, argCount);
+	impure->irsb_leader_buffer = FB_NEW_POOL(pool) UCHAR[m_leader.totalKeyLength];
+
+	UCharBuffer buffer(pool);
+
+	for (FB_SIZE_T i = 0; i < argCount; i++)
+	{
+		// Read and cache the inner streams. While doing that,
+		// hash the join condition values and populate hash tables.
+
+		m_subs[i].buffer->open(tdbb);
+		impure->irsb_hash_table->init(i, m_subs[i].buffer->getCardinality());
+
+		ULONG counter = 0;
+		const auto keyBuffer = buffer.getBuffer(m_subs[i].totalKeyLength, false);
+
+		while (m_subs[i].buffer->getRecord(tdbb))
+		{
+			const auto hash = computeHash(tdbb, request, m_subs[i], keyBuffer);
+			impure->irsb_hash_table->put(i, hash, counter++);
+		}
+	}
+
+	if (m_filter)
+		impure->irsb_hash_table->buildFilter();
+
+	impure->irsb_hash_table->finish();
+}
@@ -347,7 +347,9 @@ bool IndexTableScan::internalGetRecord(thread_db* tdbb) const
 							rpb->rpb_number.getValue());
 
 					rpb->rpb_number.setValid(true);
-					return true;
+
+					if (checkRuntimeFilter(tdbb))
+						return true;
 				}
 			}
 
@@ -409,6 +411,9 @@ void IndexTableScan::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsi
 
 	if (m_inversion)
 		printInversion(tdbb, m_inversion, planEntry.lines, true, 2, false);
+
+	if (m_runtimeFilter)
+		m_runtimeFilter->print(planEntry.lines, 1);
 }
 
 int IndexTableScan::compareKeys(const index_desc* idx,
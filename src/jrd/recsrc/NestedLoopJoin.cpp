@@ -239,6 +239,29 @@ bool NestedLoopJoin::internalGetRecord(thread_db* tdbb) const
 	return true;
 }
 
+bool NestedLoopJoin::pushRuntimeFilter(RuntimeFilter* filter)
+{
+	// Rows of the outer stream failing the filter cannot produce matching rows,
+	// whatever the join type is. Inner streams can be filtered for inner joins only.
+	// But rows may be rejected by this join, so expressions must not be evaluated there.
+
+	if (!filter->canPushDown())
+		return false;
+
+	const auto count = (m_joinType == JoinType::INNER) ? m_args.getCount() : 1;
+
+	for (FB_SIZE_T i = 0; i < count; i++)
+	{
+		StreamList streams;
+		m_args[i]->findUsedStreams(streams);
+
+		if (filter->isApplicable(streams))
+			return m_args[i]->pushRuntimeFilter(filter);
+	}
+
+	return false;
+}
+
 void NestedLoopJoin::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
 {
 	if (m_args.hasData())
@@ -0,0 +1,457 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/jrd.h"
+#include "../jrd/req.h"
+#include "../jrd/tra.h"
+#include "../jrd/met.h"
+#include "../jrd/cch_proto.h"
+#include "../jrd/dpm_proto.h"
+#include "../jrd/tra_proto.h"
+#include "../jrd/vio_proto.h"
+#include "../jrd/Attachment.h"
+#include "../jrd/WorkerAttachment.h"
+#include "../common/Task.h"
+#include "../common/classes/ClumpletWriter.h"
+
+#include "ParallelBatchScan.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+namespace
+{
+	class BatchScanTask : public Task
+	{
+	public:
+		BatchScanTask(thread_db* tdbb, const ParallelBatchScan& scan, const RecordBatch::Layout& layout,
+				const Array<BatchAggregator::Aggregate>& aggregates)
+			: Task(),
+			  m_scan(scan),
+			  m_pool(&scan.getPool()),
+			  m_dbb(tdbb->getDatabase()),
+			  m_request(tdbb->getRequest()),
+			  m_tdbb_flags(tdbb->tdbb_flags),
+			  m_tpb(*m_pool),
+			  m_items(*m_pool),
+			  m_stop(false),
+			  m_nextPP(0)
+		{
+			ClumpletWriter tpb(ClumpletReader::Tpb, 128, isc_tpb_version3);
+			tpb.insertTag(isc_tpb_concurrency);
+			tpb.insertTag(isc_tpb_read);
+			tpb.insertBigInt(isc_tpb_at_snapshot_number, m_scan.getSnapshot());
+			m_tpb.assign(tpb.getBuffer(), tpb.getBufferLength());
+
+			const int workers = MIN((ULONG) m_scan.getWorkers(), m_scan.getPointerPages());
+
+			for (int i = 0; i < workers; i++)
+				m_items.add(FB_NEW_POOL(*m_pool) Item(this, layout, aggregates));
+		}
+
+		virtual ~BatchScanTask()
+		{
+			for (Item** p = m_items.begin(); p < m_items.end(); p++)
+				delete *p;
+		}
+
+		class Item : public Task::WorkItem
+		{
+		public:
+			Item(BatchScanTask* task, const RecordBatch::Layout& layout,
+					const Array<BatchAggregator::Aggregate>& aggregates)
+				: Task::WorkItem(task),
+				  m_inuse(false),
+				  m_tra(NULL),
+				  m_ppSequence(0),
+				  m_pool(task->m_dbb),
+				  m_batch(m_pool, layout),
+				  m_aggregator(m_pool, layout, aggregates)
+			{}
+
+			virtual ~Item()
+			{
+				if (!m_attStable)
+					return;
+
+				Attachment* att = NULL;
+				{
+					AttSyncLockGuard guard(*m_attStable->getSync(), FB_FUNCTION);
+					att = m_attStable->getHandle();
+					if (!att)
+						return;
+					fb_assert(att->att_use_count > 0);
+				}
+
+				FbLocalStatus status;
+				if (m_tra)
+				{
+					BackgroundContextHolder tdbb(att->att_database, att, &status, FB_FUNCTION);
+					TRA_commit(tdbb, m_tra, false);
+				}
+				WorkerAttachment::releaseAttachment(&status, m_attStable);
+			}
+
+			BatchScanTask* getTask() const
+			{
+				return reinterpret_cast<BatchScanTask*> (m_task);
+			}
+
+			bool init(thread_db* tdbb)
+			{
+				FbStatusVector* status = tdbb->tdbb_status_vector;
+				Attachment* att = NULL;
+
+				if (!m_attStable.hasData())
+					m_attStable = WorkerAttachment::getAttachment(status, getTask()->m_dbb);
+
+				if (m_attStable)
+					att = m_attStable->getHandle();
+
+				if (!att)
+				{
+					if (!status->hasData())
+						Arg::Gds(isc_bad_db_handle).copyTo(status);
+
+					return false;
+				}
+
+				tdbb->setDatabase(att->att_database);
+				tdbb->setAttachment(att);
+
+				if (!m_tra)
+				{
+					const UCharBuffer& tpb = getTask()->m_tpb;
+
+					try
+					{
+						WorkerContextHolder holder(tdbb, FB_FUNCTION);
+						m_tra = TRA_start(tdbb, tpb.getCount(), tpb.begin());
+					}
+					catch (const Exception& ex)
+					{
+						ex.stuffException(tdbb->tdbb_status_vector);
+						return false;
+					}
+				}
+
+				tdbb->setTransaction(m_tra);
+				return true;
+			}
+
+			// Workers allocate from their own pools, not to contend for the request pool
+			class Pool
+			{
+			public:
+				explicit Pool(Database* dbb)
+					: m_dbb(dbb), m_pool(dbb->createPool())
+				{}
+
+				~Pool()
+				{
+					m_dbb->deletePool(m_pool);
+				}
+
+				operator MemoryPool&()
+				{
+					return *m_pool;
+				}
+
+				MemoryPool* get() const
+				{
+					return m_pool;
+				}
+
+			private:
+				Database* const m_dbb;
+				MemoryPool* const m_pool;
+			};
+
+			bool m_inuse;
+			RefPtr<StableAttachmentPart> m_attStable;
+			jrd_tra* m_tra;
+			ULONG m_ppSequence;
+			Pool m_pool;
+			RecordBatch m_batch;
+			BatchAggregator m_aggregator;
+		};
+
+		bool handler(WorkItem& _item);
+		bool getWorkItem(WorkItem** pItem);
+
+		bool getResult(IStatus* status)
+		{
+			if (status)
+			{
+				status->init();
+				status->setErrors(m_status.getErrors());
+			}
+
+			return m_status.isSuccess();
+		}
+
+		int getMaxWorkers()
+		{
+			return m_items.getCount();
+		}
+
+		// Merge the partial results of all workers into the request
+		void flush(thread_db* tdbb)
+		{
+			for (Item** p = m_items.begin(); p < m_items.end(); p++)
+				(*p)->m_aggregator.flush(tdbb, m_request);
+		}
+
+	private:
+		void setError(IStatus* status, bool stopTask)
+		{
+			const bool copyStatus = (m_status.isSuccess() && status && status->getState() == IStatus::STATE_ERRORS);
+			if (!copyStatus && (!stopTask || m_stop))
+				return;
+
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			if (m_status.isSuccess() && copyStatus)
+				m_status.save(status);
+			if (stopTask)
+				m_stop = true;
+		}
+
+		const ParallelBatchScan& m_scan;
+		MemoryPool* m_pool;
+		Database* m_dbb;
+		Request* m_request;
+		const ULONG m_tdbb_flags;
+		UCharBuffer m_tpb;
+
+		Mutex m_mutex;
+		HalfStaticArray<Item*, 8> m_items;
+		StatusHolder m_status;
+
+		volatile bool m_stop;
+		ULONG m_nextPP;
+	};
+
+	bool BatchScanTask::handler(WorkItem& _item)
+	{
+		Item* item = reinterpret_cast<Item*>(&_item);
+
+		ThreadContextHolder tdbb(NULL);
+		tdbb->tdbb_flags = m_tdbb_flags;
+
+		if (!item->init(tdbb))
+		{
+			setError(tdbb->tdbb_status_vector, true);
+			return false;
+		}
+
+		WorkerContextHolder holder(tdbb, FB_FUNCTION);
+
+		record_param rpb;
+		jrd_rel* relation = NULL;
+
+		try
+		{
+			Database* dbb = tdbb->getDatabase();
+			jrd_tra* transaction = item->m_tra;
+
+			relation = MetadataCache::getVersioned<Cached::Relation>(tdbb, m_scan.getRelationId(),
+				CacheFlag::AUTOCREATE);
+			fb_assert(relation);
+
+			rpb.rpb_relation = relation;
+			rpb.rpb_record = NULL;
+
+			if (m_scan.isLargeScan())
+			{
+				rpb.getWindow(tdbb).win_flags = WIN_large_scan;
+				rpb.rpb_org_scans = getPermanent(relation)->rel_scan_count++;
+			}
+
+			rpb.rpb_number.compose(dbb->dbb_max_records, dbb->dbb_dp_per_pp, 0, 0, item->m_ppSequence);
+			rpb.rpb_number.decrement();
+
+			RecordNumber lastRecNo;
+			lastRecNo.compose(dbb->dbb_max_records, dbb->dbb_dp_per_pp, 0, 0, item->m_ppSequence + 1);
+			lastRecNo.decrement();
+
+			RecordBatch& batch = item->m_batch;
+			bool eof = false;
+
+			while (!eof && !m_stop)
+			{
+				JRD_reschedule(tdbb);
+
+				batch.reset();
+
+				while (batch.count < RecordBatch::CAPACITY)
+				{
+					if (!VIO_next_record(tdbb, &rpb, transaction, item->m_pool.get(),
+							DPM_next_pointer_page, &lastRecNo))
+					{
+						eof = true;
+						break;
+					}
+
+					batch.putRecord(tdbb, relation, rpb.rpb_record);
+				}
+
+				if (!batch.count)
+					break;
+
+				batch.selectAll();
+
+				// The filters read their constants prepared by the main thread
+				for (const auto filter : m_scan.getFilters())
+					filter->apply(m_request, batch);
+
+				item->m_aggregator.pass(batch);
+			}
+
+			delete rpb.rpb_record;
+
+			if ((rpb.getWindow(tdbb).win_flags & WIN_large_scan) && getPermanent(relation)->rel_scan_count)
+				--getPermanent(relation)->rel_scan_count;
+
+			return !m_stop;
+		}
+		catch (const Exception& ex)
+		{
+			ex.stuffException(tdbb->tdbb_status_vector);
+
+			delete rpb.rpb_record;
+
+			if (relation && (rpb.getWindow(tdbb).win_flags & WIN_large_scan) &&
+				getPermanent(relation)->rel_scan_count)
+			{
+				--getPermanent(relation)->rel_scan_count;
+			}
+		}
+
+		setError(tdbb->tdbb_status_vector, true);
+		return false;
+	}
+
+	bool BatchScanTask::getWorkItem(WorkItem** pItem)
+	{
+		Item* item = reinterpret_cast<Item*> (*pItem);
+
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		if (m_stop)
+			return false;
+
+		if (item == NULL)
+		{
+			for (Item** p = m_items.begin(); p < m_items.end(); p++)
+				if (!(*p)->m_inuse)
+				{
+					(*p)->m_inuse = true;
+					*pItem = item = *p;
+					break;
+				}
+		}
+
+		if (!item)
+			return false;
+
+		item->m_inuse = (m_nextPP < m_scan.getPointerPages());
+
+		if (item->m_inuse)
+			item->m_ppSequence = m_nextPP++;
+
+		return item->m_inuse;
+	}
+} // namespace
+
+
+// -------------------------------------
+// Data access: parallel batch pipeline
+// -------------------------------------
+
+bool ParallelBatchScan::prepare(thread_db* tdbb)
+{
+	const Database* const dbb = tdbb->getDatabase();
+	const Attachment* const attachment = tdbb->getAttachment();
+	const Request* const request = tdbb->getRequest();
+	const jrd_tra* const transaction = request->req_transaction;
+
+	m_workers = attachment->att_parallel_workers;
+
+	// Classic in single-user shutdown mode can't create additional worker attachments
+	if (m_workers < 2 || (dbb->isShutdown(shut_mode_single) && !(dbb->dbb_flags & DBB_shared)))
+		return false;
+
+	// Workers don't see the changes made by the current transaction
+	if (!transaction || (transaction->tra_flags & (TRA_system | TRA_write)))
+		return false;
+
+	if (transaction->tra_flags & TRA_read_committed)
+	{
+		// Only the statement level snapshot of the read consistency mode may be shared
+		const Request* const snapshotRequest = request->req_snapshot.m_owner;
+
+		if (!(transaction->tra_flags & TRA_read_consistency) || !snapshotRequest ||
+			(snapshotRequest->req_flags & req_update_conflict))
+		{
+			return false;
+		}
+
+		m_snapshot = snapshotRequest->req_snapshot.m_number;
+	}
+	else
+		m_snapshot = transaction->tra_snapshot_number;
+
+	return (m_snapshot != 0);
+}
+
+void ParallelBatchScan::setRelation(thread_db* tdbb, jrd_rel* relation, bool largeScan)
+{
+	// Pages of the temporary tables are private to the attachment or transaction
+	if (relation->isTemporary())
+		return;
+
+	m_relationId = relation->getId();
+	m_countPP = DPM_pointer_pages(tdbb, relation);
+	m_largeScan = largeScan;
+}
+
+void ParallelBatchScan::aggregate(thread_db* tdbb, const RecordBatch::Layout& layout,
+	const Array<BatchAggregator::Aggregate>& aggregates)
+{
+	fb_assert(isValid());
+
+	Coordinator coord(tdbb->getDatabase()->dbb_permanent);
+	BatchScanTask task(tdbb, *this, layout, aggregates);
+
+	{
+		EngineCheckout cout(tdbb, FB_FUNCTION);
+
+		FbLocalStatus local_status;
+		fb_utils::init_status(&local_status);
+
+		coord.runSync(&task);
+
+		if (!task.getResult(&local_status))
+			local_status.raise();
+	}
+
+	task.flush(tdbb);
+}
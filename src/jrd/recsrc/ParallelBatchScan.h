@@ -0,0 +1,115 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_PARALLEL_BATCH_SCAN_H
+#define JRD_PARALLEL_BATCH_SCAN_H
+
+#include "../common/classes/array.h"
+#include "../jrd/recsrc/RecordBatch.h"
+
+namespace Jrd
+{
+	class thread_db;
+	class jrd_rel;
+
+	// Batch pipeline (a full table scan with the filters above it) executed by
+	// the parallel workers on behalf of the consumer.
+	//
+	// Data pages of the relation are distributed between the workers by pointer
+	// pages. Every worker uses its own attachment and a read-only transaction
+	// started at the snapshot of the current request, decodes records into its own
+	// batch, applies the filters and accumulates the partial aggregates. They are
+	// merged into the request by the calling thread when all workers are done.
+
+	class ParallelBatchScan
+	{
+	public:
+		explicit ParallelBatchScan(MemoryPool& pool)
+			: m_pool(pool),
+			  m_filters(pool)
+		{}
+
+		// Check whether the parallel execution is allowed for the current request
+		bool prepare(thread_db* tdbb);
+
+		// Called by the record sources from the bottom up
+		void setRelation(thread_db* tdbb, jrd_rel* relation, bool largeScan);
+
+		void addFilter(const BatchFilter* filter)
+		{
+			m_filters.add(filter);
+		}
+
+		bool isValid() const
+		{
+			return m_countPP > 1;
+		}
+
+		// Evaluate the aggregates over the whole pipeline and pass the results to the request
+		void aggregate(thread_db* tdbb, const RecordBatch::Layout& layout,
+			const Firebird::Array<BatchAggregator::Aggregate>& aggregates);
+
+		MemoryPool& getPool() const
+		{
+			return m_pool;
+		}
+
+		USHORT getRelationId() const
+		{
+			return m_relationId;
+		}
+
+		ULONG getPointerPages() const
+		{
+			return m_countPP;
+		}
+
+		bool isLargeScan() const
+		{
+			return m_largeScan;
+		}
+
+		int getWorkers() const
+		{
+			return m_workers;
+		}
+
+		CommitNumber getSnapshot() const
+		{
+			return m_snapshot;
+		}
+
+		const Firebird::Array<const BatchFilter*>& getFilters() const
+		{
+			return m_filters;
+		}
+
+	private:
+		MemoryPool& m_pool;
+		Firebird::Array<const BatchFilter*> m_filters;
+		CommitNumber m_snapshot = 0;
+		int m_workers = 0;
+		USHORT m_relationId = 0;
+		ULONG m_countPP = 0;
+		bool m_largeScan = false;
+	};
+
+} // namespace
+
+#endif // JRD_PARALLEL_BATCH_SCAN_H
@@ -0,0 +1,1235 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/jrd.h"
+#include "../jrd/req.h"
+#include "../jrd/exe.h"
+#include "../dsql/ExprNodes.h"
+#include "../dsql/BoolNodes.h"
+#include "../jrd/RecordSourceNodes.h"
+#include "../common/classes/auto.h"
+#include "../jrd/evl_proto.h"
+#include "../jrd/mov_proto.h"
+
+#include "RecordBatch.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+namespace
+{
+	constexpr SINT64 TICKS_PER_DAY = NoThrowTimeStamp::ISC_TICKS_PER_DAY;
+
+	// Raw value of the SINT64 domain, the scale is not applied
+	SINT64 getInt64(const dsc* desc)
+	{
+		const UCHAR* const p = desc->dsc_address;
+
+		switch (desc->dsc_dtype)
+		{
+			case dtype_short:
+				return *(SSHORT*) p;
+
+			case dtype_long:
+			case dtype_sql_date:
+				return *(SLONG*) p;
+
+			case dtype_sql_time:
+				return *(ULONG*) p;
+
+			case dtype_int64:
+				return *(SINT64*) p;
+
+			case dtype_timestamp:
+			{
+				const ISC_TIMESTAMP* const ts = (ISC_TIMESTAMP*) p;
+				return ts->timestamp_date * TICKS_PER_DAY + ts->timestamp_time;
+			}
+
+			default:
+				fb_assert(false);
+				return 0;
+		}
+	}
+
+	bool isExactNumeric(UCHAR dtype)
+	{
+		return dtype == dtype_short || dtype == dtype_long || dtype == dtype_int64;
+	}
+
+	bool isConstant(const ValueExprNode* node)
+	{
+		return nodeIs<LiteralNode>(node) || nodeIs<ParameterNode>(node);
+	}
+
+	// Keep the selected rows that match the condition. The freshly decoded batch
+	// is evaluated over contiguous arrays into a byte mask, then the selection
+	// vector is compacted without branches.
+	template <typename Condition>
+	void filterRows(RecordBatch& batch, Condition condition)
+	{
+		ULONG selected = 0;
+
+		if (batch.dense)
+		{
+			UCHAR mask[RecordBatch::CAPACITY];
+			const ULONG count = batch.selected;
+
+			for (ULONG row = 0; row < count; row++)
+				mask[row] = condition(row);
+
+			for (ULONG row = 0; row < count; row++)
+			{
+				batch.selection[selected] = (USHORT) row;
+				selected += mask[row];
+			}
+		}
+		else
+		{
+			for (ULONG i = 0; i < batch.selected; i++)
+			{
+				const USHORT row = batch.selection[i];
+				batch.selection[selected] = row;
+				selected += condition(row);
+			}
+		}
+
+		batch.dense = batch.dense && (selected == batch.selected);
+		batch.selected = selected;
+	}
+
+	// Only operator > and >= are used, as INT128 provides nothing else
+	template <typename T>
+	void compareConstant(RecordBatch& batch, const T* values, const UCHAR* nulls, UCHAR blrOp, const T value)
+	{
+		switch (blrOp)
+		{
+			case blr_eql:
+				filterRows(batch, [=](ULONG row) { return !nulls[row] & (values[row] == value); });
+				break;
+
+			case blr_neq:
+				filterRows(batch, [=](ULONG row) { return !nulls[row] & (values[row] != value); });
+				break;
+
+			case blr_gtr:
+				filterRows(batch, [=](ULONG row) { return !nulls[row] & (values[row] > value); });
+				break;
+
+			case blr_geq:
+				filterRows(batch, [=](ULONG row) { return !nulls[row] & (values[row] >= value); });
+				break;
+
+			case blr_lss:
+				filterRows(batch, [=](ULONG row) { return !nulls[row] & (value > values[row]); });
+				break;
+
+			case blr_leq:
+				filterRows(batch, [=](ULONG row) { return !nulls[row] & (value >= values[row]); });
+				break;
+
+			default:
+				fb_assert(false);
+		}
+	}
+
+	template <typename T>
+	void compareBetween(RecordBatch& batch, const T* values, const UCHAR* nulls, const T lower, const T upper)
+	{
+		filterRows(batch, [=](ULONG row) {
+			return !nulls[row] & (values[row] >= lower) & (upper >= values[row]);
+		});
+	}
+
+	template <typename T>
+	void compareColumns(RecordBatch& batch, const T* values1, const UCHAR* nulls1,
+		const T* values2, const UCHAR* nulls2, UCHAR blrOp)
+	{
+		switch (blrOp)
+		{
+			case blr_eql:
+				filterRows(batch, [=](ULONG row) {
+					return !(nulls1[row] | nulls2[row]) & (values1[row] == values2[row]);
+				});
+				break;
+
+			case blr_neq:
+				filterRows(batch, [=](ULONG row) {
+					return !(nulls1[row] | nulls2[row]) & (values1[row] != values2[row]);
+				});
+				break;
+
+			case blr_gtr:
+				filterRows(batch, [=](ULONG row) {
+					return !(nulls1[row] | nulls2[row]) & (values1[row] > values2[row]);
+				});
+				break;
+
+			case blr_geq:
+				filterRows(batch, [=](ULONG row) {
+					return !(nulls1[row] | nulls2[row]) & (values1[row] >= values2[row]);
+				});
+				break;
+
+			case blr_lss:
+				filterRows(batch, [=](ULONG row) {
+					return !(nulls1[row] | nulls2[row]) & (values2[row] > values1[row]);
+				});
+				break;
+
+			case blr_leq:
+				filterRows(batch, [=](ULONG row) {
+					return !(nulls1[row] | nulls2[row]) & (values2[row] >= values1[row]);
+				});
+				break;
+
+			default:
+				fb_assert(false);
+		}
+	}
+
+	template <typename T>
+	ULONG findExtreme(const RecordBatch& batch, const T* values, const UCHAR* nulls, bool max)
+	{
+		ULONG result = MAX_ULONG;
+
+		for (ULONG i = 0; i < batch.selected; i++)
+		{
+			const ULONG row = batch.selection[i];
+
+			if (nulls[row])
+				continue;
+
+			if (result == MAX_ULONG ||
+				(max ? values[row] > values[result] : values[result] > values[row]))
+			{
+				result = row;
+			}
+		}
+
+		return result;
+	}
+}
+
+
+// -------------------
+// Columnar data batch
+// -------------------
+
+bool RecordBatch::Layout::addField(thread_db* tdbb, CompilerScratch* csb,
+	const ValueExprNode* node, USHORT& column)
+{
+	const auto field = nodeAs<FieldNode>(node);
+
+	if (!field || field->fieldStream != stream || field->cursorNumber.has_value())
+		return false;
+
+	for (FB_SIZE_T i = 0; i < columns.getCount(); i++)
+	{
+		if (columns[i].fieldId == field->fieldId)
+		{
+			column = (USHORT) i;
+			return true;
+		}
+	}
+
+	dsc desc;
+	const_cast<FieldNode*>(field)->getDesc(tdbb, csb, &desc);
+
+	Domain domain;
+	if (!getDomain(&desc, domain))
+		return false;
+
+	Column& newColumn = columns.add();
+	newColumn.fieldId = field->fieldId;
+	newColumn.domain = domain;
+	newColumn.desc = desc;
+	newColumn.desc.dsc_address = nullptr;
+
+	column = (USHORT) (columns.getCount() - 1);
+	return true;
+}
+
+RecordBatch::RecordBatch(MemoryPool& pool, const Layout& layout)
+	: m_layout(layout),
+	  m_data(pool)
+{
+	for (const auto& column : layout.columns)
+	{
+		ColumnData& data = m_data.add();
+		memset(&data, 0, sizeof(data));
+
+		switch (column.domain)
+		{
+			case DOMAIN_INT64:
+				data.int64s = FB_NEW_POOL(pool) SINT64[CAPACITY];
+				break;
+
+			case DOMAIN_INT128:
+				data.int128s = FB_NEW_POOL(pool) Int128[CAPACITY];
+				break;
+
+			case DOMAIN_DOUBLE:
+				data.doubles = FB_NEW_POOL(pool) double[CAPACITY];
+				break;
+		}
+
+		data.nulls = FB_NEW_POOL(pool) UCHAR[CAPACITY];
+	}
+}
+
+bool RecordBatch::getDomain(const dsc* desc, Domain& domain)
+{
+	switch (desc->dsc_dtype)
+	{
+		case dtype_short:
+		case dtype_long:
+		case dtype_int64:
+		case dtype_sql_date:
+		case dtype_sql_time:
+		case dtype_timestamp:
+			domain = DOMAIN_INT64;
+			return true;
+
+		case dtype_int128:
+			domain = DOMAIN_INT128;
+			return true;
+
+		case dtype_real:
+		case dtype_double:
+			domain = DOMAIN_DOUBLE;
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+// Decode the requested fields of the record into the next row of the batch
+void RecordBatch::putRecord(thread_db* tdbb, jrd_rel* relation, Record* record)
+{
+	fb_assert(count < CAPACITY);
+
+	for (FB_SIZE_T i = 0; i < m_layout.columns.getCount(); i++)
+	{
+		dsc desc;
+		const bool notNull = EVL_field(relation, record, m_layout.columns[i].fieldId, &desc);
+		putValue(tdbb, (USHORT) i, notNull ? &desc : nullptr);
+	}
+
+	count++;
+}
+
+void RecordBatch::putValue(thread_db* tdbb, USHORT column, const dsc* value)
+{
+	const Column& info = m_layout.columns[column];
+	ColumnData& data = m_data[column];
+	const ULONG row = count;
+
+	data.nulls[row] = value ? 0 : 1;
+
+	if (!value)
+	{
+		switch (info.domain)
+		{
+			case DOMAIN_INT64:
+				data.int64s[row] = 0;
+				break;
+
+			case DOMAIN_INT128:
+				data.int128s[row].set(SINT64(0), 0);
+				break;
+
+			case DOMAIN_DOUBLE:
+				data.doubles[row] = 0;
+				break;
+		}
+
+		return;
+	}
+
+	// Records of the older formats may store the field using another data type
+
+	Value converted;
+	makeValue(tdbb, info, value, converted);
+
+	switch (info.domain)
+	{
+		case DOMAIN_INT64:
+			data.int64s[row] = converted.int64;
+			break;
+
+		case DOMAIN_INT128:
+			data.int128s[row] = converted.int128;
+			break;
+
+		case DOMAIN_DOUBLE:
+			data.doubles[row] = converted.dbl;
+			break;
+	}
+}
+
+// Convert the not null value into the column domain
+void RecordBatch::makeValue(thread_db* tdbb, const Column& column, const dsc* desc, Value& value)
+{
+	ValueBuffer buffer;
+	dsc temp;
+
+	if (desc->dsc_dtype != column.desc.dsc_dtype || desc->dsc_scale != column.desc.dsc_scale)
+	{
+		temp = column.desc;
+		temp.dsc_address = buffer.data;
+		MOV_move(tdbb, const_cast<dsc*>(desc), &temp);
+		desc = &temp;
+	}
+
+	switch (column.desc.dsc_dtype)
+	{
+		case dtype_int128:
+			value.int128 = *(Int128*) desc->dsc_address;
+			break;
+
+		case dtype_real:
+			value.dbl = *(float*) desc->dsc_address;
+			break;
+
+		case dtype_double:
+			value.dbl = *(double*) desc->dsc_address;
+			break;
+
+		default:
+			value.int64 = getInt64(desc);
+			break;
+	}
+}
+
+// Convert the domain value back to the field data type
+void RecordBatch::makeDesc(const Column& column, const Value& value, dsc* desc, ValueBuffer& buffer)
+{
+	UCHAR* const p = buffer.data;
+
+	*desc = column.desc;
+	desc->dsc_address = p;
+
+	switch (column.desc.dsc_dtype)
+	{
+		case dtype_short:
+			*(SSHORT*) p = (SSHORT) value.int64;
+			break;
+
+		case dtype_long:
+		case dtype_sql_date:
+			*(SLONG*) p = (SLONG) value.int64;
+			break;
+
+		case dtype_sql_time:
+			*(ULONG*) p = (ULONG) value.int64;
+			break;
+
+		case dtype_int64:
+			*(SINT64*) p = value.int64;
+			break;
+
+		case dtype_timestamp:
+		{
+			SINT64 date = value.int64 / TICKS_PER_DAY;
+			SINT64 time = value.int64 % TICKS_PER_DAY;
+
+			if (time < 0)
+			{
+				time += TICKS_PER_DAY;
+				date--;
+			}
+
+			ISC_TIMESTAMP* const ts = (ISC_TIMESTAMP*) p;
+			ts->timestamp_date = (ISC_DATE) date;
+			ts->timestamp_time = (ISC_TIME) time;
+			break;
+		}
+
+		case dtype_int128:
+			*(Int128*) p = value.int128;
+			break;
+
+		case dtype_real:
+			*(float*) p = (float) value.dbl;
+			break;
+
+		case dtype_double:
+			*(double*) p = value.dbl;
+			break;
+
+		default:
+			fb_assert(false);
+	}
+}
+
+void RecordBatch::getValue(USHORT column, ULONG row, Value& value) const
+{
+	const ColumnData& data = m_data[column];
+
+	switch (m_layout.columns[column].domain)
+	{
+		case DOMAIN_INT64:
+			value.int64 = data.int64s[row];
+			break;
+
+		case DOMAIN_INT128:
+			value.int128 = data.int128s[row];
+			break;
+
+		case DOMAIN_DOUBLE:
+			value.dbl = data.doubles[row];
+			break;
+	}
+}
+
+void RecordBatch::getValue(USHORT column, ULONG row, dsc* desc, ValueBuffer& buffer) const
+{
+	Value value;
+	getValue(column, row, value);
+	makeDesc(m_layout.columns[column], value, desc, buffer);
+}
+
+ULONG RecordBatch::countNotNull(USHORT column) const
+{
+	const UCHAR* const nulls = m_data[column].nulls;
+	ULONG result = 0;
+
+	if (dense)
+	{
+		for (ULONG row = 0; row < selected; row++)
+			result += !nulls[row];
+	}
+	else
+	{
+		for (ULONG i = 0; i < selected; i++)
+			result += !nulls[selection[i]];
+	}
+
+	return result;
+}
+
+// Sum of the values up to 32 bits long, it cannot overflow within the batch
+SINT64 RecordBatch::sumInt64(USHORT column) const
+{
+	const SINT64* const values = m_data[column].int64s;
+	SINT64 result = 0;
+
+	if (dense)
+	{
+		for (ULONG row = 0; row < selected; row++)
+			result += values[row];
+	}
+	else
+	{
+		for (ULONG i = 0; i < selected; i++)
+			result += values[selection[i]];
+	}
+
+	return result;
+}
+
+// Sum of the 64-bit values. The high and low halves are summed separately
+// to stay within the native integers and combined into INT128 at the end.
+Int128 RecordBatch::sumWideInt64(USHORT column) const
+{
+	const SINT64* const values = m_data[column].int64s;
+	SINT64 high = 0;
+	FB_UINT64 low = 0;
+
+	if (dense)
+	{
+		for (ULONG row = 0; row < selected; row++)
+		{
+			high += values[row] >> 32;
+			low += (ULONG) values[row];
+		}
+	}
+	else
+	{
+		for (ULONG i = 0; i < selected; i++)
+		{
+			const SINT64 value = values[selection[i]];
+			high += value >> 32;
+			low += (ULONG) value;
+		}
+	}
+
+	Int128 result, factor, lowPart;
+	result.set(high, 0);
+	factor.set(SINT64(1) << 32, 0);
+	lowPart.set((SINT64) low, 0);
+
+	return result.mul(factor).add(lowPart);
+}
+
+// Sum of the 128-bit values, overflow is checked for every addition
+Int128 RecordBatch::sumInt128(USHORT column) const
+{
+	const Int128* const values = m_data[column].int128s;
+	Int128 result;
+	result.set(SINT64(0), 0);
+
+	for (ULONG i = 0; i < selected; i++)
+		result = result.add(values[selection[i]]);
+
+	return result;
+}
+
+double RecordBatch::sumDouble(USHORT column) const
+{
+	const double* const values = m_data[column].doubles;
+	double result = 0;
+
+	if (dense)
+	{
+		for (ULONG row = 0; row < selected; row++)
+			result += values[row];
+	}
+	else
+	{
+		for (ULONG i = 0; i < selected; i++)
+			result += values[selection[i]];
+	}
+
+	return result;
+}
+
+// Row of the minimal or maximal non-null value, MAX_ULONG if there is none
+ULONG RecordBatch::findMinMax(USHORT column, bool max) const
+{
+	const ColumnData& data = m_data[column];
+
+	switch (m_layout.columns[column].domain)
+	{
+		case DOMAIN_INT64:
+			return findExtreme(*this, data.int64s, data.nulls, max);
+
+		case DOMAIN_INT128:
+			return findExtreme(*this, data.int128s, data.nulls, max);
+
+		case DOMAIN_DOUBLE:
+			return findExtreme(*this, data.doubles, data.nulls, max);
+	}
+
+	return MAX_ULONG;
+}
+
+
+// ------------------------------------
+// Aggregates accumulated over batches
+// ------------------------------------
+
+BatchAggregator::BatchAggregator(MemoryPool& pool, const RecordBatch::Layout& layout,
+	const Array<Aggregate>& aggregates)
+	: m_layout(layout),
+	  m_aggregates(aggregates),
+	  m_states(pool, aggregates.getCount())
+{
+	m_states.resize(aggregates.getCount());
+	reset();
+}
+
+void BatchAggregator::reset()
+{
+	for (auto& state : m_states)
+		initState(state);
+}
+
+// Accumulate the selected rows of the batch
+void BatchAggregator::pass(const RecordBatch& batch)
+{
+	for (FB_SIZE_T i = 0; i < m_aggregates.getCount(); i++)
+	{
+		const Aggregate& aggregate = m_aggregates[i];
+		State& state = m_states[i];
+
+		if (!aggregate.column.has_value())
+		{
+			state.count += batch.selected;
+			continue;
+		}
+
+		const USHORT column = aggregate.column.value();
+		const RecordBatch::Column& info = m_layout.columns[column];
+
+		State partial;
+		partial.count = batch.countNotNull(column);
+
+		if (!partial.count)
+			continue;
+
+		switch (aggregate.type)
+		{
+			case AggNode::BATCH_COUNT:
+				break;
+
+			case AggNode::BATCH_SUM:
+				switch (info.domain)
+				{
+					case RecordBatch::DOMAIN_INT64:
+						if (info.desc.dsc_dtype == dtype_int64)
+							partial.value.int128 = batch.sumWideInt64(column);
+						else
+							partial.value.int128.set(batch.sumInt64(column), 0);
+						break;
+
+					case RecordBatch::DOMAIN_INT128:
+						partial.value.int128 = batch.sumInt128(column);
+						break;
+
+					case RecordBatch::DOMAIN_DOUBLE:
+						partial.value.dbl = batch.sumDouble(column);
+						break;
+				}
+				break;
+
+			case AggNode::BATCH_MIN:
+			case AggNode::BATCH_MAX:
+			{
+				const bool max = (aggregate.type == AggNode::BATCH_MAX);
+				batch.getValue(column, batch.findMinMax(column, max), partial.value);
+				break;
+			}
+
+			default:
+				fb_assert(false);
+		}
+
+		merge(aggregate.type, &info, state, partial);
+	}
+}
+
+// Pass the accumulated results to the aggregates of the request and start over
+void BatchAggregator::flush(thread_db* tdbb, Request* request)
+{
+	for (FB_SIZE_T i = 0; i < m_aggregates.getCount(); i++)
+	{
+		const Aggregate& aggregate = m_aggregates[i];
+		const RecordBatch::Column* const info = aggregate.column.has_value() ?
+			&m_layout.columns[aggregate.column.value()] : nullptr;
+
+		flushState(tdbb, request, aggregate.node, aggregate.type, info, m_states[i]);
+	}
+
+	reset();
+}
+
+void BatchAggregator::initState(State& state)
+{
+	state.count = 0;
+	state.value.int64 = 0;
+	state.value.int128.set(SINT64(0), 0);
+	state.value.dbl = 0;
+}
+
+// Add a single not null value, column is absent for COUNT(*)
+void BatchAggregator::accumulate(AggNode::BatchType type, const RecordBatch::Column* column,
+	State& state, const RecordBatch::Value& value)
+{
+	State single;
+	single.count = 1;
+	single.value = value;
+
+	if (type == AggNode::BATCH_SUM && column && column->domain == RecordBatch::DOMAIN_INT64)
+		single.value.int128.set(value.int64, 0);
+
+	merge(type, column, state, single);
+}
+
+// Combine two partial results of the same aggregate
+void BatchAggregator::merge(AggNode::BatchType type, const RecordBatch::Column* column,
+	State& target, const State& source)
+{
+	if (!source.count)
+		return;
+
+	const bool first = (target.count == 0);
+	target.count += source.count;
+
+	if (!column)
+		return;
+
+	switch (type)
+	{
+		case AggNode::BATCH_COUNT:
+			break;
+
+		case AggNode::BATCH_SUM:
+			// Exact sums are accumulated as INT128
+			if (column->domain == RecordBatch::DOMAIN_DOUBLE)
+				target.value.dbl += source.value.dbl;
+			else
+				target.value.int128 = target.value.int128.add(source.value.int128);
+			break;
+
+		case AggNode::BATCH_MIN:
+		case AggNode::BATCH_MAX:
+		{
+			const bool max = (type == AggNode::BATCH_MAX);
+			const RecordBatch::Value& value = source.value;
+			RecordBatch::Value& current = target.value;
+
+			switch (column->domain)
+			{
+				case RecordBatch::DOMAIN_INT64:
+					if (first || (max ? value.int64 > current.int64 : current.int64 > value.int64))
+						current.int64 = value.int64;
+					break;
+
+				case RecordBatch::DOMAIN_INT128:
+					if (first || (max ? value.int128 > current.int128 : current.int128 > value.int128))
+						current.int128 = value.int128;
+					break;
+
+				case RecordBatch::DOMAIN_DOUBLE:
+					if (first || (max ? value.dbl > current.dbl : current.dbl > value.dbl))
+						current.dbl = value.dbl;
+					break;
+			}
+			break;
+		}
+
+		default:
+			fb_assert(false);
+	}
+}
+
+// Pass the partial result to the aggregate of the request
+void BatchAggregator::flushState(thread_db* tdbb, Request* request, const AggNode* aggNode,
+	AggNode::BatchType type, const RecordBatch::Column* column, const State& state)
+{
+	if (!state.count)
+		return;
+
+	if (!column)
+	{
+		aggNode->aggPassBatch(tdbb, request, nullptr, nullptr, state.count);
+		return;
+	}
+
+	dsc partial;
+	RecordBatch::ValueBuffer buffer;
+	RecordBatch::Value value = state.value;
+
+	switch (type)
+	{
+		case AggNode::BATCH_COUNT:
+			aggNode->aggPassBatch(tdbb, request, &column->desc, nullptr, state.count);
+			break;
+
+		case AggNode::BATCH_SUM:
+			// Exact sums are passed as INT128, the aggregate checks
+			// whether the result fits into its own data type
+			if (column->domain == RecordBatch::DOMAIN_DOUBLE)
+				partial.makeDouble(&value.dbl);
+			else
+			{
+				partial.makeInt128(column->desc.dsc_scale, &value.int128);
+				partial.dsc_sub_type = column->desc.dsc_sub_type;
+			}
+
+			aggNode->aggPassBatch(tdbb, request, &column->desc, &partial, state.count);
+			break;
+
+		case AggNode::BATCH_MIN:
+		case AggNode::BATCH_MAX:
+			RecordBatch::makeDesc(*column, value, &partial, buffer);
+			aggNode->aggPassBatch(tdbb, request, &column->desc, &partial, state.count);
+			break;
+
+		default:
+			fb_assert(false);
+	}
+}
+
+
+// --------------------------
+// Filter evaluated by batches
+// --------------------------
+
+BatchFilter* BatchFilter::compile(thread_db* tdbb, CompilerScratch* csb,
+	const BoolExprNode* boolean, RecordBatch::Layout& layout)
+{
+	AutoPtr<BatchFilter> filter(FB_NEW_POOL(csb->csb_pool) BatchFilter(csb->csb_pool, layout));
+
+	if (!filter->addPredicate(tdbb, csb, boolean, layout, false))
+		return nullptr;
+
+	filter->m_impure = csb->allocImpure<Impure>();
+	filter->m_constants = csb->allocImpure(alignof(Constant),
+		sizeof(Constant) * 2 * filter->m_predicates.getCount());
+
+	return filter.release();
+}
+
+bool BatchFilter::addPredicate(thread_db* tdbb, CompilerScratch* csb, const BoolExprNode* node,
+	RecordBatch::Layout& layout, bool negated)
+{
+	if (const auto binaryNode = nodeAs<BinaryBoolNode>(node))
+	{
+		return binaryNode->blrOp == blr_and && !negated &&
+			addPredicate(tdbb, csb, binaryNode->arg1, layout, false) &&
+			addPredicate(tdbb, csb, binaryNode->arg2, layout, false);
+	}
+
+	if (const auto notNode = nodeAs<NotBoolNode>(node))
+		return !negated && addPredicate(tdbb, csb, notNode->arg, layout, true);
+
+	Predicate predicate;
+	predicate.blrOp = 0;
+	predicate.column = predicate.column2 = 0;
+	predicate.value1 = predicate.value2 = nullptr;
+
+	if (const auto missingNode = nodeAs<MissingBoolNode>(node))
+	{
+		if (!layout.addField(tdbb, csb, missingNode->arg, predicate.column))
+			return false;
+
+		predicate.type = negated ? PRED_NOT_NULL : PRED_NULL;
+		m_predicates.add(predicate);
+		return true;
+	}
+
+	const auto cmpNode = nodeAs<ComparativeBoolNode>(node);
+
+	if (!cmpNode)
+		return false;
+
+	UCHAR blrOp = cmpNode->blrOp;
+
+	switch (blrOp)
+	{
+		case blr_eql:
+		case blr_neq:
+		case blr_gtr:
+		case blr_geq:
+		case blr_lss:
+		case blr_leq:
+			break;
+
+		case blr_between:
+			if (negated)
+				return false;
+
+			if (!layout.addField(tdbb, csb, cmpNode->arg1, predicate.column) ||
+				!isConstant(cmpNode->arg2) || !isConstant(cmpNode->arg3))
+			{
+				return false;
+			}
+
+			predicate.type = PRED_BETWEEN;
+			predicate.value1 = cmpNode->arg2;
+			predicate.value2 = cmpNode->arg3;
+			m_predicates.add(predicate);
+			return true;
+
+		default:
+			return false;
+	}
+
+	// NOT (a < b) is TRUE exactly when (a >= b) is TRUE
+
+	if (negated)
+	{
+		switch (blrOp)
+		{
+			case blr_eql: blrOp = blr_neq; break;
+			case blr_neq: blrOp = blr_eql; break;
+			case blr_gtr: blrOp = blr_leq; break;
+			case blr_geq: blrOp = blr_lss; break;
+			case blr_lss: blrOp = blr_geq; break;
+			case blr_leq: blrOp = blr_gtr; break;
+		}
+	}
+
+	const ValueExprNode* arg1 = cmpNode->arg1;
+	const ValueExprNode* arg2 = cmpNode->arg2;
+
+	if (isConstant(arg1))
+	{
+		std::swap(arg1, arg2);
+
+		switch (blrOp)
+		{
+			case blr_gtr: blrOp = blr_lss; break;
+			case blr_geq: blrOp = blr_leq; break;
+			case blr_lss: blrOp = blr_gtr; break;
+			case blr_leq: blrOp = blr_geq; break;
+		}
+	}
+
+	if (!layout.addField(tdbb, csb, arg1, predicate.column))
+		return false;
+
+	predicate.blrOp = blrOp;
+
+	if (isConstant(arg2))
+	{
+		predicate.type = PRED_COMPARE;
+		predicate.value1 = arg2;
+	}
+	else
+	{
+		if (!layout.addField(tdbb, csb, arg2, predicate.column2))
+			return false;
+
+		// Columns must be comparable without conversions
+
+		const auto& column1 = layout.columns[predicate.column];
+		const auto& column2 = layout.columns[predicate.column2];
+
+		if (column1.domain != column2.domain)
+			return false;
+
+		if (column1.domain == RecordBatch::DOMAIN_INT64)
+		{
+			const UCHAR dtype1 = column1.desc.dsc_dtype;
+			const UCHAR dtype2 = column2.desc.dsc_dtype;
+
+			if (isExactNumeric(dtype1) && isExactNumeric(dtype2))
+			{
+				if (column1.desc.dsc_scale != column2.desc.dsc_scale)
+					return false;
+			}
+			else if (dtype1 != dtype2)
+				return false;
+		}
+		else if (column1.domain == RecordBatch::DOMAIN_INT128)
+		{
+			if (column1.desc.dsc_scale != column2.desc.dsc_scale)
+				return false;
+		}
+
+		predicate.type = PRED_COMPARE_COLUMNS;
+	}
+
+	m_predicates.add(predicate);
+	return true;
+}
+
+bool BatchFilter::prepare(thread_db* tdbb, Request* request) const
+{
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+	Constant* const constants = request->getImpure<Constant>(m_constants);
+
+	impure->empty = false;
+
+	for (FB_SIZE_T i = 0; i < m_predicates.getCount(); i++)
+	{
+		const Predicate& predicate = m_predicates[i];
+		const ValueExprNode* const values[2] = {predicate.value1, predicate.value2};
+
+		for (unsigned j = 0; j < 2; j++)
+		{
+			if (!values[j])
+				continue;
+
+			const dsc* const desc = EVL_expr(tdbb, request, values[j]);
+
+			// Comparison with NULL is never TRUE
+			if (!desc)
+			{
+				impure->empty = true;
+				continue;
+			}
+
+			if (!convertConstant(tdbb, m_layout.columns[predicate.column], desc, constants[i * 2 + j]))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+// Convert the constant into the column domain, so that the comparison gives
+// the same result as MOV_compare() would. Inexact conversions are rejected.
+bool BatchFilter::convertConstant(thread_db* tdbb, const RecordBatch::Column& column,
+	const dsc* value, Constant& constant) const
+{
+	switch (column.domain)
+	{
+		case RecordBatch::DOMAIN_INT64:
+			if (!isExactNumeric(column.desc.dsc_dtype))
+			{
+				// Dates and times are comparable with the same data type only
+				if (value->dsc_dtype != column.desc.dsc_dtype)
+					return false;
+
+				constant.int64 = getInt64(value);
+				return true;
+			}
+
+			if (!isExactNumeric(value->dsc_dtype))
+				return false;
+			else
+			{
+				SINT64 number = getInt64(value);
+				const int shift = value->dsc_scale - column.desc.dsc_scale;
+
+				if (shift > 18 || shift < -18)
+					return false;
+
+				SINT64 factor = 1;
+				for (int n = (shift > 0 ? shift : -shift); n; n--)
+					factor *= 10;
+
+				if (shift > 0)
+				{
+					if (number > MAX_SINT64 / factor || number < MIN_SINT64 / factor)
+						return false;
+
+					number *= factor;
+				}
+				else if (shift < 0)
+				{
+					if (number % factor)
+						return false;
+
+					number /= factor;
+				}
+
+				constant.int64 = number;
+				return true;
+			}
+
+		case RecordBatch::DOMAIN_INT128:
+			if (!isExactNumeric(value->dsc_dtype) && value->dsc_dtype != dtype_int128)
+				return false;
+
+			if (value->dsc_scale != column.desc.dsc_scale)
+				return false;
+
+			constant.int128 = MOV_get_int128(tdbb, value, value->dsc_scale);
+			return true;
+
+		case RecordBatch::DOMAIN_DOUBLE:
+			if (!isExactNumeric(value->dsc_dtype) && value->dsc_dtype != dtype_int128 &&
+				value->dsc_dtype != dtype_real && value->dsc_dtype != dtype_double)
+			{
+				return false;
+			}
+
+			constant.dbl = MOV_get_double(tdbb, value);
+
+			// REAL is compared with anything but DOUBLE PRECISION as REAL
+			if (column.desc.dsc_dtype == dtype_real && value->dsc_dtype != dtype_double)
+				constant.dbl = (float) constant.dbl;
+
+			return true;
+	}
+
+	return false;
+}
+
+void BatchFilter::apply(Request* request, RecordBatch& batch) const
+{
+	const Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (impure->empty)
+	{
+		batch.selected = 0;
+		return;
+	}
+
+	const Constant* const constants = request->getImpure<Constant>(m_constants);
+
+	for (FB_SIZE_T i = 0; i < m_predicates.getCount() && batch.selected; i++)
+	{
+		const Predicate& predicate = m_predicates[i];
+		const USHORT column = predicate.column;
+		const RecordBatch::Domain domain = m_layout.columns[column].domain;
+		const UCHAR* const nulls = batch.getNulls(column);
+		const Constant& value1 = constants[i * 2];
+		const Constant& value2 = constants[i * 2 + 1];
+
+		switch (predicate.type)
+		{
+			case PRED_NULL:
+				filterRows(batch, [=](ULONG row) { return nulls[row] != 0; });
+				break;
+
+			case PRED_NOT_NULL:
+				filterRows(batch, [=](ULONG row) { return nulls[row] == 0; });
+				break;
+
+			case PRED_COMPARE:
+				switch (domain)
+				{
+					case RecordBatch::DOMAIN_INT64:
+						compareConstant(batch, batch.getInt64s(column), nulls, predicate.blrOp, value1.int64);
+						break;
+
+					case RecordBatch::DOMAIN_INT128:
+						compareConstant(batch, batch.getInt128s(column), nulls, predicate.blrOp, value1.int128);
+						break;
+
+					case RecordBatch::DOMAIN_DOUBLE:
+						compareConstant(batch, batch.getDoubles(column), nulls, predicate.blrOp, value1.dbl);
+						break;
+				}
+				break;
+
+			case PRED_BETWEEN:
+				switch (domain)
+				{
+					case RecordBatch::DOMAIN_INT64:
+						compareBetween(batch, batch.getInt64s(column), nulls, value1.int64, value2.int64);
+						break;
+
+					case RecordBatch::DOMAIN_INT128:
+						compareBetween(batch, batch.getInt128s(column), nulls, value1.int128, value2.int128);
+						break;
+
+					case RecordBatch::DOMAIN_DOUBLE:
+						compareBetween(batch, batch.getDoubles(column), nulls, value1.dbl, value2.dbl);
+						break;
+				}
+				break;
+
+			case PRED_COMPARE_COLUMNS:
+			{
+				const USHORT column2 = predicate.column2;
+				const UCHAR* const nulls2 = batch.getNulls(column2);
+
+				switch (domain)
+				{
+					case RecordBatch::DOMAIN_INT64:
+						compareColumns(batch, batch.getInt64s(column), nulls,
+							batch.getInt64s(column2), nulls2, predicate.blrOp);
+						break;
+
+					case RecordBatch::DOMAIN_INT128:
+						compareColumns(batch, batch.getInt128s(column), nulls,
+							batch.getInt128s(column2), nulls2, predicate.blrOp);
+						break;
+
+					case RecordBatch::DOMAIN_DOUBLE:
+						compareColumns(batch, batch.getDoubles(column), nulls,
+							batch.getDoubles(column2), nulls2, predicate.blrOp);
+						break;
+				}
+				break;
+			}
+		}
+	}
+}
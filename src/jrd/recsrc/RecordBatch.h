@@ -0,0 +1,286 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_RECORD_BATCH_H
+#define JRD_RECORD_BATCH_H
+
+#include "../common/classes/array.h"
+#include "../common/dsc.h"
+#include "../common/Int128.h"
+#include "../dsql/Nodes.h"
+#include <optional>
+
+namespace Jrd
+{
+	class thread_db;
+	class Request;
+	class CompilerScratch;
+	class BoolExprNode;
+	class ValueExprNode;
+	class jrd_rel;
+	class Record;
+
+	// Columnar batch of field values used by the vectorized execution mode.
+	//
+	// The batch mode is engaged by a consumer (currently an aggregation without
+	// GROUP BY) if all record sources below it are able to produce batches.
+	// The table scan decodes up to CAPACITY records into per-column arrays,
+	// filters shrink the selection vector and the consumer processes the selected
+	// rows in tight loops. Everything else is executed row by row, as usual.
+
+	class RecordBatch
+	{
+	public:
+		static constexpr ULONG CAPACITY = 1024;
+
+		// Value domains. Exact numerics up to 64 bits, dates, times and timestamps
+		// (as ticks since the beginning of the calendar) share the SINT64 domain.
+		enum Domain : UCHAR
+		{
+			DOMAIN_INT64,
+			DOMAIN_INT128,
+			DOMAIN_DOUBLE
+		};
+
+		struct Column
+		{
+			USHORT fieldId;
+			Domain domain;
+			dsc desc;			// field descriptor, without address
+		};
+
+		// Columns requested by the consumer and the filters in between
+		class Layout
+		{
+		public:
+			explicit Layout(MemoryPool& pool)
+				: columns(pool)
+			{}
+
+			bool addField(thread_db* tdbb, CompilerScratch* csb, const ValueExprNode* node, USHORT& column);
+
+			StreamType stream = INVALID_STREAM;
+			Firebird::Array<Column> columns;
+		};
+
+		// Storage for a single value converted back to the field data type
+		struct ValueBuffer
+		{
+			alignas(Firebird::Int128) UCHAR data[sizeof(Firebird::Int128)];
+		};
+
+		// Single value of the column domain
+		struct Value
+		{
+			SINT64 int64;
+			Firebird::Int128 int128;
+			double dbl;
+		};
+
+		RecordBatch(MemoryPool& pool, const Layout& layout);
+
+		static bool getDomain(const dsc* desc, Domain& domain);
+		static void makeValue(thread_db* tdbb, const Column& column, const dsc* desc, Value& value);
+		static void makeDesc(const Column& column, const Value& value, dsc* desc, ValueBuffer& buffer);
+
+		const Layout& getLayout() const
+		{
+			return m_layout;
+		}
+
+		void reset()
+		{
+			count = selected = 0;
+			dense = true;
+		}
+
+		void selectAll()
+		{
+			for (ULONG i = 0; i < count; i++)
+				selection[i] = (USHORT) i;
+
+			selected = count;
+			dense = true;
+		}
+
+		void putRecord(thread_db* tdbb, jrd_rel* relation, Record* record);
+		void getValue(USHORT column, ULONG row, Value& value) const;
+		void getValue(USHORT column, ULONG row, dsc* desc, ValueBuffer& buffer) const;
+
+		SINT64* getInt64s(USHORT column) const
+		{
+			return m_data[column].int64s;
+		}
+
+		Firebird::Int128* getInt128s(USHORT column) const
+		{
+			return m_data[column].int128s;
+		}
+
+		double* getDoubles(USHORT column) const
+		{
+			return m_data[column].doubles;
+		}
+
+		UCHAR* getNulls(USHORT column) const
+		{
+			return m_data[column].nulls;
+		}
+
+		// Aggregation kernels over the selected rows
+
+		ULONG countNotNull(USHORT column) const;
+		SINT64 sumInt64(USHORT column) const;
+		Firebird::Int128 sumWideInt64(USHORT column) const;
+		Firebird::Int128 sumInt128(USHORT column) const;
+		double sumDouble(USHORT column) const;
+		ULONG findMinMax(USHORT column, bool max) const;
+
+	private:
+		void putValue(thread_db* tdbb, USHORT column, const dsc* value);
+
+		struct ColumnData
+		{
+			SINT64* int64s;
+			Firebird::Int128* int128s;
+			double* doubles;
+			UCHAR* nulls;			// null values are zeroed in the value arrays
+		};
+
+		const Layout& m_layout;
+		Firebird::Array<ColumnData> m_data;
+
+	public:
+		ULONG count = 0;				// decoded rows
+		ULONG selected = 0;				// rows in the selection vector
+		bool dense = true;				// selection vector is 0 .. count - 1
+		USHORT selection[CAPACITY];
+	};
+
+	// Partial results of the aggregates evaluated by batches. They're accumulated
+	// within the column domains over any number of batches and passed to the
+	// aggregate nodes by flush(). Parallel workers have their own aggregators
+	// which are flushed into the request by the main thread. The state helpers
+	// are also used by the hash aggregation to keep the per-group results.
+
+	class BatchAggregator
+	{
+	public:
+		// Aggregate evaluated by batches, column is absent for COUNT(*)
+		struct Aggregate
+		{
+			const AggNode* node;
+			AggNode::BatchType type;
+			std::optional<USHORT> column;
+		};
+
+		BatchAggregator(MemoryPool& pool, const RecordBatch::Layout& layout,
+			const Firebird::Array<Aggregate>& aggregates);
+
+		struct State
+		{
+			SINT64 count;				// non-null values
+			RecordBatch::Value value;	// sum or the current minimum / maximum
+		};
+
+		void reset();
+		void pass(const RecordBatch& batch);
+		void flush(thread_db* tdbb, Request* request);
+
+		static void initState(State& state);
+		static void accumulate(AggNode::BatchType type, const RecordBatch::Column* column,
+			State& state, const RecordBatch::Value& value);
+		static void merge(AggNode::BatchType type, const RecordBatch::Column* column,
+			State& target, const State& source);
+		static void flushState(thread_db* tdbb, Request* request, const AggNode* aggNode,
+			AggNode::BatchType type, const RecordBatch::Column* column, const State& state);
+
+	private:
+		const RecordBatch::Layout& m_layout;
+		const Firebird::Array<Aggregate>& m_aggregates;
+		Firebird::Array<State> m_states;
+	};
+
+	// Conjunction of simple predicates evaluated over a batch:
+	// comparisons of a column with a constant or another column of the same domain,
+	// BETWEEN and IS [NOT] NULL.
+
+	class BatchFilter
+	{
+	public:
+		static BatchFilter* compile(thread_db* tdbb, CompilerScratch* csb,
+			const BoolExprNode* boolean, RecordBatch::Layout& layout);
+
+		// Evaluate the constants for the current execution.
+		// Returns false if they cannot be compared within the column domains exactly.
+		bool prepare(thread_db* tdbb, Request* request) const;
+
+		void apply(Request* request, RecordBatch& batch) const;
+
+	private:
+		enum PredicateType : UCHAR
+		{
+			PRED_COMPARE,			// column <op> constant
+			PRED_COMPARE_COLUMNS,	// column <op> column
+			PRED_BETWEEN,			// column BETWEEN constant AND constant
+			PRED_NULL,
+			PRED_NOT_NULL
+		};
+
+		struct Predicate
+		{
+			PredicateType type;
+			UCHAR blrOp;
+			USHORT column;
+			USHORT column2;
+			const ValueExprNode* value1;
+			const ValueExprNode* value2;
+		};
+
+		struct Constant
+		{
+			SINT64 int64;
+			Firebird::Int128 int128;
+			double dbl;
+		};
+
+		struct Impure
+		{
+			bool empty;				// NULL constant, nothing may pass
+		};
+
+		BatchFilter(MemoryPool& pool, const RecordBatch::Layout& layout)
+			: m_layout(layout),
+			  m_predicates(pool)
+		{}
+
+		bool addPredicate(thread_db* tdbb, CompilerScratch* csb, const BoolExprNode* node,
+			RecordBatch::Layout& layout, bool negated);
+		bool convertConstant(thread_db* tdbb, const RecordBatch::Column& column,
+			const dsc* value, Constant& constant) const;
+
+		const RecordBatch::Layout& m_layout;
+		Firebird::Array<Predicate> m_predicates;
+		ULONG m_impure = 0;
+		ULONG m_constants = 0;
+	};
+
+} // namespace
+
+#endif // JRD_RECORD_BATCH_H
@@ -112,6 +112,33 @@ void PlanEntry::asString(string& str) const
 }
 
 
+// Runtime filter class
+// --------------------
+
+bool RuntimeFilter::check(thread_db* tdbb) const
+{
+	return m_join->checkFilter(tdbb);
+}
+
+bool RuntimeFilter::isApplicable(const StreamList& streams) const
+{
+	for (const auto stream : m_streams)
+	{
+		if (!streams.exist(stream))
+			return false;
+	}
+
+	return true;
+}
+
+void RuntimeFilter::print(ObjectsArray<PlanEntry::Line>& planLines, unsigned level) const
+{
+	auto& line = planLines.add();
+	line.level = level;
+	line.text = "Runtime Filter (Bloom)";
+}
+
+
 // Record source class
 // -------------------
 
@@ -136,6 +163,14 @@ bool RecordSource::getRecord(thread_db* tdbb) const
 	return internalGetRecord(tdbb);
 }
 
+bool RecordSource::getBatch(thread_db* tdbb, RecordBatch& batch) const
+{
+	ProfilerManager::RecordSourceStopWatcher profilerRecordSourceStopWatcher(tdbb, this,
+		ProfilerManager::RecordSourceStopWatcher::Event::GET_RECORD);
+
+	return internalGetBatch(tdbb, batch);
+}
+
 string RecordSource::printName(thread_db* tdbb, const string& name, const string& alias)
 {
 	if (alias.isEmpty() || name == alias)
@@ -355,3 +390,18 @@ void RecordStream::nullRecords(thread_db* tdbb) const
 
 	record->fakeNulls();
 }
+
+bool RecordStream::acceptRuntimeFilter(RuntimeFilter* filter)
+{
+	if (m_runtimeFilter)
+		return false;
+
+	StreamList streams;
+	findUsedStreams(streams);
+
+	if (!filter->isApplicable(streams))
+		return false;
+
+	m_runtimeFilter = filter;
+	return true;
+}
@@ -33,6 +33,7 @@
 #include "firebird/impl/inf_pub.h"
 #include "../jrd/evl_proto.h"
 #include "../jrd/vio_proto.h"
+#include "../jrd/recsrc/RecordBatch.h"
 
 namespace Jrd
 {
@@ -52,6 +53,9 @@ namespace Jrd
 	class BaseBufferedStream;
 	class BufferedStream;
 	class PlanEntry;
+	class ParallelBatchScan;
+	class HashJoin;
+	class GroupTable;
 
 	enum class JoinType { INNER, OUTER, SEMI, ANTI };
 
@@ -133,6 +137,46 @@ namespace Jrd
 		unsigned level = 0;
 	};
 
+	// Runtime join filter. It's a Bloom filter built by the hash join over the join keys
+	// of its hashed streams and checked by the record sources of the probe side,
+	// thus rows having no matches are rejected before they reach the join.
+	class RuntimeFilter final
+	{
+	public:
+		RuntimeFilter(MemoryPool& pool, const HashJoin* join, bool pushDown)
+			: m_join(join), m_streams(pool), m_pushDown(pushDown)
+		{}
+
+		bool check(thread_db* tdbb) const;
+		void print(Firebird::ObjectsArray<PlanEntry::Line>& planLines, unsigned level) const;
+
+		SortedStreamList& getStreams() noexcept
+		{
+			return m_streams;
+		}
+
+		const SortedStreamList& getStreams() const noexcept
+		{
+			return m_streams;
+		}
+
+		// Streams of the record source must include all the streams referenced by the filter
+		bool isApplicable(const StreamList& streams) const;
+
+		// Whether the filter may be checked below the filters and joins of the leading
+		// stream, i.e. for rows that would be rejected before reaching the hash join.
+		// It's allowed if the join keys are plain field references that cannot fail.
+		bool canPushDown() const noexcept
+		{
+			return m_pushDown;
+		}
+
+	private:
+		const HashJoin* const m_join;
+		SortedStreamList m_streams;
+		const bool m_pushDown;
+	};
+
 	// Abstract base class for record sources.
 	class RecordSource : public AccessPath
 	{
@@ -154,6 +198,13 @@ namespace Jrd
 			fb_assert(false);
 		}
 
+		// Called at compile time by the hash join to push its runtime filter down
+		// into the probe side. Returns false if the filter cannot be applied.
+		virtual bool pushRuntimeFilter(RuntimeFilter* /*filter*/)
+		{
+			return false;
+		}
+
 		static bool rejectDuplicate(const UCHAR* /*data1*/, const UCHAR* /*data2*/, void* /*userArg*/)
 		{
 			return true;
@@ -163,6 +214,32 @@ namespace Jrd
 
 		bool getRecord(thread_db* tdbb) const;
 
+		// Vectorized execution, see RecordBatch.h.
+		// setupBatch() is called by the batch consumer at compile time and registers
+		// the required columns, openBatch() is called after open() and prepares
+		// the batch mode for the current execution. Both return false if the
+		// record source (or any of its children) cannot produce batches.
+
+		virtual bool setupBatch(thread_db* /*tdbb*/, CompilerScratch* /*csb*/,
+			RecordBatch::Layout& /*layout*/)
+		{
+			return false;
+		}
+
+		virtual bool openBatch(thread_db* /*tdbb*/) const
+		{
+			return false;
+		}
+
+		bool getBatch(thread_db* tdbb, RecordBatch& batch) const;
+
+		// Called after openBatch() by the consumer willing to run the batch pipeline
+		// in parallel. Returns false if the pipeline cannot be executed by the workers.
+		virtual bool setupParallelBatch(thread_db* /*tdbb*/, ParallelBatchScan& /*scan*/) const
+		{
+			return false;
+		}
+
 	protected:
 		// Generic impure block
 		struct Impure
@@ -175,6 +252,7 @@ namespace Jrd
 		static const ULONG irsb_joined = 4;
 		static const ULONG irsb_mustread = 8;
 		static const ULONG irsb_singular_processed = 16;
+		static const ULONG irsb_eof = 32;
 
 		RecordSource(CompilerScratch* csb);
 
@@ -195,6 +273,12 @@ namespace Jrd
 		virtual void internalOpen(thread_db* tdbb) const = 0;
 		virtual bool internalGetRecord(thread_db* tdbb) const = 0;
 
+		virtual bool internalGetBatch(thread_db* /*tdbb*/, RecordBatch& /*batch*/) const
+		{
+			fb_assert(false);
+			return false;
+		}
+
 		ULONG m_impure = 0;
 		bool m_recursive = false;
 	};
@@ -222,8 +306,15 @@ namespace Jrd
 		}
 
 	protected:
+		bool acceptRuntimeFilter(RuntimeFilter* filter);
+		bool checkRuntimeFilter(thread_db* tdbb) const
+		{
+			return !m_runtimeFilter || m_runtimeFilter->check(tdbb);
+		}
+
 		const StreamType m_stream;
 		mutable const Format* m_format;
+		const RuntimeFilter* m_runtimeFilter = nullptr;
 	};
 
 
@@ -246,10 +337,20 @@ namespace Jrd
 
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
+		bool pushRuntimeFilter(RuntimeFilter* filter) override
+		{
+			return acceptRuntimeFilter(filter);
+		}
+
+		bool setupBatch(thread_db* tdbb, CompilerScratch* csb, RecordBatch::Layout& layout) override;
+		bool openBatch(thread_db* tdbb) const override;
+		bool setupParallelBatch(thread_db* tdbb, ParallelBatchScan& scan) const override;
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
 		bool internalGetRecord(thread_db* tdbb) const override;
+		bool internalGetBatch(thread_db* tdbb, RecordBatch& batch) const override;
 
 	private:
 		const Firebird::string m_alias;
@@ -273,6 +374,11 @@ namespace Jrd
 
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
+		bool pushRuntimeFilter(RuntimeFilter* filter) override
+		{
+			return acceptRuntimeFilter(filter);
+		}
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -315,6 +421,11 @@ namespace Jrd
 
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
+		bool pushRuntimeFilter(RuntimeFilter* filter) override
+		{
+			return acceptRuntimeFilter(filter);
+		}
+
 		void setInversion(InversionNode* inversion, BoolExprNode* condition)
 		{
 			fb_assert(!m_inversion && !m_condition);
@@ -610,12 +721,19 @@ namespace Jrd
 			m_ansiNot = ansiNot;
 		}
 
+		bool pushRuntimeFilter(RuntimeFilter* filter) override;
+
+		bool setupBatch(thread_db* tdbb, CompilerScratch* csb, RecordBatch::Layout& layout) override;
+		bool openBatch(thread_db* tdbb) const override;
+		bool setupParallelBatch(thread_db* tdbb, ParallelBatchScan& scan) const override;
+
 	protected:
 		FilteredStream(CompilerScratch* csb, RecordSource* next, BoolExprNode* boolean);
 
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
 		bool internalGetRecord(thread_db* tdbb) const override;
+		bool internalGetBatch(thread_db* tdbb, RecordBatch& batch) const override;
 
 		const bool m_invariant;
 
@@ -625,6 +743,8 @@ namespace Jrd
 		NestConst<RecordSource> m_next;
 		NestConst<BoolExprNode> const m_boolean;
 		NestConst<BoolExprNode> m_anyBoolean;
+		BatchFilter* m_batchFilter = nullptr;
+		const RuntimeFilter* m_runtimeFilter = nullptr;
 		bool m_ansiAny = false;
 		bool m_ansiAll = false;
 		bool m_ansiNot = false;
@@ -735,6 +855,13 @@ namespace Jrd
 			return m_map->keyLength;
 		}
 
+		// Only FIRST (+ SKIP) records are going to be fetched, let the sort keep just them
+		void setLimit(ValueExprNode* first, ValueExprNode* skip)
+		{
+			m_first = first;
+			m_skip = skip;
+		}
+
 		bool compareKeys(const UCHAR* p, const UCHAR* q) const;
 
 		UCHAR* getData(thread_db* tdbb) const;
@@ -760,9 +887,12 @@ namespace Jrd
 
 	private:
 		Sort* init(thread_db* tdbb) const;
+		FB_UINT64 getLimit(thread_db* tdbb, Request* request) const;
 
 		NestConst<RecordSource> m_next;
 		const SortMap* const m_map;
+		NestConst<ValueExprNode> m_first;
+		NestConst<ValueExprNode> m_skip;
 	};
 
 	// Make moves in a window without going out of partition boundaries.
@@ -937,6 +1067,15 @@ namespace Jrd
 
 	class AggregatedStream final : public BaseAggWinStream<AggregatedStream, RecordSource>
 	{
+		friend class BaseAggWinStream<AggregatedStream, RecordSource>;
+
+		struct Impure : public BaseAggWinStream<AggregatedStream, RecordSource>::Impure
+		{
+			RecordBatch* batch;
+			BatchAggregator* aggregator;
+			bool batchMode;
+		};
+
 	public:
 		AggregatedStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
 			const NestValueArray* group, MapNode* map, RecordSource* next);
@@ -946,7 +1085,96 @@ namespace Jrd
 
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
+		void internalOpen(thread_db* tdbb) const override;
+		bool internalGetRecord(thread_db* tdbb) const override;
+
+	private:
+		Impure* getImpure(Request* request) const
+		{
+			return request->getImpure<Impure>(m_impure);
+		}
+
+		void setupBatchMode(thread_db* tdbb, CompilerScratch* csb);
+		bool evaluateBatches(thread_db* tdbb) const;
+
+		RecordBatch::Layout* m_batchLayout = nullptr;
+		Firebird::Array<BatchAggregator::Aggregate> m_batchAggregates;
+	};
+
+	// Grouping by hashing the group values, the input does not need to be sorted.
+	// Groups are returned in no particular order.
+
+	class HashAggregatedStream final : public BaseAggWinStream<HashAggregatedStream, RecordSource>
+	{
+		friend class BaseAggWinStream<HashAggregatedStream, RecordSource>;
+
+		struct Impure : public BaseAggWinStream<HashAggregatedStream, RecordSource>::Impure
+		{
+			GroupTable* table;
+			Sort* sort;				// partition that cannot be split further
+			UCHAR* sortedEntry;		// next record of the sorted partition
+			bool built;
+		};
+
+		struct GroupKey
+		{
+			ULONG nullOffset;		// position of the null flag, the binary key follows it
+			ULONG keyLength;		// bytes of the binary key, excluding the null flag
+			ULONG valueOffset;		// position of the group value inside the entry
+			dsc desc;				// group value descriptor, without address
+		};
+
+		struct Aggregate
+		{
+			const AggNode* node;
+			AggNode::BatchType type;
+			std::optional<RecordBatch::Column> column;	// absent for COUNT(*)
+			ULONG stateOffset;
+		};
+
+		struct Assignment
+		{
+			const ValueExprNode* target;
+			FB_SIZE_T groupKey;
+		};
+
+	public:
+		HashAggregatedStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
+			const NestValueArray* group, MapNode* map, RecordSource* next);
+
+		static bool isApplicable(thread_db* tdbb, CompilerScratch* csb,
+			const NestValueArray* group, const MapNode* map, double groupCount);
+
+	public:
+		void close(thread_db* tdbb) const override;
+
+		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
+
+	protected:
+		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
+		void internalOpen(thread_db* tdbb) const override;
 		bool internalGetRecord(thread_db* tdbb) const override;
+
+	private:
+		Impure* getImpure(Request* request) const
+		{
+			return request->getImpure<Impure>(m_impure);
+		}
+
+		static bool getKeyLength(thread_db* tdbb, const dsc* desc, ULONG& keyLength);
+
+		void makeEntry(thread_db* tdbb, Request* request, UCHAR* entry) const;
+		void insertEntry(GroupTable* table, const UCHAR* entry) const;
+		void mergeEntry(UCHAR* group, const UCHAR* entry) const;
+		void sortPartition(thread_db* tdbb, Request* request, Impure* impure) const;
+		const UCHAR* fetchSorted(thread_db* tdbb, Impure* impure) const;
+		void outputGroup(thread_db* tdbb, Request* request, const UCHAR* entry) const;
+
+		Firebird::Array<GroupKey> m_groupKeys;
+		Firebird::Array<Aggregate> m_aggregates;
+		Firebird::Array<Assignment> m_assignments;
+		ULONG m_keyLength = 0;		// null flags and binary keys of all the group values
+		ULONG m_entrySize = 0;
 	};
 
 	class WindowedStream : public RecordSource
@@ -1281,6 +1509,8 @@ namespace Jrd
 		void close(thread_db* tdbb) const override;
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
+		bool pushRuntimeFilter(RuntimeFilter* filter) override;
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -1330,6 +1560,10 @@ namespace Jrd
 			HashTable* irsb_hash_table;
 			UCHAR* irsb_leader_buffer;
 			ULONG irsb_leader_hash;
+			bool irsb_leader_hashed;	// irsb_leader_hash is computed by the runtime filter
+			bool irsb_filter_disabled;	// runtime filter rejects too few rows to pay off
+			FB_UINT64 irsb_filter_checked;
+			FB_UINT64 irsb_filter_rejected;
 		};
 
 	public:
@@ -1344,6 +1578,10 @@ namespace Jrd
 		void close(thread_db* tdbb) const override;
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
+		bool pushRuntimeFilter(RuntimeFilter* filter) override;
+
+		bool checkFilter(thread_db* tdbb) const;
+
 		static unsigned maxCapacity() noexcept;
 
 	protected:
@@ -1358,9 +1596,11 @@ namespace Jrd
 		ULONG computeHash(thread_db* tdbb, Request* request,
 						  const SubStream& sub, UCHAR* buffer) const;
 		bool fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) const;
+		void buildHashTable(thread_db* tdbb, Request* request, Impure* impure) const;
 
 		SubStream m_leader;
 		Firebird::Array<SubStream> m_subs;
+		RuntimeFilter* m_filter = nullptr;
 	};
 
 	class MergeJoin : public Join<SortedStream>
@@ -198,7 +198,12 @@ Sort* SortedStream::init(thread_db* tdbb) const
 		Sort(tdbb->getDatabase(), &request->req_sorts,
 			 m_map->length, m_map->keyItems.getCount(), m_map->keyItems.getCount(),
 			 m_map->keyItems.begin(),
-			 ((m_map->flags & FLAG_PROJECT) ? rejectDuplicate : nullptr), 0));
+			 ((m_map->flags & FLAG_PROJECT) ? rejectDuplicate : nullptr), 0,
+			 getLimit(tdbb, request)));
+
+	// Big sorts may generate their runs using the parallel workers
+
+	scb->setParallel(tdbb->getAttachment()->att_parallel_workers);
 
 	// Pump the input stream dry while pushing records into sort. For
 	// each record, map all fields into the sort record. The reverse
@@ -289,6 +294,25 @@ Sort* SortedStream::init(thread_db* tdbb) const
 	return scb.release();
 }
 
+// Number of records to be fetched from the sort, zero if unknown. The limit values
+// are evaluated before by the FIRST and SKIP record sources, so they're known to be valid.
+FB_UINT64 SortedStream::getLimit(thread_db* tdbb, Request* request) const
+{
+	if (!m_first || (m_map->flags & FLAG_PROJECT))
+		return 0;
+
+	const dsc* desc = EVL_expr(tdbb, request, m_first);
+	const SINT64 first = desc ? MOV_get_int64(tdbb, desc, 0) : 0;
+
+	desc = m_skip ? EVL_expr(tdbb, request, m_skip) : nullptr;
+	const SINT64 skip = desc ? MOV_get_int64(tdbb, desc, 0) : 0;
+
+	if (first <= 0 || skip < 0 || first > MAX_SINT64 - skip)
+		return 0;
+
+	return first + skip;
+}
+
 bool SortedStream::compareKeys(const UCHAR* p, const UCHAR* q) const
 {
 	if (!memcmp(p, q, m_map->keyLength))
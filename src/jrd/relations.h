@@ -536,6 +536,13 @@ RELATION(nam_mon_database, rel_mon_database, ODS_11_1, rel_virtual)
 	FIELD(f_mon_db_na, nam_mon_na, fld_att_id, 0, ODS_13_0)
 	FIELD(f_mon_db_ns, nam_mon_ns, fld_stmt_id, 0, ODS_13_0)
 	FIELD(f_mon_db_repl_mode, nam_mon_repl_mode, fld_repl_mode, 0, ODS_13_0)
+	FIELD(f_mon_db_buffer_policy, nam_mon_buffer_policy, fld_buffer_policy, 0, ODS_14_1)
+	FIELD(f_mon_db_buffer_hits, nam_mon_buffer_hits, fld_counter, 0, ODS_14_1)
+	FIELD(f_mon_db_buffer_misses, nam_mon_buffer_misses, fld_counter, 0, ODS_14_1)
+	FIELD(f_mon_db_compressed_pages, nam_mon_compressed_pages, fld_counter, 0, ODS_14_1)
+	FIELD(f_mon_db_compressed_size, nam_mon_compressed_size, fld_counter, 0, ODS_14_1)
+	FIELD(f_mon_db_decompressed_pages, nam_mon_decompressed_pages, fld_counter, 0, ODS_14_1)
+	FIELD(f_mon_db_compression_time, nam_mon_compression_time, fld_counter, 0, ODS_14_1)
 END_RELATION
 
 // Relation 34 (MON$ATTACHMENTS)
@@ -840,3 +847,23 @@ RELATION(nam_mon_local_temp_table_columns, rel_mon_local_temp_table_columns, ODS
 	FIELD(f_mon_lttc_charset_id, nam_mon_charset_id, fld_charset_id, 0, ODS_14_0)
 	FIELD(f_mon_lttc_collate_id, nam_mon_collate_id, fld_collate_id, 0, ODS_14_0)
 END_RELATION
+
+// Relation 59 (RDB$COLUMN_STATISTICS)
+RELATION(nam_column_stats, rel_column_stats, ODS_14_1, rel_persistent)
+	FIELD(f_cst_schema, nam_sch_name, fld_sch_name, 1, ODS_14_1)
+	FIELD(f_cst_rname, nam_r_name, fld_r_name, 1, ODS_14_1)
+	FIELD(f_cst_fname, nam_f_name, fld_f_name, 1, ODS_14_1)
+	FIELD(f_cst_null_fraction, nam_null_fraction, fld_statistics, 1, ODS_14_1)
+	FIELD(f_cst_distinct_count, nam_distinct_count, fld_statistics, 1, ODS_14_1)
+	FIELD(f_cst_sample_size, nam_sample_size, fld_counter, 1, ODS_14_1)
+	FIELD(f_cst_histogram, nam_histogram, fld_blob, 1, ODS_14_1)
+END_RELATION
+
+// Relation 60 (MON$GC_QUEUE)
+RELATION(nam_mon_gc_queue, rel_mon_gc_queue, ODS_14_1, rel_virtual)
+	FIELD(f_mon_gcq_sch_name, nam_mon_sch_name, fld_sch_name, 0, ODS_14_1)
+	FIELD(f_mon_gcq_tab_name, nam_mon_tab_name, fld_r_name, 0, ODS_14_1)
+	FIELD(f_mon_gcq_pending_pages, nam_mon_gc_pending_pages, fld_counter, 0, ODS_14_1)
+	FIELD(f_mon_gcq_processed_pages, nam_mon_gc_processed_pages, fld_counter, 0, ODS_14_1)
+	FIELD(f_mon_gcq_processing_time, nam_mon_gc_processing_time, fld_counter, 0, ODS_14_1)
+END_RELATION
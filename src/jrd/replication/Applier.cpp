@@ -325,13 +325,18 @@ void Applier::process(thread_db* tdbb, ULONG length, const UCHAR* data)
 
 	tdbb->tdbb_flags |= TDBB_replicator;
 
+	const auto protocol = ((const Block*) data)->protocol;
+
+	if (protocol < PROTOCOL_VERSION_2 || protocol > PROTOCOL_CURRENT_VERSION)
+		raiseError("Unsupported replication protocol version %u", protocol);
+
+	UCharBuffer buffer;
+	data = decompressBlock(data, buffer);
+	length = sizeof(Block) + ((const Block*) data)->length;
+
 	BlockReader reader(length, data);
 
 	const auto traNum = reader.getTransactionId();
-	const auto protocol = reader.getProtocolVersion();
-
-	if (protocol != PROTOCOL_CURRENT_VERSION)
-		raiseError("Unsupported replication protocol version %u", protocol);
 
 	while (!reader.isEof())
 	{
@@ -350,6 +355,8 @@ void Applier::process(thread_db* tdbb, ULONG length, const UCHAR* data)
 				break;
 
 			case opCommitTransaction:
+				if (protocol >= PROTOCOL_VERSION_4)
+					reader.getBinary(sizeof(ISC_TIMESTAMP));	// commit time
 				commitTransaction(tdbb, traNum);
 				break;
 
@@ -62,6 +62,8 @@ namespace
 	constexpr ULONG DEFAULT_GROUP_FLUSH_DELAY = 0;
 	constexpr ULONG DEFAULT_APPLY_IDLE_TIMEOUT = 10;			// seconds
 	constexpr ULONG DEFAULT_APPLY_ERROR_TIMEOUT = 60;			// seconds
+	constexpr ULONG DEFAULT_APPLY_PARALLEL_WORKERS = 1;
+	constexpr ULONG MAX_APPLY_PARALLEL_WORKERS = 64;
 	constexpr bool DEFAULT_REPORT_ERRORS = false;
 
 	void parseLong(const string& input, ULONG& output)
@@ -227,6 +229,8 @@ Config::Config()
 	  journalDirectory(getPool()),
 	  filePrefix(getPool()),
 	  groupFlushDelay(DEFAULT_GROUP_FLUSH_DELAY),
+	  journalCompression(false),
+	  journalCommitTimestamps(false),
 	  archiveDirectory(getPool()),
 	  archiveCommand(getPool()),
 	  archiveTimeout(DEFAULT_ARCHIVE_TIMEOUT),
@@ -235,6 +239,7 @@ Config::Config()
 	  verboseLogging(false),
 	  applyIdleTimeout(DEFAULT_APPLY_IDLE_TIMEOUT),
 	  applyErrorTimeout(DEFAULT_APPLY_ERROR_TIMEOUT),
+	  applyParallelWorkers(DEFAULT_APPLY_PARALLEL_WORKERS),
 	  schemaSearchPath(getPool()),
 	  pluginName(getPool()),
 	  logErrors(true),
@@ -256,6 +261,8 @@ Config::Config(const Config& other)
 	  journalDirectory(getPool(), other.journalDirectory),
 	  filePrefix(getPool(), other.filePrefix),
 	  groupFlushDelay(other.groupFlushDelay),
+	  journalCompression(other.journalCompression),
+	  journalCommitTimestamps(other.journalCommitTimestamps),
 	  archiveDirectory(getPool(), other.archiveDirectory),
 	  archiveCommand(getPool(), other.archiveCommand),
 	  archiveTimeout(other.archiveTimeout),
@@ -264,6 +271,7 @@ Config::Config(const Config& other)
 	  verboseLogging(other.verboseLogging),
 	  applyIdleTimeout(other.applyIdleTimeout),
 	  applyErrorTimeout(other.applyErrorTimeout),
+	  applyParallelWorkers(other.applyParallelWorkers),
 	  schemaSearchPath(getPool(), other.schemaSearchPath),
 	  pluginName(getPool(), other.pluginName),
 	  logErrors(other.logErrors),
@@ -406,6 +414,14 @@ Config* Config::get(const PathName& lookupName)
 				{
 					parseLong(value, config->groupFlushDelay);
 				}
+				else if (key == "journal_compression")
+				{
+					parseBoolean(value, config->journalCompression);
+				}
+				else if (key == "journal_commit_timestamps")
+				{
+					parseBoolean(value, config->journalCommitTimestamps);
+				}
 				else if (key == "journal_archive_directory")
 				{
 					config->archiveDirectory = value.c_str();
@@ -449,7 +465,8 @@ Config* Config::get(const PathName& lookupName)
 						(key != "source_guid") &&
 						(key != "verbose_logging") &&
 						(key != "apply_idle_timeout") &&
-						(key != "apply_error_timeout"))
+						(key != "apply_error_timeout") &&
+						(key != "apply_parallel_workers"))
 				{
 					configError(&localStatus, "unknown key",
 					                          exactMatch ? lookupName.c_str() : section.name.c_str(),
@@ -592,6 +609,15 @@ void Config::enumerate(ReplicaList& replicas)
 				{
 					parseLong(value, config->applyErrorTimeout);
 				}
+				else if (key == "apply_parallel_workers")
+				{
+					parseLong(value, config->applyParallelWorkers);
+
+					if (!config->applyParallelWorkers)
+						config->applyParallelWorkers = DEFAULT_APPLY_PARALLEL_WORKERS;
+					else if (config->applyParallelWorkers > MAX_APPLY_PARALLEL_WORKERS)
+						config->applyParallelWorkers = MAX_APPLY_PARALLEL_WORKERS;
+				}
 				else if (key == "schema_search_path")
 					config->schemaSearchPath = value;
 			}
@@ -71,6 +71,8 @@ namespace Replication
 		Firebird::PathName journalDirectory;
 		Firebird::PathName filePrefix;
 		ULONG groupFlushDelay;
+		bool journalCompression;
+		bool journalCommitTimestamps;
 		Firebird::PathName archiveDirectory;
 		Firebird::string archiveCommand;
 		ULONG archiveTimeout;
@@ -80,6 +82,7 @@ namespace Replication
 		bool verboseLogging;
 		ULONG applyIdleTimeout;
 		ULONG applyErrorTimeout;
+		ULONG applyParallelWorkers;
 		Firebird::string schemaSearchPath;
 		Firebird::string pluginName;
 		bool logErrors;
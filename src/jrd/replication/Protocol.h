@@ -29,11 +29,18 @@ namespace Replication
 	// Supported protocol versions
 	inline constexpr USHORT PROTOCOL_VERSION_1 = 1;
 	inline constexpr USHORT PROTOCOL_VERSION_2 = 2;	// support for schemas
-	inline constexpr USHORT PROTOCOL_CURRENT_VERSION = PROTOCOL_VERSION_2;
+	inline constexpr USHORT PROTOCOL_VERSION_3 = 3;	// support for compressed blocks
+	inline constexpr USHORT PROTOCOL_VERSION_4 = 4;	// commit timestamp
+	inline constexpr USHORT PROTOCOL_CURRENT_VERSION = PROTOCOL_VERSION_4;
 
 	// Global (protocol neutral) flags
 	inline constexpr USHORT BLOCK_BEGIN_TRANS	= 0x0001;
 	inline constexpr USHORT BLOCK_END_TRANS		= 0x0002;
+	inline constexpr USHORT BLOCK_COMPRESSED	= 0x0004;	// protocol 3+
+
+	// Compressed block contents: ULONG length of the original contents
+	// followed by the zlib stream
+	inline constexpr ULONG MIN_COMPRESSED_BLOCK_LENGTH = 256;
 
 	struct Block
 	{
@@ -53,7 +60,7 @@ namespace Replication
 	{
 		opStartTransaction = 1,
 		opPrepareTransaction = 2,
-		opCommitTransaction = 3,
+		opCommitTransaction = 3,	// protocol 4+: followed by ISC_TIMESTAMP of the commit (UTC)
 		opRollbackTransaction = 4,
 		opCleanupTransaction = 5,
 
@@ -53,7 +53,10 @@ void Replicator::flush(BatchBlock& block, FlushReason reason, ULONG flags)
 	const auto length = (ULONG) (block.buffer->getCount() - sizeof(Block));
 	fb_assert(length);
 
-	block.header.protocol = PROTOCOL_CURRENT_VERSION;
+	// Blocks do not use the current protocol version unless they need it,
+	// this way they remain readable by the older replicas
+
+	block.header.protocol = MAX(block.header.protocol, PROTOCOL_VERSION_2);
 	block.header.flags |= flags;
 	block.header.length = length;
 
@@ -61,6 +64,13 @@ void Replicator::flush(BatchBlock& block, FlushReason reason, ULONG flags)
 
 	memcpy(block.buffer->begin(), &block.header, sizeof(Block));
 
+	if (m_config->journalCompression)
+	{
+		UCharBuffer compressed;
+		if (compressBlock(block.buffer->begin(), compressed))
+			block.buffer->assign(compressed);
+	}
+
 	// Pass the buffer to the replication manager and setup the new one
 
 	const auto sync = (reason == FLUSH_SYNC);
@@ -211,6 +221,18 @@ void Replicator::commitTransaction(CheckStatusWrapper* status, Transaction* tran
 		m_generators.clear();
 
 		txnData.putTag(opCommitTransaction);
+
+		// Commit time allows the replicas to measure their apply lag,
+		// it's sent only if configured as older replicas cannot read it
+
+		if (m_config->journalCommitTimestamps)
+		{
+			const ISC_TIMESTAMP commitTime = TimeZoneUtil::getCurrentGmtTimeStamp().utc_timestamp;
+
+			txnData.header.protocol = PROTOCOL_VERSION_4;
+			txnData.putBinary(sizeof(ISC_TIMESTAMP), (const UCHAR*) &commitTime);
+		}
+
 		flush(txnData, FLUSH_SYNC, BLOCK_END_TRANS);
 	}
 	catch (const Exception& ex)
@@ -29,8 +29,11 @@
 #include "../common/ScanDir.h"
 #include "../common/os/mod_loader.h"
 #include "../common/os/path_utils.h"
+#include "../common/classes/init.h"
+#include "../common/classes/zip.h"
 #include "../jrd/constants.h"
 
+#include "Protocol.h"
 #include "Utils.h"
 
 #ifdef HAVE_UNISTD_H
@@ -213,10 +216,162 @@ namespace
 			logStatus(side, ERROR_MSG, database, status->getErrors());
 	}
 
+#ifdef HAVE_ZLIB_H
+	InitInstance<ZLib> zlib;
+
+	// Stream initialization allocates a lot of memory, so the streams
+	// are created once per thread and then just reset between the blocks
+
+	class BlockStreams
+	{
+	public:
+		~BlockStreams()
+		{
+			if (deflateReady)
+				zlib().deflateEnd(&deflater);
+
+			if (inflateReady)
+				zlib().inflateEnd(&inflater);
+		}
+
+		z_stream* getDeflater()
+		{
+			if (deflateReady)
+				return (zlib().deflateReset(&deflater) == Z_OK) ? &deflater : nullptr;
+
+			prepare(deflater);
+			if (zlib().deflateInit(&deflater, Z_BEST_SPEED) != Z_OK)
+				return nullptr;
+
+			deflateReady = true;
+			return &deflater;
+		}
+
+		z_stream* getInflater()
+		{
+			if (inflateReady)
+				return (zlib().inflateReset(&inflater) == Z_OK) ? &inflater : nullptr;
+
+			prepare(inflater);
+			if (zlib().inflateInit(&inflater) != Z_OK)
+				return nullptr;
+
+			inflateReady = true;
+			return &inflater;
+		}
+
+	private:
+		static void prepare(z_stream& strm)
+		{
+			memset(&strm, 0, sizeof(z_stream));
+			strm.zalloc = ZLib::allocFunc;
+			strm.zfree = ZLib::freeFunc;
+		}
+
+		z_stream deflater;
+		z_stream inflater;
+		bool deflateReady = false;
+		bool inflateReady = false;
+	};
+
+	thread_local BlockStreams blockStreams;
+#endif
+
 } // namespace
 
 namespace Replication
 {
+	// Compress the block contents, the result is returned only if it's smaller than the original
+
+	bool compressBlock(const UCHAR* data, UCharBuffer& output)
+	{
+		const auto header = reinterpret_cast<const Block*>(data);
+		fb_assert(!(header->flags & BLOCK_COMPRESSED));
+
+#ifdef HAVE_ZLIB_H
+		const ULONG length = header->length;
+		const ULONG prefixLength = sizeof(Block) + sizeof(ULONG);
+
+		if (length < MIN_COMPRESSED_BLOCK_LENGTH || !zlib())
+			return false;
+
+		z_stream* const strm = blockStreams.getDeflater();
+		if (!strm)
+			return false;
+
+		// Output must fit into the original length, otherwise compression makes no sense
+
+		UCHAR* const buffer = output.getBuffer(sizeof(Block) + length);
+
+		strm->next_in = const_cast<Bytef*>(data + sizeof(Block));
+		strm->avail_in = length;
+		strm->next_out = buffer + prefixLength;
+		strm->avail_out = length - sizeof(ULONG);
+
+		if (zlib().deflate(strm, Z_FINISH) != Z_STREAM_END)
+			return false;
+
+		Block newHeader = *header;
+		newHeader.protocol = MAX(header->protocol, PROTOCOL_VERSION_3);
+		newHeader.flags |= BLOCK_COMPRESSED;
+		newHeader.length = sizeof(ULONG) + strm->total_out;
+
+		memcpy(buffer, &newHeader, sizeof(Block));
+		memcpy(buffer + sizeof(Block), &length, sizeof(ULONG));
+		output.shrink(sizeof(Block) + newHeader.length);
+
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// Return the block with decompressed contents, either the original one
+	// (if it was not compressed) or the one placed into the output buffer
+
+	const UCHAR* decompressBlock(const UCHAR* data, UCharBuffer& output)
+	{
+		const auto header = reinterpret_cast<const Block*>(data);
+
+		if (!(header->flags & BLOCK_COMPRESSED))
+			return data;
+
+#ifdef HAVE_ZLIB_H
+		ULONG length;
+
+		if (header->length < sizeof(ULONG))
+			raiseError("Replication block is corrupted");
+
+		memcpy(&length, data + sizeof(Block), sizeof(ULONG));
+
+		if (!zlib())
+			raiseError("Compressed replication block cannot be processed: zlib is not available");
+
+		z_stream* const strm = blockStreams.getInflater();
+		if (!strm)
+			raiseError("Compressed replication block cannot be processed: zlib initialization failed");
+
+		UCHAR* const buffer = output.getBuffer(sizeof(Block) + length);
+
+		strm->next_in = const_cast<Bytef*>(data + sizeof(Block) + sizeof(ULONG));
+		strm->avail_in = header->length - sizeof(ULONG);
+		strm->next_out = buffer + sizeof(Block);
+		strm->avail_out = length;
+
+		if (zlib().inflate(strm, Z_FINISH) != Z_STREAM_END || strm->avail_out)
+			raiseError("Replication block is corrupted");
+
+		Block newHeader = *header;
+		newHeader.flags &= ~BLOCK_COMPRESSED;
+		newHeader.length = length;
+		memcpy(buffer, &newHeader, sizeof(Block));
+
+		return buffer;
+#else
+		raiseError("Compressed replication block cannot be processed: zlib is not available");
+#endif
+	}
+
 	void raiseError(const char* msg, ...)
 	{
 		char buffer[BUFFER_LARGE];
@@ -36,6 +36,8 @@
 #include "iberror.h"
 #include "../jrd/intl.h"
 #include "../common/TimeZoneUtil.h"
+#include "../common/Task.h"
+#include "../common/utils_proto.h"
 #include "../common/gdsassert.h"
 #include "../jrd/req.h"
 #include "../jrd/val.h"
@@ -79,6 +81,9 @@ using namespace Firebird;
 constexpr ULONG MAX_SORT_BUFFER_SIZE = 1024 * 128;	// 128KB
 constexpr ULONG MIN_RECORDS_TO_ALLOC = 8;
 
+// Limited sorts keeping all their records in memory may use a bigger buffer
+constexpr ULONG MAX_TOP_RECORDS_BUFFER_SIZE = 1024 * 1024 * 8;	// 8MB
+
 // the size of sr_bckptr (everything before sort_record) in bytes
 #define SIZEOF_SR_BCKPTR offsetof(sr, sr_sort_record)
 // the size of sr_bckptr in # of 32 bit longwords
@@ -147,9 +152,190 @@ namespace
 		*a = *b;
 		*b = temp;
 	}
+
+	// Buffers holding at least that many records are ordered by Sort::radix()
+	constexpr ULONG RADIX_SORT_THRESHOLD = 256;
+
+	// Radix sort buckets up to that size are finished by the insertion sort
+	constexpr ULONG RADIX_INSERTION_LIMIT = 32;
+
+	// Byte number "digit" of the key, the keys being compared as longwords
+	inline ULONG radixDigit(const SORTP* key, ULONG digit) noexcept
+	{
+		return (key[digit >> 2] >> ((3 - (digit & 3)) << 3)) & 0xFF;
+	}
+
+	// Insertion sort of the record pointers, the keys being equal up to longword "from"
+	void insertionSort(SORTP** begin, SORTP** end, ULONG from, ULONG length) noexcept
+	{
+		for (SORTP** i = begin + 1; i < end; i++)
+		{
+			SORTP* const record = *i;
+			SORTP** j = i;
+
+			for (; j > begin; j--)
+			{
+				const SORTP* p = *(j - 1) + from;
+				const SORTP* q = record + from;
+				ULONG l = length - from;
+
+				while (l && *p == *q)
+				{
+					p++;
+					q++;
+					l--;
+				}
+
+				if (!l || *p < *q)
+					break;
+
+				*j = *(j - 1);
+			}
+
+			*j = record;
+		}
+	}
 } // namespace
 
 
+namespace Jrd
+{
+	// Parallel generation of the sort runs.
+	//
+	// Records put into the sort are not sorted by the caller thread. Every time the
+	// sort buffer is full, its records are saved as is into the scratch space. When
+	// all records are put, such chunks are distributed between the parallel workers.
+	// Every worker puts the records into its own partition of the sort, which sorts
+	// and merges its own runs as usual. Partitions are merged when the records are
+	// fetched from the sort.
+
+	class ParallelSort : public Task
+	{
+	public:
+		ParallelSort(Sort* sort, int workers)
+			: Task(),
+			  m_sort(sort),
+			  m_pool(sort->m_owner->getPool()),
+			  m_workers(workers),
+			  m_chunks(m_pool),
+			  m_items(m_pool),
+			  m_stop(false),
+			  m_nextChunk(0)
+		{}
+
+		virtual ~ParallelSort()
+		{
+			for (Item** p = m_items.begin(); p < m_items.end(); p++)
+				delete *p;
+		}
+
+		class Item : public Task::WorkItem
+		{
+		public:
+			explicit Item(ParallelSort* task)
+				: Task::WorkItem(task),
+				  m_owner(task->m_pool, task->m_sort->m_dbb),
+				  m_partition(NULL),
+				  m_buffer(task->m_pool),
+				  m_chunk(0),
+				  m_inuse(false),
+				  m_finished(false)
+			{}
+
+			SortOwner m_owner;		// owns the partition, not shared with other workers
+			Sort* m_partition;
+			Array<UCHAR> m_buffer;
+			ULONG m_chunk;
+			bool m_inuse;
+			bool m_finished;
+		};
+
+		bool hasChunks() const
+		{
+			return m_chunks.hasData();
+		}
+
+		bool isMerging() const
+		{
+			return m_merger.hasData();
+		}
+
+		void addChunk(const UCHAR* records, ULONG length)
+		{
+			TempSpace* const space = m_sort->m_space;
+
+			Chunk chunk;
+			chunk.seek = space->allocateSpace(length);
+			chunk.length = length;
+
+			Sort::writeBlock(space, chunk.seek, records, length);
+			m_chunks.add(chunk);
+		}
+
+		void sort(thread_db* tdbb);
+
+		void get(thread_db* tdbb, ULONG** record_address)
+		{
+			m_merger->get(tdbb, record_address);
+		}
+
+		bool handler(WorkItem& _item);
+		bool getWorkItem(WorkItem** pItem);
+
+		bool getResult(IStatus* status)
+		{
+			if (status)
+			{
+				status->init();
+				status->setErrors(m_status.getErrors());
+			}
+
+			return m_status.isSuccess();
+		}
+
+		int getMaxWorkers()
+		{
+			return m_items.getCount();
+		}
+
+	private:
+		static constexpr ULONG NO_CHUNK = MAX_ULONG;	// sort the partition
+
+		struct Chunk
+		{
+			offset_t seek;
+			ULONG length;
+		};
+
+		void setError(IStatus* status, bool stopTask)
+		{
+			const bool copyStatus = (m_status.isSuccess() && status && status->getState() == IStatus::STATE_ERRORS);
+			if (!copyStatus && (!stopTask || m_stop))
+				return;
+
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			if (m_status.isSuccess() && copyStatus)
+				m_status.save(status);
+			if (stopTask)
+				m_stop = true;
+		}
+
+		Sort* const m_sort;
+		MemoryPool& m_pool;
+		const int m_workers;
+		Array<Chunk> m_chunks;
+		AutoPtr<PartitionedSort> m_merger;
+
+		Mutex m_mutex;
+		HalfStaticArray<Item*, 8> m_items;
+		StatusHolder m_status;
+
+		volatile bool m_stop;
+		ULONG m_nextChunk;
+	};
+} // namespace Jrd
+
+
 Sort::Sort(Database* dbb,
 		   SortOwner* owner,
 		   ULONG record_length,
@@ -162,7 +348,7 @@ Sort::Sort(Database* dbb,
 	: m_dbb(dbb), m_owner(owner),
 	  m_last_record(NULL), m_next_pointer(NULL), m_records(0),
 	  m_runs(NULL), m_merge(NULL), m_free_runs(NULL),
-	  m_flags(0), m_merge_pool(NULL),
+	  m_flags(0), m_merge_pool(NULL), m_parallel(NULL),
 	  m_description(m_owner->getPool(), keys)
 {
 /**************************************
@@ -179,6 +365,10 @@ Sort::Sort(Database* dbb,
  *		  compared. This is used at creation of unique index since sort key
  *		  includes index key (which must be unique) and record numbers.
  *
+ * If max_records is specified, only that many first records are going to
+ * be fetched. Unless duplicates are eliminated, the sort then keeps just
+ * the best records seen so far in memory and never writes runs.
+ *
  **************************************/
 	fb_assert(m_owner);
 	fb_assert(unique_keys <= keys);
@@ -218,10 +408,29 @@ Sort::Sort(Database* dbb,
 
 		m_unique_length = ROUNDUP(p->getSkdOffset() + p->getSkdLength(), sizeof(SLONG)) >> SHIFTLONG;
 
+		// The limited sort needs room for the kept records, one more record
+		// being offered and their pointers, including the low and high keys
+
+		FB_UINT64 top_size = 0;
+
+		if (max_records && !call_back)
+		{
+			top_size = (max_records + 4) * (record_size + sizeof(sort_record*));
+
+			if (top_size <= MAX_TOP_RECORDS_BUFFER_SIZE)
+			{
+				m_flags |= scb_top_records;
+				m_max_alloc_size = MAX(m_max_alloc_size, (ULONG) top_size);
+			}
+		}
+
 		// Next, try to allocate a "big block". How big? Big enough!
 
 		allocateBuffer(pool);
 
+		if (m_size_memory < top_size)
+			m_flags &= ~scb_top_records;
+
 		m_end_memory = m_memory + m_size_memory;
 		m_first_pointer = (sort_record**) m_memory;
 
@@ -293,6 +502,8 @@ Sort::~Sort()
 	}
 
 	delete[] m_merge_pool;
+
+	delete m_parallel;
 }
 
 
@@ -309,6 +520,12 @@ void Sort::get(thread_db* tdbb, ULONG** record_address)
 
 	try
 	{
+		if (m_parallel && m_parallel->isMerging())
+		{
+			m_parallel->get(tdbb, record_address);
+			return;
+		}
+
 		record = getRecord();
 		*record_address = (ULONG*) record;
 
@@ -350,11 +567,32 @@ void Sort::put(thread_db* tdbb, ULONG** record_address)
 
 		SR* record = m_last_record;
 
-		if (record != (SR*) m_end_memory)
+		if (record != (SR*) m_end_memory && !(m_flags & scb_keys_diddled))
 		{
 			diddleKey((UCHAR*) (record->sr_sort_record.sort_record_key), true, false);
 		}
 
+		// If only the first records are needed, once the memory holds that many of them
+		// they're arranged into a heap having the worst record on top. Every next record
+		// is put into the spare place after them and replaces the top one if it's better,
+		// otherwise it's discarded.
+		if ((m_flags & scb_top_records) && m_records == m_max_records)
+		{
+			if (m_flags & scb_heap_built)
+				offerRecord();
+			else
+			{
+				buildHeap();
+				m_flags |= scb_heap_built;
+
+				m_last_record = NEXT_RECORD(record);
+				m_last_record->sr_bckptr = NULL;
+			}
+
+			*record_address = (ULONG*) m_last_record->sr_sort_record.sort_record_key;
+			return;
+		}
+
 		// If there isn't room for the record, sort and write the run.
 		// Check that we are not at the beginning of the buffer in addition
 		// to checking for space for the record. This avoids the pointer
@@ -362,22 +600,32 @@ void Sort::put(thread_db* tdbb, ULONG** record_address)
 		if ((UCHAR*) record < m_memory + m_longs ||
 			(UCHAR*) NEXT_RECORD(record) <= (UCHAR*) (m_next_pointer + 1))
 		{
-			putRun(tdbb);
-			while (true)
+			if (m_parallel)
 			{
-				run_control* run = m_runs;
-				const USHORT depth = run->run_depth;
-				if (depth == MAX_MERGE_LEVEL)
-					break;
-				USHORT count = 1;
-				while ((run = run->run_next) && run->run_depth == depth)
-					count++;
-				if (count < RUN_GROUP)
-					break;
-				mergeRuns(count);
+				// Leave the records unsorted, the parallel workers will take care of them
+				saveChunk();
+				init();
+				record = m_last_record;
+			}
+			else
+			{
+				putRun(tdbb);
+				while (true)
+				{
+					run_control* run = m_runs;
+					const USHORT depth = run->run_depth;
+					if (depth == MAX_MERGE_LEVEL)
+						break;
+					USHORT count = 1;
+					while ((run = run->run_next) && run->run_depth == depth)
+						count++;
+					if (count < RUN_GROUP)
+						break;
+					mergeRuns(count);
+				}
+				init();
+				record = m_last_record;
 			}
-			init();
-			record = m_last_record;
 		}
 
 		record = NEXT_RECORD(record);
@@ -405,6 +653,26 @@ void Sort::put(thread_db* tdbb, ULONG** record_address)
 }
 
 
+void Sort::setParallel(int workers)
+{
+/**************************************
+ *
+ * Let the parallel workers generate the runs.
+ * It makes sense for the big sorts only, so nothing is done
+ * in parallel unless records don't fit into the sort buffer.
+ *
+ **************************************/
+	fb_assert(!m_records && !m_parallel);
+
+	// Limited sorts never leave the memory
+	if (m_flags & scb_top_records)
+		return;
+
+	if (workers > 1 && !m_parallel)
+		m_parallel = FB_NEW_POOL(m_owner->getPool()) ParallelSort(this, workers);
+}
+
+
 void Sort::sort(thread_db* tdbb)
 {
 /**************************************
@@ -421,11 +689,30 @@ void Sort::sort(thread_db* tdbb)
 
 	try
 	{
-		if (m_last_record != (SR*) m_end_memory)
+		if (m_last_record != (SR*) m_end_memory && !(m_flags & scb_keys_diddled))
 		{
 			diddleKey((UCHAR*) KEYOF(m_last_record), true, false);
 		}
 
+		// The spare record of the limited sort is still to be considered
+		if (m_flags & scb_heap_built)
+		{
+			offerRecord();
+			m_flags &= ~scb_heap_built;
+		}
+
+		// If some records were left for the parallel workers, pass them the rest
+		// and merge the runs generated by the workers.
+		if (m_parallel && m_parallel->hasChunks())
+		{
+			saveChunk();
+			init();
+
+			m_parallel->sort(tdbb);
+			m_flags |= scb_sorted;
+			return;
+		}
+
 		// If there aren't any runs, things fit nicely in memory. Just sort the mess
 		// and we're ready for output.
 		if (!m_runs)
@@ -655,6 +942,86 @@ void Sort::allocateBuffer(MemoryPool& pool)
 }
 
 
+int Sort::compareKeys(const SORTP* p, const SORTP* q) const noexcept
+{
+/**************************************
+ *
+ * Compare two diddled keys.
+ *
+ **************************************/
+	for (ULONG n = m_key_length; n; n--, p++, q++)
+	{
+		if (*p != *q)
+			return (*p > *q) ? 1 : -1;
+	}
+
+	return 0;
+}
+
+
+void Sort::buildHeap() noexcept
+{
+/**************************************
+ *
+ * Arrange the record pointers into a binary heap, the greatest key
+ * goes first. The heap is one-based, as the very first pointer
+ * refers to the low key.
+ *
+ **************************************/
+	for (ULONG i = (ULONG) m_records / 2; i > 0; i--)
+		siftDown(i);
+}
+
+
+void Sort::siftDown(ULONG i) noexcept
+{
+/**************************************
+ *
+ * Restore the heap property below the given position.
+ *
+ **************************************/
+	SORTP** const heap = (SORTP**) m_first_pointer;
+	const ULONG count = (ULONG) m_records;
+
+	while (true)
+	{
+		ULONG greatest = i;
+		const ULONG left = 2 * i, right = left + 1;
+
+		if (left <= count && compareKeys(heap[left], heap[greatest]) > 0)
+			greatest = left;
+
+		if (right <= count && compareKeys(heap[right], heap[greatest]) > 0)
+			greatest = right;
+
+		if (greatest == i)
+			break;
+
+		swap(heap + i, heap + greatest);
+		i = greatest;
+	}
+}
+
+
+void Sort::offerRecord() noexcept
+{
+/**************************************
+ *
+ * The spare record of the limited sort replaces the top of the heap
+ * if its key is less, otherwise it cannot be among the first records.
+ *
+ **************************************/
+	SORTP** const heap = (SORTP**) m_first_pointer;
+	SORTP* const spare = KEYOF(m_last_record);
+
+	if (compareKeys(spare, heap[1]) < 0)
+	{
+		MOVE_32(m_longs - SIZEOF_SR_BCKPTR_IN_LONGS, spare, heap[1]);
+		siftDown(1);
+	}
+}
+
+
 void Sort::releaseBuffer()
 {
 	if (m_flags & scb_reuse_buffer)
@@ -1956,7 +2323,7 @@ void Sort::orderAndSave(thread_db* tdbb)
  * scratch file as one big chunk
  *
  **************************************/
-	EngineCheckout cout(tdbb, FB_FUNCTION);
+	EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
 
 	run_control* run = m_runs;
 	run->run_records = 0;
@@ -2042,6 +2409,21 @@ void Sort::putRun(thread_db* tdbb)
 }
 
 
+void Sort::saveChunk()
+{
+/**************************************
+ *
+ * Save the records of the sort buffer, unsorted, into the
+ * scratch space to be processed by the parallel workers.
+ *
+ **************************************/
+	const ULONG length = m_end_memory - (UCHAR*) m_last_record;
+
+	if (length)
+		m_parallel->addChunk((UCHAR*) m_last_record, length);
+}
+
+
 void Sort::sortBuffer(thread_db* tdbb)
 {
 /**************************************
@@ -2052,23 +2434,29 @@ void Sort::sortBuffer(thread_db* tdbb)
  * been requested, detect and handle them.
  *
  **************************************/
-	EngineCheckout cout(tdbb, FB_FUNCTION);
+	// Partitions of the parallel sort are sorted by the workers without attachment
+	EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
 
 	// First, insert a pointer to the high key
 
 	*m_next_pointer = reinterpret_cast<sort_record*>(high_key);
 
 	// Next, call QuickSort. Keep in mind that the first pointer is the
-	// low key and not a record.
+	// low key and not a record. Bigger buffers are ordered by the radix
+	// sort, which compares the key bytes once per record instead of
+	// comparing whole keys O(n log n) times.
 
 	SORTP** j = (SORTP**) (m_first_pointer) + 1;
 	const ULONG n = (SORTP**) (m_next_pointer) - j;	// calculate # of records
 
-	quick(n, j, m_longs);
+	if (n >= RADIX_SORT_THRESHOLD)
+		radix(m_owner->getPool(), n, j, m_key_length);
+	else
+		quick(n, j, m_longs);
 
 	// Scream through and correct any out of order pairs
 	// hvlad: don't compare user keys against high_key
-	while (j < (SORTP**) m_next_pointer - 1)
+	while (n < RADIX_SORT_THRESHOLD && j < (SORTP**) m_next_pointer - 1)
 	{
 		SORTP** i = j;
 		j++;
@@ -2135,6 +2523,107 @@ void Sort::sortBuffer(thread_db* tdbb)
 }
 
 
+void Sort::radix(MemoryPool& pool, SLONG size, SORTP** pointers, ULONG length)
+{
+/**************************************
+ *
+ * Sort an array of record pointers by the most significant digit
+ * first radix sort, every byte of the key being a digit. Unlike
+ * quick(), the routine:
+ *
+ * a.  Compares only the first "length" longwords of the keys, the
+ *     order of the records having equal keys is not defined.
+ *
+ * b.  Needs no guard records around the array.
+ *
+ * c.  Sets the back pointers of the records itself, no final pass
+ *     is required.
+ *
+ **************************************/
+	struct Bucket
+	{
+		SORTP** begin;
+		ULONG count;
+		ULONG digit;
+	};
+
+	const ULONG digits = length * sizeof(SORTP);
+
+	Array<SORTP*> scratch(pool);
+	SORTP** const buffer = scratch.getBuffer(size);
+
+	// Buckets waiting to be sorted are disjoint and not smaller than
+	// RADIX_INSERTION_LIMIT, so the stack can't grow much
+
+	HalfStaticArray<Bucket, 64> stack(pool);
+	stack.push({pointers, (ULONG) size, 0});
+
+	ULONG counts[256];
+
+	while (stack.hasData())
+	{
+		const Bucket bucket = stack.pop();
+		SORTP** const begin = bucket.begin;
+		SORTP** const end = begin + bucket.count;
+
+		// Skip the digits equal for all the keys of the bucket
+
+		ULONG digit = bucket.digit;
+
+		for (; digit < digits; digit++)
+		{
+			memset(counts, 0, sizeof(counts));
+
+			for (SORTP** p = begin; p < end; p++)
+				counts[radixDigit(*p, digit)]++;
+
+			if (counts[radixDigit(*begin, digit)] != bucket.count)
+				break;
+		}
+
+		if (digit >= digits)
+			continue;
+
+		// Distribute the pointers by the digit value
+
+		ULONG offsets[256];
+		ULONG offset = 0;
+
+		for (ULONG i = 0; i < 256; i++)
+		{
+			offsets[i] = offset;
+			offset += counts[i];
+		}
+
+		for (SORTP** p = begin; p < end; p++)
+			buffer[offsets[radixDigit(*p, digit)]++] = *p;
+
+		memcpy(begin, buffer, bucket.count * sizeof(SORTP*));
+
+		// Order the buckets by the next digits
+
+		if (++digit >= digits)
+			continue;
+
+		SORTP** next = begin;
+
+		for (ULONG i = 0; i < 256; next += counts[i++])
+		{
+			if (counts[i] <= 1)
+				continue;
+
+			if (counts[i] <= RADIX_INSERTION_LIMIT)
+				insertionSort(next, next + counts[i], digit >> 2, length);
+			else
+				stack.push({next, counts[i], digit});
+		}
+	}
+
+	for (SORTP** p = pointers; p < pointers + size; p++)
+		((SORTP***) (*p))[BACK_OFFSET] = p;
+}
+
+
 void Sort::sortRunsBySeek(int n)
 {
 /**************************************
@@ -2442,3 +2931,148 @@ sort_record* PartitionedSort::getMerge()
 	return eof ? NULL : record;
 }
 
+
+
+/// class ParallelSort
+
+void ParallelSort::sort(thread_db* tdbb)
+{
+	Database* const dbb = m_sort->m_dbb;
+	const ULONG recordLength = (m_sort->m_longs << SHIFTLONG) - SIZEOF_SR_BCKPTR;
+	const FB_SIZE_T keys = m_sort->m_description.getCount();
+	const FB_SIZE_T workers = MIN((FB_SIZE_T) m_workers, m_chunks.getCount());
+
+	for (FB_SIZE_T i = 0; i < workers; i++)
+	{
+		Item* const item = FB_NEW_POOL(m_pool) Item(this);
+		m_items.add(item);
+
+		Sort* const partition = FB_NEW_POOL(m_pool) Sort(dbb, &item->m_owner,
+			recordLength, keys, keys, m_sort->m_description.begin(),
+			m_sort->m_dup_callback, m_sort->m_dup_callback_arg);
+
+		partition->m_unique_length = m_sort->m_unique_length;
+		partition->m_flags |= scb_keys_diddled;
+		item->m_partition = partition;
+	}
+
+	{
+		EngineCheckout cout(tdbb, FB_FUNCTION);
+
+		Coordinator coord(dbb->dbb_permanent);
+		coord.runSync(this);
+
+		FbLocalStatus local_status;
+		fb_utils::init_status(&local_status);
+
+		if (!getResult(&local_status))
+			local_status.raise();
+	}
+
+	// The chunks are not needed anymore
+	for (const auto& chunk : m_chunks)
+		m_sort->m_space->releaseSpace(chunk.seek, chunk.length);
+
+	m_merger = FB_NEW_POOL(m_pool) PartitionedSort(dbb, m_sort->m_owner);
+
+	for (Item** p = m_items.begin(); p < m_items.end(); p++)
+	{
+		Sort* const partition = (*p)->m_partition;
+
+		if (partition->m_records)
+		{
+			fb_assert(partition->isSorted());
+			m_merger->addPartition(partition);
+		}
+
+		(*p)->m_buffer.free();
+	}
+
+	m_merger->buildMergeTree();
+}
+
+bool ParallelSort::handler(WorkItem& _item)
+{
+	Item* const item = reinterpret_cast<Item*>(&_item);
+	Sort* const partition = item->m_partition;
+
+	try
+	{
+		if (item->m_chunk == NO_CHUNK)
+		{
+			partition->sort(NULL);
+			return true;
+		}
+
+		const Chunk& chunk = m_chunks[item->m_chunk];
+		UCHAR* const buffer = item->m_buffer.getBuffer(chunk.length);
+
+		{	// scope
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			Sort::readBlock(m_sort->m_space, chunk.seek, buffer, chunk.length);
+		}
+
+		// Records are copied with the keys already diddled, without back pointers
+
+		const ULONG recordSize = m_sort->m_longs << SHIFTLONG;
+		const ULONG dataLength = recordSize - SIZEOF_SR_BCKPTR;
+		const UCHAR* const end = buffer + chunk.length;
+
+		for (const UCHAR* p = buffer; p < end && !m_stop; p += recordSize)
+		{
+			ULONG* data = NULL;
+			partition->put(NULL, &data);
+			memcpy(data, reinterpret_cast<const SR*>(p)->sr_sort_record.sort_record_key, dataLength);
+		}
+
+		return !m_stop;
+	}
+	catch (const Exception& ex)
+	{
+		FbLocalStatus status;
+		ex.stuffException(&status);
+		setError(&status, true);
+	}
+
+	return false;
+}
+
+bool ParallelSort::getWorkItem(WorkItem** pItem)
+{
+	Item* item = reinterpret_cast<Item*> (*pItem);
+
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	if (m_stop)
+		return false;
+
+	if (item == NULL)
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+			if (!(*p)->m_inuse)
+			{
+				(*p)->m_inuse = true;
+				*pItem = item = *p;
+				break;
+			}
+	}
+
+	if (!item)
+		return false;
+
+	if (m_nextChunk < m_chunks.getCount())
+	{
+		item->m_chunk = m_nextChunk++;
+		return true;
+	}
+
+	// No more chunks, sort the runs of the partition
+	if (!item->m_finished)
+	{
+		item->m_finished = true;
+		item->m_chunk = NO_CHUNK;
+		return true;
+	}
+
+	return false;
+}
@@ -33,6 +33,7 @@ namespace Jrd {
 
 // Forward declaration
 class Attachment;
+class ParallelSort;
 class Sort;
 class SortOwner;
 struct merge_control;
@@ -272,10 +273,14 @@ typedef bool (*FPTR_REJECT_DUP_CALLBACK)(const UCHAR*, const UCHAR*, void*);
 
 inline constexpr int scb_sorted			= 1;	// stream has been sorted
 inline constexpr int scb_reuse_buffer	= 2;	// reuse buffer if possible
+inline constexpr int scb_keys_diddled	= 4;	// records are put with the keys already diddled
+inline constexpr int scb_top_records	= 8;	// keep only the first m_max_records records
+inline constexpr int scb_heap_built		= 16;	// records in memory form a heap, see Sort::put()
 
 class Sort
 {
 	friend class PartitionedSort;
+	friend class ParallelSort;
 public:
 	Sort(Database*, SortOwner*,
 		 ULONG, FB_SIZE_T, FB_SIZE_T, const sort_key_def*,
@@ -286,11 +291,17 @@ public:
 	void put(Jrd::thread_db*, ULONG**);
 	void sort(Jrd::thread_db*);
 
+	// Generate the runs by the parallel workers, must be called before the first put()
+	void setParallel(int workers);
+
 	bool isSorted() const noexcept
 	{
 		return m_flags & scb_sorted;
 	}
 
+	// Order the record pointers of the sort buffer, see sortBuffer()
+	static void radix(MemoryPool&, SLONG, SORTP**, ULONG);
+
 	static FB_UINT64 readBlock(TempSpace* space, FB_UINT64 seek, UCHAR* address, ULONG length)
 	{
 		const size_t bytes = space->read(seek, address, length);
@@ -309,6 +320,11 @@ private:
 	void allocateBuffer(MemoryPool&);
 	void releaseBuffer();
 
+	int compareKeys(const SORTP*, const SORTP*) const noexcept;
+	void buildHeap() noexcept;
+	void siftDown(ULONG) noexcept;
+	void offerRecord() noexcept;
+
 	void diddleKey(UCHAR*, bool, bool);
 	sort_record* getMerge(merge_control*);
 	sort_record* getRecord();
@@ -318,6 +334,7 @@ private:
 	ULONG order();
 	void orderAndSave(Jrd::thread_db*);
 	void putRun(Jrd::thread_db*);
+	void saveChunk();
 	void sortBuffer(Jrd::thread_db*);
 	void sortRunsBySeek(int);
 
@@ -339,7 +356,7 @@ private:
 	ULONG m_key_length;							// Key length
 	ULONG m_unique_length;						// Unique key length, used when duplicates eliminated
 	FB_UINT64 m_records;						// Number of records
-	FB_UINT64 m_max_records;					// Maximum number of records to store, assigned but unused.
+	FB_UINT64 m_max_records;					// Maximum number of records to return, zero if unlimited
 	TempSpace* m_space;							// temporary space for scratch file
 	run_control* m_runs;						// ALLOC: Run on scratch file, if any
 	merge_control* m_merge;						// Top level merge block
@@ -348,6 +365,7 @@ private:
 	FPTR_REJECT_DUP_CALLBACK m_dup_callback;	// Duplicate handling callback
 	void* m_dup_callback_arg;					// Duplicate handling callback arg
 	merge_control* m_merge_pool;				// ALLOC: pool of merge_control blocks
+	ParallelSort* m_parallel;					// ALLOC: parallel run generation, if any
 
 	ULONG m_min_alloc_size;						// MIN and MAX values
 	ULONG m_max_alloc_size;						// for the run buffer size
@@ -2978,6 +2978,8 @@ bool Service::process_switches(ClumpletReader& spb, string& switches)
 				break;
 			case isc_spb_bkp_factor:
 			case isc_spb_bkp_parallel_workers:
+			case isc_spb_res_index_memory:
+			case isc_spb_bkp_zip_level:
 			case isc_spb_res_buffers:
 			case isc_spb_res_page_size:
 			case isc_spb_verbint:
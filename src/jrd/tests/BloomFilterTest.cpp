@@ -0,0 +1,77 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/recsrc/BloomFilter.h"
+#include <random>
+#include <unordered_set>
+
+using namespace Firebird;
+using namespace Jrd;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(BloomFilterSuite)
+
+
+BOOST_AUTO_TEST_SUITE(BloomFilterTests)
+
+BOOST_AUTO_TEST_CASE(EmptyFilterTest)
+{
+	// Hash join doesn't reject anything until the filter is built
+	BloomFilter filter(*getDefaultMemoryPool());
+
+	for (ULONG hash = 0u; hash < 1'000u; ++hash)
+		BOOST_TEST(filter.check(hash));
+}
+
+BOOST_AUTO_TEST_CASE(FalsePositivesTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	for (const ULONG count : {1u, 10u, 1'000u, 100'000u})
+	{
+		std::mt19937 random(count);
+		std::unordered_set<ULONG> hashes;
+
+		while (hashes.size() < count)
+			hashes.insert(random());
+
+		BloomFilter filter(pool);
+		filter.init(count);
+
+		for (const auto hash : hashes)
+			filter.add(hash);
+
+		// Hashes put into the filter are never rejected
+
+		unsigned rejected = 0u;
+
+		for (const auto hash : hashes)
+			rejected += !filter.check(hash);
+
+		BOOST_TEST(rejected == 0u);
+
+		// Others are mostly rejected, the expected false positive rate is ~3%.
+		// Sequential values are checked too, as hashes of integer keys are.
+
+		constexpr unsigned CHECK_COUNT = 100'000u;
+		unsigned passed = 0u, checked = 0u;
+
+		for (ULONG i = 0u; checked < CHECK_COUNT; ++i)
+		{
+			const ULONG hash = (i % 2) ? random() : i;
+
+			if (hashes.find(hash) == hashes.end())
+			{
+				passed += filter.check(hash);
+				++checked;
+			}
+		}
+
+		BOOST_TEST(passed < CHECK_COUNT / 20, "false positives: " << passed << " of " << CHECK_COUNT);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// BloomFilterTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// BloomFilterSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
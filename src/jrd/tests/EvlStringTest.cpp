@@ -0,0 +1,82 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/StatusArg.h"
+#include "../jrd/evl_string.h"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <string_view>
+
+using namespace Firebird;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(EvlStringSuite)
+
+
+namespace
+{
+	std::string randomText(std::mt19937& random, size_t length, char lastChar)
+	{
+		std::string text(length, ' ');
+		std::uniform_int_distribution<int> chars('a', lastChar);
+
+		for (auto& c : text)
+			c = static_cast<char>(chars(random));
+
+		return text;
+	}
+
+	template <typename Evaluator>
+	bool processChunks(Evaluator& evaluator, std::string_view text, size_t chunkSize)
+	{
+		evaluator.reset();
+
+		for (size_t pos = 0; pos < text.length(); pos += chunkSize)
+		{
+			const auto length = std::min(chunkSize, text.length() - pos);
+			if (!evaluator.processNextChunk(reinterpret_cast<const UCHAR*>(text.data() + pos), length))
+				break;
+		}
+
+		return evaluator.getResult();
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(EvlStringTests)
+
+BOOST_AUTO_TEST_CASE(ContainsChunksTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+	std::mt19937 random(1);
+
+	for (const size_t patternLength : {1u, 2u, 3u, 5u, 17u, 40u})
+	{
+		for (unsigned i = 0u; i < 50u; ++i)
+		{
+			// Small alphabet produces many partial matches
+			const auto text = randomText(random, 300, 'c');
+			const auto pattern = randomText(random, patternLength, 'c');
+			const bool expected = text.find(pattern) != std::string::npos;
+
+			const auto patternStr = reinterpret_cast<const UCHAR*>(pattern.data());
+			ContainsEvaluator<UCHAR> contains(pool, patternStr, pattern.length());
+
+			const auto likePattern = "%" + pattern + "%";
+			LikeEvaluator<UCHAR> like(pool, reinterpret_cast<const UCHAR*>(likePattern.data()),
+				likePattern.length(), '\\', true, '%', '_');
+
+			for (const size_t chunkSize : {1u, 3u, 16u, 33u, 1000u})
+			{
+				BOOST_TEST(processChunks(contains, text, chunkSize) == expected);
+				BOOST_TEST(processChunks(like, text, chunkSize) == expected);
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// EvlStringTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// EvlStringSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -0,0 +1,153 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/recsrc/GroupTable.h"
+#include <map>
+
+using namespace Firebird;
+using namespace Jrd;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(GroupTableSuite)
+
+
+namespace
+{
+	// Entry: hash value, key, number of rows
+	struct Entry
+	{
+		ULONG hash;
+		ULONG key;
+		FB_UINT64 count;
+	};
+
+	const ULONG KEY_LENGTH = sizeof(ULONG);
+
+	struct Result
+	{
+		std::map<ULONG, FB_UINT64> groups;
+		unsigned duplicates = 0;
+		FB_UINT64 unsplitRows = 0;		// rows of the partitions that cannot be split
+		unsigned partitions = 0;
+	};
+
+	void insert(GroupTable& table, const Entry& row)
+	{
+		if (const auto group = (Entry*) table.find((const UCHAR*) &row))
+			group->count += row.count;
+		else if (!table.add((const UCHAR*) &row))
+			table.spill((const UCHAR*) &row);
+	}
+
+	void collect(GroupTable& table, Result& result)
+	{
+		while (const auto group = (const Entry*) table.fetch())
+		{
+			if (result.groups.find(group->key) != result.groups.end())
+				result.duplicates++;
+
+			result.groups[group->key] += group->count;
+		}
+	}
+
+	// Aggregate the rows as the hash aggregation does
+	template <typename HashFunc>
+	Result aggregate(ULONG groups, ULONG rowsPerGroup, ULONG memoryBudget, HashFunc hashFunc)
+	{
+		auto& pool = *getDefaultMemoryPool();
+		GroupTable table(pool, sizeof(Entry), KEY_LENGTH, memoryBudget);
+
+		for (ULONG i = 0; i < rowsPerGroup; i++)
+		{
+			for (ULONG key = 0; key < groups; key++)
+			{
+				Entry row = {};
+				row.hash = hashFunc(key);
+				row.key = key;
+				row.count = 1;
+
+				insert(table, row);
+			}
+		}
+
+		Result result;
+		collect(table, result);
+
+		while (table.startPartition())
+		{
+			result.partitions++;
+			const auto row = (const Entry*) table.getRowEntry();
+
+			if (table.isLastLevel())
+			{
+				while (table.readEntry())
+					result.unsplitRows += row->count;
+
+				continue;
+			}
+
+			while (table.readEntry())
+				insert(table, *row);
+
+			collect(table, result);
+		}
+
+		return result;
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(GroupTableTests)
+
+BOOST_AUTO_TEST_CASE(InMemoryTest)
+{
+	const auto result = aggregate(1'000u, 10u, 1024 * 1024, [](ULONG key) { return key * 7; });
+
+	BOOST_TEST(result.partitions == 0u);
+	BOOST_TEST(result.duplicates == 0u);
+	BOOST_TEST(result.groups.size() == 1'000u);
+
+	for (const auto& group : result.groups)
+		BOOST_TEST(group.second == 10u);
+}
+
+BOOST_AUTO_TEST_CASE(SpillingTest)
+{
+	// Minimal budget keeps about a thousand groups in memory
+	const auto result = aggregate(50'000u, 3u, 0, [](ULONG key) { return key; });
+
+	BOOST_TEST(result.partitions > 0u);
+	BOOST_TEST(result.duplicates == 0u);
+	BOOST_TEST(result.unsplitRows == 0u);
+	BOOST_TEST(result.groups.size() == 50'000u);
+
+	for (const auto& group : result.groups)
+		BOOST_TEST(group.second == 3u);
+}
+
+BOOST_AUTO_TEST_CASE(LastLevelTest)
+{
+	// Groups with the same hash value cannot be split, so they end up in the partition
+	// of the last level instead of growing the table beyond its budget
+	const ULONG groups = 5'000u, rowsPerGroup = 2u;
+	const auto result = aggregate(groups, rowsPerGroup, 0, [](ULONG) { return 0u; });
+
+	BOOST_TEST(result.duplicates == 0u);
+	BOOST_TEST(result.partitions == GroupTable::MAX_SPILL_LEVEL);
+	BOOST_TEST(result.unsplitRows > 0u);
+
+	FB_UINT64 rows = result.unsplitRows;
+
+	for (const auto& group : result.groups)
+	{
+		BOOST_TEST(group.second == rowsPerGroup);
+		rows += group.second;
+	}
+
+	BOOST_TEST(rows == FB_UINT64(groups) * rowsPerGroup);
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// GroupTableTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// GroupTableSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -0,0 +1,126 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/jrd.h"
+#include "../jrd/sort.h"
+#include <algorithm>
+#include <cstddef>
+#include <random>
+
+using namespace Firebird;
+using namespace Jrd;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(SortSuite)
+
+
+namespace
+{
+	const ULONG BCKPTR_LONGS = offsetof(SR, sr_sort_record) / sizeof(SORTP);
+	const int BACK_OFFSET = -static_cast<int>(offsetof(SR, sr_sort_record) / sizeof(SORTP*));
+
+	// Records laid out as in the sort buffer: back pointer followed by the key,
+	// with the guard keys around the array of pointers
+	class SortBuffer
+	{
+	public:
+		SortBuffer(MemoryPool& pool, ULONG count, ULONG keyLongs, unsigned seed)
+			: m_count(count),
+			  m_keyLongs(keyLongs),
+			  m_records(pool),
+			  m_original(pool),
+			  m_pointers(pool),
+			  m_lowKey(pool),
+			  m_highKey(pool)
+		{
+			const ULONG recordLongs = BCKPTR_LONGS + keyLongs;
+			SORTP* record = m_records.getBuffer(count * recordLongs);
+
+			// Keys mostly share their leading bytes, as diddled numbers and strings do
+
+			std::mt19937 random(seed);
+
+			for (ULONG i = 0; i < count; i++, record += recordLongs)
+			{
+				SORTP* const key = record + BCKPTR_LONGS;
+				key[0] = random() & 0x0F;
+
+				for (ULONG n = 1; n < keyLongs; n++)
+					key[n] = random();
+
+				m_original.add(key);
+			}
+
+			m_lowKey.resize(keyLongs, 0);
+			m_highKey.resize(keyLongs, MAX_ULONG);
+			m_pointers.resize(count + 2);
+		}
+
+		SORTP** reset()
+		{
+			SORTP** const pointers = m_pointers.begin() + 1;
+
+			pointers[-1] = m_lowKey.begin();
+			pointers[m_count] = m_highKey.begin();
+
+			for (ULONG i = 0; i < m_count; i++)
+			{
+				pointers[i] = m_original[i];
+				((SORTP***) pointers[i])[BACK_OFFSET] = pointers + i;
+			}
+
+			return pointers;
+		}
+
+		bool isSorted(SORTP** pointers) const
+		{
+			for (ULONG i = 0; i < m_count; i++)
+			{
+				if (((SORTP***) pointers[i])[BACK_OFFSET] != pointers + i)
+					return false;
+
+				if (i && std::lexicographical_compare(pointers[i], pointers[i] + m_keyLongs,
+						pointers[i - 1], pointers[i - 1] + m_keyLongs))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+	private:
+		const ULONG m_count;
+		const ULONG m_keyLongs;
+		Array<SORTP> m_records;
+		Array<SORTP*> m_original;
+		Array<SORTP*> m_pointers;
+		Array<SORTP> m_lowKey;
+		Array<SORTP> m_highKey;
+	};
+}
+
+
+BOOST_AUTO_TEST_SUITE(SortTests)
+
+BOOST_AUTO_TEST_CASE(RadixSortTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	for (const ULONG count : {1u, 2u, 31u, 33u, 1'000u})
+	{
+		for (const ULONG keyLongs : {1u, 3u, 16u})
+		{
+			SortBuffer buffer(pool, count, keyLongs, count + keyLongs);
+
+			SORTP** const pointers = buffer.reset();
+			Sort::radix(pool, count, pointers, keyLongs);
+			BOOST_TEST(buffer.isSorted(pointers));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// SortTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// SortSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -113,10 +113,57 @@ bool TipCache::MemBlockInitializer::initialize(SharedMemoryBase* sm, bool initFl
 	return true;
 }
 
+namespace
+{
+	// Per-thread cache of recently checked transaction states. Only final states
+	// (committed or dead) are cached, as they never change once assigned, thus
+	// entries need not be invalidated.
+	class StateCache
+	{
+	public:
+		bool get(FB_UINT64 owner, TraNumber number, CommitNumber& state) const noexcept
+		{
+			const Entry& entry = entries[number % CACHE_SIZE];
+			if (entry.owner != owner || entry.number != number)
+				return false;
+
+			state = entry.state;
+			return true;
+		}
+
+		void put(FB_UINT64 owner, TraNumber number, CommitNumber state) noexcept
+		{
+			Entry& entry = entries[number % CACHE_SIZE];
+			entry.owner = owner;
+			entry.number = number;
+			entry.state = state;
+		}
+
+	private:
+		static constexpr unsigned CACHE_SIZE = 256;
+
+		struct Entry
+		{
+			FB_UINT64 owner;
+			TraNumber number;
+			CommitNumber state;
+		};
+
+		Entry entries[CACHE_SIZE] = {};
+	};
+
+	thread_local StateCache stateCache;
+
+	// Zero is never assigned, so empty cache entries never match
+	std::atomic<FB_UINT64> lastInstanceId(0);
+}
+
 TipCache::TipCache(Database* dbb)
 	: m_tpcHeader(NULL), m_snapshots(NULL), m_transactionsPerBlock(0), m_lock(nullptr),
 	  globalTpcInitializer(this), snapshotsInitializer(this), memBlockInitializer(this),
-	  m_blocks_memory(*dbb->dbb_permanent)
+	  m_blocks_memory(*dbb->dbb_permanent),
+	  m_directory(nullptr),
+	  m_instanceId(++lastInstanceId)
 {
 }
 
@@ -124,6 +171,7 @@ TipCache::~TipCache()
 {
 	// Make sure that object is finalized before being deleted
 	fb_assert(!m_blocks_memory.getFirst());
+	fb_assert(!m_directory.load(std::memory_order_relaxed));
 	fb_assert(!m_snapshots);
 	fb_assert(!m_tpcHeader);
 	fb_assert(m_transactionsPerBlock == 0);
@@ -175,6 +223,9 @@ void TipCache::finalizeTpc(thread_db* tdbb)
 	m_blocks_memory.clear();
 	m_transactionsPerBlock = 0;
 
+	if (const auto directory = m_directory.exchange(nullptr, std::memory_order_acq_rel))
+		BlockDirectory::destroy(directory);
+
     if (nmSnap.hasData() || nmHdr.hasData())
     {
     	if (LCK_lock(tdbb, m_lock, LCK_EX, LCK_NO_WAIT))
@@ -205,22 +256,32 @@ CommitNumber TipCache::cacheState(TraNumber number)
 	if (number < oldest)
 		return CN_PREHISTORIC;
 
+	CommitNumber state;
+	if (stateCache.get(m_instanceId, number, state))
+		return state;
+
 	const TpcBlockNumber blockNumber = number / m_transactionsPerBlock;
 	const ULONG offset = number % m_transactionsPerBlock;
 
-	Sync sync(&m_sync_status, FB_FUNCTION);
-	const TransactionStatusBlock* block = getTransactionStatusBlock(header, blockNumber, sync);
+	if (!readCachedState(blockNumber, offset, state))
+	{
+		Sync sync(&m_sync_status, FB_FUNCTION);
+		const TransactionStatusBlock* block = getTransactionStatusBlock(header, blockNumber, sync);
 
-	// This should not really happen ever
-	fb_assert(block);
+		// This should not really happen ever
+		fb_assert(block);
 
-	if (!block)
-		return CN_PREHISTORIC;
+		if (!block)
+			return CN_PREHISTORIC;
 
-	// Barrier is not needed here when we are reading state from cache
-	// because all callers of this function are prepared to handle
-	// slightly out-dated information and will take slow path if necessary
-	CommitNumber state = block->data[offset];
+		// Barrier is not needed here when we are reading state from cache
+		// because all callers of this function are prepared to handle
+		// slightly out-dated information and will take slow path if necessary
+		state = block->data[offset].load(std::memory_order_relaxed);
+	}
+
+	if (state == CN_DEAD || (state >= CN_PREHISTORIC && state <= CN_MAX_NUMBER))
+		stateCache.put(m_instanceId, number, state);
 
 	return state;
 }
@@ -385,7 +446,9 @@ TipCache::StatusBlockData::StatusBlockData(thread_db* tdbb, TipCache* tipCache,
 		// Appropriate locking is performed by existenceLock using LM.
 		// This should be in sync with SharedMemoryBase::unlinkFile() call
 		// in TipCache::StatusBlockData::clear().
-		memory = FB_NEW_POOL(*dbb->dbb_permanent) SharedMemory<TransactionStatusBlock>(
+		// Memory may be unmapped after the database is released (see BlockDirectory),
+		// thus it's allocated from the default pool.
+		memory = FB_NEW_POOL(*getDefaultMemoryPool()) SharedMemory<TransactionStatusBlock>(
 			fileName.c_str(), blockSize,
 			&cache->memBlockInitializer, true);
 
@@ -456,7 +519,7 @@ void TipCache::StatusBlockData::clear(thread_db* tdbb)
 		}
 
 		fName = memory->getMapFileName();
-		delete memory;
+		cache->releaseTransactionStatusBlock(blockNumber, memory);
 		memory = NULL;
 	}
 
@@ -491,7 +554,116 @@ TipCache::TransactionStatusBlock* TipCache::createTransactionStatusBlock(ULONG b
 
 	m_blocks_memory.add(blockData);
 
-	return blockData->memory->getHeader();
+	TransactionStatusBlock* const block = blockData->memory->getHeader();
+	publishTransactionStatusBlock(blockNumber, block);
+
+	return block;
+}
+
+bool TipCache::readCachedState(TpcBlockNumber blockNumber, ULONG offset, CommitNumber& state) const
+{
+	// Block memory is unmapped not before the directory copy it was found in
+	// is reclaimed, thus it's safe to read while the hazard pointer is held
+	HazardPtr<BlockDirectory> directory(m_directory);
+
+	if (!directory || !directory->covers(blockNumber))
+		return false;
+
+	const TransactionStatusBlock* const block = directory->slot(blockNumber).load(std::memory_order_acquire);
+
+	if (!block)
+		return false;
+
+	// Barrier is not needed here, see cacheState()
+	state = block->data[offset].load(std::memory_order_relaxed);
+	return true;
+}
+
+void TipCache::publishTransactionStatusBlock(TpcBlockNumber blockNumber, TransactionStatusBlock* block)
+{
+	MutexLockGuard guard(m_directory_mutex, FB_FUNCTION);
+
+	BlockDirectory* const directory = m_directory.load(std::memory_order_relaxed);
+
+	if (directory && directory->covers(blockNumber))
+	{
+		directory->slot(blockNumber).store(block, std::memory_order_release);
+		return;
+	}
+
+	// Build new directory with the room for twice as many blocks as currently
+	// mapped. New blocks are mapped after the last one, old blocks are released
+	// from the beginning, thus the range starts with the first mapped block.
+
+	TpcBlockNumber first = blockNumber, last = blockNumber;
+
+	if (directory)
+	{
+		for (ULONG i = 0; i < directory->dir_capacity; i++)
+		{
+			if (directory->slot(directory->dir_base + i).load(std::memory_order_relaxed))
+			{
+				first = MIN(first, directory->dir_base + i);
+				last = MAX(last, directory->dir_base + i);
+			}
+		}
+	}
+
+	const ULONG capacity = MAX(ULONG(last - first + 1) * 2, MIN_DIRECTORY_CAPACITY);
+	BlockDirectory* const newDirectory = BlockDirectory::create(first, capacity);
+
+	if (directory)
+	{
+		for (ULONG i = 0; i < directory->dir_capacity; i++)
+		{
+			const TpcBlockNumber number = directory->dir_base + i;
+
+			if (const auto cur = directory->slot(number).load(std::memory_order_relaxed))
+				newDirectory->slot(number).store(cur, std::memory_order_relaxed);
+		}
+	}
+
+	newDirectory->slot(blockNumber).store(block, std::memory_order_relaxed);
+	m_directory.store(newDirectory, std::memory_order_release);
+
+	if (directory)
+		BlockDirectory::destroy(directory);
+}
+
+void TipCache::releaseTransactionStatusBlock(TpcBlockNumber blockNumber,
+	SharedMemory<TransactionStatusBlock>* memory)
+{
+	MutexLockGuard guard(m_directory_mutex, FB_FUNCTION);
+
+	BlockDirectory* const directory = m_directory.load(std::memory_order_relaxed);
+
+	if (!directory || !directory->covers(blockNumber) ||
+		!directory->slot(blockNumber).load(std::memory_order_relaxed))
+	{
+		delete memory;
+		return;
+	}
+
+	// Readers may still use the block found in the current directory, so replace
+	// it with the copy without the block and pass the memory to the old one
+
+	BlockDirectory* const newDirectory = BlockDirectory::create(directory->dir_base, directory->dir_capacity);
+
+	for (ULONG i = 0; i < directory->dir_capacity; i++)
+	{
+		const TpcBlockNumber number = directory->dir_base + i;
+
+		if (number != blockNumber)
+		{
+			newDirectory->slot(number).store(directory->slot(number).load(std::memory_order_relaxed),
+				std::memory_order_relaxed);
+		}
+	}
+
+	m_directory.store(newDirectory, std::memory_order_release);
+
+	directory->dir_released = memory;
+	BlockDirectory::destroy(directory);
 }
 
 TipCache::TransactionStatusBlock* TipCache::getTransactionStatusBlock(const GlobalTpcHeader* header, TpcBlockNumber blockNumber, Sync& sync)
@@ -752,7 +924,7 @@ int TipCache::tpc_block_blocking_ast(void* arg)
 		// Release shared memory
 		if (data->memory)
 		{
-			delete data->memory;
+			cache->releaseTransactionStatusBlock(data->blockNumber, data->memory);
 			data->memory = NULL;
 		}
 		LCK_release(tdbb, &data->existenceLock);
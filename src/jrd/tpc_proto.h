@@ -28,7 +28,9 @@
 #include "../common/classes/array.h"
 #include "../common/classes/fb_string.h"
 #include "../common/classes/SyncObject.h"
+#include "../common/classes/locks.h"
 #include "../jrd/tra.h"
+#include "../jrd/HazardPtr.h"
 
 namespace Ods {
 
@@ -316,8 +318,60 @@ private:
 
 	typedef Firebird::BePlusTree<StatusBlockData*, TpcBlockNumber, StatusBlockData> BlocksMemoryMap;
 
+	// Process-local directory of mapped blocks, indexed by block number starting
+	// from dir_base. It is read without locks. When it can't hold a new block or
+	// a block is released it is replaced as a whole, the old one is retired using
+	// hazard pointers. Memory of the released block is unmapped together with
+	// the old copy, i.e. when no reader could access it anymore.
+	class BlockDirectory : public HazardObject, public pool_alloc_rpt<std::atomic<TransactionStatusBlock*>>
+	{
+	private:
+		BlockDirectory(TpcBlockNumber base, ULONG capacity) noexcept
+			: dir_base(base), dir_capacity(capacity)
+		{
+			for (ULONG i = 0; i < dir_capacity; i++)
+				dir_blocks[i].store(nullptr, std::memory_order_relaxed);
+		}
+
+		~BlockDirectory()
+		{
+			delete dir_released;
+		}
+
+	public:
+		static BlockDirectory* create(TpcBlockNumber base, ULONG capacity)
+		{
+			return FB_NEW_RPT(*getDefaultMemoryPool(), capacity) BlockDirectory(base, capacity);
+		}
+
+		static void destroy(BlockDirectory* directory)
+		{
+			// delay delete - someone else may access it
+			directory->retire();
+		}
+
+		bool covers(TpcBlockNumber blockNumber) const noexcept
+		{
+			return blockNumber >= dir_base && blockNumber - dir_base < dir_capacity;
+		}
+
+		std::atomic<TransactionStatusBlock*>& slot(TpcBlockNumber blockNumber) noexcept
+		{
+			fb_assert(covers(blockNumber));
+			return dir_blocks[blockNumber - dir_base];
+		}
+
+		const TpcBlockNumber dir_base;
+		const ULONG dir_capacity;
+		Firebird::SharedMemory<TransactionStatusBlock>* dir_released = nullptr;
+
+	private:
+		std::atomic<TransactionStatusBlock*> dir_blocks[1];
+	};
+
 	static constexpr ULONG TPC_VERSION = 2;
 	static constexpr int SAFETY_GAP_BLOCKS = 1;
+	static constexpr ULONG MIN_DIRECTORY_CAPACITY = 16;
 
 	Firebird::SharedMemory<GlobalTpcHeader>* m_tpcHeader; // final
 	Firebird::SharedMemory<SnapshotList>* m_snapshots; // final
@@ -335,6 +389,14 @@ private:
 
 	Firebird::SyncObject m_sync_status;
 
+	// Lock-free copy of the tree above used by cacheState.
+	// Changed with m_directory_mutex locked, also from AST.
+	std::atomic<BlockDirectory*> m_directory;
+	Firebird::Mutex m_directory_mutex;
+
+	// Distinguishes instances in per-thread caches of transaction states
+	const FB_UINT64 m_instanceId; // final
+
 	// Attach to shared memory objects and populate process-local structures.
 	// If shared memory area did not exist - populate initial TIP by reading cache
 	// from disk.
@@ -350,6 +412,17 @@ private:
 	// If returns not NULL then sync remains locked.
 	TransactionStatusBlock* getTransactionStatusBlock(const GlobalTpcHeader* header, TpcBlockNumber blockNumber, Firebird::Sync& sync);
 
+	// Lock-free read of transaction state from the block found in m_directory.
+	// Returns false if block is not mapped yet or is no longer cached.
+	bool readCachedState(TpcBlockNumber blockNumber, ULONG offset, CommitNumber& state) const;
+
+	// Add mapped block to m_directory.
+	void publishTransactionStatusBlock(TpcBlockNumber blockNumber, TransactionStatusBlock* block);
+
+	// Remove block from m_directory and unmap its memory once it can't be read anymore.
+	void releaseTransactionStatusBlock(TpcBlockNumber blockNumber,
+		Firebird::SharedMemory<TransactionStatusBlock>* memory);
+
 	// Map shared memory for a block.
 	// Assume exclusive lock of m_sync_status.
 	TransactionStatusBlock* createTransactionStatusBlock(ULONG blockSize, TpcBlockNumber blockNumber);
@@ -645,6 +645,13 @@ static void explain_pp_bits(const UCHAR bits, Firebird::string& names)
 		names.append("secondary");
 	}
 
+	if (bits & ppg_dp_all_visible)
+	{
+		if (!names.empty())
+			names.append(", ");
+		names.append("all-visible");
+	}
+
 	if (bits & ppg_dp_empty)
 	{
 		if (!names.empty())
@@ -1759,6 +1766,9 @@ Validation::RTN Validation::walk_data_page(jrd_rel* relation, ULONG page_number,
 	if (dp_flags & dpg_secondary)
 		pp_bits |= ppg_dp_secondary;
 
+	if (dp_flags & dpg_all_visible)
+		pp_bits |= ppg_dp_all_visible;
+
 	if (page->dpg_count == 0)
 		pp_bits |= ppg_dp_empty;
 
@@ -2914,6 +2924,12 @@ void restoreFlags(UCHAR* byte, UCHAR flags, bool empty)
 	else
 		*byte &= ~bit;
 
+	bit = PPG_DP_BIT_MASK(slot, ppg_dp_all_visible);
+	if (flags & dpg_all_visible)
+		*byte |= bit;
+	else
+		*byte &= ~bit;
+
 	bit = PPG_DP_BIT_MASK(slot, ppg_dp_empty);
 	if (empty)
 		*byte |= bit;
@@ -1177,6 +1177,17 @@ bool VIO_chase_record_version(thread_db* tdbb, record_param* rpb,
 		rpb->rpb_f_page, rpb->rpb_f_line);
 #endif
 
+	// Data page marked as all-visible contains only primary versions created by
+	// transactions committed before any snapshot could be started, so there is
+	// neither need to look at the transaction state nor anything to collect
+
+	if (!(rpb->rpb_flags & (rpb_deleted | rpb_damaged | rpb_gc_active)) && !rpb->rpb_b_page &&
+		DPM_is_all_visible(tdbb, rpb))
+	{
+		rpb->rpb_runtime_flags &= ~RPB_CLEAR_FLAGS;
+		return true;
+	}
+
 	CommitNumber current_snapshot_number;
 	bool int_gc_done = (attachment->att_flags & ATT_no_cleanup);
 
@@ -2349,6 +2360,10 @@ bool VIO_erase(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
 			DFW_post_work(transaction, dfw_change_repl_state, {}, {}, 1);
 			break;
 
+		case rel_column_stats:
+			protect_system_table_delupd(tdbb, relation, "DELETE");
+			break;
+
 		default:    // Shut up compiler warnings
 			break;
 		}
@@ -3361,6 +3376,7 @@ bool VIO_modify(thread_db* tdbb, record_param* org_rpb, record_param* new_rpb, j
 		case rel_roles:
 		case rel_ccon:
 		case rel_pub_tables:
+		case rel_column_stats:
 		case rel_priv:
 		case rel_dpds:
 			protect_system_table_delupd(tdbb, relation, "UPDATE");
@@ -4645,6 +4661,10 @@ void VIO_store(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
 			DFW_post_work(transaction, dfw_change_repl_state, {}, {}, 1);
 			break;
 
+		case rel_column_stats:
+			protect_system_table_insert(tdbb, request, relation);
+			break;
+
 		default:    // Shut up compiler warnings
 			break;
 		}
@@ -5611,6 +5631,378 @@ void VIO_garbage_collect_idx(thread_db* tdbb, jrd_tra* transaction,
 	clearRecordStack(staying);
 }
 
+
+namespace Jrd
+{
+
+// Background garbage collection performed by a few parallel workers. Data pages
+// queued for garbage collection are split into chunks by relation and range of
+// data page sequence numbers, so different workers never compete for the same page.
+
+class GCTask : public Task
+{
+	static const ULONG CHUNK_PAGES = 64;	// max range of data pages in the chunk
+
+public:
+	GCTask(thread_db* tdbb, MemoryPool* pool, GarbageCollector* gc, int workers) : Task(),
+		m_pool(pool),
+		m_dbb(tdbb->getDatabase()),
+		m_gc(gc),
+		m_items(*m_pool),
+		m_pages(*m_pool),
+		m_chunks(*m_pool),
+		m_nextChunk(0),
+		m_stop(false)
+	{
+		for (int i = 0; i < workers; i++)
+			m_items.add(FB_NEW_POOL(*m_pool) Item(this));
+
+		// The first item works using garbage collector own attachment and transaction
+
+		m_items[0]->m_ownAttach = false;
+		m_items[0]->m_attStable = tdbb->getAttachment()->getStable();
+		m_items[0]->m_tra = tdbb->getTransaction();
+	}
+
+	virtual ~GCTask()
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+			delete *p;
+	}
+
+	class Item : public Task::WorkItem
+	{
+	public:
+		Item(GCTask* task) : Task::WorkItem(task),
+			m_inuse(false),
+			m_ownAttach(true),
+			m_tra(NULL),
+			m_chunk(0)
+		{}
+
+		virtual ~Item()
+		{
+			if (!m_ownAttach || !m_attStable)
+				return;
+
+			Attachment* att = NULL;
+			{
+				AttSyncLockGuard guard(*m_attStable->getSync(), FB_FUNCTION);
+				att = m_attStable->getHandle();
+				if (!att)
+					return;
+				fb_assert(att->att_use_count > 0);
+			}
+
+			FbLocalStatus status;
+			if (m_tra)
+			{
+				BackgroundContextHolder tdbb(att->att_database, att, &status, FB_FUNCTION);
+				TRA_commit(tdbb, m_tra, false);
+			}
+
+			att->att_flags &= ~ATT_garbage_collector;
+			WorkerAttachment::releaseAttachment(&status, m_attStable);
+		}
+
+		GCTask* getGCTask() const
+		{
+			return reinterpret_cast<GCTask*> (m_task);
+		}
+
+		bool init(thread_db* tdbb)
+		{
+			FbStatusVector* status = tdbb->tdbb_status_vector;
+
+			Attachment* att = NULL;
+
+			if (m_ownAttach && !m_attStable.hasData())
+				m_attStable = WorkerAttachment::getAttachment(status, getGCTask()->m_dbb);
+
+			if (m_attStable)
+				att = m_attStable->getHandle();
+
+			if (!att)
+			{
+				Arg::Gds(isc_bad_db_handle).copyTo(status);
+				return false;
+			}
+
+			tdbb->setDatabase(att->att_database);
+			tdbb->setAttachment(att);
+
+			if (m_ownAttach && !m_tra)
+			{
+				// Records which can't be collected yet must be queued
+				// again, as it's done by the garbage collector itself
+
+				att->att_flags |= ATT_garbage_collector;
+
+				try
+				{
+					WorkerContextHolder holder(tdbb, FB_FUNCTION);
+					m_tra = TRA_start(tdbb, sizeof(gc_tpb), gc_tpb);
+				}
+				catch (const Exception& ex)
+				{
+					ex.stuffException(tdbb->tdbb_status_vector);
+					return false;
+				}
+			}
+
+			tdbb->setTransaction(m_tra);
+			tdbb->markAsSweeper();
+
+			return true;
+		}
+
+		bool m_inuse;
+		bool m_ownAttach;
+		RefPtr<StableAttachmentPart> m_attStable;
+		jrd_tra* m_tra;
+
+		// part of work: index of chunk to work on
+		FB_SIZE_T m_chunk;
+	};
+
+	// take pages of all relations ready for garbage collection
+	bool collect(const TraNumber oldest_snapshot);
+
+	bool handler(WorkItem& _item);
+	bool getWorkItem(WorkItem** pItem);
+
+	bool getResult(IStatus* status)
+	{
+		if (status)
+		{
+			status->init();
+			status->setErrors(m_status.getErrors());
+		}
+
+		return m_status.isSuccess();
+	}
+
+	int getMaxWorkers()
+	{
+		return MIN(m_items.getCount(), m_chunks.getCount());
+	}
+
+private:
+	void addPages(USHORT relID, PageBitmap* pages);
+
+	void setError(IStatus* status)
+	{
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		if (m_status.isSuccess() && status && status->getState() == IStatus::STATE_ERRORS)
+			m_status.save(status);
+	}
+
+	struct Chunk
+	{
+		USHORT relID;
+		FB_SIZE_T first;	// first page in m_pages
+		FB_SIZE_T count;	// number of pages
+	};
+
+	MemoryPool* m_pool;
+	Database* m_dbb;
+	GarbageCollector* m_gc;
+	Mutex m_mutex;
+	HalfStaticArray<Item*, 8> m_items;
+	StatusHolder m_status;
+	Array<ULONG> m_pages;		// data page sequence numbers, grouped by chunks
+	Array<Chunk> m_chunks;
+	FB_SIZE_T m_nextChunk;		// next chunk to work on
+	volatile bool m_stop;
+};
+
+
+bool GCTask::collect(const TraNumber oldest_snapshot)
+{
+	SortedArray<USHORT> relations;
+
+	USHORT relID;
+	PageBitmap* pages;
+
+	while ((pages = m_gc->getPages(oldest_snapshot, relID)))
+	{
+		addPages(relID, pages);
+		delete pages;
+
+		// Relations are returned in circular order, stop when the same relation is met again
+
+		if (relations.exist(relID))
+			break;
+
+		relations.add(relID);
+	}
+
+	return m_chunks.hasData();
+}
+
+
+void GCTask::addPages(USHORT relID, PageBitmap* pages)
+{
+	Chunk* chunk = NULL;
+
+	if (pages->getFirst())
+	{
+		do
+		{
+			const ULONG dp_sequence = pages->current();
+
+			if (!chunk || dp_sequence / CHUNK_PAGES != m_pages[chunk->first] / CHUNK_PAGES)
+			{
+				chunk = &m_chunks.add();
+				chunk->relID = relID;
+				chunk->first = m_pages.getCount();
+				chunk->count = 0;
+			}
+
+			m_pages.add(dp_sequence);
+			chunk->count++;
+		} while (pages->getNext());
+	}
+}
+
+
+bool GCTask::handler(WorkItem& _item)
+{
+	Item* item = reinterpret_cast<Item*>(&_item);
+
+	ThreadContextHolder tdbb(NULL);
+
+	if (!item->init(tdbb))
+	{
+		setError(tdbb->tdbb_status_vector);
+		return false;
+	}
+
+	WorkerContextHolder wrkHolder(tdbb, FB_FUNCTION);
+
+	Database* const dbb = tdbb->getDatabase();
+	const Chunk& chunk = m_chunks[item->m_chunk];
+
+	record_param rpb;
+	rpb.getWindow(tdbb).win_flags = WIN_garbage_collector;
+	rpb.rpb_stream_flags = RPB_s_no_data | RPB_s_sweeper;
+
+	try
+	{
+		jrd_rel* const relation =
+			MetadataCache::getVersioned<Cached::Relation>(tdbb, chunk.relID, CacheFlag::AUTOCREATE);
+
+		if (!relation || getPermanent(relation)->isDropped())
+		{
+			m_gc->removeRelation(chunk.relID);
+			return !m_stop;
+		}
+
+		GCLock::Shared gcGuard(tdbb, getPermanent(relation));
+		if (!gcGuard.gcEnabled())
+			return !m_stop;
+
+		jrd_tra* const transaction = tdbb->getTransaction();
+		const SINT64 start = fb_utils::query_performance_counter();
+
+		rpb.rpb_relation = relation;
+
+		const ULONG* const end = m_pages.begin() + chunk.first + chunk.count;
+		const ULONG* dp = m_pages.begin() + chunk.first;
+		bool rel_exit = false;
+
+		for (; dp < end && !rel_exit && !m_stop; dp++)
+		{
+			transaction->tra_oldest = dbb->dbb_oldest_transaction;
+			transaction->tra_oldest_active = dbb->dbb_oldest_snapshot;
+
+			rpb.rpb_number.setValue(((SINT64) *dp * dbb->dbb_max_records) - 1);
+			const RecordNumber last(rpb.rpb_number.getValue() + dbb->dbb_max_records);
+
+			// Attempt to garbage collect all records on the data page.
+
+			while (VIO_next_record(tdbb, &rpb, transaction, NULL, DPM_next_data_page))
+			{
+				CCH_RELEASE(tdbb, &rpb.getWindow(tdbb));
+
+				if (!(dbb->dbb_flags & DBB_garbage_collector))
+				{
+					m_stop = true;
+					break;
+				}
+
+				if (getPermanent(relation)->isDropped() ||
+					getPermanent(relation)->rel_gc_lock.checkDisabled())
+				{
+					rel_exit = true;
+					break;
+				}
+
+				JRD_reschedule(tdbb);
+
+				if (rpb.rpb_number >= last)
+					break;
+
+				transaction->tra_oldest = dbb->dbb_oldest_transaction;
+				transaction->tra_oldest_active = dbb->dbb_oldest_snapshot;
+			}
+		}
+
+		if (TipCache* cache = dbb->dbb_tip_cache)
+			cache->updateActiveSnapshots(tdbb, &tdbb->getAttachment()->att_active_snapshots);
+
+		m_gc->processed(chunk.relID, (ULONG) (dp - m_pages.begin() - chunk.first),
+			fb_utils::elapsedMicroseconds(start));
+
+		delete rpb.rpb_record;
+		return !m_stop;
+	}
+	catch (const Exception& ex)
+	{
+		ex.stuffException(tdbb->tdbb_status_vector);
+		delete rpb.rpb_record;
+	}
+
+	setError(tdbb->tdbb_status_vector);
+	return false;
+}
+
+
+bool GCTask::getWorkItem(WorkItem** pItem)
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	Item* item = reinterpret_cast<Item*> (*pItem);
+
+	if (item == NULL)
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+		{
+			if (!(*p)->m_inuse)
+			{
+				(*p)->m_inuse = true;
+				*pItem = item = *p;
+				break;
+			}
+		}
+	}
+
+	if (!item)
+		return false;
+
+	if (m_stop || m_nextChunk >= m_chunks.getCount())
+	{
+		item->m_inuse = false;
+		return false;
+	}
+
+	item->m_chunk = m_nextChunk++;
+	return true;
+}
+
+} // namespace Jrd
+
+
 void Database::garbage_collector(Database* dbb)
 {
 /**************************************
@@ -5677,6 +6069,7 @@ void Database::garbage_collector(Database* dbb)
 			// to finish up and exit.
 
 			bool flush = false;
+			const int gcWorkers = dbb->dbb_config->getGCParallelWorkers();
 
 			while (dbb->dbb_flags & DBB_garbage_collector)
 			{
@@ -5703,7 +6096,40 @@ void Database::garbage_collector(Database* dbb)
 				USHORT relID;
 				PageBitmap* gc_bitmap = NULL;
 
-				if ((dbb->dbb_flags & DBB_gc_pending) &&
+				if (gcWorkers > 1)
+				{
+					if (dbb->dbb_flags & DBB_gc_pending)
+					{
+						if (!transaction)
+						{
+							transaction = TRA_start(tdbb, sizeof(gc_tpb), gc_tpb);
+							tdbb->setTransaction(transaction);
+						}
+
+						{	// scope
+							EngineCheckout cout(tdbb, FB_FUNCTION);
+
+							GCTask task(tdbb, dbb->dbb_permanent, gc, gcWorkers);
+
+							if (task.collect(dbb->dbb_oldest_snapshot))
+							{
+								found = flush = true;
+
+								Coordinator coord(dbb->dbb_permanent);
+								coord.runSync(&task);
+
+								// Errors of the workers are not fatal for the garbage collector
+
+								FbLocalStatus local_status;
+								if (!task.getResult(&local_status))
+									iscDbLogStatus(dbb->dbb_filename.c_str(), &local_status);
+							}
+						}
+
+						tdbb->setTransaction(transaction);
+					}
+				}
+				else if ((dbb->dbb_flags & DBB_gc_pending) &&
 					(gc_bitmap = gc->getPages(dbb->dbb_oldest_snapshot, relID)))
 				{
 					relation = MetadataCache::getVersioned<Cached::Relation>(tdbb, relID, CacheFlag::AUTOCREATE);
@@ -5722,6 +6148,9 @@ void Database::garbage_collector(Database* dbb)
 
 						rpb.rpb_relation = relation;
 
+						const SINT64 start = fb_utils::query_performance_counter();
+						ULONG processed = 0;
+
 						while (gc_bitmap->getFirst())
 						{
 							const ULONG dp_sequence = gc_bitmap->current();
@@ -5749,6 +6178,7 @@ void Database::garbage_collector(Database* dbb)
 							}
 
 							found = flush = true;
+							processed++;
 							rpb.rpb_number.setValue(((SINT64) dp_sequence * dbb->dbb_max_records) - 1);
 							const RecordNumber last(rpb.rpb_number.getValue() + dbb->dbb_max_records);
 
@@ -5797,6 +6227,8 @@ void Database::garbage_collector(Database* dbb)
 								break;
 						}
 
+						gc->processed(relID, processed, fb_utils::elapsedMicroseconds(start));
+
 						if (gc_exit)
 							break;
 
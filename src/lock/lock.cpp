@@ -58,6 +58,7 @@
 
 #include <stdio.h>
 #include <errno.h>
+#include <thread>
 
 #ifdef HAVE_SYS_TYPES_H
 #include <sys/types.h>
@@ -138,6 +139,24 @@ using namespace Firebird;
 
 constexpr SRQ_PTR DUMMY_OWNER = -1;
 
+// Let the CPU know we're spinning on a busy lock table
+static inline void spin_pause()
+{
+#if defined(WIN_NT)
+	YieldProcessor();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	__builtin_ia32_pause();
+#elif defined(__GNUC__) && defined(__aarch64__)
+	asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Conditional attempts to take the busy process-local lock table mutex before sleeping.
+// A failed attempt with the pause hint takes ~30ns on current x86 CPUs while the futex
+// sleep/wakeup handoff takes ~2.5us, so spinning for about 1us costs less than
+// a context switch and the lock table is often released meanwhile.
+constexpr ULONG LOCAL_MUTEX_SPINS = 32;
+
 constexpr SLONG HASH_MIN_SLOTS	= 101;
 constexpr SLONG HASH_MAX_SLOTS	= 65521;
 constexpr USHORT HISTORY_BLOCKS	= 256;
@@ -176,6 +195,7 @@ LockManager::LockManager(const string& id, const Config* conf)
 	  m_dbId(id),
 	  m_config(conf),
 	  m_acquireSpins(m_config->getLockAcquireSpins()),
+	  m_localSpins(std::thread::hardware_concurrency() > 1 ? MAX(m_acquireSpins, LOCAL_MUTEX_SPINS) : 1),
 	  m_memorySize(m_config->getLockMemSize()),
 	  m_hashSlots(m_config->getLockHashSlots()),
 	  m_useBlockingThread(m_config->getServerMode() != MODE_SUPER)
@@ -1043,6 +1063,35 @@ LOCK_DATA_T LockManager::writeData(SRQ_PTR request_offset, LOCK_DATA_T data)
 }
 
 
+void LockManager::acquire_local(const char* from)
+{
+/**************************************
+ *
+ *	a c q u i r e _ l o c a l
+ *
+ **************************************
+ *
+ * Functional description
+ *	Acquire the process-local lock table mutex.
+ *	Spin for a while before going to sleep: the lock table
+ *	is usually held for a very short time and a context
+ *	switch costs more than a few conditional attempts.
+ *	It makes no sense on a single CPU machine.
+ *
+ **************************************/
+	for (ULONG spins = 0; spins < m_localSpins; spins++)
+	{
+		if (m_localMutex.tryEnter(from))
+			return;
+
+		spin_pause();
+	}
+
+	m_localMutex.enter(from);
+	m_blockage = true;
+}
+
+
 void LockManager::acquire_shmem(SRQ_PTR owner_offset)
 {
 /**************************************
@@ -1073,6 +1122,7 @@ void LockManager::acquire_shmem(SRQ_PTR owner_offset)
 		}
 
 		m_blockage = true;
+		spin_pause();
 	}
 
 	// If the spin wait didn't succeed then wait forever
@@ -310,11 +310,7 @@ private:
 		explicit LockTableGuard(LockManager* lm, const char* f, SRQ_PTR owner = 0)
 			: m_lm(lm), m_owner(owner)
 		{
-			if (!m_lm->m_localMutex.tryEnter(f))
-			{
-				m_lm->m_localMutex.enter(f);
-				m_lm->m_blockage = true;
-			}
+			m_lm->acquire_local(f);
 
 			if (m_owner)
 				m_lm->acquire_shmem(m_owner);
@@ -371,12 +367,7 @@ private:
 		{
 			try
 			{
-				if (!m_lm->m_localMutex.tryEnter(FB_LOCKED_FROM))
-				{
-					m_lm->m_localMutex.enter(FB_LOCKED_FROM);
-					m_lm->m_blockage = true;
-				}
-
+				m_lm->acquire_local(FB_LOCKED_FROM);
 				m_lm->acquire_shmem(m_owner);
 			}
 			catch (const Firebird::Exception&)
@@ -424,6 +415,7 @@ public:
 	void exceptionHandler(const Firebird::Exception& ex, ThreadFinishSync<LockManager*>::ThreadRoutine* routine);
 
 private:
+	void acquire_local(const char*);
 	void acquire_shmem(SRQ_PTR);
 	UCHAR* alloc(USHORT, Firebird::CheckStatusWrapper*);
 	lbl* alloc_lock(USHORT, Firebird::CheckStatusWrapper*);
@@ -507,6 +499,7 @@ private:
 
 	// configurations parameters - cached values
 	const ULONG m_acquireSpins;
+	const ULONG m_localSpins;		// attempts to take m_localMutex before sleeping
 	ULONG m_memorySize;
 	USHORT m_hashSlots;
 	const bool m_useBlockingThread;
@@ -95,6 +95,10 @@
 #include <sys/select.h>
 #endif
 
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+
 #endif // !WIN_NT
 
 constexpr int INET_RETRY_CALL = 5;
@@ -389,6 +393,16 @@ public:
 #endif
 	}
 
+	void set(rem_port* port)
+	{
+		set(port->port_handle);
+	}
+
+	// socket is going to be closed
+	void closed(SOCKET /*handle*/)
+	{
+	}
+
 	void set(SOCKET handle)
 	{
 #ifdef HAVE_POLL
@@ -501,6 +515,304 @@ private:
 #endif
 };
 
+#ifdef HAVE_SYS_EPOLL_H
+// Used by the multiclient server main loop instead of Select.
+// Sockets are registered in epoll when their ports are waited for the first
+// time and stay registered while they are waited for, so the kernel doesn't
+// scan all sockets on every wakeup. Only ports that are ready, have expired
+// keepalive timer or a bad socket are checked after the wait.
+// Readiness is level-triggered and there is a single main loop dispatching
+// requests to the common worker queue, there are no per-core loops.
+
+class EpollSelect
+{
+public:
+	typedef Select::HandleState HandleState;
+
+	EpollSelect()
+		: slct_time(0), slct_count(0), slct_epoll(-1), slct_round(0), slct_next(0),
+		  slct_ports(*getDefaultMemoryPool()), slct_check(*getDefaultMemoryPool())
+	{ }
+
+	explicit EpollSelect(MemoryPool& pool)
+		: slct_time(0), slct_count(0), slct_epoll(-1), slct_round(0), slct_next(0),
+		  slct_ports(pool), slct_check(pool)
+	{ }
+
+	~EpollSelect()
+	{
+		clearCheck();
+
+		for (auto& reg : slct_ports)
+			unreference(reg.port);
+
+		if (slct_epoll >= 0)
+			close(slct_epoll);
+	}
+
+	void checkStart(RemPortPtr& /*port*/)
+	{
+		slct_next = 0;
+#ifdef WIRE_COMPRESS_SUPPORT
+		slct_zport = nullptr;
+#endif
+	}
+
+	// assume port_mutex is locked
+	HandleState checkNext(RemPortPtr& port)
+	{
+#ifdef WIRE_COMPRESS_SUPPORT
+		if (slct_zport)
+		{
+			if (slct_zport->port_z_data &&
+				(slct_zport->port_state != rem_port::DISCONNECTED))
+			{
+				port = slct_zport;
+				slct_zport = nullptr;	// Will be set again by select_multi() if needed
+				return Select::SEL_READY;
+			}
+
+			slct_zport = nullptr;
+		}
+#endif
+
+		while (slct_next < slct_check.getCount())
+		{
+			const Check& check = slct_check[slct_next++];
+
+			if (check.port->port_state == rem_port::DISCONNECTED)
+				continue;
+
+			port = check.port;
+#ifdef WIRE_COMPRESS_SUPPORT
+			if (port->port_z_data)
+				return Select::SEL_READY;
+#endif
+			return check.state;
+		}
+
+		port = nullptr;
+		return Select::SEL_NO_DATA;
+	}
+
+	void setZDataPort(RemPortPtr& port)
+	{
+#ifdef WIRE_COMPRESS_SUPPORT
+		slct_zport = port;
+#endif
+	}
+
+	void unset(SOCKET /*handle*/)
+	{
+	}
+
+	// start new round of registration
+	void clear()
+	{
+		slct_count = 0;
+		slct_round++;
+		clearCheck();
+#ifdef WIRE_COMPRESS_SUPPORT
+		slct_zport = nullptr;
+#endif
+	}
+
+	// wait for the port in current round, assume port_mutex is locked
+	void set(rem_port* port)
+	{
+		const SOCKET handle = port->port_handle;
+
+		if (handle == INVALID_SOCKET)
+		{
+			addCheck(port, (port->port_flags & PORT_disconnect) ? Select::SEL_DISCONNECTED : Select::SEL_BAD);
+			return;
+		}
+
+		if (port->port_dummy_timeout < 0)
+			addCheck(port, Select::SEL_NO_DATA);
+
+		FB_SIZE_T pos;
+		if (slct_ports.find(handle, pos))
+		{
+			Registration& reg = slct_ports[pos];
+			if (reg.port == port)
+			{
+				reg.round = slct_round;
+				return;
+			}
+
+			// Socket was closed and its handle is reused by another port
+			unreference(reg.port);
+			slct_ports.remove(pos);
+		}
+
+		if (!open())
+			return;
+
+		epoll_event event {};
+		event.events = EPOLLIN;
+		event.data.fd = handle;
+
+		if (epoll_ctl(slct_epoll, EPOLL_CTL_ADD, handle, &event) != 0 &&
+			(errno != EEXIST || epoll_ctl(slct_epoll, EPOLL_CTL_MOD, handle, &event) != 0))
+		{
+			// this will lead to receive() which will break bad connection
+			addCheck(port, Select::SEL_READY);
+			return;
+		}
+
+		port->addRef();
+
+		Registration reg;
+		reg.handle = handle;
+		reg.port = port;
+		reg.round = slct_round;
+		slct_ports.insert(pos, reg);
+	}
+
+	// socket is going to be closed, assume port_mutex is locked
+	void closed(SOCKET handle)
+	{
+		FB_SIZE_T pos;
+		if (slct_ports.find(handle, pos))
+		{
+			epoll_ctl(slct_epoll, EPOLL_CTL_DEL, handle, nullptr);
+			unreference(slct_ports[pos].port);
+			slct_ports.remove(pos);
+		}
+	}
+
+	void select(timeval* timeout)
+	{
+		removeStale();
+
+		if (!open())
+		{
+			slct_count = -1;
+			return;
+		}
+
+		// Don't wait if some ports need to be checked anyway
+		int milliseconds = timeout ? timeout->tv_sec * 1000 + timeout->tv_usec / 1000 : -1;
+		if (slct_check.hasData())
+			milliseconds = 0;
+
+		slct_count = epoll_wait(slct_epoll, slct_events, MAX_EVENTS, milliseconds);
+
+		for (int i = 0; i < slct_count; i++)
+		{
+			// Errors and hangups are reported as ready too, receive() will detect them
+			FB_SIZE_T pos;
+			if (slct_ports.find(slct_events[i].data.fd, pos))
+				addCheck(slct_ports[pos].port, Select::SEL_READY);
+		}
+	}
+
+	int getCount() noexcept
+	{
+		return slct_count;
+	}
+
+	time_t	slct_time;
+
+private:
+	static constexpr int MAX_EVENTS = 256;
+
+	struct Registration
+	{
+		SOCKET handle;
+		rem_port* port;		// referenced
+		unsigned round;		// last round the port was waited for
+
+		static SOCKET generate(const Registration& item)
+		{
+			return item.handle;
+		}
+	};
+
+	struct Check
+	{
+		rem_port* port;		// referenced
+		HandleState state;
+	};
+
+	// release reference added by addRef()
+	static void unreference(rem_port* port)
+	{
+		RemPortPtr(REF_NO_INCR, port);
+	}
+
+	bool open()
+	{
+		if (slct_epoll < 0)
+			slct_epoll = epoll_create1(EPOLL_CLOEXEC);
+
+		return slct_epoll >= 0;
+	}
+
+	void addCheck(rem_port* port, HandleState state)
+	{
+		port->addRef();
+
+		Check check;
+		check.port = port;
+		check.state = state;
+		slct_check.add(check);
+	}
+
+	void clearCheck()
+	{
+		for (auto& check : slct_check)
+			unreference(check.port);
+
+		slct_check.clear();
+		slct_next = 0;
+	}
+
+	// Stop waiting for sockets of the ports not waited for in current round
+	void removeStale()
+	{
+		FB_SIZE_T n = 0;
+
+		for (FB_SIZE_T i = 0; i < slct_ports.getCount(); i++)
+		{
+			Registration& reg = slct_ports[i];
+
+			if (reg.round != slct_round)
+			{
+				// If the socket is closed already, epoll has forgotten it itself
+				if (reg.port->port_handle == reg.handle)
+					epoll_ctl(slct_epoll, EPOLL_CTL_DEL, reg.handle, nullptr);
+
+				unreference(reg.port);
+				continue;
+			}
+
+			if (n != i)
+				slct_ports[n] = reg;
+			n++;
+		}
+
+		slct_ports.shrink(n);
+	}
+
+	int		slct_count;
+	int		slct_epoll;
+	unsigned	slct_round;
+	FB_SIZE_T	slct_next;		// next port to check for readiness
+	SortedArray<Registration, EmptyStorage<Registration>, SOCKET, Registration> slct_ports;
+	HalfStaticArray<Check, 16> slct_check;
+	epoll_event slct_events[MAX_EVENTS];
+#ifdef WIRE_COMPRESS_SUPPORT
+	RemPortPtr slct_zport;	// port with some compressed data remaining in the buffer
+#endif
+};
+
+typedef EpollSelect MultiSelect;
+#else
+typedef Select MultiSelect;
+#endif // HAVE_SYS_EPOLL_H
+
 static bool		accept_connection(rem_port*, const P_CNCT*);
 #ifdef HAVE_SETITIMER
 static void		alarm_handler(int);
@@ -565,9 +877,9 @@ static bool		packet_send(rem_port*, const SCHAR*, SSHORT);
 static rem_port*		receive(rem_port*, PACKET *);
 static rem_port*		select_accept(rem_port*);
 
-static void		select_port(rem_port*, Select*, RemPortPtr&);
+static void		select_port(rem_port*, MultiSelect*, RemPortPtr&);
 static bool		select_multi(rem_port*, UCHAR* buffer, SSHORT bufsize, SSHORT* length, RemPortPtr&);
-static bool		select_wait(rem_port*, Select*);
+static bool		select_wait(rem_port*, MultiSelect*);
 static int		send_full(rem_port*, PACKET *);
 static int		send_partial(rem_port*, PACKET *);
 
@@ -616,7 +928,7 @@ ULONG INET_remote_buffer;
 static GlobalPtr<Mutex> init_mutex;
 static volatile bool INET_initialized = false;
 static volatile bool INET_shutting_down = false;
-static GlobalPtr<Select> INET_select;
+static GlobalPtr<MultiSelect> INET_select;
 static rem_port* inet_async_receive = NULL;
 
 
@@ -2187,7 +2499,7 @@ static rem_port* select_accept( rem_port* main_port)
 	return 0;
 }
 
-static void select_port(rem_port* main_port, Select* selct, RemPortPtr& port)
+static void select_port(rem_port* main_port, MultiSelect* selct, RemPortPtr& port)
 {
 /**************************************
  *
@@ -2237,7 +2549,7 @@ static void select_port(rem_port* main_port, Select* selct, RemPortPtr& port)
 	}
 }
 
-static bool select_wait( rem_port* main_port, Select* selct)
+static bool select_wait( rem_port* main_port, MultiSelect* selct)
 {
 /**************************************
  *
@@ -2279,6 +2591,7 @@ static bool select_wait( rem_port* main_port, Select* selct)
 			while (ports_to_close->hasData())
 			{
 				SOCKET s = ports_to_close->pop();
+				selct->closed(s);
 				SOCLOSE(s);
 			}
 
@@ -2322,7 +2635,7 @@ static bool select_wait( rem_port* main_port, Select* selct)
 								selct->clear();
 								if (!badSocket)
 								{
-									selct->set(port->port_handle);
+									selct->set(port);
 								}
 								return true;
 							}
@@ -2332,7 +2645,7 @@ static bool select_wait( rem_port* main_port, Select* selct)
 					// if process is shuting down - don't listen on main port
 					if (!INET_shutting_down || port != main_port)
 					{
-						selct->set(port->port_handle);
+						selct->set(port);
 						found = true;
 					}
 				}
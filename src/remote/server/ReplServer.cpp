@@ -32,10 +32,13 @@
 #include "../common/os/path_utils.h"
 #include "../common/isc_proto.h"
 #include "../common/classes/ClumpletWriter.h"
+#include "../common/classes/GenericMap.h"
+#include "../common/classes/locks.h"
 #include "../common/ThreadStart.h"
 #include "../common/utils_proto.h"
 #include "../common/classes/ParsedList.h"
 #include "../common/status.h"
+#include "../common/TimeZoneUtil.h"
 
 #include "../jrd/replication/ChangeLog.h"
 #include "../jrd/replication/Config.h"
@@ -46,6 +49,8 @@
 #include <sys/stat.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <time.h>
+#include <atomic>
 
 #ifdef HAVE_SYS_FILE_H
 #include <sys/file.h>
@@ -75,6 +80,10 @@ namespace
 	inline constexpr USHORT CTL_VERSION1 = 1;
 	inline constexpr USHORT CTL_CURRENT_VERSION = CTL_VERSION1;
 
+	// With parallel apply, the workers are drained at least that often (in seconds)
+	// to save the current position
+	inline constexpr time_t PARTIAL_SAVE_INTERVAL = 1;
+
 	volatile bool shutdownFlag = false;
 	AtomicCounter activeThreads;
 	Semaphore shutdownSemaphore;
@@ -134,6 +143,14 @@ namespace
 		return oldest;
 	}
 
+	SINT64 getMilliseconds(const ISC_TIMESTAMP& value)
+	{
+		static constexpr SINT64 MSEC_PER_DAY = 24 * 60 * 60 * 1000;
+
+		return ((SINT64) value.timestamp_date) * MSEC_PER_DAY +
+			(SINT64) value.timestamp_time / 10;
+	}
+
 	class ControlFile : public AutoFile
 	{
 		struct DataV1
@@ -336,6 +353,397 @@ namespace
 #endif
 	};
 
+	// Parallel apply support
+
+	class BlockScanner
+	{
+	public:
+		BlockScanner(MemoryPool& pool, ULONG length, const UCHAR* data)
+			: m_header((const Block*) data),
+			  m_data(data + sizeof(Block)),
+			  m_end(data + length),
+			  m_atoms(pool)
+		{
+		}
+
+		// Collect the tables changed by the block and detect operations that
+		// must not be applied concurrently with other transactions.
+		// Returns false if the block cannot be parsed.
+
+		bool scan(SortedObjectsArray<string>& relations, bool& exclusive, bool& cleanup)
+		{
+			while (m_data < m_end)
+			{
+				const UCHAR op = *m_data++;
+
+				switch (op)
+				{
+				case opCommitTransaction:
+					if (m_header->protocol >= PROTOCOL_VERSION_4)
+					{
+						ISC_TIMESTAMP commitTime;
+						if (!get(commitTime))
+							return false;
+						m_commitTime = commitTime;
+					}
+					break;
+
+				case opStartTransaction:
+				case opPrepareTransaction:
+				case opRollbackTransaction:
+				case opStartSavepoint:
+				case opReleaseSavepoint:
+				case opRollbackSavepoint:
+					break;
+
+				case opCleanupTransaction:
+					if (!m_header->traNumber)
+						cleanup = true;
+					break;
+
+				case opInsertRecord:
+				case opDeleteRecord:
+					if (!getRelation(relations) || !skipString())
+						return false;
+					break;
+
+				case opUpdateRecord:
+					if (!getRelation(relations) || !skipString() || !skipString())
+						return false;
+					break;
+
+				case opStoreBlob:
+					if (!skip(2 * sizeof(SLONG)))
+						return false;
+					while (m_data < m_end)
+					{
+						SSHORT length;
+						if (!get(length))
+							return false;
+						if (!length)
+							break;
+						if (!skip((USHORT) length))
+							return false;
+					}
+					break;
+
+				case opExecuteSql:
+				case opExecuteSqlIntl:
+					exclusive = true;
+					if (!skip(sizeof(SLONG)))
+						return false;
+					if (op == opExecuteSqlIntl)
+					{
+						if (m_header->protocol >= PROTOCOL_VERSION_2 && !skip(sizeof(SLONG)))
+							return false;
+						if (!skip(sizeof(UCHAR)))
+							return false;
+					}
+					if (!skipString())
+						return false;
+					break;
+
+				case opSetSequence:
+					exclusive = true;
+					if (!skip((m_header->protocol >= PROTOCOL_VERSION_2 ? 2 : 1) * sizeof(SLONG)))
+						return false;
+					if (!skip(sizeof(SINT64)))
+						return false;
+					break;
+
+				case opDefineAtom:
+					{
+						UCHAR length;
+						if (!get(length) || m_data + length > m_end)
+							return false;
+						m_atoms.add(string((const char*) m_data, length));
+						m_data += length;
+					}
+					break;
+
+				default:
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		// Commit time of the transaction (UTC), if sent by the primary
+
+		const std::optional<ISC_TIMESTAMP>& getCommitTime() const
+		{
+			return m_commitTime;
+		}
+
+	private:
+		template <typename T>
+		bool get(T& value)
+		{
+			if (m_data + sizeof(T) > m_end)
+				return false;
+
+			memcpy(&value, m_data, sizeof(T));
+			m_data += sizeof(T);
+			return true;
+		}
+
+		bool skip(ULONG length)
+		{
+			if (m_data + length > m_end)
+				return false;
+
+			m_data += length;
+			return true;
+		}
+
+		bool skipString()
+		{
+			SLONG length;
+			return get(length) && length >= 0 && skip(length);
+		}
+
+		bool getAtom(string& name)
+		{
+			SLONG pos;
+			if (!get(pos) || pos < 0 || (FB_SIZE_T) pos >= m_atoms.getCount())
+				return false;
+
+			name = m_atoms[pos];
+			return true;
+		}
+
+		bool getRelation(SortedObjectsArray<string>& relations)
+		{
+			string name;
+			if (!getAtom(name))
+				return false;
+
+			if (m_header->protocol >= PROTOCOL_VERSION_2)
+			{
+				string object;
+				if (!getAtom(object))
+					return false;
+
+				name += '.';
+				name += object;
+			}
+
+			if (!relations.exist(name))
+				relations.add(name);
+
+			return true;
+		}
+
+		const Block* const m_header;
+		const UCHAR* m_data;
+		const UCHAR* const m_end;
+		ObjectsArray<string> m_atoms;
+		std::optional<ISC_TIMESTAMP> m_commitTime;
+	};
+
+	class ApplyWorker : public GlobalStorage
+	{
+		struct Job
+		{
+			Job(MemoryPool& pool, FB_UINT64 seq, ULONG off, ULONG length, const UCHAR* data)
+				: sequence(seq), offset(off), block(pool)
+			{
+				block.add(data, length);
+			}
+
+			const FB_UINT64 sequence;
+			const ULONG offset;
+			Array<UCHAR> block;
+		};
+
+	public:
+		ApplyWorker(IAttachment* attachment, IReplicator* replicator)
+			: m_attachment(attachment), m_replicator(replicator),
+			  m_queue(getPool()), m_ended(getPool()),
+			  m_queued(0), m_completed(0), m_failed(false), m_stop(false),
+			  m_errorSequence(0), m_errorOffset(0)
+		{
+			Thread::start(workerThread, this, THREAD_medium, &m_thread);
+		}
+
+		~ApplyWorker()
+		{
+			{	// scope
+				MutexLockGuard guard(m_mutex, FB_FUNCTION);
+				m_stop = true;
+			}
+
+			m_wakeup.release();
+			m_thread.waitForCompletion();
+
+			while (m_queue.hasData())
+				delete m_queue.pop();
+
+			FbLocalStatus localStatus;
+			m_replicator->close(&localStatus);
+			m_attachment->detach(&localStatus);
+		}
+
+		// The methods below are called by the dispatching thread only
+
+		FB_UINT64 enqueue(FB_UINT64 sequence, ULONG offset, ULONG length, const UCHAR* data)
+		{
+			const auto job = FB_NEW_POOL(getPool()) Job(getPool(), sequence, offset, length, data);
+
+			{	// scope
+				MutexLockGuard guard(m_mutex, FB_FUNCTION);
+				m_queue.add(job);
+			}
+
+			m_wakeup.release();
+			return ++m_queued;
+		}
+
+		FB_UINT64 getPending() const
+		{
+			return m_queued - m_completed.load(std::memory_order_acquire);
+		}
+
+		// Wait for the given job to be applied, return false if the worker has failed
+
+		bool waitFor(FB_UINT64 ticket)
+		{
+			while (!m_failed.load(std::memory_order_acquire) &&
+				m_completed.load(std::memory_order_acquire) < ticket)
+			{
+				m_done.tryEnter(0, 100);
+			}
+
+			return !hasFailed();
+		}
+
+		bool flush()
+		{
+			return waitFor(m_queued);
+		}
+
+		bool hasFailed() const
+		{
+			return m_failed.load(std::memory_order_acquire);
+		}
+
+		const FbLocalStatus& getStatus(FB_UINT64& sequence, ULONG& offset) const
+		{
+			fb_assert(hasFailed());
+
+			sequence = m_errorSequence;
+			offset = m_errorOffset;
+			return m_status;
+		}
+
+		// Remember the last job of a transaction that changed the given group of tables
+
+		void setEnded(const string& group, FB_UINT64 ticket)
+		{
+			m_ended.put(group, ticket);
+		}
+
+		// Return the job to be waited for before another worker may change
+		// the given group of tables, or zero if there is nothing to wait for
+
+		FB_UINT64 getEnded(const string& group)
+		{
+			if (const auto ticket = m_ended.get(group))
+			{
+				if (*ticket > m_completed.load(std::memory_order_acquire))
+					return *ticket;
+
+				m_ended.remove(group);
+			}
+
+			return 0;
+		}
+
+		void clearEnded()
+		{
+			m_ended.clear();
+		}
+
+	private:
+		static THREAD_ENTRY_DECLARE workerThread(THREAD_ENTRY_PARAM arg)
+		{
+			static_cast<ApplyWorker*>(arg)->run();
+			return 0;
+		}
+
+		void run()
+		{
+			while (true)
+			{
+				m_wakeup.enter();
+
+				Job* job = nullptr;
+
+				{	// scope
+					MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+					if (m_stop)
+						break;
+
+					if (m_queue.isEmpty())
+						continue;
+
+					job = m_queue[0];
+					m_queue.remove((FB_SIZE_T) 0);
+				}
+
+				// After an error, the remaining jobs are skipped until the target
+				// reconnects and re-applies the segments from the point of failure
+
+				if (!m_failed.load(std::memory_order_relaxed))
+				{
+					m_replicator->process(&m_status, job->block.getCount(), job->block.begin());
+
+					if (!m_status.isSuccess())
+					{
+						m_errorSequence = job->sequence;
+						m_errorOffset = job->offset;
+						m_failed.store(true, std::memory_order_release);
+					}
+				}
+
+				delete job;
+
+				m_completed.fetch_add(1, std::memory_order_release);
+				m_done.release();
+			}
+		}
+
+		IAttachment* const m_attachment;
+		IReplicator* const m_replicator;
+		Thread m_thread;
+		Mutex m_mutex;
+		Semaphore m_wakeup;
+		Semaphore m_done;
+		Array<Job*> m_queue;
+		LeftPooledMap<string, FB_UINT64> m_ended;
+		FB_UINT64 m_queued;
+		std::atomic<FB_UINT64> m_completed;
+		std::atomic<bool> m_failed;
+		bool m_stop;
+		FbLocalStatus m_status;
+		FB_UINT64 m_errorSequence;
+		ULONG m_errorOffset;
+	};
+
+	struct ApplyTransaction
+	{
+		ApplyTransaction(MemoryPool& pool, FB_SIZE_T workerNumber)
+			: worker(workerNumber), groups(pool), exclusive(false)
+		{
+		}
+
+		const FB_SIZE_T worker;
+		SortedObjectsArray<string> groups;
+		bool exclusive;
+	};
+
 	class Target : public GlobalStorage
 	{
 	public:
@@ -343,7 +751,9 @@ namespace
 			: m_config(config),
 			  m_attachment(nullptr), m_replicator(nullptr),
 			  m_sequence(0), m_connected(false),
-			  m_lastError(getPool()), m_errorSequence(0), m_errorOffset(0)
+			  m_lastError(getPool()), m_errorSequence(0), m_errorOffset(0),
+			  m_workers(getPool()), m_transactions(getPool()), m_groups(getPool()),
+			  m_conflict(false), m_serialApply(false), m_serialSequence(0)
 		{
 		}
 
@@ -367,24 +777,10 @@ namespace
 			if (m_connected)
 				return m_sequence;
 
-			ClumpletWriter dpb(ClumpletReader::dpbList, MAX_DPB_SIZE);
-
-			dpb.insertByte(isc_dpb_no_db_triggers, 1);
-			dpb.insertString(isc_dpb_user_name, DBA_USER_NAME);
-			dpb.insertString(isc_dpb_config, ParsedList::getNonLoopbackProviders(m_config->dbName));
-
-			if (m_config->schemaSearchPath.hasData())
-				dpb.insertString(isc_dpb_search_path, m_config->schemaSearchPath.c_str());
-
 #ifndef NO_DATABASE
-			DispatcherPtr provider;
 			FbLocalStatus localStatus;
 
-			const auto att =
-				provider->attachDatabase(&localStatus, m_config->dbName.c_str(),
-										 dpb.getBufferLength(), dpb.getBuffer());
-			localStatus.check();
-			m_attachment = att;
+			m_attachment = attach();
 
 			const auto repl = m_attachment->createReplicator(&localStatus);
 			localStatus.check();
@@ -408,6 +804,26 @@ namespace
 			localStatus.check();
 
 			m_sequence = result->sequence;
+
+			if (m_config->applyParallelWorkers > 1 && !m_serialApply)
+			{
+				loadDependencies();
+
+				for (ULONG i = 0; i < m_config->applyParallelWorkers; i++)
+				{
+					const auto att = attach();
+					const auto repl = att->createReplicator(&localStatus);
+
+					if (!localStatus.isSuccess())
+					{
+						FbLocalStatus tempStatus;
+						att->detach(&tempStatus);
+						localStatus.raise();
+					}
+
+					m_workers.add(FB_NEW_POOL(getPool()) ApplyWorker(att, repl));
+				}
+			}
 #endif
 			m_connected = true;
 
@@ -416,6 +832,12 @@ namespace
 
 		void shutdown()
 		{
+			while (m_workers.hasData())
+				delete m_workers.pop();
+
+			clearTransactions();
+			m_groups.clear();
+
 			FbLocalStatus localStatus;
 			if (m_replicator)
 			{
@@ -436,11 +858,107 @@ namespace
 #ifdef NO_DATABASE
 			return true;
 #else
+			// Compressed blocks are unpacked here, so that both the dispatcher
+			// and the workers deal with the plain contents
+
+			UCharBuffer buffer;
+			data = decompressBlock(data, buffer);
+			length = sizeof(Block) + ((const Block*) data)->length;
+
+			if (m_workers.hasData())
+			{
+				dispatch(sequence, offset, length, data);
+				return;
+			}
+
 			fb_assert(m_replicator);
 
 			FbLocalStatus localStatus;
 			m_replicator->process(&localStatus, length, data);
 			checkCompletion(localStatus, sequence, offset);
+
+			if (((const Block*) data)->flags & BLOCK_END_TRANS)
+			{
+				BlockScanner scanner(getPool(), length, data);
+				SortedObjectsArray<string> relations(getPool());
+				bool exclusive = false, cleanup = false;
+
+				if (scanner.scan(relations, exclusive, cleanup) && scanner.getCommitTime().has_value())
+					m_commitTime = scanner.getCommitTime();
+			}
+#endif
+		}
+
+		// Wait for all the dispatched blocks to be applied
+
+		void flush()
+		{
+			for (const auto worker : m_workers)
+			{
+				if (!worker->flush())
+					checkWorker(worker);
+			}
+		}
+
+		bool isIdle() const
+		{
+			for (const auto worker : m_workers)
+			{
+				if (worker->getPending())
+					return false;
+			}
+
+			return true;
+		}
+
+		// Publish the apply state as session context variables of the replica
+		// attachment, so that it can be watched through MON$CONTEXT_VARIABLES.
+		// The lag is the time passed since the last applied transaction was committed
+		// on the primary, it's unknown (NULL) unless the primary sends commit times.
+		// Must be called when all the dispatched blocks are applied.
+
+		void reportProgress()
+		{
+#ifndef NO_DATABASE
+			fb_assert(m_attachment);
+
+			FbLocalStatus localStatus;
+
+			string lag = "NULL";
+
+			if (m_commitTime.has_value())
+			{
+				const ISC_TIMESTAMP now = TimeZoneUtil::getCurrentGmtTimeStamp().utc_timestamp;
+				const SINT64 delta = getMilliseconds(now) - getMilliseconds(m_commitTime.value());
+				lag.printf("%" SQUADFORMAT, MAX(delta, 0) / 1000);
+			}
+
+			string sql;
+			sql.printf("select rdb$set_context('USER_SESSION', 'REPLICATION_APPLY_LAG', %s), "
+					   "rdb$set_context('USER_SESSION', 'REPLICATION_APPLY_WORKERS', %u) "
+					   "from system.rdb$database",
+					   lag.c_str(), (ULONG) MAX(m_workers.getCount(), 1));
+
+			FB_MESSAGE(Result, CheckStatusWrapper,
+				(FB_INTEGER, lagResult)
+				(FB_INTEGER, workersResult)
+			) result(&localStatus, fb_get_master_interface());
+
+			const auto transaction = m_attachment->startTransaction(&localStatus, 0, NULL);
+			localStatus.check();
+
+			m_attachment->execute(&localStatus, transaction, 0, sql.c_str(), SQL_DIALECT_V6,
+								  NULL, NULL, result.getMetadata(), result.getData());
+
+			if (localStatus.isSuccess())
+				transaction->commit(&localStatus);
+
+			if (!localStatus.isSuccess())
+			{
+				FbLocalStatus tempStatus;
+				transaction->rollback(&tempStatus);
+				localStatus.raise();
+			}
 #endif
 		}
 
@@ -449,6 +967,32 @@ namespace
 			return (m_attachment == nullptr);
 		}
 
+		// Parallel workers have failed due to a conflict between them. The failed
+		// segments will be re-applied serially, starting with the next connection.
+
+		bool retrySerially()
+		{
+			if (!m_conflict)
+				return false;
+
+			m_conflict = false;
+			m_serialApply = true;
+			m_serialSequence = m_errorSequence;
+			return true;
+		}
+
+		// Serial apply is finished when the failed segment is applied
+		// and no transaction of the previous connection remains active
+
+		bool resumeParallel(FB_UINT64 sequence, bool active)
+		{
+			if (!m_serialApply || sequence < m_serialSequence || active)
+				return false;
+
+			m_serialApply = false;
+			return true;
+		}
+
 		const PathName& getDirectory() const
 		{
 			return m_config->sourceDirectory;
@@ -503,6 +1047,264 @@ namespace
 		}
 
 	private:
+		IAttachment* attach()
+		{
+			ClumpletWriter dpb(ClumpletReader::dpbList, MAX_DPB_SIZE);
+
+			dpb.insertByte(isc_dpb_no_db_triggers, 1);
+			dpb.insertString(isc_dpb_user_name, DBA_USER_NAME);
+			dpb.insertString(isc_dpb_config, ParsedList::getNonLoopbackProviders(m_config->dbName));
+
+			if (m_config->schemaSearchPath.hasData())
+				dpb.insertString(isc_dpb_search_path, m_config->schemaSearchPath.c_str());
+
+			DispatcherPtr provider;
+			FbLocalStatus localStatus;
+
+			const auto att =
+				provider->attachDatabase(&localStatus, m_config->dbName.c_str(),
+										 dpb.getBufferLength(), dpb.getBuffer());
+			localStatus.check();
+
+			return att;
+		}
+
+		void checkWorker(ApplyWorker* worker)
+		{
+			FB_UINT64 sequence;
+			ULONG offset;
+			const auto& status = worker->getStatus(sequence, offset);
+
+			// Workers may wait for the records changed by each other, as the table
+			// groups do not reflect the original concurrency on the primary
+
+			const ISC_STATUS* const errors = status->getErrors();
+
+			if (fb_utils::containsErrorCode(errors, isc_update_conflict) ||
+				fb_utils::containsErrorCode(errors, isc_lock_conflict) ||
+				fb_utils::containsErrorCode(errors, isc_deadlock))
+			{
+				m_conflict = true;
+			}
+
+			checkCompletion(status, sequence, offset);
+		}
+
+		void clearTransactions()
+		{
+			for (const auto& item : m_transactions)
+				delete item.second;
+
+			m_transactions.clear();
+		}
+
+		// Tables linked by foreign keys are combined into a single group,
+		// as changes inside a group must be applied in the original order
+
+		void loadDependencies()
+		{
+			m_groups.clear();
+
+			FbLocalStatus localStatus;
+
+			const char* sql =
+				"select trim(fk.rdb$schema_name), trim(fk.rdb$relation_name), "
+				"		trim(pk.rdb$schema_name), trim(pk.rdb$relation_name) "
+				"	from system.rdb$ref_constraints ref "
+				"	join system.rdb$relation_constraints fk "
+				"		on fk.rdb$schema_name = ref.rdb$schema_name and "
+				"		   fk.rdb$constraint_name = ref.rdb$constraint_name "
+				"	join system.rdb$relation_constraints pk "
+				"		on pk.rdb$schema_name = ref.rdb$const_schema_name_uq and "
+				"		   pk.rdb$constraint_name = ref.rdb$const_name_uq";
+
+			FB_MESSAGE(Result, CheckStatusWrapper,
+				(FB_VARCHAR(MAX_SQL_IDENTIFIER_LEN), childSchema)
+				(FB_VARCHAR(MAX_SQL_IDENTIFIER_LEN), childName)
+				(FB_VARCHAR(MAX_SQL_IDENTIFIER_LEN), parentSchema)
+				(FB_VARCHAR(MAX_SQL_IDENTIFIER_LEN), parentName)
+			) result(&localStatus, fb_get_master_interface());
+
+			const auto transaction = m_attachment->startTransaction(&localStatus, 0, NULL);
+			localStatus.check();
+
+			try
+			{
+				RefPtr<IResultSet> rs(REF_NO_INCR,
+					m_attachment->openCursor(&localStatus, transaction, 0, sql, SQL_DIALECT_V6,
+											 NULL, NULL, result.getMetadata(), NULL, 0));
+				localStatus.check();
+
+				while (rs->fetchNext(&localStatus, result.getData()) == IStatus::RESULT_OK)
+				{
+					const string childSchema(result->childSchema.str, result->childSchema.length);
+					const string childName(result->childName.str, result->childName.length);
+					const string parentSchema(result->parentSchema.str, result->parentSchema.length);
+					const string parentName(result->parentName.str, result->parentName.length);
+
+					linkGroups(childSchema + "." + childName, parentSchema + "." + parentName);
+
+					// Older primaries (protocol version 1) send the table names without schema
+					linkGroups(childName, parentName);
+				}
+				localStatus.check();
+			}
+			catch (const Exception&)
+			{
+				FbLocalStatus tempStatus;
+				transaction->rollback(&tempStatus);
+				throw;
+			}
+
+			transaction->commit(&localStatus);
+			localStatus.check();
+		}
+
+		void linkGroups(const string& child, const string& parent)
+		{
+			const string childGroup = getGroup(child);
+			const string parentGroup = getGroup(parent);
+
+			if (!m_groups.get(child))
+				m_groups.put(child, childGroup);
+
+			if (!m_groups.get(parent))
+				m_groups.put(parent, parentGroup);
+
+			if (childGroup == parentGroup)
+				return;
+
+			for (auto& item : m_groups)
+			{
+				if (item.second == childGroup)
+					item.second = parentGroup;
+			}
+		}
+
+		string getGroup(const string& relation) const
+		{
+			const auto group = m_groups.get(relation);
+			return group ? *group : relation;
+		}
+
+		// Distribute the block between the workers.
+		//
+		// All blocks of a transaction are applied by the same worker. A block changing
+		// some group of tables waits until the transactions that changed the same group
+		// and ended earlier on other workers are applied, thus preserving the commit
+		// order of dependent transactions. Global operations and blocks containing
+		// DDL or sequence changes are applied while all other workers are idle.
+
+		void dispatch(FB_UINT64 sequence, ULONG offset, ULONG length, const UCHAR* data)
+		{
+			const Block* const header = (const Block*) data;
+			const auto traNumber = header->traNumber;
+
+			SortedObjectsArray<string> relations(getPool());
+			bool exclusive = false, cleanup = false;
+
+			BlockScanner scanner(getPool(), length, data);
+			if (!scanner.scan(relations, exclusive, cleanup))
+				exclusive = true;
+
+			if (!traNumber)
+			{
+				flush();
+
+				if (cleanup)
+				{
+					for (const auto worker : m_workers)
+					{
+						worker->enqueue(sequence, offset, length, data);
+						worker->clearEnded();
+					}
+
+					clearTransactions();
+				}
+				else
+				{
+					m_workers[0]->enqueue(sequence, offset, length, data);
+				}
+
+				flush();
+				return;
+			}
+
+			ApplyTransaction* transaction = nullptr;
+
+			if (!m_transactions.get(traNumber, transaction))
+			{
+				FB_SIZE_T worker = 0;
+
+				for (FB_SIZE_T i = 1; i < m_workers.getCount(); i++)
+				{
+					if (m_workers[i]->getPending() < m_workers[worker]->getPending())
+						worker = i;
+				}
+
+				transaction = FB_NEW_POOL(getPool()) ApplyTransaction(getPool(), worker);
+				m_transactions.put(traNumber, transaction);
+			}
+
+			const auto worker = m_workers[transaction->worker];
+			const bool endTransaction = (header->flags & BLOCK_END_TRANS);
+
+			if (exclusive)
+				transaction->exclusive = true;
+
+			const bool barrier = exclusive || (endTransaction && transaction->exclusive);
+
+			for (const auto& relation : relations)
+			{
+				const auto group = getGroup(relation);
+
+				if (!transaction->groups.exist(group))
+					transaction->groups.add(group);
+
+				if (barrier)
+					continue;
+
+				for (const auto other : m_workers)
+				{
+					if (other == worker)
+						continue;
+
+					if (const auto ticket = other->getEnded(group))
+					{
+						if (!other->waitFor(ticket))
+							checkWorker(other);
+					}
+				}
+			}
+
+			if (barrier)
+				flush();
+
+			const auto ticket = worker->enqueue(sequence, offset, length, data);
+
+			if (scanner.getCommitTime().has_value())
+				m_commitTime = scanner.getCommitTime();
+
+			if (endTransaction)
+			{
+				for (const auto& group : transaction->groups)
+					worker->setEnded(group, ticket);
+
+				m_transactions.remove(traNumber);
+				delete transaction;
+			}
+
+			if (barrier)
+			{
+				flush();
+
+				// DDL could change the foreign keys, so reload them
+
+				if (endTransaction)
+					loadDependencies();
+			}
+		}
+
 		AutoPtr<const Replication::Config> m_config;
 		IAttachment* m_attachment;
 		IReplicator* m_replicator;
@@ -511,6 +1313,13 @@ namespace
 		string m_lastError;
 		FB_UINT64 m_errorSequence;
 		ULONG m_errorOffset;
+		HalfStaticArray<ApplyWorker*, 16> m_workers;
+		NonPooledMap<FB_UINT64, ApplyTransaction*> m_transactions;
+		FullPooledMap<string, string> m_groups;
+		std::optional<ISC_TIMESTAMP> m_commitTime;
+		bool m_conflict;
+		bool m_serialApply;
+		FB_UINT64 m_serialSequence;
 	};
 
 	typedef Array<Target*> TargetList;
@@ -551,14 +1360,7 @@ namespace
 
 	string formatInterval(const TimeStamp& start, const TimeStamp& finish)
 	{
-		static constexpr SINT64 MSEC_PER_DAY = 24 * 60 * 60 * 1000;
-
-		const SINT64 startMsec = ((SINT64) start.value().timestamp_date) * MSEC_PER_DAY +
-			(SINT64) start.value().timestamp_time / 10;
-		const SINT64 finishMsec = ((SINT64) finish.value().timestamp_date) * MSEC_PER_DAY +
-			(SINT64) finish.value().timestamp_time / 10;
-
-		const SINT64 delta = finishMsec - startMsec;
+		const SINT64 delta = getMilliseconds(finish.value()) - getMilliseconds(start.value());
 		const double seconds = (double) delta / 1000;
 
 		string value;
@@ -887,6 +1689,8 @@ namespace
 					raiseError("Journal file %s was unexpectedly changed", segment->filename.c_str());
 
 				ULONG totalLength = sizeof(SegmentHeader);
+				time_t saveTime = time(NULL);
+
 				while (totalLength < segment->header.hdr_length)
 				{
 					if (shutdownFlag)
@@ -917,11 +1721,25 @@ namespace
 
 					totalLength += length;
 
-					control.savePartial(sequence, totalLength, transactions);
+					// With parallel apply, the position is saved only when nothing is in progress,
+					// so the workers are drained periodically even if the applier is never idle
+
+					if (!target->isIdle() && time(NULL) - saveTime >= PARTIAL_SAVE_INTERVAL)
+						target->flush();
+
+					if (target->isIdle())
+					{
+						control.savePartial(sequence, totalLength, transactions);
+						saveTime = time(NULL);
+					}
 				}
 
+				target->flush();
+
 				control.saveComplete(sequence, transactions);
 
+				target->reportProgress();
+
 				file.release();
 
 				const TimeStamp finishTime(TimeStamp::getCurrentTimeStamp());
@@ -976,10 +1794,27 @@ namespace
 				}
 
 				ret = PROCESS_CONTINUE;
+
+				if (target->resumeParallel(sequence, transactions.hasData()))
+				{
+					target->verbose("Resuming parallel apply after segment %" UQUADFORMAT, sequence);
+					ret = PROCESS_SHUTDOWN;		// reconnect with the workers
+					break;
+				}
 			}
 		}
 		catch (const Exception& ex)
 		{
+			if (target->retrySerially())
+			{
+				target->verbose("Conflict between parallel workers, re-applying serially");
+
+				while (queue.hasData())
+					delete queue.pop();
+
+				return PROCESS_SHUTDOWN;
+			}
+
 			FbLocalStatus localStatus;
 			ex.stuffException(&localStatus);
 
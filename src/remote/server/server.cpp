@@ -1326,7 +1326,6 @@ public:
 	~Worker();
 
 	bool wait(int timeout = IDLE_TIMEOUT);	// true is success, false if timeout
-	static bool wakeUp();
 
 	void setState(const bool active);
 	static void start(USHORT flags);
@@ -1349,11 +1348,13 @@ private:
 
 	void remove();
 	void insert(const bool active);
+	static bool wakeUp();
 	static void wakeUpAll();
 
+	// Workers lists and counters are protected by request_que_mutex, as they are
+	// changed when requests are queued and dequeued
 	static Worker* m_activeWorkers;
 	static Worker* m_idleWorkers;
-	static GlobalPtr<Mutex> m_mutex;
 	static int m_cntAll;
 	static int m_cntIdle;
 	static int m_cntGoing;
@@ -1362,7 +1363,6 @@ private:
 
 Worker* Worker::m_activeWorkers = NULL;
 Worker* Worker::m_idleWorkers = NULL;
-GlobalPtr<Mutex> Worker::m_mutex;
 int Worker::m_cntAll = 0;
 int Worker::m_cntIdle = 0;
 int Worker::m_cntGoing = 0;
@@ -7298,13 +7298,13 @@ Worker::Worker()
 	m_tid = getThreadId();
 #endif
 
-	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+	MutexLockGuard guard(request_que_mutex, FB_FUNCTION);
 	insert(m_active);
 }
 
 Worker::~Worker()
 {
-	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+	MutexLockGuard guard(request_que_mutex, FB_FUNCTION);
 	remove();
 	--m_cntAll;
 	if (m_going)
@@ -7317,7 +7317,7 @@ bool Worker::wait(int timeout)
 	if (m_sem.tryEnter(timeout))
 		return true;
 
-	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+	MutexLockGuard guard(request_que_mutex, FB_FUNCTION);
 	if (m_sem.tryEnter(0))
 		return true;
 
@@ -7332,20 +7332,19 @@ bool Worker::wait(int timeout)
 	return false;
 }
 
+// assume request_que_mutex is locked
 void Worker::setState(const bool active)
 {
 	if (m_active == active)
 		return;
 
-	MutexLockGuard guard(m_mutex, FB_FUNCTION);
 	remove();
 	insert(active);
 }
 
+// assume request_que_mutex is locked
 bool Worker::wakeUp()
 {
-	MutexLockGuard reqQueGuard(request_que_mutex, FB_FUNCTION);
-
 #ifdef _DEBUG
 	int cnt = 0;
 	for (server_req_t* req = request_que; req; req = req->req_next)
@@ -7361,8 +7360,6 @@ bool Worker::wakeUp()
 	if (!ports_pending)
 		return true;
 
-	MutexLockGuard guard(m_mutex, FB_FUNCTION);
-
 	if (m_idleWorkers)
 	{
 		Worker* idle = m_idleWorkers;
@@ -7377,9 +7374,9 @@ bool Worker::wakeUp()
 	return (m_cntAll - m_cntGoing >= MAX_THREADS);
 }
 
+// assume request_que_mutex is locked
 void Worker::wakeUpAll()
 {
-	MutexLockGuard guard(m_mutex, FB_FUNCTION);
 	for (Worker* thd = m_idleWorkers; thd; thd = thd->m_next)
 		thd->m_sem.release();
 }
@@ -7430,30 +7427,37 @@ void Worker::insert(const bool active)
 
 void Worker::start(USHORT flags)
 {
-	if (!isShuttingDown() && !wakeUp())
-	{
-		if (isShuttingDown())
+	if (isShuttingDown())
+		return;
+
+	{	// scope
+		MutexLockGuard guard(request_que_mutex, FB_FUNCTION);
+
+		if (wakeUp() || isShuttingDown())
 			return;
 
-		MutexLockGuard guard(m_mutex, FB_FUNCTION);
-		try
-		{
-			Thread::start(loopThread, (void*)(IPTR) flags, THREAD_medium);
-			++m_cntAll;
-		}
-		catch (const Exception&)
+		// New thread is counted in advance, the queue is not blocked while it's started
+		++m_cntAll;
+	}
+
+	try
+	{
+		Thread::start(loopThread, (void*)(IPTR) flags, THREAD_medium);
+	}
+	catch (const Exception&)
+	{
+		MutexLockGuard guard(request_que_mutex, FB_FUNCTION);
+
+		if (!--m_cntAll)
 		{
-			if (!m_cntAll)
-			{
-				Arg::Gds(isc_no_threads).raise();
-			}
+			Arg::Gds(isc_no_threads).raise();
 		}
 	}
 }
 
 void Worker::shutdown()
 {
-	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+	MutexLockGuard guard(request_que_mutex, FB_FUNCTION);
 	if (shutting_down)
 	{
 		return;
@@ -7464,17 +7468,17 @@ void Worker::shutdown()
 	while (getCount())
 	{
 		wakeUpAll();
-		m_mutex->leave();	// we need CheckoutGuard here
+		request_que_mutex->leave();	// we need CheckoutGuard here
 		try
 		{
 			Thread::sleep(100);
 		}
 		catch (const Exception&)
 		{
-			m_mutex->enter(FB_FUNCTION);
+			request_que_mutex->enter(FB_FUNCTION);
 			throw;
 		}
-		m_mutex->enter(FB_FUNCTION);
+		request_que_mutex->enter(FB_FUNCTION);
 	}
 }
 
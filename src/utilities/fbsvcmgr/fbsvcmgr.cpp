@@ -426,6 +426,7 @@ constexpr SvcSwitches backupOptions[] =
 	{"bkp_crypt", putStringArgument, 0, isc_spb_bkp_crypt, 0 },
 	{"bkp_zip", putOption, 0, isc_spb_bkp_zip, 0 },
 	{"bkp_parallel_workers", putIntArgument, 0, isc_spb_bkp_parallel_workers, 0},
+	{"bkp_zip_level", putIntArgument, 0, isc_spb_bkp_zip_level, 0},
 	{"bkp_direct_io", putOption, 0, isc_spb_bkp_direct_io, 0},
 	{0, 0, 0, 0, 0}
 };
@@ -460,6 +461,7 @@ constexpr SvcSwitches restoreOptions[] =
 	{"res_crypt", putStringArgument, 0, isc_spb_res_crypt, 0 },
 	{"res_replica_mode", putReplicaMode, 0, isc_spb_res_replica_mode, 0},
 	{"res_parallel_workers", putIntArgument, 0, isc_spb_res_parallel_workers, 0},
+	{"res_index_memory", putIntArgument, 0, isc_spb_res_index_memory, 0},
 	{"res_direct_io", putOption, 0, isc_spb_res_direct_io, 0},
 	{0, 0, 0, 0, 0}
 };